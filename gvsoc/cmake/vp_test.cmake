@@ -0,0 +1,87 @@
+# Model tests
+#
+# A test runs a small platform described by a JSON configuration with the
+# optimized launcher. The runner gets the module of every model the platform
+# uses and lays them out like an installed GVSOC_PATH, so that tests run from
+# the build tree.
+# Tests are only available when optimized models are built.
+
+set(VP_TEST_RUNNER "${CMAKE_CURRENT_LIST_DIR}/../gvsoc/tests/gvsoc_test.py" CACHE INTERNAL "")
+
+# Models which are always needed to run a platform
+set(VP_TEST_ENGINE_MODELS
+    "vp.trace_domain_impl=trace_domain_impl"
+    "vp.time_domain_impl=time_domain_impl"
+    "vp.clock_domain_impl=clock_domain_impl"
+    "utils.composite_impl=composite_impl"
+    CACHE INTERNAL "")
+
+# Model only used by tests, it is built like an optimized model but not installed
+function(vp_test_model)
+    cmake_parse_arguments(
+        VP_TEST_MODEL
+        ""
+        "NAME"
+        "SOURCES"
+        ${ARGN}
+        )
+
+    if(${BUILD_OPTIMIZED})
+        add_library(${VP_TEST_MODEL_NAME} MODULE ${VP_TEST_MODEL_SOURCES})
+        target_link_libraries(${VP_TEST_MODEL_NAME} PRIVATE gvsoc gap_archi archi_pulp)
+        set_target_properties(${VP_TEST_MODEL_NAME} PROPERTIES PREFIX "")
+        target_compile_options(${VP_TEST_MODEL_NAME} PRIVATE "-D__GVSOC__")
+        foreach(X IN LISTS VP_MODEL_ROOT_DIRS)
+            target_include_directories(${VP_TEST_MODEL_NAME} PRIVATE ${X})
+        endforeach()
+    endif()
+endfunction()
+
+# Test running a platform.
+# MODELS gives the models used by the platform as <module name>=<model name>,
+# where the model name is the one given to vp_model, or to vp_test_model for
+# models only used by tests.
+# SET overrides configuration properties as <path>=<JSON value>.
+# EXPECT gives regular expressions which must match the output.
+function(vp_test)
+    cmake_parse_arguments(
+        VP_TEST
+        ""
+        "NAME;CONFIG;TIMEOUT"
+        "MODELS;SET;EXPECT"
+        ${ARGN}
+        )
+
+    if(NOT ${BUILD_OPTIMIZED})
+        return()
+    endif()
+
+    set(VP_TEST_ARGS
+        "--launcher=$<TARGET_FILE:gvsoc_launcher>"
+        "--config=${CMAKE_CURRENT_SOURCE_DIR}/${VP_TEST_CONFIG}"
+        )
+
+    foreach(X IN LISTS VP_TEST_ENGINE_MODELS VP_TEST_MODELS)
+        string(REPLACE "=" ";" X_ITEMS ${X})
+        list(GET X_ITEMS 0 X_MODULE)
+        list(GET X_ITEMS 1 X_TARGET)
+        if(TARGET ${X_TARGET}_optim)
+            set(X_TARGET ${X_TARGET}_optim)
+        endif()
+        list(APPEND VP_TEST_ARGS "--model=${X_MODULE}=$<TARGET_FILE:${X_TARGET}>")
+    endforeach()
+
+    foreach(X IN LISTS VP_TEST_SET)
+        list(APPEND VP_TEST_ARGS "--set=${X}")
+    endforeach()
+
+    foreach(X IN LISTS VP_TEST_EXPECT)
+        list(APPEND VP_TEST_ARGS "--expect=${X}")
+    endforeach()
+
+    add_test(NAME ${VP_TEST_NAME} COMMAND ${VP_TEST_RUNNER} ${VP_TEST_ARGS})
+
+    if(VP_TEST_TIMEOUT)
+        set_tests_properties(${VP_TEST_NAME} PROPERTIES TIMEOUT ${VP_TEST_TIMEOUT})
+    endif()
+endfunction()
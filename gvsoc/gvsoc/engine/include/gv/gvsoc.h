@@ -44,6 +44,10 @@ void *gv_open(const char *config_path, bool open_proxy, int *proxy_socket, int r
 
 void *gv_create(const char *config_path, struct gv_conf *conf);
 
+// Build and bind all the components of the platform without starting them. This is
+// done by gv_start if it has not been done before.
+void gv_elaborate(void *instance);
+
 void gv_start(void *instance);
 
 void gv_reset(void *instance, bool active);
@@ -52,6 +56,18 @@ void gv_step(void *instance, int64_t timestamp);
 
 int64_t gv_time(void *instance);
 
+// Save the state of the whole platform to the specified file. The engine
+// must not be running. Memories are stored in separate sparse files whose
+// names start with the same path.
+// Returns 0 if it succeeded.
+int gv_checkpoint(void *instance, const char *path);
+
+// Restore the state of the platform from the specified checkpoint file.
+// The platform must have been created with the same configuration, started
+// and reset.
+// Returns 0 if it succeeded.
+int gv_restore(void *instance, const char *path);
+
 int gv_run(void *_instance);
 
 void gv_stop(void *_instance, int status);
@@ -60,6 +76,13 @@ void gv_destroy(void *handle);
 
 void *gv_chip_pad_bind(void *handle, char *name, int ext_handle);
 
+// Run a batch simulation server. The platform is elaborated once, then each test
+// received on the unix socket at socket_path is simulated in a process forked from
+// it, with at most nb_jobs tests running at the same time (0 for the number of host
+// cores). See docs/engine.rst for the protocol.
+// Returns when a quit command has been received and all tests are done.
+int gv_batch_server(const char *config_path, const char *socket_path, int nb_jobs);
+
 #ifdef __cplusplus
 }
 #endif
@@ -373,6 +373,32 @@ namespace gv {
          * @returns The timestamp where the execution will stop after the duration is reached.
          */
         virtual int64_t step(int64_t duration) = 0;
+
+        /**
+         * Save the simulated system state
+         *
+         * This saves the state of all components to the specified file so that
+         * it can be restored later on, possibly from another process.
+         * Memories are saved to separate sparse files whose names start with the same path.
+         * Execution must be stopped.
+         *
+         * @param path The path of the checkpoint file.
+         *
+         * @returns 0 if the operation succeeded, or another value otherwise.
+         */
+        virtual int checkpoint(std::string path) = 0;
+
+        /**
+         * Restore the simulated system state
+         *
+         * This restores the state of all components from the specified checkpoint file.
+         * The system must have been opened with the same configuration and started.
+         *
+         * @param path The path of the checkpoint file.
+         *
+         * @returns 0 if the operation succeeded, or another value otherwise.
+         */
+        virtual int restore(std::string path) = 0;
     };
 
 
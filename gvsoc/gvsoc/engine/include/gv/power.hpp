@@ -242,6 +242,16 @@ namespace vp
              */
             inline bool get_active() { return trace.get_event_active(); }
 
+            /**
+             * @brief Register a callback called when the trace is enabled or disabled
+             *
+             * This can be used by models which have a faster mode when power is not
+             * accounted, to know when they have to switch mode.
+             *
+             * @param callback Callback to be called when the trace state changes.
+             */
+            inline void register_callback(std::function<void()> callback) { trace.register_callback(callback); }
+
             /**
              * @brief Dump the trace
              *
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+
+namespace vp {
+
+    class component;
+
+    // Binary stream used to save the state of all components to a checkpoint
+    // file and to restore it.
+    // The same stream is used for both directions so that components can
+    // implement save and restore with the same sequence of accesses.
+    // Components having big data like memories can use the checkpoint path
+    // to store them into separate files.
+    class checkpoint
+    {
+    public:
+        checkpoint(std::string path, bool is_restore);
+        ~checkpoint();
+
+        // Open the checkpoint file and write or check the header, returns 0 if
+        // it succeeded
+        int open(int64_t *time);
+
+        inline bool is_restore() { return this->restore; }
+        inline bool has_error() { return this->error_msg != ""; }
+        inline std::string get_error() { return this->error_msg; }
+        inline std::string get_path() { return this->path; }
+
+        // Get the path of a file which can be used by a component to store
+        // data out of the main checkpoint file
+        std::string get_file_path(vp::component *comp, std::string suffix);
+
+        void error(std::string msg);
+
+        void write(const void *data, size_t size);
+        void read(void *data, size_t size);
+
+        // Save the data in save mode or restore it in restore mode
+        inline void sync(void *data, size_t size)
+        {
+            if (this->restore)
+                this->read(data, size);
+            else
+                this->write(data, size);
+        }
+
+        template<typename T> inline void sync(T *value)
+        {
+            this->sync((void *)value, sizeof(T));
+        }
+
+        void sync(std::string *value);
+
+        // Save the tag in save mode or check it in restore mode, to detect
+        // checkpoints from different platforms
+        void sync_tag(std::string tag);
+
+    private:
+        std::string path;
+        bool restore;
+        FILE *file = NULL;
+        std::string error_msg;
+    };
+};
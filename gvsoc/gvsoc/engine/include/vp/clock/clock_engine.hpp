@@ -107,6 +107,11 @@ namespace vp {
 
     int64_t exec();
 
+    // Remove all pending events
+    void clear();
+
+    void checkpoint_state(vp::checkpoint *cp);
+
     inline void sync();
 
     void update();
@@ -125,12 +130,27 @@ namespace vp {
 
     int64_t get_frequency() { return freq; }
 
-    bool has_events() { return this->nb_enqueued_to_cycle || this->delayed_queue; }
+    bool has_events() { return this->nb_enqueued_to_cycle || this->nb_enqueued_to_wheel; }
+
+    // Reports the number of events executed by this clock domain
+    void get_perf_counters(std::vector<std::pair<std::string, int64_t>> &counters);
 
   protected:
 
     void flush_delayed_queue();
 
+    void wheel_insert(clock_event *event);
+
+    void wheel_remove(clock_event *event);
+
+    void wheel_set_position(int64_t cycle);
+
+    void wheel_cascade(int level, int slot);
+
+    void wheel_flush(int64_t limit);
+
+    clock_event *wheel_get_first();
+
     inline void enqueue_to_cycle(clock_event *event, int64_t cycles)
     {
       // The position of one round of the circular buffer is always aligned
@@ -145,7 +165,26 @@ namespace vp {
     clock_event *enqueue_other(clock_event *event, int64_t cycles);
 
     clock_event *event_queue[CLOCK_EVENT_QUEUE_SIZE];
-    clock_event *delayed_queue = NULL;
+
+    // Hierarchical timing wheel keeping the events which do not fit into the
+    // circular buffer.
+    // Slots of level k cover 64^k cycles and only contain events which have
+    // the same level k+1 slot as the wheel position, so that the events of a
+    // level are always after the events of the lower levels.
+    // The last level is an overflow list for events which are too far.
+    // Slots are doubly-linked lists so that events can be removed in constant
+    // time, and a bitmask per level tells which slots are not empty.
+    clock_event *wheel_first[CLOCK_WHEEL_NB_LEVELS + 1][CLOCK_WHEEL_LEVEL_SIZE];
+    clock_event *wheel_last[CLOCK_WHEEL_NB_LEVELS + 1][CLOCK_WHEEL_LEVEL_SIZE];
+    uint64_t wheel_mask[CLOCK_WHEEL_NB_LEVELS + 1];
+    // Cycle from which the wheel is organized. All events in the wheel are
+    // at this cycle or after.
+    int64_t wheel_cycle = 0;
+    // Tells how many events are enqueued to the timing wheel.
+    int nb_enqueued_to_wheel = 0;
+    // First event of the timing wheel, as found by wheel_get_first, so that it is not searched
+    // again before the wheel is modified. NULL if it must be searched.
+    clock_event *wheel_first_event = NULL;
     int current_cycle = 0;
     int64_t period = 0;
     int64_t freq;
@@ -156,6 +195,10 @@ namespace vp {
     // engine is updated by an external interaction.
     int64_t cycles = 0;
 
+    // Number of events executed so far, to see how much work the models of this domain
+    // need to simulate a given amount of traffic.
+    int64_t nb_events = 0;
+
     // Tells how many events are enqueued to the circular buffer.
     // If it is zero, there could still be some events in the delayed queue.
     int nb_enqueued_to_cycle = 0;
@@ -34,6 +34,10 @@ namespace vp {
   #define CLOCK_EVENT_NB_ARGS 8
   #define CLOCK_EVENT_QUEUE_SIZE 32
   #define CLOCK_EVENT_QUEUE_MASK (CLOCK_EVENT_QUEUE_SIZE - 1)
+  #define CLOCK_WHEEL_LEVEL_BITS 6
+  #define CLOCK_WHEEL_LEVEL_SIZE (1 << CLOCK_WHEEL_LEVEL_BITS)
+  #define CLOCK_WHEEL_LEVEL_MASK (CLOCK_WHEEL_LEVEL_SIZE - 1)
+  #define CLOCK_WHEEL_NB_LEVELS 5
 
   typedef void (clock_event_meth_t)(void *, clock_event *event);
 
@@ -47,7 +51,7 @@ namespace vp {
     clock_event(component_clock *comp, clock_event_meth_t *meth);
 
     clock_event(component_clock *comp, void *_this, clock_event_meth_t *meth) 
-      : comp(comp), _this(_this), meth(meth), enqueued(false) {}
+      : comp(comp), _this(_this), meth(meth), enqueued(false), wheel_level(-1) {}
 
     inline int get_payload_size() { return CLOCK_EVENT_PAYLOAD_SIZE; }
     inline uint8_t *get_payload() { return payload; }
@@ -68,8 +72,13 @@ namespace vp {
     void *_this;
     clock_event_meth_t *meth;
     clock_event *next;
+    // Only valid when the event is in the timing wheel
+    clock_event *prev;
     bool enqueued;
     int64_t cycle;
+    // Level and slot of the timing wheel where the event is, or -1 if it is not in the wheel
+    int wheel_level;
+    int wheel_slot;
   };    
 
 };
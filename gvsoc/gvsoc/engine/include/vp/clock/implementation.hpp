@@ -92,6 +92,11 @@ inline vp::time_engine *vp::component_clock::get_engine()
 
 inline void vp::clock_engine::sync()
 {
+  // In parallel mode, a domain simulated by another thread is left as it is, it is
+  // only reached through links, which post what they receive to its thread
+  if (unlikely(this->engine->is_parallel()) && !this->engine->is_local(this))
+    return;
+
   if (!is_running() && !nb_enqueued_to_cycle)
   {
     this->update();
@@ -39,6 +39,7 @@
 #include "json.hpp"
 #include <functional>
 #include "vp/register.hpp"
+#include "vp/checkpoint.hpp"
 
 
 #define   likely(x) __builtin_expect(x, 1)
@@ -75,6 +76,7 @@ namespace vp {
 
     protected:
         void reset_all(bool active);
+        void checkpoint_all(vp::checkpoint *cp);
         void add_block(block *block);
 
     private:
@@ -115,8 +117,27 @@ namespace vp {
 
     virtual void dump_traces(FILE *file) {}
 
+    // Called when a checkpoint is saved or restored, to let the component
+    // save or restore its internal state which is not in registers,
+    // signals or clock events. In restore mode, this is called on a platform
+    // which has been started and reset.
+    virtual void checkpoint_state(vp::checkpoint *cp) {}
+
+    // Called in the child process when the simulator is forked after elaboration, to let the
+    // component create again the host threads it created before, as only the forking thread
+    // exists in the child.
+    virtual void post_fork() {}
+
+    // Called at the end of a batch test to let the component report its performance
+    // counters, for example the HW counters of a core, as name/value pairs.
+    virtual void get_perf_counters(std::vector<std::pair<std::string, int64_t>> &counters) {}
+
     void dump_traces_recursive(FILE *file);
 
+    // Same as get_perf_counters for this component and its childs, with the counter names
+    // prefixed by the component path.
+    void get_perf_counters_recursive(std::vector<std::pair<std::string, int64_t>> &counters);
+
     component *get_parent() { return this->parent; }
     inline js::config *get_js_config() { return comp_js_config; }
 
@@ -160,6 +181,12 @@ namespace vp {
 
     int build_new();
 
+    void bind_new();
+
+    void start_new();
+
+    void post_fork_all();
+
     void load_all();
 
     void flush_all();
@@ -178,6 +205,11 @@ namespace vp {
 
     void reset_all(bool active, bool from_itf=false);
 
+    // Save or restore the state of this component and its childs.
+    // Clock events are re-enqueued through the returned callbacks once
+    // all components, including clock engines, have been restored.
+    void checkpoint_all(vp::checkpoint *cp, std::vector<std::function<void()>> *enqueue_callbacks);
+
     void new_master_port(std::string name, master_port *port);
 
     void new_master_port(void *comp, std::string name, master_port *port);
@@ -191,6 +223,11 @@ namespace vp {
     void add_service(std::string name, void *service);
 
     vp::component *new_component(std::string name, js::config *config, std::string module="");
+
+    // Registers the constructor of a model linked into the simulator, which is then used instead of
+    // loading the model module. Module name is the one from the vp_component property, prefixed
+    // by the flavor the model is compiled for ("debug.", "sv." or none).
+    static int register_constructor(std::string module_name, vp::component *(*constructor)(js::config *));
     void build_instance(std::string name, vp::component *parent);
 
     int get_ports(bool master, int size, const char *names[], void *ports[]);
@@ -270,9 +307,23 @@ namespace vp {
   public:
       component *top_instance;
       power::engine *power_engine;
+      bool elaborated = false;
   private:
   };
 
 };  
 
+// Flavor of the models being compiled, which prefixes their module path
+#if defined(__VP_USE_SYSTEMV)
+#define VP_MODULE_FLAVOR "sv."
+#elif defined(VP_TRACE_ACTIVE)
+#define VP_MODULE_FLAVOR "debug."
+#else
+#define VP_MODULE_FLAVOR ""
+#endif
+
+// Can be used by models linked into the simulator to register their constructor
+#define VP_REGISTER_COMPONENT(module_name, constructor) \
+  static int __vp_register_component = vp::component::register_constructor(std::string(VP_MODULE_FLAVOR) + module_name, constructor)
+
 #endif
@@ -36,6 +36,14 @@ namespace vp
             stopped
         } state;
 
+        // Watchpoint types, with the same values as in the RSP Z/z packets
+        typedef enum
+        {
+            watch_write = 2,
+            watch_read = 3,
+            watch_access = 4
+        } watchpoint_type;
+
         virtual int gdbserver_get_id() = 0;
         virtual std::string gdbserver_get_name() = 0;
         virtual int gdbserver_reg_set(int reg, uint8_t *value) = 0;
@@ -45,6 +53,13 @@ namespace vp
         virtual int gdbserver_cont() = 0;
         virtual int gdbserver_stepi() = 0;
         virtual int gdbserver_state() = 0;
+
+        // Data watchpoints are optional, cores which do not support them just
+        // keep these default implementations.
+        virtual int gdbserver_watchpoint_insert(int type, uint64_t addr, int size) { return -1; }
+        virtual int gdbserver_watchpoint_remove(int type, uint64_t addr, int size) { return -1; }
+        // Returns true if the core was stopped by a watchpoint, with its type and the accessed address
+        virtual bool gdbserver_watchpoint_hit(int *type, uint64_t *addr) { return false; }
     };
 
 
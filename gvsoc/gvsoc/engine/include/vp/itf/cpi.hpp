@@ -38,6 +38,10 @@ namespace vp {
   typedef void (cpi_sync_cycle_meth_t)(void *, int href, int vsync, int data);
   typedef void (cpi_sync_cycle_meth_muxed_t)(void *, int href, int vsync, int data, int id);
 
+  // Bytes sampled while href is active, for camera models sending a whole line at once
+  typedef void (cpi_sync_line_meth_t)(void *, uint8_t *data, int size);
+  typedef void (cpi_sync_line_meth_muxed_t)(void *, uint8_t *data, int size, int id);
+
 
   class cpi_master : public vp::master_port
   {
@@ -57,6 +61,14 @@ namespace vp {
       return sync_cycle_meth(this->get_remote_context(), href, vsync, data);
     }
 
+    inline void sync_line(uint8_t *data, int size)
+    {
+      return sync_line_meth(this->get_remote_context(), data, size);
+    }
+
+    // Tell if the slave can receive lines with sync_line instead of byte per byte
+    bool has_sync_line() { return sync_line_meth != NULL; }
+
     void bind_to(vp::port *port, vp::config *config);
 
     bool is_bound() { return slave_port != NULL; }
@@ -65,6 +77,7 @@ namespace vp {
 
     static inline void sync_muxed_stub(cpi_master *_this, int pclk, int href, int vsync, int data);
     static inline void sync_cycle_muxed_stub(cpi_master *_this, int href, int vsync, int data);
+    static inline void sync_line_muxed_stub(cpi_master *_this, uint8_t *data, int size);
 
     void (*sync_meth)(void *, int pclk, int href, int vsync, int data);
     void (*sync_meth_mux)(void *, int pclk, int href, int vsync, int data, int mux);
@@ -72,6 +85,9 @@ namespace vp {
     void (*sync_cycle_meth)(void *, int href, int vsync, int data);
     void (*sync_cycle_meth_mux)(void *, int href, int vsync, int data, int mux);
 
+    void (*sync_line_meth)(void *, uint8_t *data, int size) = NULL;
+    void (*sync_line_meth_mux)(void *, uint8_t *data, int size, int mux);
+
     vp::component *comp_mux;
     int sync_mux;
     cpi_slave *slave_port = NULL;
@@ -95,6 +111,9 @@ namespace vp {
     inline void set_sync_cycle_meth(cpi_sync_cycle_meth_t *meth);
     inline void set_sync_cycle_meth_muxed(cpi_sync_cycle_meth_muxed_t *meth, int id);
 
+    inline void set_sync_line_meth(cpi_sync_line_meth_t *meth);
+    inline void set_sync_line_meth_muxed(cpi_sync_line_meth_muxed_t *meth, int id);
+
     inline void bind_to(vp::port *_port, vp::config *config);
 
   private:
@@ -105,6 +124,9 @@ namespace vp {
     void (*sync_cycle_meth)(void *comp, int href, int vsync, int data);
     void (*sync_cycle_mux_meth)(void *comp, int href, int vsync, int data, int mux);
 
+    void (*sync_line_meth)(void *comp, uint8_t *data, int size) = NULL;
+    void (*sync_line_mux_meth)(void *comp, uint8_t *data, int size, int mux) = NULL;
+
     static inline void sync_default(cpi_slave *, int pclk, int href, int vsync, int data);
     static inline void sync_cycle_default(cpi_slave *, int href, int vsync, int data);
 
@@ -129,6 +151,11 @@ namespace vp {
     return _this->sync_cycle_meth_mux(_this->comp_mux, href, vsync, data, _this->sync_mux);
   }
 
+  inline void cpi_master::sync_line_muxed_stub(cpi_master *_this, uint8_t *data, int size)
+  {
+    return _this->sync_line_meth_mux(_this->comp_mux, data, size, _this->sync_mux);
+  }
+
   inline void cpi_master::bind_to(vp::port *_port, vp::config *config)
   {
     cpi_slave *port = (cpi_slave *)_port;
@@ -136,6 +163,7 @@ namespace vp {
     {
       sync_meth = port->sync_meth;
       sync_cycle_meth = port->sync_cycle_meth;
+      sync_line_meth = port->sync_line_meth;
       set_remote_context(port->get_context());
     }
     else
@@ -146,6 +174,12 @@ namespace vp {
       sync_cycle_meth_mux = port->sync_cycle_mux_meth;
       sync_cycle_meth = (cpi_sync_cycle_meth_t *)&cpi_master::sync_cycle_muxed_stub;
 
+      if (port->sync_line_mux_meth)
+      {
+        sync_line_meth_mux = port->sync_line_mux_meth;
+        sync_line_meth = (cpi_sync_line_meth_t *)&cpi_master::sync_line_muxed_stub;
+      }
+
       set_remote_context(this);
       comp_mux = (vp::component *)port->get_context();
       sync_mux = port->mux_id;
@@ -188,6 +222,19 @@ namespace vp {
     mux_id = id;
   }
 
+  inline void cpi_slave::set_sync_line_meth(cpi_sync_line_meth_t *meth)
+  {
+    sync_line_meth = meth;
+    sync_line_mux_meth = NULL;
+  }
+
+  inline void cpi_slave::set_sync_line_meth_muxed(cpi_sync_line_meth_muxed_t *meth, int id)
+  {
+    sync_line_mux_meth = meth;
+    sync_line_meth = NULL;
+    mux_id = id;
+  }
+
   inline void cpi_slave::sync_default(cpi_slave *, int pclk, int href, int vsync, int data)
   {
   }
@@ -32,12 +32,33 @@ namespace vp {
 
 
 
+  // Burst-level transfer of several data bytes at once.
+  // This is a companion of the cycle-level sync which lets a master move a whole
+  // chunk of the data phase of a transaction with a single call instead of one
+  // sync per byte. The transaction is still opened with the command-address
+  // bytes, so the burst continues it at the current address of the device.
+  // Slaves which do not implement it reject the burst and the master must then
+  // fall back to cycle-level syncs.
+  class hyper_burst
+  {
+  public:
+    int size;           // Number of data bytes
+    bool is_write;      // True if data goes from master to slave
+    uint8_t *data;      // Data sent for writes, filled by the slave for reads
+    int64_t duration;   // Duration of the whole burst in picoseconds
+  };
+
+
+
   typedef void (hyper_sync_cycle_meth_t)(void *, int data);
   typedef void (hyper_cs_sync_meth_t)(void *, int cs, int active);
 
   typedef void (hyper_sync_cycle_meth_muxed_t)(void *, int data, int id);
   typedef void (hyper_cs_sync_meth_muxed_t)(void *, int cs, int active, int id);
 
+  typedef bool (hyper_burst_meth_t)(void *, hyper_burst *burst);
+  typedef bool (hyper_burst_meth_muxed_t)(void *, hyper_burst *burst, int id);
+
 
   class hyper_master : public vp::master_port
   {
@@ -57,6 +78,13 @@ namespace vp {
       return cs_sync_meth(this->get_remote_context(), cs, active);
     }
 
+    // Returns false if the slave does not support burst-level transfers, in
+    // which case nothing has been transfered.
+    inline bool burst(hyper_burst *burst)
+    {
+      return burst_meth(this->get_remote_context(), burst);
+    }
+
     void bind_to(vp::port *port, vp::config *config);
 
     inline void set_sync_cycle_meth(hyper_sync_cycle_meth_t *meth);
@@ -68,6 +96,7 @@ namespace vp {
 
     static inline void sync_cycle_muxed_stub(hyper_master *_this, int data);
     static inline void cs_sync_muxed_stub(hyper_master *_this, int cs, int active);
+    static inline bool burst_muxed_stub(hyper_master *_this, hyper_burst *burst);
 
     void (*slave_sync_cycle)(void *comp, int data);
     void (*slave_sync_cycle_mux)(void *comp, int data, int mux);
@@ -76,6 +105,8 @@ namespace vp {
     void (*sync_cycle_meth_mux)(void *, int data, int mux);
     void (*cs_sync_meth)(void *, int cs, int active);
     void (*cs_sync_meth_mux)(void *, int cs, int active, int mux);
+    bool (*burst_meth)(void *, hyper_burst *burst);
+    bool (*burst_meth_mux)(void *, hyper_burst *burst, int mux);
 
     static inline void sync_cycle_default(void *, int data);
 
@@ -108,6 +139,9 @@ namespace vp {
     inline void set_cs_sync_meth(hyper_cs_sync_meth_t *meth);
     inline void set_cs_sync_meth_muxed(hyper_cs_sync_meth_muxed_t *meth, int id);
 
+    inline void set_burst_meth(hyper_burst_meth_t *meth);
+    inline void set_burst_meth_muxed(hyper_burst_meth_muxed_t *meth, int id);
+
     inline void bind_to(vp::port *_port, vp::config *config);
 
     static inline void sync_cycle_muxed_stub(hyper_slave *_this, int data);
@@ -122,9 +156,13 @@ namespace vp {
     void (*sync_cycle_mux_meth)(void *comp, int data, int mux);
     void (*cs_sync)(void *comp, int cs, int active);
     void (*cs_sync_mux)(void *comp, int cs, int active, int mux);
+    bool (*burst)(void *comp, hyper_burst *burst);
+    bool (*burst_mux)(void *comp, hyper_burst *burst, int mux);
 
     static inline void sync_cycle_default(hyper_slave *, int data);
     static inline void cs_sync_default(hyper_slave *, int cs, int active);
+    static inline bool burst_default(hyper_slave *, hyper_burst *burst);
+    static inline bool burst_muxed_default(hyper_slave *, hyper_burst *burst, int id);
 
     vp::component *comp_mux;
     int sync_mux;
@@ -173,6 +211,13 @@ namespace vp {
 
 
 
+  inline bool hyper_master::burst_muxed_stub(hyper_master *_this, hyper_burst *burst)
+  {
+    return _this->burst_meth_mux(_this->comp_mux, burst, _this->sync_mux);
+  }
+
+
+
   inline void hyper_master::bind_to(vp::port *_port, vp::config *config)
   {
     hyper_slave *port = (hyper_slave *)_port;
@@ -180,6 +225,7 @@ namespace vp {
     {
       sync_cycle_meth = port->sync_cycle_meth;
       cs_sync_meth = port->cs_sync;
+      burst_meth = port->burst;
       this->set_remote_context(port->get_context());
     }
     else
@@ -190,6 +236,9 @@ namespace vp {
       cs_sync_meth_mux = port->cs_sync_mux;
       cs_sync_meth = (hyper_cs_sync_meth_t *)&hyper_master::cs_sync_muxed_stub;
 
+      burst_meth_mux = port->burst_mux;
+      burst_meth = (hyper_burst_meth_t *)&hyper_master::burst_muxed_stub;
+
       this->set_remote_context(this);
       comp_mux = (vp::component *)port->get_context();
       sync_mux = port->mux_id;
@@ -225,6 +274,8 @@ namespace vp {
   inline hyper_slave::hyper_slave() : sync_cycle_meth(NULL), sync_cycle_mux_meth(NULL) {
     sync_cycle_meth = (hyper_sync_cycle_meth_t *)&hyper_slave::sync_cycle_default;
     cs_sync = (hyper_cs_sync_meth_t *)&hyper_slave::cs_sync_default;
+    burst = (hyper_burst_meth_t *)&hyper_slave::burst_default;
+    burst_mux = (hyper_burst_meth_muxed_t *)&hyper_slave::burst_muxed_default;
   }
 
   inline void hyper_slave::set_sync_cycle_meth(hyper_sync_cycle_meth_t *meth)
@@ -239,6 +290,17 @@ namespace vp {
     cs_sync_mux = NULL;
   }
 
+  inline void hyper_slave::set_burst_meth(hyper_burst_meth_t *meth)
+  {
+    burst = meth;
+  }
+
+  inline void hyper_slave::set_burst_meth_muxed(hyper_burst_meth_muxed_t *meth, int id)
+  {
+    burst_mux = meth;
+    mux_id = id;
+  }
+
   inline void hyper_slave::set_sync_cycle_meth_muxed(hyper_sync_cycle_meth_muxed_t *meth, int id)
   {
     sync_cycle_mux_meth = meth;
@@ -263,6 +325,18 @@ namespace vp {
   }
 
 
+  inline bool hyper_slave::burst_default(hyper_slave *, hyper_burst *burst)
+  {
+    return false;
+  }
+
+
+  inline bool hyper_slave::burst_muxed_default(hyper_slave *, hyper_burst *burst, int id)
+  {
+    return false;
+  }
+
+
 
 };
 
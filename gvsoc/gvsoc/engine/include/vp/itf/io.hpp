@@ -29,6 +29,7 @@ namespace vp {
 
   class io_slave;
   class io_req;
+  class io_dmi;
 
   typedef enum
   {
@@ -52,6 +53,107 @@ namespace vp {
   typedef void (io_resp_meth_t)(void *, io_req *);
   typedef void (io_grant_meth_t)(void *, io_req *);
 
+  typedef bool (io_dmi_meth_t)(void *, io_dmi *);
+  typedef bool (io_dmi_meth_muxed_t)(void *, io_dmi *, int id);
+  typedef void (io_dmi_invalidate_meth_t)(void *);
+
+
+  /*
+   * Direct memory interface descriptor.
+   *
+   * A master can ask the slave for a direct access to the memory backing an
+   * address. The slave then returns the biggest address range around it for
+   * which the same answer applies:
+   * - if the access is granted, mem is the host pointer corresponding to the
+   *   first address of the range and any access inside the range can be done
+   *   with a memcpy, and must then be accounted with the given latency.
+   * - if the access is denied, mem is NULL and the master must keep using
+   *   normal requests for any address inside the range.
+   * The range is given with inclusive bounds so that the full address space
+   * can be described.
+   * A master which models by itself the timing of the accesses (e.g. a DMA
+   * computing the duration of a whole transfer) can mark the descriptor with
+   * set_master_timing, so that components which only deny direct accesses
+   * to model bandwidth or clock domain crossings can grant them.
+   * A master able to handle strided ranges can mark the descriptor with
+   * set_allow_stride. The slave can then return a range made of chunks of
+   * chunk_size bytes, one every stride bytes, which are contiguous in host
+   * memory, like the words of one bank of an interleaved memory. Addresses
+   * between the chunks are not part of the range.
+   */
+  class io_dmi
+  {
+  public:
+    inline void init(uint64_t addr)
+    {
+      this->addr = addr;
+      this->base = 0;
+      this->end = (uint64_t)-1;
+      this->mem = NULL;
+      this->latency = 0;
+      this->master_timing = false;
+      this->allow_stride = false;
+      this->chunk_size = 0;
+      this->stride = 0;
+    }
+
+    inline uint64_t get_addr() { return this->addr; }
+    inline void set_addr(uint64_t addr) { this->addr = addr; }
+
+    inline uint64_t get_base() { return this->base; }
+    inline uint64_t get_end() { return this->end; }
+    inline void set_range(uint64_t base, uint64_t end) { this->base = base; this->end = end; }
+
+    inline uint8_t *get_mem() { return this->mem; }
+    inline void set_mem(uint8_t *mem) { this->mem = mem; }
+
+    inline int64_t get_latency() { return this->latency; }
+    inline void set_latency(int64_t latency) { this->latency = latency; }
+    inline void inc_latency(int64_t incr) { this->latency += incr; }
+
+    inline bool get_master_timing() { return this->master_timing; }
+    inline void set_master_timing(bool master_timing) { this->master_timing = master_timing; }
+
+    inline bool get_allow_stride() { return this->allow_stride; }
+    inline void set_allow_stride(bool allow_stride) { this->allow_stride = allow_stride; }
+
+    // A chunk size of 0 means the range is contiguous
+    inline uint64_t get_chunk_size() { return this->chunk_size; }
+    inline uint64_t get_stride() { return this->stride; }
+    inline void set_stride(uint64_t chunk_size, uint64_t stride) { this->chunk_size = chunk_size; this->stride = stride; }
+
+    // Tell if the address is inside the range, and not between 2 chunks of a strided range
+    inline bool is_inside(uint64_t addr);
+
+    // Host pointer corresponding to an address inside the range
+    inline uint8_t *get_mem(uint64_t addr);
+
+    // Last address of the contiguous part of the range starting at the specified address
+    inline uint64_t get_contiguous_end(uint64_t addr);
+
+    // Deny the access on the specified range
+    inline void deny(uint64_t base, uint64_t end) { this->set_range(base, end); this->mem = NULL; }
+
+    // Restrict the range to the specified one, the host pointer is moved accordingly.
+    // A strided range may end up smaller, as it is kept starting on a chunk.
+    inline void clip(uint64_t base, uint64_t end);
+
+    // Move the range by the specified offset, to convert it from slave address space
+    // to master address space, the host pointer is unchanged.
+    inline void shift(int64_t offset) { this->base += offset; this->end += offset; }
+
+  private:
+    uint64_t addr;
+    uint64_t base;
+    uint64_t end;
+    uint8_t *mem;
+    int64_t latency;
+    bool master_timing;
+    bool allow_stride;
+    uint64_t chunk_size;
+    uint64_t stride;
+  };
+
   class io_req : public vp::queue_elem
   {
     friend class io_master;
@@ -145,6 +247,10 @@ namespace vp {
     uint8_t payload[IO_REQ_PAYLOAD_SIZE];
     void *args[IO_REQ_NB_ARGS];
     int current_arg = 0;
+    // Data buffer owned by the request when it is allocated from a port pool,
+    // kept when the request is recycled so that it can be reused
+    uint8_t *pool_data = NULL;
+    uint64_t pool_data_size = 0;
   };
 
 
@@ -162,9 +268,18 @@ namespace vp {
      */
 
     // Can be called to allocate an IO request.
+    // Requests are taken from a pool attached to this port, so that allocating
+    // them during the simulation does not go through malloc once the pool
+    // is warm.
     inline io_req *req_new(uint64_t addr, uint8_t *data, uint64_t size, bool is_write);
 
+    // Same as req_new, except that the data buffer is provided by the request
+    // itself. It stays valid until the request is deallocated and is recycled
+    // with it.
+    inline io_req *req_new(uint64_t addr, uint64_t size, bool is_write);
+
     // Can be called to deallocate an IO request.
+    // The request is given back to the pool of this port.
     inline void req_del(io_req *req);
 
     // Return if this master port is bound.
@@ -184,6 +299,14 @@ namespace vp {
     // on which port the response will be sent back by the slave.
     inline io_req_status_e req(io_req *req, io_slave *slave_port);
 
+    // Can be called by master component to get a direct access to the memory
+    // backing the address set in the descriptor.
+    // Returns true if the access is granted.
+    inline bool get_dmi(io_dmi *dmi);
+
+    // Same as get_dmi but on the specified slave port.
+    inline bool get_dmi(io_dmi *dmi, io_slave *slave_port);
+
 
 
     /*
@@ -198,6 +321,11 @@ namespace vp {
     // an IO request response. Before being set, a default empty callback is active.
     inline void set_resp_meth(io_resp_meth_t *meth);
 
+    // Set the callback on master side called when the slave is invalidating
+    // all direct memory accesses it previously granted. Before being set, a default
+    // empty callback is active.
+    inline void set_dmi_invalidate_meth(io_dmi_invalidate_meth_t *meth);
+
 
 
     /*
@@ -238,6 +366,14 @@ namespace vp {
     // Default response callback, just do nothing.
     static inline void resp_default(void *, io_req *);
 
+    // DMI invalidation callback set by the user.
+    // This gets called anytime the slave is invalidating direct memory accesses.
+    // This is set to an empty callback by default.
+    void (*dmi_invalidate_meth)(void *context);
+
+    // Default DMI invalidation callback, just do nothing.
+    static inline void dmi_invalidate_default(void *);
+
 
     /*
      * Slave callbacks
@@ -253,6 +389,15 @@ namespace vp {
     // setup instead
     io_req_status_e (*req_meth_freq_cross)(void *, io_req *);
 
+    // dmi_meth saved when the binding is crossing frequency domains as a stub is setup instead
+    bool (*dmi_meth_freq_cross)(void *, io_dmi *);
+
+    // DMI callback set by the user on slave port and retrieved during binding
+    bool (*dmi_meth)(void *, io_dmi *);
+
+    // dmi_meth saved when the slave port is multiplexed as a stub is setup instead
+    bool (*dmi_meth_mux)(void *, io_dmi *, int mux);
+
 
     /*
      * Stubs
@@ -268,6 +413,16 @@ namespace vp {
     // domain before we call it.
     static inline io_req_status_e req_freq_cross_stub(io_master *_this, io_req *req);
 
+    // This is a stub setup when the slave is multiplexing the port so that we
+    // can capture the master DMI call and insert the mux ID.
+    static inline bool dmi_muxed_stub(io_master *_this, io_dmi *dmi);
+
+    // This is a stub setup when the binding is crossing 2 different clock
+    // domains. Direct accesses are then always denied, since the slave domain
+    // would have to be resynchronized on each access and the latency would be
+    // expressed in the wrong clock domain.
+    static inline bool dmi_freq_cross_stub(io_master *_this, io_dmi *dmi);
+
 
     /*
      * Internal data
@@ -290,6 +445,9 @@ namespace vp {
     // is multiplexed.
     int slave_req_mux_id = -1;
 
+    // Pool of requests which were deallocated and can be reused by req_new
+    io_req *first_free_req = NULL;
+
 
     // Several IO master ports are often connected to the same slave port
     // while the slave will need to reply to the master.
@@ -327,6 +485,11 @@ namespace vp {
     // owned back by the master which can then proceed with the request.
     inline void resp(io_req *req) { this->master_resp_meth(this->get_remote_context(), req); }
 
+    // Can be called to invalidate all the direct memory accesses which were
+    // granted through this port, for example because the memory state changed
+    // and accesses must go again through normal requests.
+    inline void dmi_invalidate();
+
 
 
     /*
@@ -342,6 +505,14 @@ namespace vp {
     // when calling the callback, and can be used to multiplex a slave port
     inline void set_req_meth_muxed(io_req_meth_muxed_t *meth, int id);
 
+    // Set the callback on slave side called when the master is asking for
+    // a direct memory access. Before being set, a default callback denying
+    // any access is active.
+    inline void set_dmi_meth(io_dmi_meth_t *meth);
+
+    // Same as set_dmi_meth but for multiplexed ports.
+    inline void set_dmi_meth_muxed(io_dmi_meth_muxed_t *meth);
+
 
 
     /*
@@ -377,6 +548,17 @@ namespace vp {
     // This one gets called instead of the normal once in case it is not NULL
     io_req_status_e (*req_meth_mux)(void *context, io_req *, int mux);
 
+    // DMI callback set by the user.
+    // This gets called anytime the master is asking for a direct memory access.
+    // This is set to a callback denying the access by default.
+    bool (*dmi_meth)(void *context, io_dmi *);
+
+    // Default DMI callback, deny any access.
+    static inline bool dmi_default(void *, io_dmi *);
+
+    // Multiplexed DMI callback set by the user.
+    bool (*dmi_meth_mux)(void *context, io_dmi *, int mux);
+
 
 
     /*
@@ -393,6 +575,9 @@ namespace vp {
     // setup instead
     void (*master_resp_meth_freq_cross)(void *, io_req *);
 
+    // Master ports bound to this port, used to broadcast DMI invalidations
+    std::vector<io_master *> dmi_masters;
+
     // master_grant_meth when the binding is crossing frequency domains as a stub is 
     // setup instead
     void (*master_grant_meth_freq_cross)(void *, io_req *);
@@ -434,10 +619,63 @@ namespace vp {
 
 
 
+  inline void io_dmi::clip(uint64_t base, uint64_t end)
+  {
+    if (base > this->base)
+    {
+      if (this->chunk_size != 0)
+      {
+        // Strided ranges must start on a chunk, so the base is moved to the next one
+        uint64_t offset = (base - this->base + this->stride - 1) / this->stride;
+        base = this->base + offset * this->stride;
+        if (this->mem)
+          this->mem += offset * this->chunk_size;
+      }
+      else if (this->mem)
+        this->mem += base - this->base;
+      this->base = base;
+    }
+    if (end < this->end)
+    {
+      this->end = end;
+    }
+  }
+
+  inline bool io_dmi::is_inside(uint64_t addr)
+  {
+    if (addr < this->base || addr > this->end)
+      return false;
+
+    return this->chunk_size == 0 || (addr - this->base) % this->stride < this->chunk_size;
+  }
+
+  inline uint8_t *io_dmi::get_mem(uint64_t addr)
+  {
+    uint64_t offset = addr - this->base;
+
+    if (this->chunk_size == 0)
+      return this->mem + offset;
+
+    return this->mem + offset / this->stride * this->chunk_size + offset % this->stride;
+  }
+
+  inline uint64_t io_dmi::get_contiguous_end(uint64_t addr)
+  {
+    if (this->chunk_size == 0)
+      return this->end;
+
+    uint64_t end = addr - (addr - this->base) % this->stride + this->chunk_size - 1;
+    return end < this->end ? end : this->end;
+  }
+
+
+
   inline io_master::io_master() {
     // Set default callbacks in case the user does not set them
     this->resp_meth = &io_master::resp_default;
     this->grant_meth = &io_master::grant_default;
+    this->dmi_invalidate_meth = &io_master::dmi_invalidate_default;
+    this->dmi_meth = (io_dmi_meth_t *)&io_slave::dmi_default;
   }
 
 
@@ -472,10 +710,62 @@ namespace vp {
 
 
 
+  inline bool io_master::get_dmi(io_dmi *dmi)
+  {
+    return this->dmi_meth(this->get_remote_context(), dmi);
+  }
+
+
+
+  inline bool io_master::get_dmi(io_dmi *dmi, io_slave *port)
+  {
+    if (port->dmi_meth_mux)
+      return port->dmi_meth_mux(port->get_context(), dmi, port->req_mux_id);
+    else
+      return port->dmi_meth(port->get_context(), dmi);
+  }
+
+
+
   inline io_req *io_master::req_new(uint64_t addr, uint8_t *data, uint64_t size, bool is_write)
   {
-    // For now we allocate new requests but this would be better to manage a pool of requests
-    io_req *req = new io_req(addr, data, size, is_write);
+    io_req *req = this->first_free_req;
+    bool reused = req != NULL;
+
+    if (reused)
+    {
+      this->first_free_req = req->next;
+    }
+    else
+    {
+      req = new io_req();
+    }
+
+    this->get_comp()->traces.get_trace_manager()->io_req_alloc(reused);
+
+    req->addr = addr;
+    req->data = data;
+    req->size = size;
+    req->is_write = is_write;
+    req->init();
+
+    return req;
+  }
+
+
+
+  inline io_req *io_master::req_new(uint64_t addr, uint64_t size, bool is_write)
+  {
+    io_req *req = this->req_new(addr, NULL, size, is_write);
+
+    if (req->pool_data_size < size)
+    {
+      delete[] req->pool_data;
+      req->pool_data = new uint8_t[size];
+      req->pool_data_size = size;
+    }
+
+    req->data = req->pool_data;
 
     return req;
   }
@@ -484,7 +774,8 @@ namespace vp {
 
   inline void io_master::req_del(io_req *req)
   {
-    delete req;
+    req->next = this->first_free_req;
+    this->first_free_req = req;
   }
 
 
@@ -503,12 +794,25 @@ namespace vp {
 
 
 
+  inline void io_master::set_dmi_invalidate_meth(io_dmi_invalidate_meth_t *meth)
+  {
+    dmi_invalidate_meth = meth;
+  }
+
+
+
   inline void io_master::resp_default(void *, io_req *)
   {
   }
 
 
 
+  inline void io_master::dmi_invalidate_default(void *)
+  {
+  }
+
+
+
   inline void io_master::grant_default(void *, io_req *)
   {
   }
@@ -528,6 +832,7 @@ namespace vp {
       // Normal binding, just register the method and context into the master
       // port for fast access
       this->req_meth = port->req_meth;
+      this->dmi_meth = port->dmi_meth;
       this->set_remote_context(port->get_context());
     }
     else
@@ -536,6 +841,8 @@ namespace vp {
       // the stub to insert the multiplex ID.
       this->req_meth_mux = port->req_meth_mux;
       this->req_meth = (io_req_meth_t *)&io_master::req_muxed_stub;
+      this->dmi_meth_mux = port->dmi_meth_mux;
+      this->dmi_meth = (io_dmi_meth_t *)&io_master::dmi_muxed_stub;
       this->set_remote_context(this);
       this->slave_context_for_mux = port->get_context();
       this->slave_req_mux_id = port->req_mux_id;
@@ -571,6 +878,29 @@ namespace vp {
 
 
 
+  inline bool io_master::dmi_muxed_stub(io_master *_this, io_dmi *dmi)
+  {
+    if (_this->dmi_meth_mux == NULL)
+      return false;
+
+    return _this->dmi_meth_mux((component *)_this->slave_context_for_mux, dmi, _this->slave_req_mux_id);
+  }
+
+
+
+  inline bool io_master::dmi_freq_cross_stub(io_master *_this, io_dmi *dmi)
+  {
+    // The latency would be in cycles of the other domain, this is only fine
+    // if the master is anyway modeling the timing by itself.
+    if (!dmi->get_master_timing())
+      return false;
+
+    _this->remote_port->get_owner()->get_clock()->sync();
+    return _this->dmi_meth_freq_cross((component *)_this->slave_context_for_freq_cross, dmi);
+  }
+
+
+
   inline void io_master::finalize()
   {
     vp_assert(this->get_owner() != NULL, NULL,
@@ -593,7 +923,9 @@ namespace vp {
       // Just save the normal handler and tweak it to enter the stub when the
       // master is pushing the request.
       this->req_meth_freq_cross = this->req_meth;
+      this->dmi_meth_freq_cross = this->dmi_meth;
       this->req_meth = (io_req_meth_t *)&io_master::req_freq_cross_stub;
+      this->dmi_meth = (io_dmi_meth_t *)&io_master::dmi_freq_cross_stub;
       this->slave_context_for_freq_cross = this->get_remote_context();
       this->set_remote_context(this);
     }
@@ -601,8 +933,9 @@ namespace vp {
 
 
 
-  inline io_slave::io_slave() : req_meth(NULL), req_meth_mux(NULL) {
+  inline io_slave::io_slave() : req_meth(NULL), req_meth_mux(NULL), dmi_meth_mux(NULL) {
     req_meth = (io_req_meth_t *)&io_slave::req_default;
+    dmi_meth = &io_slave::dmi_default;
   }
 
 
@@ -618,6 +951,7 @@ namespace vp {
     port->slave_port->master_resp_meth = port->resp_meth;
     port->slave_port->master_grant_meth = port->grant_meth;
     port->slave_port->set_remote_context(port->get_context());
+    this->dmi_masters.push_back(port);
   }
 
 
@@ -638,6 +972,31 @@ namespace vp {
 
 
 
+  inline void io_slave::set_dmi_meth(io_dmi_meth_t *meth)
+  {
+    this->dmi_meth = meth;
+    this->dmi_meth_mux = NULL;
+  }
+
+
+
+  inline void io_slave::set_dmi_meth_muxed(io_dmi_meth_muxed_t *meth)
+  {
+    this->dmi_meth_mux = meth;
+  }
+
+
+
+  inline void io_slave::dmi_invalidate()
+  {
+    for (io_master *master: this->dmi_masters)
+    {
+      master->dmi_invalidate_meth(master->get_context());
+    }
+  }
+
+
+
   inline io_req_status_e io_slave::req_default(io_slave *, io_req *)
   {
     return IO_REQ_OK;
@@ -645,6 +1004,13 @@ namespace vp {
 
 
 
+  inline bool io_slave::dmi_default(void *, io_dmi *)
+  {
+    return false;
+  }
+
+
+
   inline void io_slave::grant_freq_cross_stub(io_slave *_this, io_req *req)
   {
     // The normal callback was tweaked in order to get there when the master is sending a
@@ -32,12 +32,37 @@ namespace vp {
 
 
 
+  // Value reported in a transfer receive buffer for a cycle where the slave is not driving the lanes
+  #define QSPIM_XFER_UNDRIVEN 0xff
+
+  // Transaction-level transfer of several SCK cycles at once.
+  // This is a companion of the edge-level sync which lets a master drive a whole
+  // chunk of a command (opcode, address, mode or payload) with a single call
+  // instead of one sync per clock edge. Slaves which do not implement it (e.g.
+  // pin-level testbenches) reject the transfer and the master must then fall back
+  // to edge-level syncs.
+  class qspim_xfer
+  {
+  public:
+    int nb_cycles;      // Number of SCK cycles of the transfer
+    int lanes;          // Number of data lanes used, 1 or 4
+    bool ddr;           // True if data is sampled on both SCK edges
+    uint8_t *tx_data;   // Value driven by the master for each cycle, lane i on bit i
+    uint8_t *rx_data;   // Filled by the slave with the value it drives after each cycle, or QSPIM_XFER_UNDRIVEN
+    int64_t duration;   // Duration of the whole transfer in picoseconds
+  };
+
+
+
   typedef void (qspim_sync_meth_t)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
   typedef void (qspim_cs_sync_meth_t)(void *, int cs, int active);
 
   typedef void (qspim_sync_meth_muxed_t)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int id);
   typedef void (qspim_cs_sync_meth_muxed_t)(void *, int cs, int active, int id);
 
+  typedef bool (qspim_xfer_meth_t)(void *, qspim_xfer *xfer);
+  typedef bool (qspim_xfer_meth_muxed_t)(void *, qspim_xfer *xfer, int id);
+
   typedef void (qspim_slave_sync_meth_t)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
   typedef void (qspim_slave_sync_meth_muxed_t)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int id);
 
@@ -61,6 +86,13 @@ namespace vp {
       return cs_sync_meth(this->get_remote_context(), cs, active);
     }
 
+    // Returns false if the slave does not support transaction-level transfers,
+    // in which case nothing has been transfered.
+    inline bool xfer(qspim_xfer *xfer)
+    {
+      return xfer_meth(this->get_remote_context(), xfer);
+    }
+
     void bind_to(vp::port *port, vp::config *config);
 
     inline void set_sync_meth(qspim_slave_sync_meth_t *meth);
@@ -73,6 +105,7 @@ namespace vp {
 
     static inline void sync_muxed_stub(qspim_master *_this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
     static inline void cs_sync_muxed_stub(qspim_master *_this, int cs, int active);
+    static inline bool xfer_muxed_stub(qspim_master *_this, qspim_xfer *xfer);
 
     void (*slave_sync)(void *comp, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
     void (*slave_sync_mux)(void *comp, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int id);
@@ -81,6 +114,8 @@ namespace vp {
     void (*sync_meth_mux)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int mux);
     void (*cs_sync_meth)(void *, int cs, int active);
     void (*cs_sync_meth_mux)(void *, int cs, int active, int mux);
+    bool (*xfer_meth)(void *, qspim_xfer *xfer);
+    bool (*xfer_meth_mux)(void *, qspim_xfer *xfer, int mux);
 
     static inline void sync_default(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
 
@@ -114,6 +149,9 @@ namespace vp {
     inline void set_cs_sync_meth(qspim_cs_sync_meth_t *meth);
     inline void set_cs_sync_meth_muxed(qspim_cs_sync_meth_muxed_t *meth, int id);
 
+    inline void set_xfer_meth(qspim_xfer_meth_t *meth);
+    inline void set_xfer_meth_muxed(qspim_xfer_meth_muxed_t *meth, int id);
+
     inline void bind_to(vp::port *_port, vp::config *config);
 
   private:
@@ -128,9 +166,13 @@ namespace vp {
     void (*sync_mux_meth)(void *comp, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int mux);
     void (*cs_sync)(void *comp, int cs, int active);
     void (*cs_sync_mux)(void *comp, int cs, int active, int mux);
+    bool (*xfer)(void *comp, qspim_xfer *xfer);
+    bool (*xfer_mux)(void *comp, qspim_xfer *xfer, int mux);
 
     static inline void sync_default(qspim_slave *, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
     static inline void cs_sync_default(qspim_slave *, int cs, int active);
+    static inline bool xfer_default(qspim_slave *, qspim_xfer *xfer);
+    static inline bool xfer_muxed_default(qspim_slave *, qspim_xfer *xfer, int id);
 
     vp::component *comp_mux;
     int sync_mux;
@@ -162,6 +204,13 @@ namespace vp {
 
 
 
+  inline bool qspim_master::xfer_muxed_stub(qspim_master *_this, qspim_xfer *xfer)
+  {
+    return _this->xfer_meth_mux(_this->comp_mux, xfer, _this->sync_mux);
+  }
+
+
+
   inline void qspim_master::bind_to(vp::port *_port, vp::config *config)
   {
     qspim_slave *port = (qspim_slave *)_port;
@@ -169,6 +218,7 @@ namespace vp {
     {
       sync_meth = port->sync_meth;
       cs_sync_meth = port->cs_sync;
+      xfer_meth = port->xfer;
       this->set_remote_context(port->get_context());
     }
     else
@@ -179,6 +229,9 @@ namespace vp {
       cs_sync_meth_mux = port->cs_sync_mux;
       cs_sync_meth = (qspim_cs_sync_meth_t *)&qspim_master::cs_sync_muxed_stub;
 
+      xfer_meth_mux = port->xfer_mux;
+      xfer_meth = (qspim_xfer_meth_t *)&qspim_master::xfer_muxed_stub;
+
       this->set_remote_context(this);
       comp_mux = (vp::component *)port->get_context();
       sync_mux = port->mux_id;
@@ -230,6 +283,8 @@ namespace vp {
   inline qspim_slave::qspim_slave() : sync_meth(NULL), sync_mux_meth(NULL) {
     sync_meth = (qspim_sync_meth_t *)&qspim_slave::sync_default;
     cs_sync = (qspim_cs_sync_meth_t *)&qspim_slave::cs_sync_default;
+    xfer = (qspim_xfer_meth_t *)&qspim_slave::xfer_default;
+    xfer_mux = (qspim_xfer_meth_muxed_t *)&qspim_slave::xfer_muxed_default;
   }
 
   inline void qspim_slave::set_sync_meth(qspim_sync_meth_t *meth)
@@ -244,6 +299,17 @@ namespace vp {
     cs_sync_mux = NULL;
   }
 
+  inline void qspim_slave::set_xfer_meth(qspim_xfer_meth_t *meth)
+  {
+    xfer = meth;
+  }
+
+  inline void qspim_slave::set_xfer_meth_muxed(qspim_xfer_meth_muxed_t *meth, int id)
+  {
+    xfer_mux = meth;
+    mux_id = id;
+  }
+
   inline void qspim_slave::set_sync_meth_muxed(qspim_sync_meth_muxed_t *meth, int id)
   {
     sync_mux_meth = meth;
@@ -268,6 +334,18 @@ namespace vp {
   }
 
 
+  inline bool qspim_slave::xfer_default(qspim_slave *, qspim_xfer *xfer)
+  {
+    return false;
+  }
+
+
+  inline bool qspim_slave::xfer_muxed_default(qspim_slave *, qspim_xfer *xfer, int id)
+  {
+    return false;
+  }
+
+
 
 };
 
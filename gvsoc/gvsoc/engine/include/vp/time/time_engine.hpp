@@ -33,9 +33,57 @@ namespace vp
 {
 
 class time_engine_client;
+class time_engine_partition;
+class master_port;
+class slave_port;
 
-class time_engine : public component
+// Clients ordered by the time of their next event. The engine has one, and in
+// parallel mode, each partition has its own.
+class time_engine_queue
 {
+protected:
+    // Heap entry. The ordering key of the client is copied there, so that ordering
+    // clients does not need to access them.
+    struct time_engine_queue_entry
+    {
+        int64_t time;
+        int64_t seq;
+        time_engine_client *client;
+    };
+
+    // Clients are kept in a binary min-heap ordered by next event time. Clients
+    // with the same time are scheduled starting with the most recently
+    // enqueued one.
+    inline time_engine_client *get_first_client();
+    inline void push_client(time_engine_client *client, int64_t time);
+    inline time_engine_client *pop_client();
+    // Reenqueue the client at the specified time and pop the first one, with a single
+    // heap update. The first client must be before the specified time.
+    inline time_engine_client *replace_first_client(time_engine_client *client, int64_t time);
+    // Move an enqueued client to an earlier time
+    inline void move_client_up(time_engine_client *client, int64_t time);
+    inline void remove_client(time_engine_client *client);
+    inline bool entry_is_before(time_engine_queue_entry *a, time_engine_queue_entry *b);
+    inline void heap_set(int index, int64_t time, int64_t seq, time_engine_client *client);
+    inline void heap_sift_up(int index);
+    inline void heap_sift_down(int index);
+
+    // Enqueue the client at the specified absolute time
+    bool queue_enqueue(time_engine_client *client, int64_t time);
+    bool queue_dequeue(time_engine_client *client);
+
+    std::vector<time_engine_queue_entry> clients_heap;
+    // Decremented each time a client is enqueued to order clients having the same time
+    int64_t clients_seq = 0;
+
+    int64_t time = 0;
+};
+
+class time_engine : public component, public time_engine_queue
+{
+
+    friend class time_engine_partition;
+
 public:
     time_engine(js::config *config);
 
@@ -81,10 +129,13 @@ public:
 
     bool enqueue(time_engine_client *client, int64_t time);
 
-    int64_t get_time() { return time; }
+    int64_t get_time() { return likely(!this->parallel) ? this->time : this->get_parallel_time(); }
+
+    void set_time(int64_t time);
 
-    inline void retain() { retain_count++; }
-    inline void release() { retain_count--; }
+    // Models of several threads may retain the engine in parallel mode
+    inline void retain() { __atomic_add_fetch(&retain_count, 1, __ATOMIC_RELAXED); }
+    inline void release() { __atomic_sub_fetch(&retain_count, 1, __ATOMIC_RELAXED); }
 
     inline void fatal(const char *fmt, ...);
 
@@ -92,8 +143,52 @@ public:
 
     void wait_ready();
 
+    /*
+     * Parallel mode
+     *
+     * Clock domains are spread over several threads, which simulate windows of time
+     * in parallel. Domains can only interact through links, which are slave ports
+     * delaying what they receive by a minimum latency. The window, also called the
+     * lookahead, is small enough compared to these latencies so that nothing received
+     * in a window has to be executed in the same window.
+     */
+
+    // Tell if clock domains are simulated by several threads
+    inline bool is_parallel() { return this->parallel; }
+
+    // Tell if the client is simulated by the calling thread, which is always the case
+    // in sequential mode
+    bool is_local(time_engine_client *client);
+
+    // Client which is being executed by the calling thread, or NULL
+    time_engine_client *get_current_client();
+
+    // Minimum delay of anything posted to another client
+    int64_t get_parallel_lookahead() { return this->lookahead; }
+
+    // Execute the method with the 2 arguments at the specified absolute time, in the thread
+    // of the target client. The time is moved to the lookahead if it is closer.
+    void parallel_post(time_engine_client *target, int64_t time, void (*meth)(void *, void *),
+        void *arg0, void *arg1);
+
+    // Declare that bindings to this port from other clock domains are fine in parallel mode,
+    // since the port owner delays what it receives by this number of cycles of its clock.
+    void register_parallel_link(vp::slave_port *port, int64_t cycles);
+
+    // Called for each final binding when the platform is started, to see if the
+    // parallel mode can be used
+    void check_parallel_binding(vp::master_port *master, vp::slave_port *slave);
+
 private:
-    time_engine_client *first_client = NULL;
+    bool has_clients();
+    bool parallel_start();
+    void run_parallel();
+    static void *partition_routine(void *arg);
+    void run_partition(time_engine_partition *partition);
+    int64_t get_parallel_time();
+    bool parallel_enqueue(time_engine_client *client, int64_t time);
+    bool parallel_dequeue(time_engine_client *client);
+
     bool locked = false;
     bool locked_run_req;
     bool run_req;
@@ -107,7 +202,6 @@ private:
     pthread_cond_t cond;
     pthread_t run_thread;
 
-    int64_t time = 0;
     int stop_status = -1;
     bool engine_has_been_stopped = false;
     int retain_count = 0;
@@ -122,12 +216,33 @@ private:
 private:
     vp::component *stop_event;
     std::vector<Notifier *> exec_notifiers;
+
+    bool parallel = false;
+    bool parallel_enabled = false;
+    bool parallel_checked = false;
+    int parallel_nb_threads = 0;
+    // First reason found for not using the parallel mode
+    std::string parallel_error;
+    std::vector<std::pair<vp::slave_port *, int64_t>> parallel_links;
+    // Clock domains seen in bindings, in a deterministic order
+    std::vector<time_engine_client *> parallel_clients;
+    std::vector<time_engine_partition *> partitions;
+    int parallel_next_id = 0;
+    int64_t lookahead = 0;
+    int64_t window_end = 0;
+    int64_t window_gen = 0;
+    int window_done = 0;
+    int window_sleepers = 0;
+    pthread_mutex_t window_mutex;
+    pthread_cond_t window_cond;
 };
 
 class time_engine_client : public component
 {
 
     friend class time_engine;
+    friend class time_engine_queue;
+    friend class time_engine_partition;
 
 public:
     time_engine_client(js::config *config)
@@ -152,7 +267,10 @@ public:
     virtual int64_t exec() = 0;
 
 protected:
-    time_engine_client *next;
+    // Position of the client in the engine heap, only valid when enqueued
+    int heap_index = -1;
+    // Ordering key used when several clients have the same time
+    int64_t heap_seq = 0;
 
     // This gives the time of the next event.
     // It is only valid when the client is not the currently active one,
@@ -163,6 +281,13 @@ protected:
     vp::time_engine *engine;
     bool running = false;
     bool is_enqueued = false;
+
+    // Partition simulating this client in parallel mode
+    time_engine_partition *partition = NULL;
+    // Identifier and counter of posted calls, to order the calls of several clients
+    // the same way whatever the number of threads
+    int parallel_id = -1;
+    int64_t parallel_seq = 0;
 };
 
 // This can be called from anywhere so just propagate the stop request
@@ -179,7 +304,7 @@ inline void vp::time_engine::stop_engine(int status, bool force, bool no_retain)
         stop_status |= status;
     }
 
-    if (no_retain || stop_retain_count == 0 || stop_status != 0)
+    if (no_retain || __atomic_load_n(&stop_retain_count, __ATOMIC_SEQ_CST) == 0 || stop_status != 0)
     {
     #ifdef __VP_USE_SYSTEMC
         sync_event.notify();
@@ -200,7 +325,7 @@ inline void vp::time_engine::stop_engine(int status, bool force, bool no_retain)
 
 inline void vp::time_engine::stop_retain(int count)
 {
-    this->stop_retain_count += count;
+    __atomic_add_fetch(&this->stop_retain_count, count, __ATOMIC_SEQ_CST);
 }
 
 
@@ -285,6 +410,127 @@ inline void vp::time_engine::fatal(const char *fmt, ...)
     stop_engine(-1);
 }
 
+inline vp::time_engine_client *vp::time_engine_queue::get_first_client()
+{
+    return this->clients_heap.size() ? this->clients_heap[0].client : NULL;
+}
+
+inline bool vp::time_engine_queue::entry_is_before(time_engine_queue_entry *a, time_engine_queue_entry *b)
+{
+    // Computed without branches, as the result is hard to predict when clients are popped.
+    // Times are below 2^62, so the difference of the times, minus the borrow of the
+    // sequence numbers compared as unsigned, is negative only if a is before b.
+    uint64_t borrow = ((uint64_t)a->seq ^ (1ULL << 63)) < ((uint64_t)b->seq ^ (1ULL << 63));
+    return (uint64_t)(a->time - b->time - borrow) >> 63;
+}
+
+inline void vp::time_engine_queue::heap_set(int index, int64_t time, int64_t seq, time_engine_client *client)
+{
+    time_engine_queue_entry *entry = &this->clients_heap[index];
+    entry->time = time;
+    entry->seq = seq;
+    entry->client = client;
+    client->heap_index = index;
+}
+
+inline void vp::time_engine_queue::heap_sift_up(int index)
+{
+    time_engine_queue_entry *heap = this->clients_heap.data();
+    time_engine_queue_entry entry = heap[index];
+    while (index > 0)
+    {
+        int parent = (index - 1) >> 1;
+        if (!this->entry_is_before(&entry, &heap[parent]))
+            break;
+        this->heap_set(index, heap[parent].time, heap[parent].seq, heap[parent].client);
+        index = parent;
+    }
+    this->heap_set(index, entry.time, entry.seq, entry.client);
+}
+
+inline void vp::time_engine_queue::heap_sift_down(int index)
+{
+    int size = this->clients_heap.size();
+    time_engine_queue_entry *heap = this->clients_heap.data();
+    time_engine_queue_entry entry = heap[index];
+    while (1)
+    {
+        int child = (index << 1) + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size)
+            child += this->entry_is_before(&heap[child + 1], &heap[child]);
+        if (!this->entry_is_before(&heap[child], &entry))
+            break;
+        this->heap_set(index, heap[child].time, heap[child].seq, heap[child].client);
+        index = child;
+    }
+    this->heap_set(index, entry.time, entry.seq, entry.client);
+}
+
+inline void vp::time_engine_queue::push_client(time_engine_client *client, int64_t time)
+{
+    client->next_event_time = time;
+    client->heap_seq = --this->clients_seq;
+    client->is_enqueued = true;
+    this->clients_heap.resize(this->clients_heap.size() + 1);
+    this->heap_set(this->clients_heap.size() - 1, time, client->heap_seq, client);
+    this->heap_sift_up(this->clients_heap.size() - 1);
+}
+
+inline vp::time_engine_client *vp::time_engine_queue::pop_client()
+{
+    time_engine_client *client = this->clients_heap[0].client;
+    time_engine_queue_entry last = this->clients_heap.back();
+    this->clients_heap.pop_back();
+    if (last.client != client)
+    {
+        this->heap_set(0, last.time, last.seq, last.client);
+        this->heap_sift_down(0);
+    }
+    client->heap_index = -1;
+    client->is_enqueued = false;
+    return client;
+}
+
+inline vp::time_engine_client *vp::time_engine_queue::replace_first_client(time_engine_client *client, int64_t time)
+{
+    time_engine_client *first = this->clients_heap[0].client;
+    client->next_event_time = time;
+    client->heap_seq = --this->clients_seq;
+    client->is_enqueued = true;
+    this->heap_set(0, time, client->heap_seq, client);
+    this->heap_sift_down(0);
+    first->heap_index = -1;
+    first->is_enqueued = false;
+    return first;
+}
+
+inline void vp::time_engine_queue::move_client_up(time_engine_client *client, int64_t time)
+{
+    client->next_event_time = time;
+    client->heap_seq = --this->clients_seq;
+    this->heap_set(client->heap_index, time, client->heap_seq, client);
+    this->heap_sift_up(client->heap_index);
+}
+
+inline void vp::time_engine_queue::remove_client(time_engine_client *client)
+{
+    int index = client->heap_index;
+    time_engine_queue_entry last = this->clients_heap.back();
+    this->clients_heap.pop_back();
+    if (last.client != client)
+    {
+        this->heap_set(index, last.time, last.seq, last.client);
+        if (index > 0 && this->entry_is_before(&last, &this->clients_heap[(index - 1) >> 1]))
+            this->heap_sift_up(index);
+        else
+            this->heap_sift_down(index);
+    }
+    client->heap_index = -1;
+    client->is_enqueued = false;
+}
+
 inline void vp::time_engine::update(int64_t time)
 {
     if (time > this->time)
@@ -57,6 +57,10 @@ namespace vp {
 
     void new_trace_event_real(std::string name, trace *trace);
 
+    // Binary traces dump fixed-size records of the specified size, which are
+    // all kept, even when several are dumped at the same timestamp.
+    void new_trace_event_binary(std::string name, trace *trace, int bytes);
+
     inline trace_engine *get_trace_manager();
 
     void set_trace_manager(trace_engine *trace_manager) { this->trace_manager = trace_manager; }
@@ -50,9 +50,11 @@ namespace vp {
     Event_trace(string trace_name, Event_file *file, int width, bool is_real, bool is_string);
     void reg(int64_t timestamp, uint8_t *event, int width, uint8_t flags, uint8_t *flag_mask);
     inline void dump(int64_t timestamp) { file->dump(timestamp, id, this->buffer, this->width, this->is_real, this->is_string, this->flags, this->flags_mask); }
+    inline void dump_binary(int64_t timestamp, uint8_t *record) { file->dump(timestamp, id, record, this->width, false, false, 0, NULL); }
     std::string trace_name;
     bool is_real = false;
     bool is_string;
+    bool is_binary = false;
     Event_trace *next;
     bool is_enqueued;
     int width;
@@ -75,6 +77,7 @@ namespace vp {
     Event_trace *get_trace(string trace_name, string file_name, int width, bool is_real=false, bool is_string=false);
     Event_trace *get_trace_real(string trace_name, string file_name);
     Event_trace *get_trace_string(string trace_name, string file_name);
+    Event_trace *get_trace_binary(string trace_name, string file_name, int width);
     void close();
     void set_vcd_user(gv::Vcd_user *user);
 
@@ -128,6 +131,32 @@ namespace vp {
   };
 
 
+  // Binary file made of fixed-size records, each one being the timestamp
+  // followed by the record dumped by the model.
+  // An index giving the timestamp of every BINARY_INDEX_PERIOD records is
+  // written to a second file with the .idx extension, so that tools can seek
+  // by time without reading the whole file.
+  #define BINARY_MAGIC        0x54424756  // "GVBT"
+  #define BINARY_VERSION      1
+  #define BINARY_INDEX_PERIOD 4096
+
+  class Binary_file : public Event_file
+  {
+  public:
+    Binary_file(Event_dumper *dumper, string path);
+    void close();
+    void add_trace(string name, int id, int width, bool is_real, bool is_string);
+    void dump(int64_t timestamp, int id, uint8_t *event, int width, bool is_real, bool is_string, uint8_t flags, uint8_t *flag_mask);
+
+  private:
+    Event_dumper *dumper;
+    string path;
+    FILE *index_file;
+    int record_bytes = -1;
+    uint64_t nb_records = 0;
+  };
+
+
   class Raw_file : public Event_file
   {
   public:
@@ -99,6 +99,17 @@ namespace vp {
   }
 
 
+  inline void vp::trace::event_binary(uint8_t *record)
+  {
+  #ifdef VP_TRACE_ACTIVE
+    if (is_event_active)
+    {
+      trace_manager->dump_event_binary(this, comp->get_time(), record, bytes);
+    }
+  #endif
+  }
+
+
   inline void vp::trace::user_msg(const char *fmt, ...) {
     #if 0
     fprintf(trace_file, "%ld: %ld: [\033[34m%-*.*s\033[0m] ", comp->get_clock()->get_time(), comp->get_clock()->get_cycles(), max_trace_len, max_trace_len, comp->get_path());
@@ -59,6 +59,7 @@ namespace vp {
     inline void event_real(double value);
     inline void event_real_pulse(int64_t duration, double pulse_value, double background_value);
     inline void event_real_delayed(double value);
+    inline void event_binary(uint8_t *record);
 
     void register_callback(std::function<void()> callback) { this->callbacks.push_back(callback); }
 
@@ -92,6 +93,7 @@ namespace vp {
     Event_trace *event_trace = NULL;
     bool is_real = false;
     bool is_string = false;
+    bool is_binary = false;
     int id;
     FILE *trace_file = stdout;
     int is_event;
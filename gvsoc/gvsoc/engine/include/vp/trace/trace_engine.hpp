@@ -28,11 +28,49 @@
 #include "gv/gvsoc.hpp"
 #include <pthread.h>
 #include <thread>
+#include <atomic>
 
 namespace vp {
 
   #define TRACE_EVENT_BUFFER_SIZE (1<<16)
-  #define TRACE_EVENT_NB_BUFFER   4
+  #define TRACE_EVENT_NB_BUFFER   16
+
+  // Lock-free queue of event buffers between one producer thread and one consumer thread.
+  // It can contain all the buffers, so that a push never fails.
+  class trace_buffer_ring
+  {
+  public:
+    trace_buffer_ring() : head(0), tail(0) {}
+
+    // Producer side
+    inline void push(char *buffer)
+    {
+      unsigned int tail = this->tail.load(std::memory_order_relaxed);
+      this->buffers[tail % TRACE_EVENT_NB_BUFFER] = buffer;
+      this->tail.store(tail + 1, std::memory_order_seq_cst);
+    }
+
+    // Consumer side, returns NULL if the queue is empty
+    inline char *pop()
+    {
+      unsigned int head = this->head.load(std::memory_order_relaxed);
+      if (head == this->tail.load(std::memory_order_acquire))
+        return NULL;
+      char *buffer = this->buffers[head % TRACE_EVENT_NB_BUFFER];
+      this->head.store(head + 1, std::memory_order_release);
+      return buffer;
+    }
+
+    inline bool is_empty()
+    {
+      return this->head.load(std::memory_order_seq_cst) == this->tail.load(std::memory_order_seq_cst);
+    }
+
+  private:
+    char *buffers[TRACE_EVENT_NB_BUFFER];
+    std::atomic<unsigned int> head;
+    std::atomic<unsigned int> tail;
+  };
 
   #define TRACE_FORMAT_LONG  0
   #define TRACE_FORMAT_SHORT 1
@@ -44,6 +82,8 @@ namespace vp {
 
     void stop();
 
+    void post_fork();
+
     virtual void reg_trace(vp::trace *trace, int event, string path, string name) = 0;
 
     virtual int get_max_path_len() = 0;
@@ -66,6 +106,8 @@ namespace vp {
 
     void dump_event_delayed(vp::trace *trace, int64_t timestamp, uint8_t *event, int width);
 
+    void dump_event_binary(vp::trace *trace, int64_t timestamp, uint8_t *record, int bytes);
+
     void set_global_enable(bool enable) { this->global_enable = enable; }
 
     Event_dumper event_dumper;
@@ -79,14 +121,31 @@ namespace vp {
     virtual void add_exclude_trace_path(int events, std::string path) {}
     virtual void check_traces() {}
 
+    // Called by IO master ports each time a request is allocated, to check
+    // that requests are recycled instead of being allocated during the simulation
+    inline void io_req_alloc(bool reused)
+    {
+        if (reused)
+            this->nb_io_req_reused++;
+        else
+            this->nb_io_req_alloc++;
+    }
+
+    inline int64_t get_nb_io_req_alloc() { return this->nb_io_req_alloc; }
+    inline int64_t get_nb_io_req_reused() { return this->nb_io_req_reused; }
+
   protected:
     std::map<std::string, trace *> traces_map;
     std::vector<trace *> traces_array;
     int trace_format;
+    vp::trace io_req_trace;
 
   private:
     void enqueue_pending(vp::trace *trace, int64_t timestamp, uint8_t *event);
     char *get_event_buffer(int bytes);
+    void push_ready_buffer();
+    char *pop_buffer(trace_buffer_ring *ring, std::atomic<bool> *waiting);
+    void push_buffer(trace_buffer_ring *ring, std::atomic<bool> *waiting, char *buffer);
     void vcd_routine();
     void flush();
     void check_pending_events(int64_t timestamp);
@@ -98,19 +157,27 @@ namespace vp {
     // the same timestamp.
     void flush_event_traces(int64_t timestamp);
 
-    vector<char *> event_buffers;
-    vector<char *> ready_event_buffers;
+    // The engine thread fills the buffers of events and pushes them to the ready queue, the
+    // trace thread pops them, dumps the events and pushes them back to the free queue.
+    // The mutex and the condition are only used to put a thread to sleep when its queue is
+    // empty, the waiting flags tell the other thread that it must wake it up.
+    trace_buffer_ring free_event_buffers;
+    trace_buffer_ring ready_event_buffers;
+    std::atomic<bool> engine_waiting;
+    std::atomic<bool> vcd_waiting;
     char *current_buffer;
     int current_buffer_size;
     pthread_mutex_t mutex;
     pthread_cond_t cond;
-    int end = 0;
+    std::atomic<bool> end;
     std::thread *thread;
     trace *first_pending_event;
 
     Event_trace *first_trace_to_dump;
     bool global_enable = true;
     gv::Vcd_user *vcd_user;
+    int64_t nb_io_req_alloc = 0;
+    int64_t nb_io_req_reused = 0;
   };
 
 };
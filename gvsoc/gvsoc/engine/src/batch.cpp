@@ -0,0 +1,618 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#include <vp/vp.hpp>
+#include <gv/gvsoc.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <chrono>
+#include <list>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+
+class Gv_batch_client
+{
+public:
+    int fd;
+    std::string buffer;
+    bool closed = false;
+    int nb_pending_tests = 0;
+};
+
+
+class Gv_batch_test
+{
+public:
+    Gv_batch_client *client;
+    std::string req;
+    std::string dir;
+    std::string log;
+    std::vector<std::pair<std::string, std::string>> patches;
+
+    pid_t pid = -1;
+    // Read end of the pipe through which the child process sends back the test results
+    int result_fd = -1;
+    int64_t start_time;
+};
+
+
+class Gv_batch_server
+{
+public:
+    Gv_batch_server(void *instance, int nb_jobs);
+    int open(std::string socket_path);
+    void run();
+
+private:
+    void handle_client(Gv_batch_client *client);
+    void handle_request(Gv_batch_client *client, std::string line);
+    void launch_test(Gv_batch_test *test);
+    void run_test(Gv_batch_test *test, int result_fd);
+    void test_done(Gv_batch_test *test);
+    void send_reply(Gv_batch_client *client, std::string msg);
+    void release_client(Gv_batch_client *client);
+
+    void *instance;
+    int nb_jobs;
+    std::string socket_path;
+    int socket_fd = -1;
+    bool quit = false;
+
+    std::list<Gv_batch_client *> clients;
+    std::list<Gv_batch_test *> pending_tests;
+    std::list<Gv_batch_test *> running_tests;
+};
+
+
+static int64_t gv_batch_get_time()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+static js::config *gv_batch_parse_value(std::string value)
+{
+    char *end;
+    double number = strtod(value.c_str(), &end);
+
+    if (value.size() > 0 && *end == 0)
+    {
+        return new js::config_number(number);
+    }
+    else if (value == "true" || value == "false")
+    {
+        return new js::config_bool(value == "true");
+    }
+    else if (value.size() > 0 && (value[0] == '[' || value[0] == '{'))
+    {
+        return js::import_config_from_string("{\"value\": " + value + "}")->get("value");
+    }
+
+    return new js::config_string(value);
+}
+
+
+// Replace the property at the specified path in the platform configuration. This is only
+// seen by the components reading the property when they are started, so properties which
+// have already been read while the platform was elaborated are rejected.
+// Returns -1 if the path is invalid and -2 if the property has already been read.
+static int gv_batch_patch_config(js::config *config, std::string path, std::string value)
+{
+    size_t index = path.rfind('/');
+    js::config *parent = index == std::string::npos ? config : config->get(path.substr(0, index));
+    js::config_object *object = dynamic_cast<js::config_object *>(parent);
+
+    if (object == NULL)
+    {
+        return -1;
+    }
+
+    std::string name = path.substr(index + 1);
+    auto it = object->childs.find(name);
+    if (it != object->childs.end() && it->second->accessed)
+    {
+        return -2;
+    }
+
+    object->childs[name] = gv_batch_parse_value(value);
+
+    return 0;
+}
+
+
+Gv_batch_server::Gv_batch_server(void *instance, int nb_jobs)
+    : instance(instance), nb_jobs(nb_jobs)
+{
+    if (this->nb_jobs <= 0)
+    {
+        this->nb_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+}
+
+
+int Gv_batch_server::open(std::string socket_path)
+{
+    struct sockaddr_un addr;
+
+    if (socket_path.size() >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "Batch server socket path is too long: %s\n", socket_path.c_str());
+        return -1;
+    }
+
+    this->socket_path = socket_path;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path.c_str());
+
+    this->socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (this->socket_fd < 0)
+    {
+        fprintf(stderr, "Unable to create batch server socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    unlink(socket_path.c_str());
+
+    if (bind(this->socket_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1)
+    {
+        fprintf(stderr, "Unable to bind the batch server socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    if (listen(this->socket_fd, 16) == -1)
+    {
+        fprintf(stderr, "Unable to listen: %s\n", strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+
+void Gv_batch_server::send_reply(Gv_batch_client *client, std::string msg)
+{
+    if (!client->closed)
+    {
+        // The client may have left, in which case the reply is just dropped
+        if (send(client->fd, msg.c_str(), msg.size(), MSG_NOSIGNAL) < 0)
+        {
+            client->closed = true;
+        }
+    }
+}
+
+
+void Gv_batch_server::release_client(Gv_batch_client *client)
+{
+    // The socket is kept until all the tests of the client are done, so that its descriptor
+    // is not reused by another client which would receive the results
+    if (client->closed && client->nb_pending_tests == 0)
+    {
+        close(client->fd);
+        this->clients.remove(client);
+        delete client;
+    }
+}
+
+
+void Gv_batch_server::handle_request(Gv_batch_client *client, std::string line)
+{
+    Gv_batch_test *test = new Gv_batch_test();
+    std::string cmd = "";
+    size_t start = 0;
+
+    test->client = client;
+
+    while (start < line.size())
+    {
+        size_t end = line.find(';', start);
+        if (end == std::string::npos)
+        {
+            end = line.size();
+        }
+
+        std::string token = line.substr(start, end - start);
+        size_t index = token.find('=');
+        std::string name = token.substr(0, index);
+        std::string value = index == std::string::npos ? "" : token.substr(index + 1);
+
+        if (name == "req")
+        {
+            test->req = value;
+        }
+        else if (name == "cmd")
+        {
+            cmd = value;
+        }
+        else if (name == "dir")
+        {
+            test->dir = value;
+        }
+        else if (name == "log")
+        {
+            test->log = value;
+        }
+        else if (name == "patch" || name == "stim")
+        {
+            index = value.find('=');
+            if (index != std::string::npos)
+            {
+                std::string path = value.substr(0, index);
+                if (name == "stim")
+                {
+                    path += "/stim_file";
+                }
+                test->patches.push_back({path, value.substr(index + 1)});
+            }
+        }
+
+        start = end + 1;
+    }
+
+    if (cmd == "run")
+    {
+        client->nb_pending_tests++;
+        this->pending_tests.push_back(test);
+        return;
+    }
+
+    if (cmd == "quit")
+    {
+        this->quit = true;
+        this->send_reply(client, "req=" + test->req + "\n");
+    }
+    else
+    {
+        this->send_reply(client, "req=" + test->req + ";error=invalid command\n");
+    }
+
+    delete test;
+}
+
+
+void Gv_batch_server::handle_client(Gv_batch_client *client)
+{
+    char data[4096];
+    ssize_t size = read(client->fd, data, sizeof(data));
+
+    if (size <= 0)
+    {
+        client->closed = true;
+        this->release_client(client);
+        return;
+    }
+
+    client->buffer.append(data, size);
+
+    size_t index;
+    while ((index = client->buffer.find('\n')) != std::string::npos)
+    {
+        std::string line = client->buffer.substr(0, index);
+        client->buffer.erase(0, index + 1);
+        this->handle_request(client, line);
+    }
+}
+
+
+void Gv_batch_server::run_test(Gv_batch_test *test, int result_fd)
+{
+    // Only keep the pipe to the server
+    close(this->socket_fd);
+    for (auto x: this->clients)
+    {
+        close(x->fd);
+    }
+    for (auto x: this->running_tests)
+    {
+        close(x->result_fd);
+    }
+
+    if (test->dir != "" && chdir(test->dir.c_str()) != 0)
+    {
+        dprintf(result_fd, "error=failed to enter test directory\n");
+        _exit(-1);
+    }
+
+    if (test->log != "")
+    {
+        int log_fd = ::open(test->log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (log_fd < 0)
+        {
+            dprintf(result_fd, "error=failed to open log file\n");
+            _exit(-1);
+        }
+        dup2(log_fd, 1);
+        dup2(log_fd, 2);
+        close(log_fd);
+    }
+
+    vp::top *top = (vp::top *)this->instance;
+    vp::component *instance = top->top_instance;
+
+    for (auto x: test->patches)
+    {
+        int err = gv_batch_patch_config(instance->get_js_config(), x.first, x.second);
+        if (err == -2)
+        {
+            dprintf(result_fd, "error=patched property %s is read during build\n", x.first.c_str());
+            _exit(-1);
+        }
+        else if (err)
+        {
+            dprintf(result_fd, "error=invalid patch path %s\n", x.first.c_str());
+            _exit(-1);
+        }
+    }
+
+    instance->post_fork_all();
+
+    gv_start(this->instance);
+    gv_reset(this->instance, true);
+    gv_reset(this->instance, false);
+
+    int status = gv_run(this->instance);
+    int64_t time = instance->get_time_engine()->get_time();
+
+    // Counters are reported before stopping, as they are the ones seen by the test
+    std::vector<std::pair<std::string, int64_t>> counters;
+    instance->get_perf_counters_recursive(counters);
+
+    std::string perf;
+    for (auto x: counters)
+    {
+        perf += (perf == "" ? "" : ",") + x.first + ":" + std::to_string(x.second);
+    }
+
+    gv_stop(this->instance, status);
+
+    fflush(NULL);
+
+    dprintf(result_fd, "status=%d;time=%ld;perf=%s\n", status, time, perf.c_str());
+
+    _exit(status);
+}
+
+
+void Gv_batch_server::launch_test(Gv_batch_test *test)
+{
+    int result_pipe[2];
+
+    if (pipe(result_pipe) != 0)
+    {
+        this->send_reply(test->client, "req=" + test->req + ";error=failed to create pipe\n");
+        test->client->nb_pending_tests--;
+        this->release_client(test->client);
+        delete test;
+        return;
+    }
+
+    // Buffered outputs would be written again by each child
+    fflush(NULL);
+
+    test->start_time = gv_batch_get_time();
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(result_pipe[0]);
+        this->run_test(test, result_pipe[1]);
+    }
+
+    close(result_pipe[1]);
+
+    if (pid < 0)
+    {
+        close(result_pipe[0]);
+        this->send_reply(test->client, "req=" + test->req + ";error=failed to fork\n");
+        test->client->nb_pending_tests--;
+        this->release_client(test->client);
+        delete test;
+        return;
+    }
+
+    test->pid = pid;
+    test->result_fd = result_pipe[0];
+    this->running_tests.push_back(test);
+}
+
+
+void Gv_batch_server::test_done(Gv_batch_test *test)
+{
+    std::string result;
+    char data[256];
+    ssize_t size;
+
+    // The child only closes the pipe when it exits
+    while ((size = read(test->result_fd, data, sizeof(data))) > 0)
+    {
+        result.append(data, size);
+    }
+
+    close(test->result_fd);
+
+    int wstatus;
+    struct rusage usage;
+    wait4(test->pid, &wstatus, 0, &usage);
+
+    int64_t wall_time = gv_batch_get_time() - test->start_time;
+
+    std::string reply = "req=" + test->req + ";";
+
+    if (!result.empty() && result.back() == '\n')
+    {
+        result.pop_back();
+    }
+
+    if (result != "")
+    {
+        reply += result;
+    }
+    else if (WIFSIGNALED(wstatus))
+    {
+        reply += "status=-1;signal=" + std::to_string(WTERMSIG(wstatus));
+    }
+    else
+    {
+        reply += "status=" + std::to_string(WEXITSTATUS(wstatus));
+    }
+
+    reply += ";wall=" + std::to_string(wall_time) +
+        ";user=" + std::to_string((int64_t)usage.ru_utime.tv_sec * 1000000 + usage.ru_utime.tv_usec) +
+        ";sys=" + std::to_string((int64_t)usage.ru_stime.tv_sec * 1000000 + usage.ru_stime.tv_usec) +
+        ";maxrss=" + std::to_string(usage.ru_maxrss) + "\n";
+
+    this->send_reply(test->client, reply);
+
+    test->client->nb_pending_tests--;
+    this->release_client(test->client);
+
+    this->running_tests.remove(test);
+    delete test;
+}
+
+
+void Gv_batch_server::run()
+{
+    while (!this->quit || !this->pending_tests.empty() || !this->running_tests.empty())
+    {
+        while (!this->pending_tests.empty() && (int)this->running_tests.size() < this->nb_jobs)
+        {
+            Gv_batch_test *test = this->pending_tests.front();
+            this->pending_tests.pop_front();
+            this->launch_test(test);
+        }
+
+        // Poll the server socket, the clients and the result pipes of the running tests
+        std::vector<struct pollfd> fds;
+        std::vector<Gv_batch_client *> poll_clients;
+        std::vector<Gv_batch_test *> poll_tests;
+
+        if (!this->quit)
+        {
+            fds.push_back({ this->socket_fd, POLLIN, 0 });
+        }
+
+        for (auto x: this->clients)
+        {
+            if (!x->closed)
+            {
+                fds.push_back({ x->fd, POLLIN, 0 });
+                poll_clients.push_back(x);
+            }
+        }
+
+        for (auto x: this->running_tests)
+        {
+            fds.push_back({ x->result_fd, POLLIN, 0 });
+            poll_tests.push_back(x);
+        }
+
+        if (fds.size() == 0)
+        {
+            break;
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Batch server poll failed: %s\n", strerror(errno));
+            break;
+        }
+
+        int index = 0;
+
+        if (!this->quit)
+        {
+            if (fds[index].revents)
+            {
+                int client_fd = accept(this->socket_fd, NULL, NULL);
+                if (client_fd >= 0)
+                {
+                    Gv_batch_client *client = new Gv_batch_client();
+                    client->fd = client_fd;
+                    this->clients.push_back(client);
+                }
+            }
+            index++;
+        }
+
+        for (auto x: poll_clients)
+        {
+            if (fds[index++].revents)
+            {
+                this->handle_client(x);
+            }
+        }
+
+        for (auto x: poll_tests)
+        {
+            if (fds[index++].revents)
+            {
+                this->test_done(x);
+            }
+        }
+    }
+
+    close(this->socket_fd);
+    unlink(this->socket_path.c_str());
+}
+
+
+extern "C" int gv_batch_server(const char *config_path, const char *socket_path, int nb_jobs)
+{
+    struct gv_conf gv_conf;
+
+    gv_conf.open_proxy = false;
+    gv_conf.proxy_socket = NULL;
+    gv_conf.req_pipe = -1;
+    gv_conf.reply_pipe = -1;
+
+    void *instance = gv_create(config_path, &gv_conf);
+    if (instance == NULL)
+    {
+        return -1;
+    }
+
+    // Everything up to the start of the components is shared by all the tests. Starting
+    // is left to each test, as this is where components create the threads which would
+    // not survive the fork, and where memories load their stimuli.
+    gv_elaborate(instance);
+
+    Gv_batch_server *server = new Gv_batch_server(instance, nb_jobs);
+
+    if (server->open(socket_path))
+    {
+        return -1;
+    }
+
+    server->run();
+
+    return 0;
+}
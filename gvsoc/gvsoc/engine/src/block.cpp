@@ -48,6 +48,22 @@ void vp::block::reset_all(bool active)
 }
 
 
+void vp::block::checkpoint_all(vp::checkpoint *cp)
+{
+    for (block *block: this->subblocks)
+    {
+        block->checkpoint_all(cp);
+    }
+
+    for (signal *signal: this->signals)
+    {
+        int64_t value = signal->get();
+        cp->sync(&value);
+        signal->set(value);
+    }
+}
+
+
 void vp::block::add_block(block *block)
 {
     this->subblocks.push_back(block);
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#include <vp/vp.hpp>
+#include <vp/checkpoint.hpp>
+#include <string.h>
+#include <algorithm>
+
+#define CHECKPOINT_MAGIC   0x50434756  // "GVCP"
+#define CHECKPOINT_VERSION 1
+
+
+vp::checkpoint::checkpoint(std::string path, bool is_restore)
+    : path(path), restore(is_restore)
+{
+}
+
+
+vp::checkpoint::~checkpoint()
+{
+    if (this->file)
+    {
+        fclose(this->file);
+    }
+}
+
+
+int vp::checkpoint::open(int64_t *time)
+{
+    this->file = fopen(this->path.c_str(), this->restore ? "rb" : "wb");
+    if (this->file == NULL)
+    {
+        this->error("Failed to open checkpoint file (path: " + this->path + ", error: " + strerror(errno) + ")");
+        return -1;
+    }
+
+    uint32_t magic = CHECKPOINT_MAGIC;
+    uint32_t version = CHECKPOINT_VERSION;
+
+    this->sync(&magic);
+    this->sync(&version);
+
+    if (magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION)
+    {
+        this->error("Invalid checkpoint file (path: " + this->path + ")");
+        return -1;
+    }
+
+    this->sync(time);
+
+    return this->has_error() ? -1 : 0;
+}
+
+
+std::string vp::checkpoint::get_file_path(vp::component *comp, std::string suffix)
+{
+    std::string comp_path = comp->get_path();
+    std::replace(comp_path.begin(), comp_path.end(), '/', '.');
+    return this->path + comp_path + "." + suffix;
+}
+
+
+void vp::checkpoint::error(std::string msg)
+{
+    // Only keep the first error as the other ones are usually a consequence
+    if (!this->has_error())
+    {
+        this->error_msg = msg;
+    }
+}
+
+
+void vp::checkpoint::write(const void *data, size_t size)
+{
+    if (this->has_error())
+        return;
+
+    if (fwrite(data, 1, size, this->file) != size)
+    {
+        this->error("Failed to write checkpoint file (path: " + this->path + ")");
+    }
+}
+
+
+void vp::checkpoint::read(void *data, size_t size)
+{
+    if (this->has_error())
+    {
+        memset(data, 0, size);
+        return;
+    }
+
+    if (fread(data, 1, size, this->file) != size)
+    {
+        memset(data, 0, size);
+        this->error("Failed to read checkpoint file, file is truncated (path: " + this->path + ")");
+    }
+}
+
+
+void vp::checkpoint::sync(std::string *value)
+{
+    uint32_t size = value->size();
+    this->sync(&size);
+
+    if (this->restore)
+    {
+        std::vector<char> buffer(size);
+        this->read(buffer.data(), size);
+        *value = std::string(buffer.data(), size);
+    }
+    else
+    {
+        this->write(value->c_str(), size);
+    }
+}
+
+
+void vp::checkpoint::sync_tag(std::string tag)
+{
+    std::string value = tag;
+    this->sync(&value);
+
+    if (value != tag)
+    {
+        this->error("Checkpoint does not match platform (expected: " + tag + ", got: " + value + ")");
+    }
+}
@@ -37,6 +37,10 @@ public:
 
     int64_t step(int64_t duration);
 
+    int checkpoint(std::string path);
+
+    int restore(std::string path);
+
     gv::Io_binding *io_bind(gv::Io_user *user, std::string comp_name, std::string itf_name);
 
     void vcd_bind(gv::Vcd_user *user);
@@ -90,6 +94,16 @@ int64_t Gvsoc_launcher::step(int64_t duration)
     return 0;
 }
 
+int Gvsoc_launcher::checkpoint(std::string path)
+{
+    return gv_checkpoint(this->handler, path.c_str());
+}
+
+int Gvsoc_launcher::restore(std::string path)
+{
+    return gv_restore(this->handler, path.c_str());
+}
+
 gv::Io_binding *Gvsoc_launcher::io_bind(gv::Io_user *user, std::string comp_name, std::string itf_name)
 {
     return (gv::Io_binding *)this->instance->external_bind(comp_name, itf_name, (void *)user);
@@ -24,6 +24,7 @@
 #include <dlfcn.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 
 
@@ -31,6 +32,8 @@
 int main(int argc, char *argv[])
 {
     char *config_path = NULL;
+    char *batch_socket = NULL;
+    int batch_jobs = 0;
     bool open_proxy = false;
 
     for (int i=1; i<argc; i++)
@@ -43,6 +46,14 @@ int main(int argc, char *argv[])
         {
             open_proxy = true;
         }
+        else if (strncmp(argv[i], "--batch-server=", 15) == 0)
+        {
+            batch_socket = &argv[i][15];
+        }
+        else if (strncmp(argv[i], "--batch-jobs=", 13) == 0)
+        {
+            batch_jobs = atoi(&argv[i][13]);
+        }
     }
 
     if (config_path == NULL)
@@ -51,6 +62,11 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    if (batch_socket != NULL)
+    {
+        return gv_batch_server(config_path, batch_socket, batch_jobs);
+    }
+
     int proxy_socket = -1;
     void *instance = gv_open(config_path, open_proxy, &proxy_socket, -1, -1);
 
@@ -0,0 +1,507 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Parallel mode of the time engine.
+ *
+ * This is a conservative scheme, where clock domains are spread over partitions,
+ * each simulated by a thread. All partitions simulate the same window of time,
+ * and then wait for each other before the next window is started.
+ * Clock domains can only interact through links, which are slave ports whose
+ * owner delays what it receives. When a link is called from another partition,
+ * it posts the call to its own partition, at least one lookahead later. Since the
+ * window is the lookahead, a call posted during a window is always for the next
+ * windows, and partitions never have to look at each other during a window.
+ * Anything else crossing clock domains would access a domain simulated by
+ * another thread, so the engine then falls back to the sequential mode.
+ */
+
+#include "vp/vp.hpp"
+#include "vp/itf/clk.hpp"
+#include <algorithm>
+#include <sched.h>
+
+namespace vp
+{
+
+// Call posted by a client to a client of another partition
+class time_engine_call
+{
+public:
+    int64_t time;
+    // Calls with the same time are ordered by posting client and then by order of
+    // posting, which does not depend on how clients are spread over the threads.
+    int source;
+    int64_t seq;
+    time_engine_client *target;
+    void (*meth)(void *, void *);
+    void *arg0;
+    void *arg1;
+
+    // Order of the heap of calls, the first call to execute must be on top
+    bool operator<(const time_engine_call &other) const
+    {
+        if (this->time != other.time)
+            return this->time > other.time;
+        if (this->source != other.source)
+            return this->source > other.source;
+        return this->seq > other.seq;
+    }
+};
+
+class time_engine_partition : public time_engine_queue
+{
+public:
+    time_engine_partition(time_engine *engine) : engine(engine)
+    {
+        pthread_mutex_init(&this->inbox_mutex, NULL);
+    }
+
+    // Post a call from any thread, it will be seen at the next window
+    void post(time_engine_call &call);
+
+    // Move the calls posted during the previous window to the heap of calls
+    void flush_inbox();
+
+    int64_t get_next_time();
+
+    // Execute everything before the end of the window
+    void run_window(int64_t end);
+
+    bool has_pending() { return this->get_first_client() != NULL || this->calls.size() != 0; }
+
+    int64_t get_time() { return this->time; }
+
+    time_engine *engine;
+    // Client being executed, to know who is posting
+    time_engine_client *current = NULL;
+    std::vector<time_engine_call> calls;
+
+    friend class time_engine;
+
+private:
+    pthread_mutex_t inbox_mutex;
+    std::vector<time_engine_call> inbox;
+};
+
+};
+
+
+// Partition simulated by this thread while the parallel mode is running
+static thread_local vp::time_engine_partition *current_partition = NULL;
+
+
+void vp::time_engine_partition::post(time_engine_call &call)
+{
+    pthread_mutex_lock(&this->inbox_mutex);
+    this->inbox.push_back(call);
+    pthread_mutex_unlock(&this->inbox_mutex);
+}
+
+
+void vp::time_engine_partition::flush_inbox()
+{
+    pthread_mutex_lock(&this->inbox_mutex);
+    for (time_engine_call &call: this->inbox)
+    {
+        this->calls.push_back(call);
+        std::push_heap(this->calls.begin(), this->calls.end());
+    }
+    this->inbox.clear();
+    pthread_mutex_unlock(&this->inbox_mutex);
+}
+
+
+int64_t vp::time_engine_partition::get_next_time()
+{
+    int64_t time = INT64_MAX;
+    time_engine_client *client = this->get_first_client();
+
+    if (client)
+        time = client->next_event_time;
+
+    if (this->calls.size() && this->calls[0].time < time)
+        time = this->calls[0].time;
+
+    return time;
+}
+
+
+void vp::time_engine_partition::run_window(int64_t end)
+{
+    current_partition = this;
+
+    while (__atomic_load_n(&this->engine->run_req, __ATOMIC_RELAXED))
+    {
+        time_engine_client *client = this->get_first_client();
+        int64_t client_time = client ? client->next_event_time : INT64_MAX;
+
+        // Calls are executed before clients of the same time, so that the clients
+        // see what was received at this time
+        if (this->calls.size() && this->calls[0].time <= client_time)
+        {
+            if (this->calls[0].time >= end)
+                break;
+
+            std::pop_heap(this->calls.begin(), this->calls.end());
+            time_engine_call call = this->calls.back();
+            this->calls.pop_back();
+
+            this->time = call.time;
+            this->current = call.target;
+            call.meth(call.arg0, call.arg1);
+        }
+        else
+        {
+            if (client_time >= end)
+                break;
+
+            this->pop_client();
+            this->time = client_time;
+            this->current = client;
+
+            client->running = true;
+            int64_t time = client->exec();
+            client->running = false;
+
+            if (time > 0)
+            {
+                this->push_client(client, this->time + time);
+            }
+        }
+
+        this->current = NULL;
+    }
+}
+
+
+void *vp::time_engine::partition_routine(void *arg)
+{
+    vp::time_engine_partition *partition = (vp::time_engine_partition *)arg;
+    partition->engine->run_partition(partition);
+    return NULL;
+}
+
+
+void vp::time_engine::run_partition(time_engine_partition *partition)
+{
+    int64_t gen = 0;
+
+    while (1)
+    {
+        // Wait for the next window, first actively since windows are usually short,
+        // and then on the condition in case the engine is paused
+        int spins = 0;
+        while (__atomic_load_n(&this->window_gen, __ATOMIC_SEQ_CST) == gen)
+        {
+            spins++;
+            if (spins > 100000)
+            {
+                pthread_mutex_lock(&this->window_mutex);
+                __atomic_add_fetch(&this->window_sleepers, 1, __ATOMIC_SEQ_CST);
+                while (__atomic_load_n(&this->window_gen, __ATOMIC_SEQ_CST) == gen)
+                {
+                    pthread_cond_wait(&this->window_cond, &this->window_mutex);
+                }
+                __atomic_sub_fetch(&this->window_sleepers, 1, __ATOMIC_SEQ_CST);
+                pthread_mutex_unlock(&this->window_mutex);
+            }
+            else if (spins > 1000)
+            {
+                sched_yield();
+            }
+        }
+        gen++;
+
+        partition->run_window(this->window_end);
+
+        __atomic_add_fetch(&this->window_done, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+
+void vp::time_engine::run_parallel()
+{
+    int nb_workers = this->partitions.size() - 1;
+
+    while (__atomic_load_n(&this->run_req, __ATOMIC_RELAXED))
+    {
+        // All partitions are waiting, so the calls posted during the previous window
+        // can be looked at, to find where the next window starts
+        int64_t start = INT64_MAX;
+        for (time_engine_partition *partition: this->partitions)
+        {
+            partition->flush_inbox();
+            start = std::min(start, partition->get_next_time());
+        }
+
+        if (start == INT64_MAX)
+            break;
+
+        this->time = start;
+        this->window_end = start + this->lookahead < start ? INT64_MAX : start + this->lookahead;
+        __atomic_store_n(&this->window_done, 0, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&this->window_gen, 1, __ATOMIC_SEQ_CST);
+
+        if (__atomic_load_n(&this->window_sleepers, __ATOMIC_SEQ_CST))
+        {
+            pthread_mutex_lock(&this->window_mutex);
+            pthread_cond_broadcast(&this->window_cond);
+            pthread_mutex_unlock(&this->window_mutex);
+        }
+
+        // This thread simulates the first partition
+        this->partitions[0]->run_window(this->window_end);
+
+        int spins = 0;
+        while (__atomic_load_n(&this->window_done, __ATOMIC_SEQ_CST) != nb_workers)
+        {
+            if (++spins > 1000)
+                sched_yield();
+        }
+    }
+
+    current_partition = NULL;
+}
+
+
+bool vp::time_engine::parallel_start()
+{
+    std::string error = this->parallel_error;
+    js::config *gv_config = this->get_vp_config();
+
+    if (gv_config->get_child_bool("proxy/enabled"))
+    {
+        error = "the proxy is enabled";
+    }
+    else if (gv_config->get_child_bool("debug-mode"))
+    {
+        error = "the debug mode is enabled";
+    }
+
+    for (std::string path: { "traces/include_regex", "events/include_regex", "events/include_raw" })
+    {
+        js::config *paths = gv_config->get(path);
+        if (paths && paths->get_elems().size())
+        {
+            error = "traces or events are enabled";
+        }
+    }
+
+    for (time_engine_queue_entry &entry: this->clients_heap)
+    {
+        time_engine_client *client = entry.client;
+        if (dynamic_cast<clock_engine *>(client) == NULL)
+        {
+            error = "a time domain is used (" + client->get_path() + ")";
+        }
+        else if (std::find(this->parallel_clients.begin(), this->parallel_clients.end(), client) ==
+            this->parallel_clients.end())
+        {
+            this->parallel_clients.push_back(client);
+        }
+    }
+
+    // Half of the latency of the fastest link, see the routers for why
+    this->lookahead = INT64_MAX;
+    for (auto link: this->parallel_links)
+    {
+        clock_engine *clock = link.first->get_owner()->get_clock();
+        int64_t lookahead = clock ? link.second * clock->get_period() / 2 : 0;
+        if (lookahead <= 0)
+        {
+            error = "the link " + link.first->get_owner()->get_path() + " has no latency";
+        }
+        this->lookahead = std::min(this->lookahead, lookahead);
+    }
+
+    int nb_partitions = this->parallel_nb_threads;
+    if (nb_partitions <= 0 || nb_partitions > (int)this->parallel_clients.size())
+    {
+        nb_partitions = this->parallel_clients.size();
+    }
+
+    if (error == "" && nb_partitions < 2)
+    {
+        error = this->parallel_clients.size() < 2 ? "there is a single clock domain" : "a single thread is requested";
+    }
+
+    if (error != "")
+    {
+        fprintf(stdout, "[\033[31mWARNING\033[0m] Parallel mode disabled, %s, falling back to sequential mode\n",
+            error.c_str());
+        return false;
+    }
+
+    for (int i=0; i<nb_partitions; i++)
+    {
+        time_engine_partition *partition = new time_engine_partition(this);
+        partition->time = this->time;
+        this->partitions.push_back(partition);
+    }
+
+    // Clock domains are spread over the partitions in the order of the bindings, the
+    // identifier is the same whatever the number of threads
+    int id = 0;
+    for (time_engine_client *client: this->parallel_clients)
+    {
+        client->partition = this->partitions[id % nb_partitions];
+        client->parallel_id = id;
+        id++;
+    }
+    this->parallel_next_id = id;
+
+    while (this->get_first_client())
+    {
+        time_engine_client *client = this->get_first_client();
+        this->pop_client();
+        client->partition->push_client(client, client->next_event_time);
+    }
+
+    pthread_mutex_init(&this->window_mutex, NULL);
+    pthread_cond_init(&this->window_cond, NULL);
+
+    for (int i=1; i<nb_partitions; i++)
+    {
+        pthread_t thread;
+        pthread_create(&thread, NULL, partition_routine, (void *)this->partitions[i]);
+        pthread_detach(thread);
+    }
+
+    return true;
+}
+
+
+bool vp::time_engine::has_clients()
+{
+    if (this->get_first_client())
+        return true;
+
+    for (time_engine_partition *partition: this->partitions)
+    {
+        if (partition->has_pending())
+            return true;
+    }
+
+    return false;
+}
+
+
+bool vp::time_engine::is_local(time_engine_client *client)
+{
+    return !this->parallel || current_partition == NULL || client->partition == current_partition;
+}
+
+
+vp::time_engine_client *vp::time_engine::get_current_client()
+{
+    return current_partition ? current_partition->current : NULL;
+}
+
+
+int64_t vp::time_engine::get_parallel_time()
+{
+    return current_partition ? current_partition->time : this->time;
+}
+
+
+bool vp::time_engine::parallel_enqueue(time_engine_client *client, int64_t time)
+{
+    time_engine_partition *partition = client->partition;
+
+    // Clients which were not seen when the mode was started are simulated by the
+    // partition enqueueing them first, this is fine since they are not bound to
+    // another clock domain.
+    if (partition == NULL)
+    {
+        partition = current_partition ? current_partition : this->partitions[0];
+        client->partition = partition;
+        client->parallel_id = __atomic_fetch_add(&this->parallel_next_id, 1, __ATOMIC_RELAXED);
+    }
+
+    return partition->queue_enqueue(client, this->get_parallel_time() + time);
+}
+
+
+bool vp::time_engine::parallel_dequeue(time_engine_client *client)
+{
+    if (client->partition == NULL)
+        return false;
+
+    return client->partition->queue_dequeue(client);
+}
+
+
+void vp::time_engine::parallel_post(time_engine_client *target, int64_t time, void (*meth)(void *, void *),
+    void *arg0, void *arg1)
+{
+    time_engine_call call;
+    time_engine_client *source = this->get_current_client();
+    int64_t min_time = this->get_parallel_time() + this->lookahead;
+
+    call.time = time < min_time ? min_time : time;
+    call.source = source ? source->parallel_id : -1;
+    call.seq = source ? source->parallel_seq++ : 0;
+    call.target = target;
+    call.meth = meth;
+    call.arg0 = arg0;
+    call.arg1 = arg1;
+
+    target->partition->post(call);
+}
+
+
+void vp::time_engine::register_parallel_link(vp::slave_port *port, int64_t cycles)
+{
+    this->parallel_links.push_back(std::pair<vp::slave_port *, int64_t>(port, cycles));
+}
+
+
+void vp::time_engine::check_parallel_binding(vp::master_port *master, vp::slave_port *slave)
+{
+    if (!this->parallel_enabled)
+        return;
+
+    clock_engine *master_clock = master->get_owner()->get_clock();
+    clock_engine *slave_clock = slave->get_owner()->get_clock();
+
+    for (clock_engine *clock: { master_clock, slave_clock })
+    {
+        if (clock && std::find(this->parallel_clients.begin(), this->parallel_clients.end(), clock) ==
+            this->parallel_clients.end())
+        {
+            this->parallel_clients.push_back(clock);
+        }
+    }
+
+    // Clocks are registered before anything is simulated
+    if (master_clock == slave_clock || dynamic_cast<vp::clk_master *>(master) != NULL)
+        return;
+
+    for (auto link: this->parallel_links)
+    {
+        if (link.first == slave)
+            return;
+    }
+
+    if (this->parallel_error == "")
+    {
+        this->parallel_error = "the binding " + master->get_owner()->get_path() + ":" + master->get_name() +
+            " -> " + slave->get_owner()->get_path() + ":" + slave->get_name() +
+            " crosses clock domains without a link";
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#include "vp/vp.hpp"
+#include "vp/trace/event_dumper.hpp"
+#include <string.h>
+
+
+vp::Binary_file::Binary_file(vp::Event_dumper *dumper, string path)
+    : dumper(dumper), path(path)
+{
+    this->file = fopen(path.c_str(), "wb");
+    if (this->file == NULL)
+    {
+        dumper->comp->get_engine()->fatal("Error while opening binary trace file (path: %s, error: %s)\n", path.c_str(), strerror(errno));
+    }
+
+    std::string index_path = path + ".idx";
+    this->index_file = fopen(index_path.c_str(), "wb");
+    if (this->index_file == NULL)
+    {
+        dumper->comp->get_engine()->fatal("Error while opening binary trace index file (path: %s, error: %s)\n", index_path.c_str(), strerror(errno));
+    }
+}
+
+
+void vp::Binary_file::add_trace(string path, int id, int width, bool is_real, bool is_string)
+{
+    int record_bytes = (width + 7) / 8 + sizeof(int64_t);
+
+    // The header is only dumped once the first trace is known, since it
+    // contains the record size
+    if (this->record_bytes == -1)
+    {
+        this->record_bytes = record_bytes;
+
+        uint32_t header[] = { BINARY_MAGIC, BINARY_VERSION, (uint32_t)record_bytes, BINARY_INDEX_PERIOD };
+        fwrite(header, sizeof(header), 1, this->file);
+    }
+    else if (this->record_bytes != record_bytes)
+    {
+        this->dumper->comp->get_engine()->fatal("Binary traces with different record sizes dumped to the same file (path: %s, trace: %s)\n",
+            this->path.c_str(), path.c_str());
+    }
+}
+
+
+void vp::Binary_file::dump(int64_t timestamp, int id, uint8_t *event, int width, bool is_real, bool is_string, uint8_t flags, uint8_t *flag_mask)
+{
+    if (this->nb_records % BINARY_INDEX_PERIOD == 0)
+    {
+        uint64_t index_entry[] = { (uint64_t)timestamp, this->nb_records };
+        fwrite(index_entry, sizeof(index_entry), 1, this->index_file);
+    }
+
+    fwrite(&timestamp, sizeof(timestamp), 1, this->file);
+    fwrite(event, this->record_bytes - sizeof(timestamp), 1, this->file);
+
+    this->nb_records++;
+}
+
+
+void vp::Binary_file::close()
+{
+    fclose(this->file);
+    fclose(this->index_file);
+}
@@ -133,6 +133,33 @@ vp::Event_trace *vp::Event_dumper::get_trace_string(string trace_name, string fi
   return trace;
 }
 
+vp::Event_trace *vp::Event_dumper::get_trace_binary(string trace_name, string file_name, int width)
+{
+  vp::Event_trace *trace = event_traces[trace_name];
+
+  if (trace == NULL)
+  {
+    // Binary records are always dumped to their own file, whatever the event
+    // format is, as they are only meant for offline tools
+    vp::Event_file *event_file = event_files[file_name];
+    if (event_file == NULL)
+    {
+      event_file = new Binary_file(this, file_name);
+      event_files[file_name] = event_file;
+    }
+    else if (dynamic_cast<Binary_file *>(event_file) == NULL)
+    {
+      this->comp->get_trace()->fatal("Binary trace must be dumped to a dedicated file (trace: %s, file: %s)\n", trace_name.c_str(), file_name.c_str());
+    }
+
+    trace = new Event_trace(trace_name, event_file, width, false, false);
+    trace->is_binary = true;
+    event_traces[trace_name] = trace;
+  }
+
+  return trace;
+}
+
 void vp::Event_trace::set_vcd_user(gv::Vcd_user *user)
 {
   user->event_register(this->id, this->trace_name, this->is_real ? gv::Vcd_event_type_real : this->is_string ? gv::Vcd_event_type_string : gv::Vcd_event_type_logical, this->width);
@@ -153,6 +180,7 @@ void vp::Event_dumper::set_vcd_user(gv::Vcd_user *user)
 
     for (auto const& x : event_traces)
     {
-      x.second->set_vcd_user(user);
+      if (!x.second->is_binary)
+        x.second->set_vcd_user(user);
     }
 }
\ No newline at end of file
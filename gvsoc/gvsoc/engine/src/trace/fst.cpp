@@ -32,6 +32,9 @@ vp::Fst_file::Fst_file(vp::Event_dumper *dumper, string path)
     dumper->comp->get_engine()->fatal("Error while opening FST file (path: %s)\n", path.c_str());
   }
   fstWriterSetTimescale(this->writer, -12);
+  // Blocks are compressed by a dedicated thread while the trace thread goes on
+  // with the next events
+  fstWriterSetParallelMode(this->writer, 1);
 }
 
 
@@ -94,6 +94,23 @@ void vp::component_trace::new_trace_event_string(std::string name, trace *trace)
     this->reg_trace(trace, 1);
 }
 
+void vp::component_trace::new_trace_event_binary(std::string name, trace *trace, int bytes)
+{
+    trace_events[name] = trace;
+    trace->comp = static_cast<vp::component *>(&top);
+    trace->name = name;
+    trace->path = top.get_path() + "/" + name;
+
+    trace->width = bytes * 8;
+    trace->bytes = bytes;
+    trace->is_binary = true;
+    trace->pending_timestamp = -1;
+    trace->buffer = NULL;
+    trace->buffer2 = NULL;
+
+    this->reg_trace(trace, 1);
+}
+
 void vp::component_trace::post_post_build()
 {
     // TODO this seems useless now that the traces are registered immediately to the trace engine
@@ -174,31 +191,61 @@ void vp::trace::set_event_active(bool active)
     }
 }
 
-char *vp::trace_engine::get_event_buffer(int bytes)
+char *vp::trace_engine::pop_buffer(trace_buffer_ring *ring, std::atomic<bool> *waiting)
 {
-    if (current_buffer == NULL || bytes > TRACE_EVENT_BUFFER_SIZE - current_buffer_size)
+    char *buffer = ring->pop();
+    if (buffer == NULL)
     {
+        // Only go to sleep if the queue is still empty after telling the other thread that
+        // we are waiting, otherwise it may have pushed a buffer without waking us up.
         pthread_mutex_lock(&mutex);
-
-        if (current_buffer && bytes > TRACE_EVENT_BUFFER_SIZE - current_buffer_size)
+        *waiting = true;
+        while (ring->is_empty() && !this->end)
         {
-            if ((unsigned int)(TRACE_EVENT_BUFFER_SIZE - current_buffer_size) > sizeof(vp::trace *))
-                *(vp::trace **)(current_buffer + current_buffer_size) = NULL;
+            pthread_cond_wait(&cond, &mutex);
+        }
+        *waiting = false;
+        pthread_mutex_unlock(&mutex);
 
-            ready_event_buffers.push_back(current_buffer);
-            current_buffer = NULL;
+        buffer = ring->pop();
+    }
+    return buffer;
+}
 
-            pthread_cond_broadcast(&cond);
-        }
+void vp::trace_engine::push_buffer(trace_buffer_ring *ring, std::atomic<bool> *waiting, char *buffer)
+{
+    ring->push(buffer);
+
+    // The lock is only taken if the other thread is sleeping
+    if (*waiting)
+    {
+        pthread_mutex_lock(&mutex);
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&mutex);
+    }
+}
+
+void vp::trace_engine::push_ready_buffer()
+{
+    if ((unsigned int)(TRACE_EVENT_BUFFER_SIZE - current_buffer_size) >= sizeof(vp::trace *))
+        *(vp::trace **)(current_buffer + current_buffer_size) = NULL;
+
+    this->push_buffer(&this->ready_event_buffers, &this->vcd_waiting, current_buffer);
+    current_buffer = NULL;
+    current_buffer_size = 0;
+}
 
-        while (event_buffers.size() == 0)
+char *vp::trace_engine::get_event_buffer(int bytes)
+{
+    if (current_buffer == NULL || bytes > TRACE_EVENT_BUFFER_SIZE - current_buffer_size)
+    {
+        if (current_buffer)
         {
-            pthread_cond_wait(&cond, &mutex);
+            this->push_ready_buffer();
         }
-        current_buffer = event_buffers[0];
-        event_buffers.erase(event_buffers.begin());
+
+        current_buffer = this->pop_buffer(&this->free_event_buffers, &this->engine_waiting);
         current_buffer_size = 0;
-        pthread_mutex_unlock(&mutex);
     }
 
     char *result = current_buffer + current_buffer_size;
@@ -210,34 +257,38 @@ char *vp::trace_engine::get_event_buffer(int bytes)
 
 void vp::trace_engine::stop()
 {
+    this->io_req_trace.msg(vp::trace::LEVEL_INFO, "IO requests statistics (allocated: %ld, reused: %ld)\n",
+        this->nb_io_req_alloc, this->nb_io_req_reused);
+
     this->check_pending_events(-1);
     this->flush();
     pthread_mutex_lock(&mutex);
-    this->end = 1;
+    this->end = true;
     pthread_cond_broadcast(&cond);
     pthread_mutex_unlock(&mutex);
     this->thread->join();
     fflush(NULL);
 }
 
+void vp::trace_engine::post_fork()
+{
+    // The trace thread does not exist anymore in the child, and may have left the
+    // mutex locked
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cond, NULL);
+    this->vcd_waiting = false;
+    this->thread = new std::thread(&trace_engine::vcd_routine, this);
+}
+
 void vp::trace_engine::flush()
 {
     // Flush only the events until the current timestamp as we may resume
     // the execution right after
     this->check_pending_events(this->get_time());
 
-    if (current_buffer_size)
+    if (current_buffer && current_buffer_size)
     {
-        pthread_mutex_lock(&mutex);
-
-        if (current_buffer)
-        {
-            *(vp::trace **)(current_buffer + current_buffer_size) = NULL;
-            ready_event_buffers.push_back(current_buffer);
-            current_buffer = NULL;
-        }
-        pthread_cond_broadcast(&cond);
-        pthread_mutex_unlock(&mutex);
+        this->push_ready_buffer();
     }
 }
 
@@ -398,6 +449,13 @@ void vp::trace_engine::dump_event_delayed(vp::trace *trace, int64_t timestamp, u
     this->dump_event_to_buffer(trace, timestamp, event, bytes);
 }
 
+void vp::trace_engine::dump_event_binary(vp::trace *trace, int64_t timestamp, uint8_t *record, int bytes)
+{
+    this->check_pending_events(timestamp);
+
+    this->dump_event_to_buffer(trace, timestamp, record, bytes);
+}
+
 void vp::trace_engine::flush_event_traces(int64_t timestamp)
 {
     Event_trace *current = first_trace_to_dump;
@@ -465,27 +523,16 @@ void vp::trace_engine::vcd_routine()
     {
         char *event_buffer, *event_buffer_start;
 
-        pthread_mutex_lock(&this->mutex);
-
-        // Wait for a buffer of event of the end of simulation
-        while (this->ready_event_buffers.size() == 0 && !end)
-        {
-            pthread_cond_wait(&this->cond, &this->mutex);
-        }
+        // Wait for a buffer of events or the end of simulation
+        event_buffer = this->pop_buffer(&this->ready_event_buffers, &this->vcd_waiting);
 
         // In case of the end of simulation, just leave
-        if (this->ready_event_buffers.size() == 0 && end)
+        if (event_buffer == NULL)
         {
-            pthread_mutex_unlock(&this->mutex);
             break;
         }
 
-        // Pop the first buffer
-        event_buffer = ready_event_buffers[0];
         event_buffer_start = event_buffer;
-        ready_event_buffers.erase(ready_event_buffers.begin());
-
-        pthread_mutex_unlock(&this->mutex);
 
         // And go through the events to unpack them
         while (event_buffer - event_buffer_start < (int)(TRACE_EVENT_BUFFER_SIZE - sizeof(vp::trace *)))
@@ -546,9 +593,18 @@ void vp::trace_engine::vcd_routine()
             memcpy((void *)&event, (void *)event_buffer, bytes);
             event_buffer += bytes;
 
+            // Binary records are not merged, they are all written in order
+            // to their file.
+            if (trace->is_binary)
+            {
+                if (trace->event_trace)
+                {
+                    trace->event_trace->dump_binary(timestamp, event);
+                }
+            }
             // Check if the event trace is already registered, otherwise register it
             // to dump it when the next timestamp is detected.
-            if (trace->event_trace)
+            else if (trace->event_trace)
             {
                 trace->event_trace->reg(timestamp, event, trace->width, flags, flags_mask);
                 if (!trace->event_trace->is_enqueued)
@@ -561,10 +617,7 @@ void vp::trace_engine::vcd_routine()
         }
 
         // Now push back the buffer of events into the list of free buffers
-        pthread_mutex_lock(&this->mutex);
-        event_buffers.push_back(event_buffer_start);
-        pthread_cond_broadcast(&cond);
-        pthread_mutex_unlock(&this->mutex);
+        this->push_buffer(&this->free_event_buffers, &this->engine_waiting, event_buffer_start);
     }
 
     this->flush_event_traces(last_timestamp);
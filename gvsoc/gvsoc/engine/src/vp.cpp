@@ -39,6 +39,7 @@
 #include <poll.h>
 #include <signal.h>
 #include <regex>
+#include <chrono>
 #include <gv/gvsoc_proxy.hpp>
 #include <gv/gvsoc.h>
 #include <sys/types.h>
@@ -189,18 +190,44 @@ void vp::component::load_all()
 
 
 int vp::component::build_new()
+{
+    this->bind_new();
+
+    this->start_new();
+
+    return 0;
+}
+
+
+
+void vp::component::bind_new()
 {
     this->bind_comps();
 
     this->post_post_build_all();
+}
 
+
+
+void vp::component::start_new()
+{
     this->pre_start_all();
 
     this->start_all();
 
     this->final_bind();
+}
 
-    return 0;
+
+
+void vp::component::post_fork_all()
+{
+    for (auto &x : this->childs)
+    {
+        x->post_fork_all();
+    }
+
+    this->post_fork();
 }
 
 
@@ -315,6 +342,63 @@ void vp::component::reset_all(bool active, bool from_itf)
 
 }
 
+void vp::component::checkpoint_all(vp::checkpoint *cp, std::vector<std::function<void()>> *enqueue_callbacks)
+{
+    cp->sync_tag(this->get_path());
+
+    uint32_t nb_regs = this->regs.size();
+    uint32_t nb_events = this->events.size();
+    cp->sync(&nb_regs);
+    cp->sync(&nb_events);
+
+    if (nb_regs != this->regs.size() || nb_events != this->events.size())
+    {
+        cp->error("Checkpoint does not match component (path: " + this->get_path() + ")");
+        return;
+    }
+
+    for (auto reg : this->regs)
+    {
+        cp->sync(reg->get_bytes(), reg->nb_bytes);
+    }
+
+    this->block::checkpoint_all(cp);
+
+    // Pending events are saved with their distance from the current cycle
+    // since the clock engine may not be restored yet when they are read.
+    for (clock_event *event: this->events)
+    {
+        bool enqueued = event->is_enqueued();
+        int64_t cycles = enqueued ? event->get_cycle() - this->get_clock()->get_cycles() : 0;
+
+        cp->sync(&enqueued);
+        cp->sync(&cycles);
+        cp->sync(event->get_payload(), event->get_payload_size());
+
+        if (cp->is_restore())
+        {
+            this->event_cancel(event);
+
+            if (enqueued)
+            {
+                enqueue_callbacks->push_back([this, event, cycles]() {
+                    this->event_enqueue(event, cycles);
+                });
+            }
+        }
+    }
+
+    this->checkpoint_state(cp);
+
+    for (auto &x : this->childs)
+    {
+        if (cp->has_error())
+            return;
+
+        x->checkpoint_all(cp, enqueue_callbacks);
+    }
+}
+
 void vp::component_clock::reset_sync(void *__this, bool active)
 {
     component *_this = (component *)__this;
@@ -338,42 +422,58 @@ void vp::component_clock::pre_build(component *comp)
 
 int64_t vp::time_engine::get_next_event_time()
 {
-    if (this->first_client)
+    time_engine_client *first_client = this->get_first_client();
+    if (first_client)
     {
-        return this->first_client->next_event_time;
+        return first_client->next_event_time;
     }
 
     return this->time;
 }
 
 
-bool vp::time_engine::dequeue(time_engine_client *client)
+bool vp::time_engine_queue::queue_dequeue(time_engine_client *client)
 {
     if (!client->is_enqueued)
         return false;
 
-    client->is_enqueued = false;
+    this->remove_client(client);
+
+    return true;
+}
+
+bool vp::time_engine_queue::queue_enqueue(time_engine_client *client, int64_t full_time)
+{
+    if (client->is_running())
+        return false;
 
-    time_engine_client *current = this->first_client, *prev = NULL;
-    while (current && current != client)
+    if (client->is_enqueued)
     {
-        prev = current;
-        current = current->next;
+        if (client->next_event_time <= full_time)
+            return false;
+
+        // The client can only move towards the head of the heap
+        this->move_client_up(client, full_time);
+        return true;
     }
-    if (prev)
-        prev->next = client->next;
-    else
-        this->first_client = client->next;
+
+    this->push_client(client, full_time);
 
     return true;
 }
 
+bool vp::time_engine::dequeue(time_engine_client *client)
+{
+    if (unlikely(this->parallel))
+        return this->parallel_dequeue(client);
+
+    return this->queue_dequeue(client);
+}
+
 bool vp::time_engine::enqueue(time_engine_client *client, int64_t time)
 {
     vp_assert(time >= 0, NULL, "Time must be positive\n");
 
-    int64_t full_time = this->get_time() + time;
-
 #ifdef __VP_USE_SYSTEMC
     // Notify to the engine that something has been pushed in case it is done
     // by an external systemC component and the engine needs to be waken up
@@ -385,32 +485,22 @@ bool vp::time_engine::enqueue(time_engine_client *client, int64_t time)
     dpi_raise_event();
 #endif
 
-    if (client->is_running())
-        return false;
-
-    if (client->is_enqueued)
-    {
-        if (client->next_event_time <= full_time)
-            return false;
-        this->dequeue(client);
-    }
+    if (unlikely(this->parallel))
+        return this->parallel_enqueue(client, time);
 
-    client->is_enqueued = true;
+    return this->queue_enqueue(client, this->get_time() + time);
+}
 
-    time_engine_client *current = first_client, *prev = NULL;
-    client->next_event_time = full_time;
-    while (current && current->next_event_time < client->next_event_time)
+void vp::time_engine::set_time(int64_t time)
+{
+    // Pending clients keep the same delay from the current time
+    for (time_engine_queue_entry &entry: this->clients_heap)
     {
-        prev = current;
-        current = current->next;
+        entry.client->next_event_time += time - this->time;
+        entry.time = entry.client->next_event_time;
     }
-    if (prev)
-        prev->next = client;
-    else
-        first_client = client;
-    client->next = current;
 
-    return true;
+    this->time = time;
 }
 
 bool vp::clock_engine::dequeue_from_engine()
@@ -518,28 +608,249 @@ vp::clock_event *vp::clock_engine::enqueue_other(vp::clock_event *event, int64_t
             enqueue_to_engine(cycle * period);
         }
 
-        vp::clock_event *current = delayed_queue, *prev = NULL;
-        int64_t full_cycle = cycle + get_cycles();
-        while (current && current->cycle < full_cycle)
+        event->cycle = cycle + get_cycles();
+        this->wheel_insert(event);
+    }
+    return event;
+}
+
+void vp::clock_engine::wheel_insert(vp::clock_event *event)
+{
+    // Events in the past can only come from an engine which was not properly
+    // synchronized, just put them in the first slot so that they are executed
+    // as soon as possible.
+    int64_t cycle = event->cycle < this->wheel_cycle ? this->wheel_cycle : event->cycle;
+    int64_t diff = cycle ^ this->wheel_cycle;
+
+    // Find the first level where the event has the same upper slot as the
+    // wheel position, which is given by the highest bit which differs.
+    int level = 0;
+    if (diff >> CLOCK_WHEEL_LEVEL_BITS)
+    {
+        level = (63 - __builtin_clzll(diff)) / CLOCK_WHEEL_LEVEL_BITS;
+        if (level > CLOCK_WHEEL_NB_LEVELS)
+            level = CLOCK_WHEEL_NB_LEVELS;
+    }
+
+    int slot = 0;
+    if (level < CLOCK_WHEEL_NB_LEVELS)
+    {
+        slot = (cycle >> (level * CLOCK_WHEEL_LEVEL_BITS)) & CLOCK_WHEEL_LEVEL_MASK;
+    }
+
+    // Events are always added at the end so that events of the same cycle
+    // keep the order in which they were enqueued.
+    vp::clock_event *last = this->wheel_last[level][slot];
+    event->next = NULL;
+    event->prev = last;
+    if (last)
+        last->next = event;
+    else
+        this->wheel_first[level][slot] = event;
+    this->wheel_last[level][slot] = event;
+
+    this->wheel_mask[level] |= 1ULL << slot;
+    event->wheel_level = level;
+    event->wheel_slot = slot;
+    this->nb_enqueued_to_wheel++;
+    this->wheel_first_event = NULL;
+}
+
+void vp::clock_engine::wheel_remove(vp::clock_event *event)
+{
+    int level = event->wheel_level;
+    int slot = event->wheel_slot;
+
+    if (event->prev)
+        event->prev->next = event->next;
+    else
+        this->wheel_first[level][slot] = event->next;
+
+    if (event->next)
+        event->next->prev = event->prev;
+    else
+        this->wheel_last[level][slot] = event->prev;
+
+    if (this->wheel_first[level][slot] == NULL)
+        this->wheel_mask[level] &= ~(1ULL << slot);
+
+    event->wheel_level = -1;
+    this->nb_enqueued_to_wheel--;
+    this->wheel_first_event = NULL;
+}
+
+void vp::clock_engine::wheel_cascade(int level, int slot)
+{
+    vp::clock_event *event = this->wheel_first[level][slot];
+
+    this->wheel_first[level][slot] = NULL;
+    this->wheel_last[level][slot] = NULL;
+    this->wheel_mask[level] &= ~(1ULL << slot);
+
+    while (event)
+    {
+        vp::clock_event *next = event->next;
+        this->nb_enqueued_to_wheel--;
+        this->wheel_insert(event);
+        event = next;
+    }
+}
+
+void vp::clock_engine::wheel_set_position(int64_t cycle)
+{
+    if (cycle <= this->wheel_cycle)
+        return;
+
+    int64_t prev_cycle = this->wheel_cycle;
+    this->wheel_cycle = cycle;
+
+    // All events are after the new position, so the only events which need
+    // to be moved to lower levels are the ones in the slots that the new
+    // position is entering. Upper levels are handled first since they can
+    // move events to the lower ones.
+    if ((prev_cycle >> (CLOCK_WHEEL_NB_LEVELS * CLOCK_WHEEL_LEVEL_BITS)) != (cycle >> (CLOCK_WHEEL_NB_LEVELS * CLOCK_WHEEL_LEVEL_BITS)))
+    {
+        this->wheel_cascade(CLOCK_WHEEL_NB_LEVELS, 0);
+    }
+
+    for (int level = CLOCK_WHEEL_NB_LEVELS - 1; level > 0; level--)
+    {
+        int shift = level * CLOCK_WHEEL_LEVEL_BITS;
+        int slot = (cycle >> shift) & CLOCK_WHEEL_LEVEL_MASK;
+        if ((prev_cycle >> shift) != (cycle >> shift) && (this->wheel_mask[level] >> slot) & 1)
         {
-            prev = current;
-            current = current->next;
+            this->wheel_cascade(level, slot);
         }
-        if (prev)
-            prev->next = event;
-        else
-            delayed_queue = event;
-        event->next = current;
-        event->cycle = full_cycle;
     }
-    return event;
+}
+
+void vp::clock_engine::wheel_flush(int64_t limit)
+{
+    for (int level = 0; level <= CLOCK_WHEEL_NB_LEVELS; level++)
+    {
+        uint64_t mask = this->wheel_mask[level];
+        while (mask)
+        {
+            int slot = __builtin_ctzll(mask);
+            mask &= mask - 1;
+
+            // Slots and levels are ordered, we can stop as soon as a slot
+            // starts after the limit.
+            if (level < CLOCK_WHEEL_NB_LEVELS)
+            {
+                int shift = level * CLOCK_WHEEL_LEVEL_BITS;
+                int64_t upper_mask = ((int64_t)1 << (shift + CLOCK_WHEEL_LEVEL_BITS)) - 1;
+                int64_t slot_cycle = (this->wheel_cycle & ~upper_mask) | ((int64_t)slot << shift);
+                if (slot_cycle >= limit)
+                    return;
+            }
+
+            // Go through the slot from the end since the circular buffer
+            // is filled by the head, so that events of the same cycle are
+            // executed in the order they were enqueued.
+            vp::clock_event *event = this->wheel_last[level][slot];
+            while (event)
+            {
+                vp::clock_event *prev = event->prev;
+                if (event->cycle < limit)
+                {
+                    int64_t cycle_diff = event->cycle - this->get_cycles();
+                    this->wheel_remove(event);
+                    this->enqueue_to_cycle(event, cycle_diff > 0 ? cycle_diff : 0);
+                }
+                event = prev;
+            }
+        }
+    }
+}
+
+vp::clock_event *vp::clock_engine::wheel_get_first()
+{
+    if (this->wheel_first_event)
+        return this->wheel_first_event;
+
+    // The first event is in the first slot of the first non-empty level,
+    // events in this slot are not sorted so we have to go through all of them.
+    for (int level = 0; level <= CLOCK_WHEEL_NB_LEVELS; level++)
+    {
+        uint64_t mask = this->wheel_mask[level];
+        if (mask)
+        {
+            vp::clock_event *event = this->wheel_first[level][__builtin_ctzll(mask)];
+            vp::clock_event *first = event;
+            while (event)
+            {
+                if (event->cycle < first->cycle)
+                    first = event;
+                event = event->next;
+            }
+            this->wheel_first_event = first;
+            return first;
+        }
+    }
+
+    return NULL;
+}
+
+void vp::clock_engine::clear()
+{
+    for (int i = 0; i < CLOCK_EVENT_QUEUE_SIZE; i++)
+    {
+        for (vp::clock_event *event = event_queue[i]; event; event = event->next)
+        {
+            event->enqueued = false;
+        }
+        event_queue[i] = NULL;
+    }
+    this->nb_enqueued_to_cycle = 0;
+
+    for (int level = 0; level <= CLOCK_WHEEL_NB_LEVELS; level++)
+    {
+        for (int slot = 0; slot < CLOCK_WHEEL_LEVEL_SIZE; slot++)
+        {
+            for (vp::clock_event *event = this->wheel_first[level][slot]; event; event = event->next)
+            {
+                event->enqueued = false;
+                event->wheel_level = -1;
+            }
+            this->wheel_first[level][slot] = NULL;
+            this->wheel_last[level][slot] = NULL;
+        }
+        this->wheel_mask[level] = 0;
+    }
+    this->nb_enqueued_to_wheel = 0;
+    this->wheel_first_event = NULL;
+
+    this->dequeue_from_engine();
+}
+
+void vp::clock_engine::checkpoint_state(vp::checkpoint *cp)
+{
+    // Events which are not owned by a component can not be restored, all
+    // pending events are dropped and the ones owned by components are
+    // re-enqueued after the whole platform is restored.
+    if (cp->is_restore())
+    {
+        this->clear();
+    }
+
+    cp->sync(&this->cycles);
+    cp->sync(&this->stop_time);
+    cp->sync(&this->freq);
+    cp->sync(&this->period);
+
+    if (cp->is_restore())
+    {
+        this->wheel_cycle = this->cycles;
+        this->must_flush_delayed_queue = true;
+    }
 }
 
 vp::clock_event *vp::clock_engine::get_next_event()
 {
     // There is no quick way of getting the next event.
     // We have to first check if there is an event in the circular buffer
-    // and if not in the delayed queue
+    // and if not in the timing wheel
 
     if (this->nb_enqueued_to_cycle)
     {
@@ -555,7 +866,7 @@ vp::clock_event *vp::clock_engine::get_next_event()
         vp_assert(false, 0, "Didn't find any event in circular buffer while it is not empty\n");
     }
 
-    return this->delayed_queue;
+    return this->wheel_get_first();
 }
 
 void vp::clock_engine::cancel(vp::clock_event *event)
@@ -563,29 +874,14 @@ void vp::clock_engine::cancel(vp::clock_event *event)
     if (!event->is_enqueued())
         return;
 
-    // There is no way to know if the event is enqueued into the circular buffer
-    // or in the delayed queue so first go through the delayed queue and if it is
-    // not found, look in the circular buffer
-
-    // First the delayed queue
-    vp::clock_event *current = delayed_queue, *prev = NULL;
-    while (current)
+    // Events in the timing wheel know where they are and can be removed directly
+    if (event->wheel_level != -1)
     {
-        if (current == event)
-        {
-            if (prev)
-                prev->next = event->next;
-            else
-                delayed_queue = event->next;
-
-            goto end;
-        }
-
-        prev = current;
-        current = current->next;
+        this->wheel_remove(event);
+        goto end;
     }
 
-    // Then in the circular buffer
+    // Otherwise look for it in the circular buffer
     for (int i = 0; i < CLOCK_EVENT_QUEUE_SIZE; i++)
     {
         vp::clock_event *current = event_queue[i], *prev = NULL;
@@ -619,24 +915,18 @@ end:
 
 void vp::clock_engine::flush_delayed_queue()
 {
-    clock_event *event = delayed_queue;
     this->must_flush_delayed_queue = false;
-    while (event)
-    {
-        if (nb_enqueued_to_cycle == 0)
-            cycles = event->cycle;
-
-        uint64_t cycle_diff = event->cycle - get_cycles();
-        if (cycle_diff >= CLOCK_EVENT_QUEUE_SIZE)
-            break;
 
-        clock_event *next = event->next;
+    if (this->nb_enqueued_to_wheel == 0)
+        return;
 
-        enqueue_to_cycle(event, cycle_diff);
+    // If the circular buffer is empty, directly jump to the first event
+    if (nb_enqueued_to_cycle == 0)
+        cycles = this->wheel_get_first()->cycle;
 
-        event = next;
-        delayed_queue = event;
-    }
+    // Move to the circular buffer all the events which now fit into it
+    this->wheel_set_position(get_cycles());
+    this->wheel_flush(get_cycles() + CLOCK_EVENT_QUEUE_SIZE);
 }
 
 int64_t vp::clock_engine::exec()
@@ -667,6 +957,7 @@ int64_t vp::clock_engine::exec()
         event_queue[current_cycle] = current->next;
         current->enqueued = false;
         nb_enqueued_to_cycle--;
+        nb_events++;
 
         current->meth(current->_this, current);
         current = event_queue[current_cycle];
@@ -698,9 +989,9 @@ int64_t vp::clock_engine::exec()
         // in case we enqueue and event from another engine.
         this->stop_time = this->get_time();
 
-        if (delayed_queue)
+        if (this->nb_enqueued_to_wheel)
         {
-            return (delayed_queue->cycle - get_cycles()) * period;
+            return (this->wheel_get_first()->cycle - get_cycles()) * period;
         }
         else
         {
@@ -711,8 +1002,13 @@ int64_t vp::clock_engine::exec()
     }
 }
 
+void vp::clock_engine::get_perf_counters(std::vector<std::pair<std::string, int64_t>> &counters)
+{
+    counters.push_back({"events", this->nb_events});
+}
+
 vp::clock_event::clock_event(component_clock *comp, clock_event_meth_t *meth)
-    : comp(comp), _this((void *)static_cast<vp::component *>((vp::component_clock *)(comp))), meth(meth), enqueued(false)
+    : comp(comp), _this((void *)static_cast<vp::component *>((vp::component_clock *)(comp))), meth(meth), enqueued(false), wheel_level(-1)
 {
     comp->add_clock_event(this);
 }
@@ -1311,6 +1607,14 @@ void vp::master_port::final_bind()
     if (this->is_bound)
     {
         this->finalize();
+
+        if (!this->is_virtual())
+        {
+            for (auto slave : this->get_final_ports())
+            {
+                this->get_owner()->get_time_engine()->check_parallel_binding(this, slave);
+            }
+        }
     }
 }
 
@@ -1364,46 +1668,162 @@ void vp::component::build_instance(std::string name, vp::component *parent)
 }
 
 
-vp::component *vp::component::new_component(std::string name, js::config *config, std::string module_name)
+typedef vp::component *(*vp_constructor_t)(js::config *);
+
+
+// Time spent in the startup steps, reported when the startup-stats option is enabled.
+// Times are in nanoseconds.
+static struct
 {
-    if (module_name == "")
+    int64_t config_load_time;
+    bool config_cache_hit;
+    int64_t module_load_time;
+    int nb_modules_loaded;
+    int nb_modules_reused;
+    int nb_modules_static;
+    int64_t constructor_time;
+    int nb_components;
+    int64_t create_time;
+    int64_t build_time;
+    int64_t bind_time;
+    int64_t start_time;
+} vp_startup_stats;
+
+
+static int64_t vp_startup_get_time()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// Constructors of the models linked into the simulator, indexed by flavor and module name, so
+// that a model compiled for one flavor is never used for another one. This is a function static
+// since models register themselves from their static initializers.
+static std::map<std::string, vp_constructor_t> &vp_static_constructors()
+{
+    static std::map<std::string, vp_constructor_t> constructors;
+    return constructors;
+}
+
+
+// Constructors of the modules already loaded, indexed by module path, so that each module is
+// opened only once
+static std::map<std::string, vp_constructor_t> vp_loaded_constructors;
+
+
+int vp::component::register_constructor(std::string module_name, vp_constructor_t constructor)
+{
+    vp_static_constructors()[module_name] = constructor;
+    return 0;
+}
+
+
+static vp_constructor_t vp_get_constructor(std::string module_name, std::string flavor, std::string *error)
+{
+    auto static_it = vp_static_constructors().find(flavor + module_name);
+    if (static_it != vp_static_constructors().end())
     {
-        module_name = config->get_child_str("vp_component");
+        vp_startup_stats.nb_modules_static++;
+        return static_it->second;
+    }
 
-        if (module_name == "")
-        {
-            module_name = "utils.composite_impl";
-        }
+    std::string module_path = flavor + module_name;
+    std::replace(module_path.begin(), module_path.end(), '.', '/');
+
+    auto loaded_it = vp_loaded_constructors.find(module_path);
+    if (loaded_it != vp_loaded_constructors.end())
+    {
+        vp_startup_stats.nb_modules_reused++;
+        return loaded_it->second;
     }
 
-    if (this->get_vp_config()->get_child_bool("sv-mode"))
+    int64_t start_time = vp_startup_get_time();
+
+    std::string path = std::string(getenv("GVSOC_PATH")) + "/" + module_path + ".so";
+
+    void *module = dlopen(path.c_str(), RTLD_NOW | RTLD_GLOBAL | RTLD_DEEPBIND);
+    if (module == NULL)
     {
-        module_name = "sv." + module_name;
+        *error = "ERROR, Failed to open periph model (module: " + module_path + ", error: " + std::string(dlerror()) + ")";
+        return NULL;
     }
-    else if (this->get_vp_config()->get_child_bool("debug-mode"))
+
+    vp_constructor_t constructor = (vp_constructor_t) dlsym(module, "vp_constructor");
+    if (constructor == NULL)
     {
-        module_name = "debug." + module_name;
+        *error = "ERROR, couldn't find vp_constructor in loaded module (module: " + module_path + ")";
+        return NULL;
     }
 
-    this->get_trace()->msg(vp::trace::LEVEL_DEBUG, "New component (name: %s, module: %s)\n", name.c_str(), module_name.c_str());
+    vp_loaded_constructors[module_path] = constructor;
 
-    std::replace(module_name.begin(), module_name.end(), '.', '/');
+    vp_startup_stats.module_load_time += vp_startup_get_time() - start_time;
+    vp_startup_stats.nb_modules_loaded++;
 
-    std::string path = std::string(getenv("GVSOC_PATH")) + "/" + module_name + ".so";
+    return constructor;
+}
 
-    void *module = dlopen(path.c_str(), RTLD_NOW | RTLD_GLOBAL | RTLD_DEEPBIND);
-    if (module == NULL)
+
+static std::string vp_get_module_flavor(js::config *gv_config)
+{
+    if (gv_config->get_child_bool("sv-mode"))
+    {
+        return "sv.";
+    }
+    else if (gv_config->get_child_bool("debug-mode"))
+    {
+        return "debug.";
+    }
+    return "";
+}
+
+
+static void vp_startup_stats_dump()
+{
+    fprintf(stdout, "Startup time (total: %.3f ms)\n",
+        (vp_startup_stats.create_time + vp_startup_stats.build_time + vp_startup_stats.bind_time +
+        vp_startup_stats.start_time) / 1e6);
+    fprintf(stdout, "  Configuration load: %.3f ms (%s)\n", vp_startup_stats.config_load_time / 1e6,
+        vp_startup_stats.config_cache_hit ? "binary cache" : "JSON");
+    fprintf(stdout, "  Module load: %.3f ms (loaded: %d, reused: %d, static: %d)\n", vp_startup_stats.module_load_time / 1e6,
+        vp_startup_stats.nb_modules_loaded, vp_startup_stats.nb_modules_reused, vp_startup_stats.nb_modules_static);
+    fprintf(stdout, "  Component constructors: %.3f ms (components: %d)\n", vp_startup_stats.constructor_time / 1e6,
+        vp_startup_stats.nb_components);
+    fprintf(stdout, "  Create: %.3f ms\n", vp_startup_stats.create_time / 1e6);
+    fprintf(stdout, "  Build: %.3f ms\n", vp_startup_stats.build_time / 1e6);
+    fprintf(stdout, "  Bind: %.3f ms\n", vp_startup_stats.bind_time / 1e6);
+    fprintf(stdout, "  Start: %.3f ms\n", vp_startup_stats.start_time / 1e6);
+}
+
+
+vp::component *vp::component::new_component(std::string name, js::config *config, std::string module_name)
+{
+    if (module_name == "")
     {
-        this->throw_error("ERROR, Failed to open periph model (module: " + module_name + ", error: " + std::string(dlerror()) + ")");
+        module_name = config->get_child_str("vp_component");
+
+        if (module_name == "")
+        {
+            module_name = "utils.composite_impl";
+        }
     }
 
-    vp::component *(*constructor)(js::config *) = (vp::component * (*)(js::config *)) dlsym(module, "vp_constructor");
+    std::string flavor = vp_get_module_flavor(this->get_vp_config());
+
+    this->get_trace()->msg(vp::trace::LEVEL_DEBUG, "New component (name: %s, module: %s)\n", name.c_str(), (flavor + module_name).c_str());
+
+    std::string error;
+    vp_constructor_t constructor = vp_get_constructor(module_name, flavor, &error);
     if (constructor == NULL)
     {
-        this->throw_error("ERROR, couldn't find vp_constructor in loaded module (module: " + module_name + ")");
+        this->throw_error(error);
     }
 
+    int64_t start_time = vp_startup_get_time();
     vp::component *instance = constructor(config);
+    vp_startup_stats.constructor_time += vp_startup_get_time() - start_time;
+    vp_startup_stats.nb_components++;
 
     instance->build_instance(name, this);
 
@@ -1610,45 +2030,58 @@ void vp::component::dump_traces_recursive(FILE *file)
 }
 
 
-vp::component *vp::__gv_create(std::string config_path, struct gv_conf *gv_conf)
+void vp::component::get_perf_counters_recursive(std::vector<std::pair<std::string, int64_t>> &counters)
 {
-    setenv("PULP_CONFIG_FILE", config_path.c_str(), 1);
+    std::vector<std::pair<std::string, int64_t>> comp_counters;
 
-    js::config *js_config = js::import_config_from_file(config_path);
-    if (js_config == NULL)
+    this->get_perf_counters(comp_counters);
+
+    for (auto& x: comp_counters)
     {
-        fprintf(stderr, "Invalid configuration.");
-        return NULL;
+        counters.push_back({this->get_path() + "/" + x.first, x.second});
     }
 
-    js::config *gv_config = js_config->get("**/gvsoc");
+    for (auto& x: this->get_childs())
+    {
+        x->get_perf_counters_recursive(counters);
+    }
+}
 
-    std::string module_name = "vp.trace_domain_impl";
 
-    if (gv_config->get_child_bool("sv-mode"))
+vp::component *vp::__gv_create(std::string config_path, struct gv_conf *gv_conf)
+{
+    setenv("PULP_CONFIG_FILE", config_path.c_str(), 1);
+
+    int64_t start_time = vp_startup_get_time();
+
+    // The configuration can go through a binary cache, which avoids parsing the JSON
+    // configuration when the same platform is launched again
+    js::config *js_config;
+    char *config_cache = getenv("GVSOC_CONFIG_CACHE");
+    if (config_cache != NULL)
     {
-        module_name = "sv." + module_name;
+        js_config = js::import_config_from_file_cached(config_path, config_cache, &vp_startup_stats.config_cache_hit);
     }
-    else if (gv_config->get_child_bool("debug-mode"))
+    else
     {
-        module_name = "debug." + module_name;
+        js_config = js::import_config_from_file(config_path);
     }
 
-
-    std::replace(module_name.begin(), module_name.end(), '.', '/');
-
-    std::string path = std::string(getenv("GVSOC_PATH")) + "/" + module_name + ".so";
-
-    void *module = dlopen(path.c_str(), RTLD_NOW | RTLD_GLOBAL | RTLD_DEEPBIND);
-    if (module == NULL)
+    if (js_config == NULL)
     {
-        throw std::invalid_argument("ERROR, Failed to open periph model (module: " + module_name + ", error: " + std::string(dlerror()) + ")");
+        fprintf(stderr, "Invalid configuration.");
+        return NULL;
     }
 
-    vp::component *(*constructor)(js::config *) = (vp::component * (*)(js::config *)) dlsym(module, "vp_constructor");
+    vp_startup_stats.config_load_time = vp_startup_get_time() - start_time;
+
+    js::config *gv_config = js_config->get("**/gvsoc");
+
+    std::string error;
+    vp_constructor_t constructor = vp_get_constructor("vp.trace_domain_impl", vp_get_module_flavor(gv_config), &error);
     if (constructor == NULL)
     {
-        throw std::invalid_argument("ERROR, couldn't find vp_constructor in loaded module (module: " + module_name + ")");
+        throw std::invalid_argument(error);
     }
 
     vp::component *instance = constructor(js_config);
@@ -1661,6 +2094,8 @@ vp::component *vp::__gv_create(std::string config_path, struct gv_conf *gv_conf)
     instance->set_vp_config(gv_config);
     instance->set_gv_conf(gv_conf);
 
+    vp_startup_stats.create_time = vp_startup_get_time() - start_time;
+
     return (vp::component *)top;
 }
 
@@ -1676,15 +2111,50 @@ extern "C" void gv_destroy(void *arg)
 }
 
 
-extern "C" void gv_start(void *arg)
+extern "C" void gv_elaborate(void *arg)
 {
     vp::top *top = (vp::top *)arg;
     vp::component *instance = (vp::component *)top->top_instance;
 
+    if (top->elaborated)
+    {
+        return;
+    }
+
+    int64_t start_time = vp_startup_get_time();
+
     instance->pre_pre_build();
     instance->pre_build();
     instance->build();
-    instance->build_new();
+
+    int64_t build_time = vp_startup_get_time();
+    vp_startup_stats.build_time = build_time - start_time;
+
+    instance->bind_new();
+
+    vp_startup_stats.bind_time = vp_startup_get_time() - build_time;
+
+    top->elaborated = true;
+}
+
+
+extern "C" void gv_start(void *arg)
+{
+    vp::top *top = (vp::top *)arg;
+    vp::component *instance = (vp::component *)top->top_instance;
+
+    gv_elaborate(arg);
+
+    int64_t start_time = vp_startup_get_time();
+
+    instance->start_new();
+
+    vp_startup_stats.start_time = vp_startup_get_time() - start_time;
+
+    if (instance->get_vp_config()->get_child_bool("startup-stats"))
+    {
+        vp_startup_stats_dump();
+    }
 
     if (instance->gv_conf.open_proxy || instance->get_vp_config()->get_child_bool("proxy/enabled"))
     {
@@ -1705,6 +2175,59 @@ extern "C" void gv_start(void *arg)
 }
 
 
+static int gv_checkpoint_sync(void *arg, const char *path, bool restore)
+{
+    vp::top *top = (vp::top *)arg;
+    vp::component *instance = (vp::component *)top->top_instance;
+    vp::time_engine *engine = instance->get_time_engine();
+    vp::checkpoint cp(path, restore);
+    std::vector<std::function<void()>> enqueue_callbacks;
+
+    engine->lock();
+
+    int64_t time = engine->get_time();
+    if (cp.open(&time) == 0)
+    {
+        if (restore)
+        {
+            engine->set_time(time);
+        }
+
+        instance->checkpoint_all(&cp, &enqueue_callbacks);
+
+        if (!cp.has_error())
+        {
+            for (auto callback: enqueue_callbacks)
+            {
+                callback();
+            }
+        }
+    }
+
+    engine->unlock();
+
+    if (cp.has_error())
+    {
+        fprintf(stderr, "%s\n", cp.get_error().c_str());
+        return -1;
+    }
+
+    return 0;
+}
+
+
+extern "C" int gv_checkpoint(void *arg, const char *path)
+{
+    return gv_checkpoint_sync(arg, path, false);
+}
+
+
+extern "C" int gv_restore(void *arg, const char *path)
+{
+    return gv_checkpoint_sync(arg, path, true);
+}
+
+
 extern "C" void gv_reset(void *arg, bool active)
 {
     vp::top *top = (vp::top *)arg;
@@ -95,11 +95,19 @@ void clock_domain::pre_start()
 vp::clock_engine::clock_engine(js::config *config)
   : vp::time_engine_client(config), cycles(0), period(0), freq(0), must_flush_delayed_queue(true)
 {
-  delayed_queue = NULL;
   for (int i=0; i<CLOCK_EVENT_QUEUE_SIZE; i++)
   {
     event_queue[i] = NULL;
   }
+  for (int i=0; i<=CLOCK_WHEEL_NB_LEVELS; i++)
+  {
+    for (int j=0; j<CLOCK_WHEEL_LEVEL_SIZE; j++)
+    {
+      wheel_first[i][j] = NULL;
+      wheel_last[i][j] = NULL;
+    }
+    wheel_mask[i] = 0;
+  }
   current_cycle = 0;
 }
 
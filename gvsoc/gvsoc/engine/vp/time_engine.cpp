@@ -173,7 +173,7 @@ static void *engine_routine(void *arg)
 }
 
 vp::time_engine::time_engine(js::config *config)
-    : vp::component(config), first_client(NULL)
+    : vp::component(config)
 {
     pthread_mutex_init(&mutex, NULL);
     pthread_cond_init(&cond, NULL);
@@ -297,6 +297,10 @@ void vp::time_engine::start()
 
     this->stop_event = new Time_engine_stop_event(this);
 
+    // Bindings are checked after the start, so the parallel mode must be known now
+    this->parallel_enabled = this->get_js_config()->get_child_bool("**/gvsoc/parallel/enabled");
+    this->parallel_nb_threads = this->get_js_config()->get_child_int("**/gvsoc/parallel/nb_threads");
+
     if (sa_mode)
     {
     #ifdef __VP_USE_SYSTEMV
@@ -311,7 +315,7 @@ void vp::time_engine::start()
 
 void vp::time_engine::wait_ready()
 {
-    while (!first_client)
+    while (!this->get_first_client())
     {
     }
 }
@@ -395,12 +399,26 @@ void vp::time_engine::run_loop()
 
         pthread_mutex_unlock(&mutex);
 
-        time_engine_client *current = first_client;
+#if !defined(__VP_USE_SYSTEMC) && !defined(__VP_USE_SYSTEMV)
+        // Bindings are all known now, see if clock domains can be simulated by several threads
+        if (unlikely(!this->parallel_checked))
+        {
+            this->parallel_checked = true;
+            this->parallel = this->parallel_enabled && this->parallel_start();
+        }
+
+        // Clients are then all in the partitions, nothing is left in the engine
+        if (unlikely(this->parallel))
+        {
+            this->run_parallel();
+        }
+#endif
+
+        time_engine_client *current = this->get_first_client();
 
         if (current)
         {
-            first_client = current->next;
-            current->is_enqueued = false;
+            this->pop_client();
 
 #if defined(__VP_USE_SYSTEMC) || defined(__VP_USE_SYSTEMV)
             while(1)
@@ -444,22 +462,7 @@ void vp::time_engine::run_loop()
                 // And reenqueue it in case it has events in the future
                 if (time > 0)
                 {
-                    time += this->time;
-                    current->next_event_time = time;
-                    time_engine_client *client = first_client, *prev = NULL;
-
-                    while (client && client->next_event_time < time)
-                    {
-                        prev = client;
-                        client = client->next;
-                    }
-                    if (prev)
-                        prev->next = current;
-                    else
-                        first_client = current;
-
-                    current->next = client;
-                    current->is_enqueued = true;
+                    this->push_client(current, time + this->time);
                 }
 
                 if (!run_req)
@@ -470,6 +473,7 @@ void vp::time_engine::run_loop()
                 // enqueues a new event.
                 while (1)
                 {
+                    time_engine_client *first_client = this->get_first_client();
                     if (!first_client)
                     {
                         if (stop_req || locked)
@@ -515,20 +519,19 @@ void vp::time_engine::run_loop()
                     }
                 }
 
-                current = first_client;
+                current = this->get_first_client();
                 if (current)
                 {
-                    vp_assert(first_client->next_event_time >= get_time(), NULL, "event time is before vp time\n");
+                    vp_assert(current->next_event_time >= get_time(), NULL, "event time is before vp time\n");
 
-                    first_client = current->next;
-                    current->is_enqueued = false;
+                    this->pop_client();
                 }
 
 #else
 
                 int64_t time = current->exec();
 
-                time_engine_client *next = first_client;
+                time_engine_client *next = this->get_first_client();
 
                 // Shortcut to quickly continue with the same client
                 if (likely(time > 0))
@@ -543,48 +546,41 @@ void vp::time_engine::run_loop()
                         }
                         else
                         {
-                            current->next = first_client;
-                            first_client = current;
-                            current->next_event_time = time;
-                            current->is_enqueued = true;
+                            this->push_client(current, time);
                             current->running = false;
                             break;
                         }
                     }
                 }
 
-                // Otherwise remove it, reenqueue it and continue with the next one.
-                // We can optimize a bit the operation as we already know
-                // who to schedule next.
+                current->running = false;
 
-                if (time > 0)
+                // Otherwise reenqueue it and continue with the next one, which is before it.
+                // This is the most common case with several clock domains, so it is done with
+                // a single heap update.
+                if (likely(time > 0 && run_req))
+                {
+                    current = this->replace_first_client(current, time);
+                }
+                else
                 {
-                    current->next_event_time = time;
-                    time_engine_client *client = next->next, *prev = next;
-                    while (client && client->next_event_time < time)
+                    if (time > 0)
                     {
-                        prev = client;
-                        client = client->next;
+                        this->push_client(current, time);
                     }
-                    current->next = client;
-                    prev->next = current;
-                    current->is_enqueued = true;
-                }
 
-                current->running = false;
-
-                if (!run_req)
-                    break;
+                    if (!run_req)
+                        break;
 
-                current = first_client;
-                if (current)
-                {
-                    vp_assert(first_client->next_event_time >= get_time(), NULL, "event time is before vp time\n");
-
-                    first_client = current->next;
-                    current->is_enqueued = false;
+                    current = this->get_first_client();
+                    if (current)
+                    {
+                        this->pop_client();
+                    }
                 }
 
+                vp_assert(!current || current->next_event_time >= get_time(), NULL, "event time is before vp time\n");
+
 #endif
 
                 if (!current)
@@ -599,7 +595,7 @@ void vp::time_engine::run_loop()
 
         running = false;
 
-        while (!first_client && retain_count && !locked)
+        while (!this->has_clients() && retain_count && !locked)
         {
 #if defined(__VP_USE_SYSTEMV)
             pthread_mutex_unlock(&mutex);
@@ -614,9 +610,7 @@ void vp::time_engine::run_loop()
 #endif
         }
 
-        current = first_client;
-
-        if (first_client == NULL && !locked && !retain_count)
+        if (!this->has_clients() && !locked && !retain_count)
         {
 #ifdef __VP_USE_SYSTEMC
             sc_stop();
@@ -102,12 +102,15 @@ vp::trace_engine::trace_engine(js::config *config)
     pthread_mutex_init(&mutex, NULL);
     pthread_cond_init(&cond, NULL);
 
-    for (int i = 0; i < TRACE_EVENT_NB_BUFFER; i++)
+    this->engine_waiting = false;
+    this->vcd_waiting = false;
+    this->end = false;
+
+    for (int i = 0; i < TRACE_EVENT_NB_BUFFER - 1; i++)
     {
-        event_buffers.push_back(new char[TRACE_EVENT_BUFFER_SIZE]);
+        free_event_buffers.push(new char[TRACE_EVENT_BUFFER_SIZE]);
     }
-    current_buffer = event_buffers[0];
-    event_buffers.erase(event_buffers.begin());
+    current_buffer = new char[TRACE_EVENT_BUFFER_SIZE];
     current_buffer_size = 0;
     this->first_pending_event = NULL;
 
@@ -186,6 +189,8 @@ void trace_domain::check_trace_active(vp::trace *trace, int event)
                     event_trace = event_dumper.get_trace_real(full_path, file_path);
                 else if (trace->is_string)
                     event_trace = event_dumper.get_trace_string(full_path, file_path);
+                else if (trace->is_binary)
+                    event_trace = event_dumper.get_trace_binary(full_path, file_path, trace->width);
                 else
                     event_trace = event_dumper.get_trace(full_path, file_path, trace->width);
                 trace->set_event_active(true);
@@ -315,6 +320,8 @@ int trace_domain::build()
 {
     this->time_engine = this->new_component("", this->get_js_config(), "vp.time_domain_impl");
 
+    traces.new_trace("io_req", &this->io_req_trace, vp::INFO);
+
     js::config *config = get_js_config()->get("gvsoc");
 
     string format = this->get_vp_config()->get_child_str("traces/format");
@@ -490,6 +497,8 @@ void trace_domain::conf_trace(int event, std::string path_str, bool enabled)
                     event_trace = event_dumper.get_trace_real(trace->get_full_path(), file_path);
                 else if (trace->is_string)
                     event_trace = event_dumper.get_trace_string(trace->get_full_path(), file_path);
+                else if (trace->is_binary)
+                    event_trace = event_dumper.get_trace_binary(trace->get_full_path(), file_path, trace->width);
                 else
                     event_trace = event_dumper.get_trace(trace->get_full_path(), file_path, trace->width);
                 trace->event_trace = event_trace;
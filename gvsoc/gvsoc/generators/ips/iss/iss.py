@@ -52,6 +52,24 @@ class Iss(st.Component):
         starts it (default: False).
     boot_addr : int, optional
         Address of the first instruction (default: 0)
+    dmi : bool, optional
+        True if the ISS should directly access memories which allow it, instead of going
+        through the interconnect for each access (default: True).
+    block_exec : bool, optional
+        True if the ISS can execute straight-line sequences of instructions in a row and
+        account their timing once at the end. This is faster but interrupts and accesses
+        to the platform can be seen a few cycles earlier or later (default: False).
+    functional : dict, optional
+        Functional mode configuration. When 'enabled' is True, the ISS executes instructions in
+        big batches, one cycle each, without any timing model, until the core reaches 'switch_pc'
+        or the time 'switch_time' (in ps), where it switches to the timed execution. -1 means
+        no switch for both. This is still an interpreter of the decoded instructions, not a
+        translation to host code (default: None).
+    sampling : dict, optional
+        Sampling mode configuration. When 'enabled' is True, the ISS alternates 'warmup_insns'
+        instructions executed in detailed mode, a measured window of 'window_insns' instructions
+        and 'fast_forward_insns' instructions executed functionally and timed with the CPI
+        measured so far. The CPI estimation is reported on the 'sampling' trace (default: None).
     
     """
 
@@ -71,7 +89,11 @@ class Iss(st.Component):
             cluster_id: int=0,
             core_id: int=0,
             fetch_enable: bool=False,
-            boot_addr: int=0):
+            boot_addr: int=0,
+            dmi: bool=True,
+            block_exec: bool=False,
+            functional: dict=None,
+            sampling: dict=None):
 
         super(Iss, self).__init__(parent, name)
 
@@ -92,8 +114,29 @@ class Iss(st.Component):
             'core_id': core_id,
             'fetch_enable': fetch_enable,
             'boot_addr': boot_addr,
+            'dmi': dmi,
+            'block_exec': block_exec,
         })
 
+        if functional is not None:
+            self.add_properties({
+                'functional': {
+                    'enabled': functional.get('enabled', True),
+                    'switch_pc': functional.get('switch_pc', -1),
+                    'switch_time': functional.get('switch_time', -1),
+                }
+            })
+
+        if sampling is not None:
+            self.add_properties({
+                'sampling': {
+                    'enabled': sampling.get('enabled', True),
+                    'warmup_insns': sampling.get('warmup_insns', 2000),
+                    'window_insns': sampling.get('window_insns', 1000),
+                    'fast_forward_insns': sampling.get('fast_forward_insns', 1000000),
+                }
+            })
+
 
     def gen_gtkw(self, tree, comp_traces):
 
@@ -26,6 +26,9 @@ class Gvsoc(st.Component):
         self.add_property("proxy/enabled", False)
         self.add_property("proxy/port", 42951)
 
+        self.add_property("parallel/enabled", False)
+        self.add_property("parallel/nb_threads", 0)
+
         self.add_property("events/enabled", False)
         self.add_property("events/include_raw", [])
         self.add_property("events/include_regex", [])
@@ -50,6 +53,7 @@ class Gvsoc(st.Component):
             "verbose": True,
             "debug-mode": False,
             "sa-mode": True,
+            "startup-stats": False,
         
             "launchers": {
                 "default": "gvsoc_launcher",
@@ -30,6 +30,7 @@ static inline int iss_exec_account_cycles(iss_t *iss, int cycles);
 
 iss_insn_t *iss_exec_insn_with_trace(iss_t *iss, iss_insn_t *insn);
 void iss_trace_dump(iss_t *iss, iss_insn_t *insn);
+void iss_trace_dump_binary(iss_t *iss, iss_insn_t *insn);
 void iss_trace_init(iss_t *iss);
 
 
@@ -41,6 +42,11 @@ static inline void iss_exec_insn_terminate(iss_t *iss)
   {
     iss_trace_dump(iss, iss->cpu.stall_insn);
   }
+
+  if (iss_insn_bin_active(iss))
+  {
+    iss_trace_dump_binary(iss, iss->cpu.stall_insn);
+  }
 }
 
 static inline void iss_exec_insn_stall(iss_t *iss)
@@ -1363,6 +1363,7 @@ static inline unsigned int lib_VEC_PACK_SC_HL_16(iss_cpu_state_t *s, unsigned in
 #include "flexfloat.h"
 #include <stdint.h>
 #include <math.h>
+#include <string.h>
 #include <fenv.h>
 #pragma STDC FENV_ACCESS ON
 
@@ -1565,6 +1566,236 @@ static inline unsigned int lib_flexfloat_nmadd(iss_cpu_state_t *s, unsigned int
   return flexfloat_get_bits(&ff_res);
 }
 
+// Native floating-point fast path
+//
+// Operations on binary32 and binary16 with round-to-nearest-even are computed
+// with host doubles and converted to the target format with a single rounding.
+// Double has enough precision (p >= 2q+2) for this double rounding to give the
+// same result as flexfloat, which works the same way but goes through much
+// more expensive packing and rounding steps, as well as the host floating-point
+// environment for the rounding mode and the flags.
+// Here the flags are instead rebuilt from the operands and the result,
+// following what flexfloat reports, including its overflow conventions, so
+// that both paths are bit-exact.
+// Results falling into the subnormal range of the target format are given back
+// to flexfloat, as its rounding and flags there have their own conventions.
+// Other formats and rounding modes also still go through flexfloat.
+
+#ifdef __FLT16_MAX__
+#define LIB_FF_NATIVE_F16 1
+#else
+#define LIB_FF_NATIVE_F16 0
+#endif
+
+#define LIB_FF_FLAG_NX (1<<0)
+#define LIB_FF_FLAG_OF (1<<2)
+#define LIB_FF_FLAG_DZ (1<<3)
+#define LIB_FF_FLAG_NV (1<<4)
+
+static inline bool lib_ff_native(iss_cpu_state_t *s, uint8_t e, uint8_t m, unsigned int round)
+{
+  // The format check is resolved at compile-time since all callers give constant formats
+  if (!((e == 8 && m == 23) || (LIB_FF_NATIVE_F16 && e == 5 && m == 10)))
+    return false;
+
+  return round == 0 || (round == 7 && s->fcsr.frm == 0);
+}
+
+static inline bool lib_ff_native_is_snan(unsigned int a, uint8_t e, uint8_t m)
+{
+  unsigned int exp = (a >> m) & ((1 << e) - 1);
+  unsigned int frac = a & ((1 << m) - 1);
+  return exp == (1U << e) - 1 && frac != 0 && !(frac >> (m - 1));
+}
+
+static inline double lib_ff_native_unpack(unsigned int a, uint8_t e, uint8_t m)
+{
+#if LIB_FF_NATIVE_F16
+  if (e == 5)
+  {
+    uint16_t bits = a;
+    _Float16 value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+#endif
+  uint32_t bits = a;
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Round the double result to the target format and accumulate the flags.
+// exact tells if the double result is the exact result of the operation.
+// Returns false if the result must be computed by flexfloat instead.
+static inline bool lib_ff_native_pack(iss_cpu_state_t *s, double d, bool exact, unsigned int flags, uint8_t e, uint8_t m, unsigned int *result)
+{
+  unsigned int bits;
+  double r;
+
+  if (isnan(d))
+  {
+    // Canonical NaN
+    set_fflags(s, flags);
+    *result = (((1U << e) - 1) << m) | (1U << (m - 1));
+    return true;
+  }
+
+  if (d != 0 && fabs(d) < (e == 5 ? 0x1p-14 : 0x1p-126))
+    return false;
+
+#if LIB_FF_NATIVE_F16
+  if (e == 5)
+  {
+    _Float16 value = (_Float16)d;
+    uint16_t value_bits;
+    memcpy(&value_bits, &value, sizeof(value_bits));
+    bits = value_bits;
+    r = value;
+  }
+  else
+#endif
+  {
+    float value = (float)d;
+    uint32_t value_bits;
+    memcpy(&value_bits, &value, sizeof(value_bits));
+    bits = value_bits;
+    r = value;
+  }
+
+  if (isinf(r))
+  {
+    // Like flexfloat, any infinite result is reported as an overflow, unless
+    // it comes from a division by zero
+    if (!(flags & LIB_FF_FLAG_DZ))
+      flags |= LIB_FF_FLAG_OF | LIB_FF_FLAG_NX;
+  }
+  else if (!exact || r != d)
+  {
+    flags |= LIB_FF_FLAG_NX;
+  }
+
+  set_fflags(s, flags);
+
+  *result = DoExtend(bits, e, m);
+  return true;
+}
+
+// Invalid flag for operations which have no specific invalid case, the result
+// is a NaN only if an input is a NaN or if the operation is invalid.
+static inline unsigned int lib_ff_native_nv(double d, unsigned int a, double da, unsigned int b, double db, uint8_t e, uint8_t m)
+{
+  if (lib_ff_native_is_snan(a, e, m) || lib_ff_native_is_snan(b, e, m) || (isnan(d) && !isnan(da) && !isnan(db)))
+    return LIB_FF_FLAG_NV;
+  return 0;
+}
+
+// Exact error of a double addition (2Sum)
+static inline double lib_ff_native_add_err(double a, double b, double sum)
+{
+  double b_virtual = sum - a;
+  double a_virtual = sum - b_virtual;
+  return (a - a_virtual) + (b - b_virtual);
+}
+
+static inline bool lib_ff_native_add(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t e, uint8_t m, unsigned int *result)
+{
+  double da = lib_ff_native_unpack(a, e, m), db = lib_ff_native_unpack(b, e, m);
+  double d = da + db;
+  bool exact = !isfinite(d) || lib_ff_native_add_err(da, db, d) == 0;
+  return lib_ff_native_pack(s, d, exact, lib_ff_native_nv(d, a, da, b, db, e, m), e, m, result);
+}
+
+static inline bool lib_ff_native_sub(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t e, uint8_t m, unsigned int *result)
+{
+  double da = lib_ff_native_unpack(a, e, m), db = lib_ff_native_unpack(b, e, m);
+  double d = da - db;
+  bool exact = !isfinite(d) || lib_ff_native_add_err(da, -db, d) == 0;
+  return lib_ff_native_pack(s, d, exact, lib_ff_native_nv(d, a, da, b, db, e, m), e, m, result);
+}
+
+static inline bool lib_ff_native_mul(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t e, uint8_t m, unsigned int *result)
+{
+  double da = lib_ff_native_unpack(a, e, m), db = lib_ff_native_unpack(b, e, m);
+  // The product of 2 binary32 numbers is always exact in double
+  double d = da * db;
+  return lib_ff_native_pack(s, d, true, lib_ff_native_nv(d, a, da, b, db, e, m), e, m, result);
+}
+
+static inline bool lib_ff_native_div(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t e, uint8_t m, unsigned int *result)
+{
+  double da = lib_ff_native_unpack(a, e, m), db = lib_ff_native_unpack(b, e, m);
+  double d = da / db;
+  unsigned int flags = lib_ff_native_nv(d, a, da, b, db, e, m);
+  if (db == 0 && isfinite(da) && da != 0)
+    flags |= LIB_FF_FLAG_DZ;
+  bool exact = !isfinite(d) || isinf(db) || fma(d, db, -da) == 0;
+  return lib_ff_native_pack(s, d, exact, flags, e, m, result);
+}
+
+static inline bool lib_ff_native_sqrt(iss_cpu_state_t *s, unsigned int a, uint8_t e, uint8_t m, unsigned int *result)
+{
+  double da = lib_ff_native_unpack(a, e, m);
+  double d = sqrt(da);
+  bool exact = !isfinite(d) || fma(d, d, -da) == 0;
+  return lib_ff_native_pack(s, d, exact, lib_ff_native_nv(d, a, da, a, da, e, m), e, m, result);
+}
+
+// Fused multiply-add, computing (neg_mul ? -a*b : a*b) + (neg_add ? -c : c).
+// The product is exact in double, so the double result only has the rounding
+// of the addition.
+// This follows the way flexfloat computes it, which first rounds in double
+// away from zero when the operation is not an effective subtraction, or towards
+// zero for nmadd, in order to get a correct rounding after the second rounding.
+static inline bool lib_ff_native_fma(iss_cpu_state_t *s, unsigned int a, unsigned int b, unsigned int c, bool is_nmadd, bool neg_a, bool neg_c, uint8_t e, uint8_t m, unsigned int *result)
+{
+  double da = lib_ff_native_unpack(a, e, m), db = lib_ff_native_unpack(b, e, m), dc = lib_ff_native_unpack(c, e, m);
+  if (neg_a) da = -da;
+  if (neg_c) dc = -dc;
+
+  double p = da * db;
+  unsigned int flags = 0;
+
+  if (lib_ff_native_is_snan(a, e, m) || lib_ff_native_is_snan(b, e, m) || lib_ff_native_is_snan(c, e, m) ||
+    (((isinf(da) && db == 0) || (da == 0 && isinf(db))) && (is_nmadd || !isnan(dc))))
+  {
+    flags |= LIB_FF_FLAG_NV;
+  }
+
+  bool eff_sub = signbit(da) ^ signbit(db) ^ signbit(dc);
+  // Sign of the fused result, used by flexfloat to decide the rounding direction
+  double sum = p + dc;
+  bool round_up = sum >= 0;
+
+  if (is_nmadd)
+  {
+    p = -p;
+    dc = -dc;
+    sum = p + dc;
+  }
+
+  double d = sum;
+  double err = isfinite(sum) ? lib_ff_native_add_err(p, dc, sum) : 0;
+
+  if (!eff_sub)
+  {
+    if (round_up && err > 0)
+      d = nextafter(sum, INFINITY);
+    else if (!round_up && err < 0)
+      d = nextafter(sum, -INFINITY);
+  }
+  else if (is_nmadd)
+  {
+    if ((sum > 0 && err < 0) || (sum < 0 && err > 0))
+      d = nextafter(sum, 0);
+  }
+
+  if (isnan(d) && !isnan(da) && !isnan(db) && !isnan(dc))
+    flags |= LIB_FF_FLAG_NV;
+
+  return lib_ff_native_pack(s, d, err == 0, flags, e, m, result);
+}
+
 static inline unsigned int setFFRoundingMode(iss_cpu_state_t *s, unsigned int mode)
 {
   int old = fegetround();
@@ -1594,6 +1825,9 @@ static inline void restoreFFRoundingMode(unsigned int mode)
 }
 
 static inline unsigned int lib_flexfloat_madd_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, unsigned int c, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int native_result;
+  if (lib_ff_native(s, e, m, round) && lib_ff_native_fma(s, a, b, c, false, false, false, e, m, &native_result))
+    return native_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_madd(s, a, b, c, e, m);
   restoreFFRoundingMode(old);
@@ -1601,6 +1835,9 @@ static inline unsigned int lib_flexfloat_madd_round(iss_cpu_state_t *s, unsigned
 }
 
 static inline unsigned int lib_flexfloat_msub_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, unsigned int c, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int native_result;
+  if (lib_ff_native(s, e, m, round) && lib_ff_native_fma(s, a, b, c, false, false, true, e, m, &native_result))
+    return native_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_msub(s, a, b, c, e, m);
   restoreFFRoundingMode(old);
@@ -1608,6 +1845,9 @@ static inline unsigned int lib_flexfloat_msub_round(iss_cpu_state_t *s, unsigned
 }
 
 static inline unsigned int lib_flexfloat_nmadd_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, unsigned int c, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int native_result;
+  if (lib_ff_native(s, e, m, round) && lib_ff_native_fma(s, a, b, c, true, false, false, e, m, &native_result))
+    return native_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_nmadd(s, a, b, c, e, m);
   restoreFFRoundingMode(old);
@@ -1615,6 +1855,9 @@ static inline unsigned int lib_flexfloat_nmadd_round(iss_cpu_state_t *s, unsigne
 }
 
 static inline unsigned int lib_flexfloat_nmsub_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, unsigned int c, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int native_result;
+  if (lib_ff_native(s, e, m, round) && lib_ff_native_fma(s, a, b, c, false, true, false, e, m, &native_result))
+    return native_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_nmsub(s, a, b, c, e, m);
   restoreFFRoundingMode(old);
@@ -1622,6 +1865,9 @@ static inline unsigned int lib_flexfloat_nmsub_round(iss_cpu_state_t *s, unsigne
 }
 
 static inline unsigned int lib_flexfloat_add_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int native_result;
+  if (lib_ff_native(s, e, m, round) && lib_ff_native_add(s, a, b, e, m, &native_result))
+    return native_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_add(s, a, b, e, m);
   restoreFFRoundingMode(old);
@@ -1629,6 +1875,9 @@ static inline unsigned int lib_flexfloat_add_round(iss_cpu_state_t *s, unsigned
 }
 
 static inline unsigned int lib_flexfloat_sub_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int native_result;
+  if (lib_ff_native(s, e, m, round) && lib_ff_native_sub(s, a, b, e, m, &native_result))
+    return native_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_sub(s, a, b, e, m);
   restoreFFRoundingMode(old);
@@ -1636,6 +1885,9 @@ static inline unsigned int lib_flexfloat_sub_round(iss_cpu_state_t *s, unsigned
 }
 
 static inline unsigned int lib_flexfloat_mul_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int native_result;
+  if (lib_ff_native(s, e, m, round) && lib_ff_native_mul(s, a, b, e, m, &native_result))
+    return native_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_mul(s, a, b, e, m);
   restoreFFRoundingMode(old);
@@ -1643,6 +1895,9 @@ static inline unsigned int lib_flexfloat_mul_round(iss_cpu_state_t *s, unsigned
 }
 
 static inline unsigned int lib_flexfloat_div_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int native_result;
+  if (lib_ff_native(s, e, m, round) && lib_ff_native_div(s, a, b, e, m, &native_result))
+    return native_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_div(s, a, b, e, m);
   restoreFFRoundingMode(old);
@@ -1656,16 +1911,24 @@ static inline unsigned int lib_flexfloat_avg_round(iss_cpu_state_t *s, unsigned
   return result;
 }
 
-static inline unsigned int lib_flexfloat_sqrt_round(iss_cpu_state_t *s, unsigned int a, uint8_t e, uint8_t m, unsigned int round) {
-  int old = setFFRoundingMode(s, round);
+static inline unsigned int lib_flexfloat_sqrt(iss_cpu_state_t *s, unsigned int a, uint8_t e, uint8_t m) {
   FF_INIT_1(a, e, m)
   feclearexcept(FE_ALL_EXCEPT);
   ff_init_double(&ff_res, sqrt(ff_get_double(&ff_a)), env);
   update_fflags_fenv(s);
-  restoreFFRoundingMode(old);
   return flexfloat_get_bits(&ff_res);
 }
 
+static inline unsigned int lib_flexfloat_sqrt_round(iss_cpu_state_t *s, unsigned int a, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int native_result;
+  if (lib_ff_native(s, e, m, round) && lib_ff_native_sqrt(s, a, e, m, &native_result))
+    return native_result;
+  int old = setFFRoundingMode(s, round);
+  unsigned int result = lib_flexfloat_sqrt(s, a, e, m);
+  restoreFFRoundingMode(old);
+  return result;
+}
+
 static inline unsigned int lib_flexfloat_sgnj(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t e, uint8_t m) {
 #ifdef OLD
   FF_INIT_2(a, b, e, m)
@@ -163,6 +163,21 @@ typedef struct iss_insn_arg_s {
   } u;
 } iss_insn_arg_t;
 
+#define ISS_INSN_RECORD_FLAG_VALUE 1
+#define ISS_INSN_RECORD_FLAG_ADDR  2
+
+// Record dumped for each executed instruction to the binary instruction trace.
+// The layout must be kept in sync with the gvsoc-insn-trace decoder.
+typedef struct iss_insn_record_s {
+  uint64_t pc;
+  uint64_t value;        // Value written to the output register
+  uint64_t addr;         // Memory address accessed by the instruction
+  uint32_t opcode;
+  uint16_t core_id;
+  uint8_t out_reg;       // Output register index, 0xff if none
+  uint8_t flags;         // Tells which of value and addr are valid
+} iss_insn_record_t;
+
 typedef struct iss_decoder_range_s {
   int bit;
   int width;
@@ -320,45 +335,49 @@ typedef struct {
   iss_addr_t addr;
 } iss_prefetcher_t;
 
-typedef struct iss_insn_s {
-  iss_addr_t addr;
-  iss_reg_t opcode;
-  bool fetched;
-  iss_insn_t *(*fast_handler)(iss_t *, iss_insn_t*);
-  iss_insn_t *(*handler)(iss_t *, iss_insn_t*);
-  iss_insn_t *(*resource_handler)(iss_t *, iss_insn_t*);        // Handler called when an instruction with an associated resource is executed. The handler will take care of simulating the timing of the resource.
-  iss_insn_t *(*hwloop_handler)(iss_t *, iss_insn_t*);
-  iss_insn_t *(*stall_handler)(iss_t *, iss_insn_t*);
-  iss_insn_t *(*stall_fast_handler)(iss_t *, iss_insn_t*);
-  int size;
+// Decoded instruction fields which are only needed at decode time, when tracing
+// or for resource offloading. They are kept out of iss_insn_t so that the
+// fields touched on every executed instruction stay packed together.
+typedef struct iss_insn_cold_s {
+  iss_decoder_item_t *decoder_item;
+  iss_insn_arg_t args[ISS_MAX_DECODE_ARGS];
   int nb_out_reg;
   int nb_in_reg;
-  int out_regs[ISS_MAX_NB_OUT_REGS];
-  int in_regs[ISS_MAX_NB_IN_REGS];
-  iss_uim_t uim[ISS_MAX_IMMEDIATES];
-  iss_sim_t sim[ISS_MAX_IMMEDIATES];
-  iss_insn_arg_t args[ISS_MAX_DECODE_ARGS];
-  iss_insn_t *next;
-  iss_decoder_item_t *decoder_item;
   int resource_id;   // Identifier of the resource associated to this instruction
   int resource_latency;          // Time required to get the result when accessing the resource
   int resource_bandwidth;        // Time required to accept the next access when accessing the resource
-
   int input_latency;
   int input_latency_reg;
-
+  iss_insn_t *(*resource_handler)(iss_t *, iss_insn_t*);        // Handler called when an instruction with an associated resource is executed. The handler will take care of simulating the timing of the resource.
   iss_insn_t *(*saved_handler)(iss_t *, iss_insn_t*);
-  iss_insn_t *branch;
-
-  int in_spregs[6];
+} iss_insn_cold_t;
 
+// Fields are ordered by how often they are accessed when executing, so that
+// the ones used by the fast path share the first cache line.
+typedef struct iss_insn_s {
+  iss_insn_t *(*fast_handler)(iss_t *, iss_insn_t*);
+  iss_insn_t *(*handler)(iss_t *, iss_insn_t*);
+  iss_insn_t *next;
+  iss_addr_t addr;
+  iss_reg_t opcode;
+  int8_t out_regs[ISS_MAX_NB_OUT_REGS];
+  int8_t in_regs[ISS_MAX_NB_IN_REGS];
+  uint8_t size;
+  bool fetched;
   int latency;
-
+  iss_uim_t uim[ISS_MAX_IMMEDIATES];
+  iss_sim_t sim[ISS_MAX_IMMEDIATES];
+  iss_insn_t *branch;
+  iss_insn_t *(*hwloop_handler)(iss_t *, iss_insn_t*);
+  iss_insn_t *(*stall_handler)(iss_t *, iss_insn_t*);
+  iss_insn_t *(*stall_fast_handler)(iss_t *, iss_insn_t*);
+  iss_insn_cold_t *cold;
 } iss_insn_t;
 
 typedef struct iss_insn_block_s {
   iss_addr_t pc;
   iss_insn_t insns[ISS_INSN_BLOCK_SIZE];
+  iss_insn_cold_t cold[ISS_INSN_BLOCK_SIZE];
   iss_insn_block_t *next;
   bool is_init;
 } iss_insn_block_t;
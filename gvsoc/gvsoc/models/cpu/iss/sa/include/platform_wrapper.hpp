@@ -115,6 +115,24 @@ static inline int iss_insn_event_active(iss_t *iss)
   return 0;
 }
 
+static inline int iss_insn_bin_active(iss_t *iss)
+{
+  return 0;
+}
+
+static inline bool iss_watchpoints_armed(iss_t *iss)
+{
+  return false;
+}
+
+static inline void iss_watchpoint_check_stop(iss_t *iss)
+{
+}
+
+static inline void iss_insn_bin_dump(iss_t *iss, iss_insn_record_t *record)
+{
+}
+
 static inline void iss_handle_ebreak(iss_t *iss, iss_insn_t *insn)
 {
 }
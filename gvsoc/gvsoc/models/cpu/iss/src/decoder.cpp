@@ -69,9 +69,9 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
   insn->latency = 0;
   insn->fast_handler = item->u.insn.fast_handler;
   insn->handler = item->u.insn.handler;
-  insn->resource_id = item->u.insn.resource_id;
-  insn->resource_latency = item->u.insn.resource_latency;
-  insn->resource_bandwidth = item->u.insn.resource_bandwidth;
+  insn->cold->resource_id = item->u.insn.resource_id;
+  insn->cold->resource_latency = item->u.insn.resource_latency;
+  insn->cold->resource_bandwidth = item->u.insn.resource_bandwidth;
 
   if (insn->hwloop_handler != NULL)
   {
@@ -83,27 +83,31 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
 
   if (item->u.insn.resource_id != -1)
   {
-    insn->resource_handler = insn->handler;
+    insn->cold->resource_handler = insn->handler;
     insn->fast_handler = iss_resource_offload;
     insn->handler = iss_resource_offload;
   }
 
-  insn->decoder_item = item;
+  insn->cold->decoder_item = item;
   insn->size = item->u.insn.size;
-  insn->nb_out_reg = 0;
-  insn->nb_in_reg = 0;
+  insn->cold->nb_out_reg = 0;
+  insn->cold->nb_in_reg = 0;
   insn->latency = item->u.insn.latency;
 
-  for (int i=0; i<item->u.insn.nb_args; i++)
+  for (int i=0; i<ISS_MAX_NB_OUT_REGS; i++)
   {
     insn->out_regs[i] = -1;
+  }
+
+  for (int i=0; i<ISS_MAX_NB_IN_REGS; i++)
+  {
     insn->in_regs[i] = -1;
   }
 
   for (int i=0; i<item->u.insn.nb_args; i++)
   {
     iss_decoder_arg_t *darg = &item->u.insn.args[i];
-    iss_insn_arg_t *arg = &insn->args[i];
+    iss_insn_arg_t *arg = &insn->cold->args[i];
     arg->type = darg->type;
     arg->flags = darg->flags;
 
@@ -122,14 +126,14 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
 #endif
 
         if (darg->type == ISS_DECODER_ARG_TYPE_IN_REG) {
-          if (darg->u.reg.id >= insn->nb_in_reg)
-            insn->nb_in_reg = darg->u.reg.id + 1;
+          if (darg->u.reg.id >= insn->cold->nb_in_reg)
+            insn->cold->nb_in_reg = darg->u.reg.id + 1;
 
           insn->in_regs[darg->u.reg.id] = arg->u.reg.index;
         }
         else {
-          if (darg->u.reg.id >= insn->nb_out_reg)
-            insn->nb_out_reg = darg->u.reg.id + 1;
+          if (darg->u.reg.id >= insn->cold->nb_out_reg)
+            insn->cold->nb_out_reg = darg->u.reg.id + 1;
 
           insn->out_regs[darg->u.reg.id] = arg->u.reg.index;
         }
@@ -138,8 +142,8 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
         {
           iss_insn_t *next = insn_cache_get(iss, insn->addr + insn->size);
 
-          next->input_latency_reg = arg->u.reg.index;
-          next->input_latency = darg->u.reg.latency;
+          next->cold->input_latency_reg = arg->u.reg.index;
+          next->cold->input_latency = darg->u.reg.latency;
         }
 
 
@@ -159,8 +163,8 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
         arg->u.indirect_imm.reg_index = decode_info(iss, insn, opcode, &darg->u.indirect_imm.reg.info, false);
         if (darg->u.indirect_imm.reg.flags & ISS_DECODER_ARG_FLAG_COMPRESSED) arg->u.indirect_imm.reg_index += 8;
         insn->in_regs[darg->u.indirect_imm.reg.id] = arg->u.indirect_imm.reg_index;
-        if (darg->u.indirect_imm.reg.id >= insn->nb_in_reg)
-          insn->nb_in_reg = darg->u.indirect_imm.reg.id + 1;
+        if (darg->u.indirect_imm.reg.id >= insn->cold->nb_in_reg)
+          insn->cold->nb_in_reg = darg->u.indirect_imm.reg.id + 1;
         arg->u.indirect_imm.imm = decode_info(iss, insn, opcode, &darg->u.indirect_imm.imm.info, darg->u.indirect_imm.imm.is_signed);
         insn->sim[darg->u.indirect_imm.imm.id] = arg->u.indirect_imm.imm;
         break;
@@ -169,20 +173,20 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
         arg->u.indirect_reg.base_reg_index = decode_info(iss, insn, opcode, &darg->u.indirect_reg.base_reg.info, false);
         if (darg->u.indirect_reg.base_reg.flags & ISS_DECODER_ARG_FLAG_COMPRESSED) arg->u.indirect_reg.base_reg_index += 8;
         insn->in_regs[darg->u.indirect_reg.base_reg.id] = arg->u.indirect_reg.base_reg_index;
-        if (darg->u.indirect_reg.base_reg.id >= insn->nb_in_reg)
-          insn->nb_in_reg = darg->u.indirect_reg.base_reg.id + 1;
+        if (darg->u.indirect_reg.base_reg.id >= insn->cold->nb_in_reg)
+          insn->cold->nb_in_reg = darg->u.indirect_reg.base_reg.id + 1;
 
         arg->u.indirect_reg.offset_reg_index = decode_info(iss, insn, opcode, &darg->u.indirect_reg.offset_reg.info, false);
         if (darg->u.indirect_reg.offset_reg.flags & ISS_DECODER_ARG_FLAG_COMPRESSED) arg->u.indirect_reg.offset_reg_index += 8;
         insn->in_regs[darg->u.indirect_reg.offset_reg.id] = arg->u.indirect_reg.offset_reg_index;
-        if (darg->u.indirect_reg.offset_reg.id >= insn->nb_in_reg)
-          insn->nb_in_reg = darg->u.indirect_reg.offset_reg.id + 1;
+        if (darg->u.indirect_reg.offset_reg.id >= insn->cold->nb_in_reg)
+          insn->cold->nb_in_reg = darg->u.indirect_reg.offset_reg.id + 1;
 
         break;
     }
   }
 
-  if (insn->input_latency_reg != -1)
+  if (insn->cold->input_latency_reg != -1)
   {
     // We can stall the next instruction either if latency is superior
     // to 2 (due to number of pipeline stages) or if there is a data
@@ -192,20 +196,20 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
     // in case we find a register dependency so that we can properly
     // handle the stall
     bool set_pipe_latency = true;
-    for (int j=0; j<insn->nb_in_reg; j++)
+    for (int j=0; j<insn->cold->nb_in_reg; j++)
     {
-      if (insn->in_regs[j] == insn->input_latency_reg)
+      if (insn->in_regs[j] == insn->cold->input_latency_reg)
       {
-        insn->latency += insn->input_latency;
+        insn->latency += insn->cold->input_latency;
         set_pipe_latency = false;
         break;
       }
     }
 
     // If no dependency was found, apply the one for the pipeline stages
-    if (set_pipe_latency && insn->input_latency > PIPELINE_STAGES)
+    if (set_pipe_latency && insn->cold->input_latency > PIPELINE_STAGES)
     {
-      insn->latency += insn->input_latency - PIPELINE_STAGES + 1;
+      insn->latency += insn->cold->input_latency - PIPELINE_STAGES + 1;
     }
   }
 
@@ -307,6 +311,22 @@ static iss_insn_t *iss_exec_insn_illegal(iss_t *iss, iss_insn_t *insn)
   return iss_except_raise(iss, ISS_EXCEPT_ILLEGAL);
 }
 
+// Only used while gdb watchpoints are armed. The accesses are checked by the memory
+// access path, this handler stops the core once the instruction which hit a watchpoint is over.
+static iss_insn_t *iss_exec_insn_with_watchpoint(iss_t *iss, iss_insn_t *insn)
+{
+  iss_insn_t *next_insn;
+
+  if (iss_insn_trace_active(iss) || iss_insn_event_active(iss) || iss_insn_bin_active(iss))
+    next_insn = iss_exec_insn_with_trace(iss, insn);
+  else
+    next_insn = iss_exec_insn_handler(iss, insn, insn->cold->saved_handler);
+
+  iss_watchpoint_check_stop(iss);
+
+  return next_insn;
+}
+
 iss_insn_t *iss_decode_pc_noexec(iss_t *iss, iss_insn_t *insn)
 {
   iss_decoder_msg(iss, "Decoding instruction (pc: 0x%lx)\n", insn->addr);
@@ -324,13 +344,22 @@ iss_insn_t *iss_decode_pc_noexec(iss_t *iss, iss_insn_t *insn)
 
   insn->opcode = opcode;
 
-  if (iss_insn_trace_active(iss) || iss_insn_event_active(iss))
+  if (iss_insn_trace_active(iss) || iss_insn_event_active(iss) || iss_insn_bin_active(iss))
   {
-    insn->saved_handler = insn->handler;
+    insn->cold->saved_handler = insn->handler;
     insn->handler = iss_exec_insn_with_trace;
     insn->fast_handler = iss_exec_insn_with_trace;
   }
 
+  if (iss_watchpoints_armed(iss))
+  {
+    // The trace wrapper, if any, is called by the watchpoint one
+    if (insn->handler != iss_exec_insn_with_trace)
+      insn->cold->saved_handler = insn->handler;
+    insn->handler = iss_exec_insn_with_watchpoint;
+    insn->fast_handler = iss_exec_insn_with_watchpoint;
+  }
+
   return insn;
 }
 
@@ -60,7 +60,7 @@ void insn_init(iss_insn_t *insn, iss_addr_t addr) {
   insn->next = NULL;
   insn->hwloop_handler = NULL;
   insn->fetched = false;
-  insn->input_latency_reg = -1;
+  insn->cold->input_latency_reg = -1;
 }
 
 static void insn_block_init(iss_insn_block_t *b, iss_addr_t pc)
@@ -69,6 +69,7 @@ static void insn_block_init(iss_insn_block_t *b, iss_addr_t pc)
   for (int i=0; i<ISS_INSN_BLOCK_SIZE; i++)
   {
     iss_insn_t *insn = &b->insns[i];
+    insn->cold = &b->cold[i];
     insn_init(insn, pc + (i<<ISS_INSN_PC_BITS));
   }
 }
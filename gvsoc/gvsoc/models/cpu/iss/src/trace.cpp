@@ -328,7 +328,7 @@ static void iss_trace_dump_insn(iss_t *iss, iss_insn_t *insn, char *buff, int bu
 
   char *start_buff = buff;
 
-  buff += sprintf(buff,  "%s ", insn->decoder_item->u.insn.label);
+  buff += sprintf(buff,  "%s ", insn->cold->decoder_item->u.insn.label);
 
   if (is_long) {
     len = buff - start_buff;
@@ -343,9 +343,9 @@ static void iss_trace_dump_insn(iss_t *iss, iss_insn_t *insn, char *buff, int bu
 
   iss_decoder_arg_t *prev_arg = NULL;
   start_buff = buff;
-  int nb_args = insn->decoder_item->u.insn.nb_args;
+  int nb_args = insn->cold->decoder_item->u.insn.nb_args;
   for (int i=0; i<nb_args; i++) {
-    buff = iss_trace_dump_arg(iss, insn, buff, &insn->args[i], &insn->decoder_item->u.insn.args[i], &prev_arg, is_long);
+    buff = iss_trace_dump_arg(iss, insn, buff, &insn->cold->args[i], &insn->cold->decoder_item->u.insn.args[i], &prev_arg, is_long);
   }
   if (nb_args != 0) buff += sprintf(buff,  " ");
 
@@ -364,10 +364,10 @@ static void iss_trace_dump_insn(iss_t *iss, iss_insn_t *insn, char *buff, int bu
   {
     prev_arg = NULL;
     for (int i=0; i<nb_args; i++) {
-      buff = iss_trace_dump_arg_value(iss, insn, buff, &insn->args[i], &insn->decoder_item->u.insn.args[i], &saved_args[i], &prev_arg, 1, is_long);
+      buff = iss_trace_dump_arg_value(iss, insn, buff, &insn->cold->args[i], &insn->cold->decoder_item->u.insn.args[i], &saved_args[i], &prev_arg, 1, is_long);
     }
     for (int i=0; i<nb_args; i++) {
-      buff = iss_trace_dump_arg_value(iss, insn, buff, &insn->args[i], &insn->decoder_item->u.insn.args[i], &saved_args[i], &prev_arg, 0, is_long);
+      buff = iss_trace_dump_arg_value(iss, insn, buff, &insn->cold->args[i], &insn->cold->decoder_item->u.insn.args[i], &saved_args[i], &prev_arg, 0, is_long);
     }
 
     buff += sprintf(buff,  "\n");
@@ -414,9 +414,9 @@ static void iss_trace_save_arg(iss_t *iss, iss_insn_t *insn, iss_insn_arg_t *ins
 
 static void iss_trace_save_args(iss_t *iss, iss_insn_t *insn, iss_insn_arg_t saved_args[], bool save_out)
 {
-  for (int i=0; i<insn->decoder_item->u.insn.nb_args; i++) {
-    iss_decoder_arg_t *arg = &insn->decoder_item->u.insn.args[i];
-    iss_trace_save_arg(iss, insn, &insn->args[i], arg, &saved_args[i], save_out);
+  for (int i=0; i<insn->cold->decoder_item->u.insn.nb_args; i++) {
+    iss_decoder_arg_t *arg = &insn->cold->decoder_item->u.insn.args[i];
+    iss_trace_save_arg(iss, insn, &insn->cold->args[i], arg, &saved_args[i], save_out);
   }
 }
 
@@ -431,6 +431,56 @@ void iss_trace_dump(iss_t *iss, iss_insn_t *insn)
   iss_insn_msg(iss, buffer);
 }
 
+// Binary version of the instruction trace, which only dumps a fixed-size
+// record with raw values, the text is produced offline by gvsoc-insn-trace.
+// This must be called after the instruction has been executed, with the input
+// arguments saved before the execution.
+void iss_trace_dump_binary(iss_t *iss, iss_insn_t *insn)
+{
+  iss_insn_record_t record;
+  iss_insn_arg_t *saved_args = iss->cpu.state.saved_args;
+
+  record.pc = insn->addr;
+  record.opcode = insn->opcode;
+  record.core_id = iss->cpu.config.mhartid;
+  record.out_reg = 0xff;
+  record.flags = 0;
+  record.value = 0;
+  record.addr = 0;
+
+  for (int i=0; i<insn->cold->decoder_item->u.insn.nb_args; i++)
+  {
+    iss_decoder_arg_t *arg = &insn->cold->decoder_item->u.insn.args[i];
+    iss_insn_arg_t *insn_arg = &insn->cold->args[i];
+
+    if (arg->type == ISS_DECODER_ARG_TYPE_OUT_REG && !(record.flags & ISS_INSN_RECORD_FLAG_VALUE))
+    {
+      record.out_reg = insn_arg->u.reg.index;
+      record.flags |= ISS_INSN_RECORD_FLAG_VALUE;
+      if (arg->flags & ISS_DECODER_ARG_FLAG_REG64)
+        record.value = iss_get_reg64_untimed(iss, insn_arg->u.reg.index);
+      else
+        record.value = iss_get_reg_untimed(iss, insn_arg->u.reg.index);
+    }
+    else if (arg->type == ISS_DECODER_ARG_TYPE_INDIRECT_IMM)
+    {
+      record.flags |= ISS_INSN_RECORD_FLAG_ADDR;
+      record.addr = saved_args[i].u.indirect_imm.reg_value;
+      if (!(arg->flags & ISS_DECODER_ARG_FLAG_POSTINC))
+        record.addr += insn_arg->u.indirect_imm.imm;
+    }
+    else if (arg->type == ISS_DECODER_ARG_TYPE_INDIRECT_REG)
+    {
+      record.flags |= ISS_INSN_RECORD_FLAG_ADDR;
+      record.addr = saved_args[i].u.indirect_reg.base_reg_value;
+      if (!(arg->flags & ISS_DECODER_ARG_FLAG_POSTINC))
+        record.addr += saved_args[i].u.indirect_reg.offset_reg_value;
+    }
+  }
+
+  iss_insn_bin_dump(iss, &record);
+}
+
 void iss_event_dump(iss_t *iss, iss_insn_t *insn)
 {
   char buffer[1024];
@@ -458,18 +508,24 @@ iss_insn_t *iss_exec_insn_with_trace(iss_t *iss, iss_insn_t *insn)
     iss_event_dump(iss, insn);
   }
 
-  if (iss_insn_trace_active(iss))
+  if (iss_insn_trace_active(iss) || iss_insn_bin_active(iss))
   {
     iss_trace_save_args(iss, insn, iss->cpu.state.saved_args, false);
     
-    next_insn = iss_exec_insn_handler(iss, insn, insn->saved_handler);
+    next_insn = iss_exec_insn_handler(iss, insn, insn->cold->saved_handler);
 
     if (!iss_exec_is_stalled(iss))
-      iss_trace_dump(iss, insn);
+    {
+      if (iss_insn_trace_active(iss))
+        iss_trace_dump(iss, insn);
+
+      if (iss_insn_bin_active(iss))
+        iss_trace_dump_binary(iss, insn);
+    }
   }
   else
   {
-    next_insn = iss_exec_insn_handler(iss, insn, insn->saved_handler);
+    next_insn = iss_exec_insn_handler(iss, insn, insn->cold->saved_handler);
   }
 
 
@@ -41,6 +41,51 @@ typedef struct
 } iss_wrapper_pcer_info_t;
 
 
+#define ISS_DMI_NB_ENTRIES 4
+
+// Maximum number of instructions executed in a row in block execution mode
+#define ISS_BLOCK_MAX_INSNS 64
+
+// Maximum number of instructions executed in a row during a sampling fast-forward phase
+#define ISS_SAMPLING_FF_MAX_INSNS 1024
+
+// Maximum number of instructions executed in a row in functional mode
+#define ISS_FUNCTIONAL_MAX_INSNS 4096
+
+// Phases of the sampling mode. Each sampling period is made of a detailed warm-up
+// phase, a detailed measured window and a functional fast-forward phase.
+typedef enum
+{
+  ISS_SAMPLING_WARMUP,
+  ISS_SAMPLING_MEASURE,
+  ISS_SAMPLING_FAST_FORWARD
+} iss_sampling_phase_e;
+
+// Range of addresses for which a direct memory access was either granted or denied
+typedef struct
+{
+    iss_addr_t base;
+    iss_addr_t end;
+    uint8_t *mem;       // Host pointer corresponding to base, NULL if the direct access was denied
+    int64_t latency;
+} iss_dmi_entry_t;
+
+// Small cache of direct memory accesses for one master port
+typedef struct
+{
+    iss_dmi_entry_t entries[ISS_DMI_NB_ENTRIES];
+    int next;           // Index of the next entry to be replaced
+} iss_dmi_table_t;
+
+// Data watchpoint set by gdb on the range of addresses [base, end]
+typedef struct
+{
+    int type;           // One of vp::Gdbserver_core::watchpoint_type
+    iss_addr_t base;
+    iss_addr_t end;
+} iss_watchpoint_t;
+
+
 class iss_wrapper : public vp::component, vp::Gdbserver_core
 {
 
@@ -52,6 +97,9 @@ public:
   void start();
   void pre_reset();
   void reset(bool active);
+  void checkpoint_state(vp::checkpoint *cp);
+  void stop();
+  void get_perf_counters(std::vector<std::pair<std::string, int64_t>> &counters);
 
   virtual void target_open();
 
@@ -61,7 +109,27 @@ public:
   static void fetch_grant(void *_this, vp::io_req *req);
   static void fetch_response(void *_this, vp::io_req *req);
 
+  static void data_dmi_invalidate(void *_this);
+  static void fetch_dmi_invalidate(void *_this);
+  inline iss_dmi_entry_t *dmi_get(iss_dmi_table_t *table, vp::io_master *port, iss_addr_t addr, int size);
+  iss_dmi_entry_t *dmi_refill(iss_dmi_table_t *table, vp::io_master *port, iss_addr_t addr, int size);
+  void dmi_flush(iss_dmi_table_t *table);
+
   static void exec_instr(void *__this, vp::clock_event *event);
+  static void exec_block(void *__this, vp::clock_event *event);
+  inline bool block_exec_allowed();
+  inline bool insn_traces_active();
+  static void exec_sampled(void *__this, vp::clock_event *event);
+  void exec_fast_forward(vp::clock_event *event);
+  int64_t exec_untimed(vp::clock_event *event, int64_t max_insns);
+  void exec_untimed_end(int64_t cycles);
+  static void exec_functional(void *__this, vp::clock_event *event);
+  inline bool functional_switch_reached();
+  void functional_stop();
+  inline void sampling_account_insn();
+  void sampling_set_phase(iss_sampling_phase_e phase);
+  void sampling_restart();
+  vp::clock_event_meth_t *get_instr_handler();
   static void exec_first_instr(void *__this, vp::clock_event *event);
   void exec_first_instr(vp::clock_event *event);
   static void exec_instr_check_all(void *__this, vp::clock_event *event);
@@ -104,6 +172,11 @@ public:
   int gdbserver_cont();
   int gdbserver_stepi();
   int gdbserver_state();
+  int gdbserver_watchpoint_insert(int type, uint64_t addr, int size);
+  int gdbserver_watchpoint_remove(int type, uint64_t addr, int size);
+  bool gdbserver_watchpoint_hit(int *type, uint64_t *addr);
+  void watchpoints_update();
+  void watchpoint_check(iss_addr_t addr, int size, bool is_write);
 
   void declare_pcer(int index, std::string name, std::string help);
 
@@ -123,6 +196,54 @@ public:
   vp::io_req     io_req;
   vp::io_req     fetch_req;
 
+  bool dmi_enabled;
+  iss_dmi_table_t data_dmi;
+  iss_dmi_table_t fetch_dmi;
+
+  // GDB data watchpoints. They cost nothing while none is armed, since accesses are only
+  // checked on the IO path, which all accesses take while one is armed, and instructions
+  // are only wrapped with the handler stopping the core in this case.
+  std::vector<iss_watchpoint_t> watchpoints;
+  bool watchpoints_armed = false;
+  bool watchpoint_hit = false;      // An access hit a watchpoint, reported to gdb until the core is resumed
+  bool watchpoint_stop = false;     // The core must be stopped before executing the next instruction
+  int watchpoint_hit_type;
+  iss_addr_t watchpoint_hit_addr;
+
+  // True if the core can execute several instructions in the same event
+  bool block_exec;
+  // Set when the current instruction interacted with the platform and thus
+  // the current block must be stopped to not shift further the time seen by the platform
+  bool block_sync;
+
+  // Functional mode, instructions are executed in batches, one cycle each, until the core
+  // reaches switch_pc or switch_time (ps), where it switches to the timed execution
+  bool functional;
+  iss_addr_t functional_switch_pc;
+  int64_t functional_switch_time;
+
+  // Sampling mode, the core alternates detailed windows, during which the CPI is measured,
+  // and functional fast-forward phases, timed with the CPI measured so far
+  bool sampling;
+  int64_t sampling_warmup_insns;
+  int64_t sampling_window_insns;
+  int64_t sampling_ff_insns;
+  iss_sampling_phase_e sampling_phase;
+  // Number of instructions remaining in the current phase
+  int64_t sampling_phase_remaining;
+  // Cycle at which the current measured window started
+  int64_t sampling_window_start;
+  // Running statistics of the CPI measured on each window
+  int64_t sampling_nb_windows;
+  int64_t sampling_nb_dropped_windows;
+  double sampling_cpi_mean;
+  double sampling_cpi_m2;
+  // Fraction of cycle not yet reported at the end of the last fast-forward batch
+  double sampling_ff_cycles_rest;
+  int64_t sampling_total_detailed_insns;
+  int64_t sampling_total_ff_insns;
+  vp::trace sampling_trace;
+
   iss_cpu_t cpu;
 
   vp::trace     trace;
@@ -156,6 +277,7 @@ public:
   vp::trace     binaries_trace_event;
   vp::trace     pcer_trace_event[32];
   vp::trace     insn_trace_event;
+  vp::trace     insn_bin_event;
 
   iss_wrapper_pcer_info_t pcer_info[32];
   int64_t cycle_count_start;
@@ -180,6 +302,7 @@ public:
 private:
 
   vp::clock_event *instr_event;
+  vp::clock_event *timed_instr_event;
   vp::clock_event *check_all_event;
   vp::clock_event *misaligned_event;
   vp::clock_event *irq_sync_event;
@@ -257,9 +380,55 @@ void iss_wrapper::exec_misaligned(void *__this, vp::clock_event *event)
   }
 }
 
+inline iss_dmi_entry_t *iss_wrapper::dmi_get(iss_dmi_table_t *table, vp::io_master *port, iss_addr_t addr, int size)
+{
+  for (int i=0; i<ISS_DMI_NB_ENTRIES; i++)
+  {
+    iss_dmi_entry_t *entry = &table->entries[i];
+    if (addr >= entry->base && addr + size - 1 <= entry->end)
+    {
+      return entry;
+    }
+  }
+
+  // Direct accesses are not checked against watchpoints, all accesses must go through
+  // the IO path while they are armed
+  if (!this->dmi_enabled || this->watchpoints_armed)
+  {
+    return NULL;
+  }
+
+  return this->dmi_refill(table, port, addr, size);
+}
+
 inline int iss_wrapper::data_req_aligned(iss_addr_t addr, uint8_t *data_ptr, int size, bool is_write)
 {
   decode_trace.msg("Data request (addr: 0x%lx, size: 0x%x, is_write: %d)\n", addr, size, is_write);
+
+  // Fast path, if the memory can be directly accessed, do it without going
+  // through the whole interconnect.
+  iss_dmi_entry_t *dmi = this->dmi_get(&this->data_dmi, &this->data, addr, size);
+  if (dmi && dmi->mem)
+  {
+    uint8_t *mem = dmi->mem + (addr - dmi->base);
+    if (is_write)
+      memcpy(mem, data_ptr, size);
+    else
+      memcpy(data_ptr, mem, size);
+
+    this->cpu.state.insn_cycles += dmi->latency;
+    // Misaligned accesses get the latency from the request
+    io_req.set_latency(dmi->latency);
+    return vp::IO_REQ_OK;
+  }
+
+  this->block_sync = true;
+
+  if (unlikely(this->watchpoints_armed))
+  {
+    this->watchpoint_check(addr, size, is_write);
+  }
+
   vp::io_req *req = &io_req;
   req->init();
   req->set_addr(addr);
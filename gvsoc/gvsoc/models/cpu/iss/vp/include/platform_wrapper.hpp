@@ -73,6 +73,31 @@ static inline void iss_insn_event_dump(iss_t *iss, const char *msg)
   iss->insn_trace_event.event_string(msg);
 }
 
+static inline int iss_insn_bin_active(iss_t *iss)
+{
+  return iss->insn_bin_event.get_event_active();
+}
+
+static inline bool iss_watchpoints_armed(iss_t *iss)
+{
+  return iss->watchpoints_armed;
+}
+
+static inline void iss_watchpoint_check_stop(iss_t *iss)
+{
+  // The core is stopped by the check-all handler, before the next instruction
+  if (iss->watchpoint_hit && !iss->watchpoint_stop)
+  {
+    iss->watchpoint_stop = true;
+    iss->trigger_check_all();
+  }
+}
+
+static inline void iss_insn_bin_dump(iss_t *iss, iss_insn_record_t *record)
+{
+  iss->insn_bin_event.event_binary((uint8_t *)record);
+}
+
 static inline void iss_set_halt_mode(iss_t *iss, bool halted, int cause)
 {
   iss->set_halt_mode(halted, cause);
@@ -156,6 +181,16 @@ static inline int iss_io_req(iss_t *_this, uint64_t addr, uint8_t *data, uint64_
 
 static inline int iss_fetch_req(iss_t *_this, uint64_t addr, uint8_t *data, uint64_t size, bool is_write)
 {
+  iss_dmi_entry_t *dmi = _this->dmi_get(&_this->fetch_dmi, &_this->fetch, addr, size);
+  if (dmi && dmi->mem)
+  {
+    memcpy(data, dmi->mem + (addr - dmi->base), size);
+    _this->cpu.state.fetch_cycles = dmi->latency;
+    return 0;
+  }
+
+  _this->block_sync = true;
+
   vp::io_req *req = &_this->fetch_req;
 
   req->init();
@@ -27,6 +27,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <math.h>
 
 #ifndef O_BINARY
 # define O_BINARY 0
@@ -111,7 +112,7 @@ do { \
   int cycles = func(_this); \
   if (_this->power.get_power_trace()->get_active()) \
   { \
-  _this->insn_groups_power[insn->decoder_item->u.insn.power_group].account_energy_quantum(); \
+  _this->insn_groups_power[insn->cold->decoder_item->u.insn.power_group].account_energy_quantum(); \
  } \
   trdb_record_instruction(_this, insn); \
   if (!_this->stalled.get()) \
@@ -152,19 +153,360 @@ void iss_wrapper::exec_instr(void *__this, vp::clock_event *event)
   EXEC_INSTR_COMMON(_this, event, iss_exec_step_nofetch);
 }
 
+inline bool iss_wrapper::insn_traces_active()
+{
+  return this->pc_trace_event.get_event_active() || this->active_pc_trace_event.get_event_active() ||
+    this->func_trace_event.get_event_active() || this->inline_trace_event.get_event_active() ||
+    this->file_trace_event.get_event_active() || this->line_trace_event.get_event_active() ||
+    this->ipc_stat_event.get_event_active() ||
+    iss_insn_trace_active(this) || iss_insn_event_active(this) || iss_insn_bin_active(this);
+}
+
+inline bool iss_wrapper::block_exec_allowed()
+{
+  // Anything which must be observed at each instruction forces the
+  // instruction by instruction mode.
+  return !this->insn_traces_active() && !this->power.get_power_trace()->get_active();
+}
+
+void iss_wrapper::exec_block(void *__this, vp::clock_event *event)
+{
+  iss_t *_this = (iss_t *)__this;
+
+  if (!_this->block_exec_allowed())
+  {
+    exec_instr(__this, event);
+    return;
+  }
+
+  // Execute the straight-line sequence of instructions starting at the current one
+  // and only report the total time at the end of the block.
+  // The block is stopped as soon as the execution is not sequential anymore (taken
+  // branch, hardware loop, exception), when something interacted with the platform
+  // or changed the core state, or before an instruction using a shared resource,
+  // since it needs to see the current time.
+  int64_t cycles = 0;
+  int nb_insns = 0;
+
+  _this->block_sync = false;
+
+  while(1)
+  {
+    iss_insn_t *insn = _this->cpu.current_insn;
+    int insn_cycles = iss_exec_step_nofetch(_this);
+
+    if (_this->stalled.get())
+    {
+      // The instruction is waiting for the platform, the previous instructions of the
+      // block are accounted when it resumes.
+      if (_this->misaligned_access.get())
+      {
+        _this->event_enqueue(_this->misaligned_event, _this->misaligned_latency + cycles);
+      }
+      else
+      {
+        _this->wakeup_latency += cycles;
+        _this->is_active_reg.set(false);
+      }
+      return;
+    }
+
+    cycles += insn_cycles;
+    nb_insns++;
+
+    iss_insn_t *next = _this->cpu.current_insn;
+
+    if (next != insn->next || nb_insns == ISS_BLOCK_MAX_INSNS || _this->block_sync ||
+      _this->current_event != event || next->fast_handler == iss_resource_offload)
+    {
+      break;
+    }
+  }
+
+  _this->enqueue_next_instr(cycles);
+}
+
+vp::clock_event_meth_t *iss_wrapper::get_instr_handler()
+{
+  if (this->sampling)
+    return iss_wrapper::exec_sampled;
+  else if (this->block_exec)
+    return iss_wrapper::exec_block;
+  else
+    return iss_wrapper::exec_instr;
+}
+
+// Called at the beginning of each instruction executed in detailed mode, so that a window
+// of N instructions is measured from the start of its first instruction to the start of
+// the one following its last instruction.
+inline void iss_wrapper::sampling_account_insn()
+{
+  if (this->sampling_phase_remaining > 0)
+  {
+    this->sampling_phase_remaining--;
+    return;
+  }
+
+  switch (this->sampling_phase)
+  {
+    case ISS_SAMPLING_WARMUP:
+      this->sampling_set_phase(ISS_SAMPLING_MEASURE);
+      break;
+
+    case ISS_SAMPLING_MEASURE:
+    {
+      // Welford update of the CPI statistics
+      double cpi = (double)(this->get_cycles() - this->sampling_window_start) / this->sampling_window_insns;
+      this->sampling_nb_windows++;
+      double delta = cpi - this->sampling_cpi_mean;
+      this->sampling_cpi_mean += delta / this->sampling_nb_windows;
+      this->sampling_cpi_m2 += delta * (cpi - this->sampling_cpi_mean);
+
+      this->sampling_trace.msg(vp::trace::LEVEL_DEBUG, "Measured window (index: %ld, cpi: %f, mean_cpi: %f)\n",
+        this->sampling_nb_windows - 1, cpi, this->sampling_cpi_mean);
+
+      this->sampling_set_phase(this->sampling_ff_insns ? ISS_SAMPLING_FAST_FORWARD : ISS_SAMPLING_WARMUP);
+      break;
+    }
+
+    case ISS_SAMPLING_FAST_FORWARD:
+      this->sampling_set_phase(ISS_SAMPLING_WARMUP);
+      break;
+  }
+
+  // The current instruction is the first one of the new phase
+  this->sampling_phase_remaining--;
+}
+
+void iss_wrapper::sampling_set_phase(iss_sampling_phase_e phase)
+{
+  this->sampling_trace.msg(vp::trace::LEVEL_TRACE, "Switching sampling phase (phase: %d)\n", phase);
+
+  this->sampling_phase = phase;
+
+  switch (phase)
+  {
+    case ISS_SAMPLING_WARMUP:
+      this->sampling_phase_remaining = this->sampling_warmup_insns;
+      if (this->sampling_phase_remaining)
+        break;
+      this->sampling_phase = ISS_SAMPLING_MEASURE;
+      // Fall through to directly start the measure if there is no warm-up
+
+    case ISS_SAMPLING_MEASURE:
+      this->sampling_phase_remaining = this->sampling_window_insns;
+      this->sampling_window_start = this->get_cycles();
+      break;
+
+    case ISS_SAMPLING_FAST_FORWARD:
+      this->sampling_phase_remaining = this->sampling_ff_insns;
+      break;
+  }
+}
+
+void iss_wrapper::sampling_restart()
+{
+  // Make the next executed instruction close the current phase, so that a new period
+  // starts with a warm-up phase at the time this instruction starts
+  this->sampling_phase = ISS_SAMPLING_FAST_FORWARD;
+  this->sampling_phase_remaining = 0;
+}
+
+void iss_wrapper::exec_sampled(void *__this, vp::clock_event *event)
+{
+  iss_t *_this = (iss_t *)__this;
+
+  if (_this->sampling_phase == ISS_SAMPLING_FAST_FORWARD && _this->sampling_phase_remaining > 0 &&
+    !_this->insn_traces_active())
+  {
+    _this->exec_fast_forward(event);
+  }
+  else
+  {
+    // Detailed phases, and also fast-forward phases while per-instruction traces
+    // are active, as they need to see each instruction at its exact time.
+    _this->sampling_account_insn();
+    _this->sampling_total_detailed_insns++;
+
+    // The check-all handler is not used anymore once a fast-forward phase has been
+    // entered, so the HW counters must be updated here when they are enabled.
+    if (iss_exec_switch_to_fast(_this))
+    {
+      EXEC_INSTR_COMMON(_this, event, iss_exec_step_nofetch);
+    }
+    else
+    {
+      EXEC_INSTR_COMMON(_this, event, iss_exec_step_nofetch_perf);
+    }
+  }
+}
+
+int64_t iss_wrapper::exec_untimed(vp::clock_event *event, int64_t max_insns)
+{
+  // Execute instructions functionally, the cycles reported by the instructions (stalls,
+  // memory latencies, branches) are ignored and the caller advances the time once at the
+  // end of the batch.
+  // As for blocks, the batch stops when the core state changes or when it interacted
+  // with the platform, so that interrupts and peripherals still see a coherent time.
+  // This is the loop a native backend executing translated instruction blocks would
+  // replace, the rest of the functional and fast-forward handlers would be kept.
+  int64_t nb_insns = 0;
+  bool power_active = this->power.get_power_trace()->get_active();
+
+  this->block_sync = false;
+
+  while(1)
+  {
+    iss_insn_t *insn = this->cpu.current_insn;
+
+    if (insn->fast_handler == iss_resource_offload && nb_insns > 0)
+    {
+      break;
+    }
+
+    iss_exec_step_nofetch(this);
+
+    if (power_active)
+    {
+      this->insn_groups_power[insn->cold->decoder_item->u.insn.power_group].account_energy_quantum();
+    }
+
+    nb_insns++;
+
+    if (this->stalled.get() || nb_insns == max_insns || this->block_sync || this->current_event != event ||
+      !this->is_active_reg.get() || this->cpu.current_insn->addr == this->functional_switch_pc)
+    {
+      break;
+    }
+  }
+
+  return nb_insns;
+}
+
+void iss_wrapper::exec_untimed_end(int64_t cycles)
+{
+  if (this->stalled.get())
+  {
+    if (this->misaligned_access.get())
+    {
+      this->event_enqueue(this->misaligned_event, this->misaligned_latency + cycles);
+    }
+    else
+    {
+      this->wakeup_latency += cycles;
+      this->is_active_reg.set(false);
+    }
+    return;
+  }
+
+  this->enqueue_next_instr(cycles > 0 ? cycles : 1);
+}
+
+void iss_wrapper::exec_fast_forward(vp::clock_event *event)
+{
+  // The fast-forward instructions are timed using the mean CPI measured so far
+  int64_t max_insns = std::min(this->sampling_phase_remaining, (int64_t)ISS_SAMPLING_FF_MAX_INSNS);
+  int64_t nb_insns = this->exec_untimed(event, max_insns);
+  this->sampling_phase_remaining -= nb_insns;
+
+  double cpi = this->sampling_nb_windows ? this->sampling_cpi_mean : 1.0;
+  double ff_cycles = nb_insns * cpi + this->sampling_ff_cycles_rest;
+  int64_t cycles = (int64_t)ff_cycles;
+  this->sampling_ff_cycles_rest = ff_cycles - cycles;
+
+  this->sampling_total_ff_insns += nb_insns;
+
+  // Report the estimation to the performance counters as if the instructions were executed
+  // in detailed mode
+  iss_pccr_account_event(this, CSR_PCER_INSTR, nb_insns);
+  iss_exec_account_cycles(this, cycles);
+
+  this->exec_untimed_end(cycles);
+}
+
+inline bool iss_wrapper::functional_switch_reached()
+{
+  return this->cpu.current_insn->addr == this->functional_switch_pc ||
+    (this->functional_switch_time != -1 && this->get_time() >= this->functional_switch_time);
+}
+
+void iss_wrapper::functional_stop()
+{
+  this->trace.msg(vp::trace::LEVEL_INFO, "Switching to timed execution (pc: 0x%lx)\n", this->cpu.current_insn->addr);
+
+  this->functional = false;
+  this->functional_switch_pc = -1;
+  this->functional_switch_time = -1;
+
+  vp::clock_event *event = this->instr_event;
+  this->instr_event = this->timed_instr_event;
+  if (this->current_event == event)
+  {
+    this->current_event = this->instr_event;
+  }
+}
+
+void iss_wrapper::exec_functional(void *__this, vp::clock_event *event)
+{
+  iss_t *_this = (iss_t *)__this;
+
+  if (_this->functional_switch_reached())
+  {
+    // The timed handler executes this instruction and is used for the next ones
+    _this->functional_stop();
+    _this->get_instr_handler()(__this, event);
+    return;
+  }
+
+  if (_this->insn_traces_active())
+  {
+    exec_instr(__this, event);
+    return;
+  }
+
+  // Each instruction takes one cycle so that the rest of the platform still sees
+  // the time progressing
+  int64_t nb_insns = _this->exec_untimed(event, ISS_FUNCTIONAL_MAX_INSNS);
+
+  iss_pccr_account_event(_this, CSR_PCER_INSTR, nb_insns);
+  iss_exec_account_cycles(_this, nb_insns);
+
+  _this->exec_untimed_end(nb_insns);
+}
+
 void iss_wrapper::exec_instr_check_all(void *__this, vp::clock_event *event)
 {
   iss_t *_this = (iss_t *)__this;
 
+  // The previous instruction hit a watchpoint, stop before executing this one so that
+  // gdb sees the access done
+  if (_this->watchpoint_stop)
+  {
+    _this->watchpoint_stop = false;
+    _this->halted.set(true);
+    _this->gdbserver->signal(_this);
+    _this->check_state();
+    return;
+  }
+
   // Switch back to optimize instruction handler only
-  // if HW counters are disabled as they are checked with the slow handler
-  if (iss_exec_switch_to_fast(_this))
+  // if HW counters are disabled as they are checked with the slow handler.
+  // In functional mode and during sampling fast-forward phases, the counters are updated
+  // by the functional handlers.
+  if (iss_exec_switch_to_fast(_this) || _this->functional ||
+    (_this->sampling && _this->sampling_phase == ISS_SAMPLING_FAST_FORWARD))
   {
     _this->current_event = _this->instr_event;
   }
 
   int debug_mode = _this->cpu.state.debug_mode;
 
+  if (_this->sampling)
+  {
+    _this->sampling_account_insn();
+    _this->sampling_total_detailed_insns++;
+  }
+
   EXEC_INSTR_COMMON(_this, event, iss_exec_step_nofetch_perf);
   if (_this->step_mode.get() && !debug_mode)
   {
@@ -186,7 +528,7 @@ void iss_wrapper::exec_instr_check_all(void *__this, vp::clock_event *event)
 
 void iss_wrapper::exec_first_instr(vp::clock_event *event)
 {
-  current_event = event_new(iss_wrapper::exec_instr);
+  current_event = this->instr_event;
   iss_start(this);
   exec_instr((void *)this, event);
 }
@@ -205,7 +547,7 @@ void iss_wrapper::data_response(void *__this, vp::io_req *req)
 {
   iss_t *_this = (iss_t *)__this;
   _this->stalled.dec(1);
-  _this->wakeup_latency = req->get_latency();
+  _this->wakeup_latency += req->get_latency();
   if (_this->misaligned_access.get())
   {
     _this->misaligned_access.set(false);
@@ -236,6 +578,57 @@ void iss_wrapper::fetch_response(void *__this, vp::io_req *req)
   _this->check_state();
 }
 
+void iss_wrapper::dmi_flush(iss_dmi_table_t *table)
+{
+  for (int i=0; i<ISS_DMI_NB_ENTRIES; i++)
+  {
+    // Empty range so that no address can match
+    table->entries[i].base = 1;
+    table->entries[i].end = 0;
+    table->entries[i].mem = NULL;
+  }
+  table->next = 0;
+}
+
+iss_dmi_entry_t *iss_wrapper::dmi_refill(iss_dmi_table_t *table, vp::io_master *port, iss_addr_t addr, int size)
+{
+  vp::io_dmi dmi;
+  dmi.init(addr);
+
+  bool granted = port->get_dmi(&dmi);
+
+  this->decode_trace.msg(vp::trace::LEVEL_DEBUG, "Got direct memory access (addr: 0x%lx, granted: %d, base: 0x%lx, end: 0x%lx, latency: %ld)\n",
+    addr, granted, dmi.get_base(), dmi.get_end(), dmi.get_latency());
+
+  // Restrict the range to what the core can address
+  dmi.clip(0, (iss_addr_t)-1);
+
+  iss_dmi_entry_t *entry = &table->entries[table->next];
+  table->next = (table->next + 1) % ISS_DMI_NB_ENTRIES;
+
+  entry->base = dmi.get_base();
+  entry->end = dmi.get_end();
+  entry->mem = granted ? dmi.get_mem() : NULL;
+  entry->latency = dmi.get_latency();
+
+  if (addr + size - 1 > entry->end)
+    return NULL;
+
+  return entry;
+}
+
+void iss_wrapper::data_dmi_invalidate(void *__this)
+{
+  iss_t *_this = (iss_t *)__this;
+  _this->dmi_flush(&_this->data_dmi);
+}
+
+void iss_wrapper::fetch_dmi_invalidate(void *__this)
+{
+  iss_t *_this = (iss_t *)__this;
+  _this->dmi_flush(&_this->fetch_dmi);
+}
+
 void iss_wrapper::bootaddr_sync(void *__this, uint32_t value)
 {
   iss_t *_this = (iss_t *)__this;
@@ -558,6 +951,14 @@ void iss_wrapper::irq_check()
 
 void iss_wrapper::wait_for_interrupt()
 {
+  // The time spent sleeping must not be accounted in the measured CPI, just drop
+  // the current window and measure a new one after the wake-up.
+  if (this->sampling && this->sampling_phase == ISS_SAMPLING_MEASURE)
+  {
+    this->sampling_nb_dropped_windows++;
+    this->sampling_restart();
+  }
+
   wfi.set(true);
   check_state();
 }
@@ -1351,6 +1752,8 @@ int iss_wrapper::build()
   traces.new_trace_event("active_pc", &active_pc_trace_event, 32);
   this->pc_trace_event.register_callback(std::bind(&iss_wrapper::insn_trace_callback, this));
   traces.new_trace_event_string("asm", &insn_trace_event);
+  traces.new_trace_event_binary("insn_bin", &insn_bin_event, sizeof(iss_insn_record_t));
+  this->insn_bin_event.register_callback(std::bind(&iss_wrapper::insn_trace_callback, this));
   traces.new_trace_event_string("func", &func_trace_event);
   traces.new_trace_event_string("inline_func", &inline_trace_event);
   traces.new_trace_event_string("file", &file_trace_event);
@@ -1358,6 +1761,7 @@ int iss_wrapper::build()
   traces.new_trace_event("line", &line_trace_event, 32);
 
   traces.new_trace_event_real("ipc_stat", &ipc_stat_event);
+  traces.new_trace("sampling", &sampling_trace, vp::DEBUG);
 
   this->new_reg("bootaddr", &this->bootaddr_reg, get_config_int("boot_addr"));
   
@@ -1388,12 +1792,19 @@ int iss_wrapper::build()
 
   data.set_resp_meth(&iss_wrapper::data_response);
   data.set_grant_meth(&iss_wrapper::data_grant);
+  data.set_dmi_invalidate_meth(&iss_wrapper::data_dmi_invalidate);
   new_master_port("data", &data);
 
   fetch.set_resp_meth(&iss_wrapper::fetch_response);
   fetch.set_grant_meth(&iss_wrapper::fetch_grant);
+  fetch.set_dmi_invalidate_meth(&iss_wrapper::fetch_dmi_invalidate);
   new_master_port("fetch", &fetch);
 
+  js::config *dmi_config = this->get_js_config()->get("dmi");
+  this->dmi_enabled = dmi_config == NULL || dmi_config->get_bool();
+  this->dmi_flush(&this->data_dmi);
+  this->dmi_flush(&this->fetch_dmi);
+
   dbg_unit.set_req_meth(&iss_wrapper::dbg_unit_req);
   new_slave_port("dbg_unit", &dbg_unit);
 
@@ -1430,8 +1841,48 @@ int iss_wrapper::build()
     this->pcer_info[i].name  = "";
   }
 
+  js::config *block_exec_config = this->get_js_config()->get("block_exec");
+  this->block_exec = block_exec_config != NULL && block_exec_config->get_bool();
+
+  this->sampling_ff_insns = 0;
+  this->sampling_window_insns = 0;
+  this->sampling_warmup_insns = 0;
+  js::config *sampling_config = this->get_js_config()->get("sampling");
+  this->sampling = sampling_config != NULL && sampling_config->get_child_bool("enabled");
+  if (this->sampling)
+  {
+    this->sampling_ff_insns = sampling_config->get_child_int("fast_forward_insns");
+    this->sampling_window_insns = sampling_config->get_child_int("window_insns");
+    this->sampling_warmup_insns = sampling_config->get_child_int("warmup_insns");
+
+    if (this->sampling_window_insns <= 0 || this->sampling_ff_insns < 0 || this->sampling_warmup_insns < 0)
+    {
+      this->trace.fatal("Invalid sampling configuration (window_insns: %ld, fast_forward_insns: %ld, warmup_insns: %ld)\n",
+        this->sampling_window_insns, this->sampling_ff_insns, this->sampling_warmup_insns);
+    }
+  }
+
+  this->functional_switch_pc = -1;
+  this->functional_switch_time = -1;
+  js::config *functional_config = this->get_js_config()->get("functional");
+  this->functional = functional_config != NULL && functional_config->get_child_bool("enabled");
+  if (this->functional)
+  {
+    js::config *switch_pc_config = functional_config->get("switch_pc");
+    if (switch_pc_config != NULL && switch_pc_config->get_int() != -1)
+    {
+      this->functional_switch_pc = (uint32_t)switch_pc_config->get_int();
+    }
+    js::config *switch_time_config = functional_config->get("switch_time");
+    if (switch_time_config != NULL)
+    {
+      this->functional_switch_time = switch_time_config->get_int();
+    }
+  }
+
   current_event = event_new(iss_wrapper::exec_first_instr);
-  instr_event = event_new(iss_wrapper::exec_instr);
+  timed_instr_event = event_new(this->get_instr_handler());
+  instr_event = this->functional ? event_new(iss_wrapper::exec_functional) : timed_instr_event;
   check_all_event = event_new(iss_wrapper::exec_instr_check_all);
   misaligned_event = event_new(iss_wrapper::exec_misaligned);
   irq_sync_event = event_new(iss_wrapper::irq_req_sync_handler);
@@ -1521,6 +1972,15 @@ void iss_wrapper::reset(bool active)
 
     this->ipc_stat_nb_insn = 0;
     this->ipc_stat_delay = 10;
+
+    this->sampling_nb_windows = 0;
+    this->sampling_nb_dropped_windows = 0;
+    this->sampling_cpi_mean = 0;
+    this->sampling_cpi_m2 = 0;
+    this->sampling_ff_cycles_rest = 0;
+    this->sampling_total_detailed_insns = 0;
+    this->sampling_total_ff_insns = 0;
+    this->sampling_restart();
     this->clock_active = false;
 
     this->active_pc_trace_event.event(NULL);
@@ -1561,6 +2021,106 @@ void iss_wrapper::reset(bool active)
 }
 
 
+void iss_wrapper::stop()
+{
+  if (this->sampling)
+  {
+    // SMARTS-like estimation, the CPI of the whole execution is estimated by the mean
+    // of the CPIs measured on the windows, with a 95% confidence interval computed
+    // from their standard deviation.
+    int64_t nb_insns = this->sampling_total_detailed_insns + this->sampling_total_ff_insns;
+    double cpi_ci = 0;
+
+    if (this->sampling_nb_windows > 1)
+    {
+      double stddev = sqrt(this->sampling_cpi_m2 / (this->sampling_nb_windows - 1));
+      cpi_ci = 1.96 * stddev / sqrt(this->sampling_nb_windows);
+    }
+
+    this->sampling_trace.msg(vp::trace::LEVEL_INFO, "Sampling results (windows: %ld, dropped_windows: %ld, detailed_insns: %ld, fast_forward_insns: %ld)\n",
+      this->sampling_nb_windows, this->sampling_nb_dropped_windows, this->sampling_total_detailed_insns, this->sampling_total_ff_insns);
+
+    if (this->sampling_nb_windows)
+    {
+      this->sampling_trace.msg(vp::trace::LEVEL_INFO, "Estimated CPI: %f +/- %f (IPC: %f, cycles: %.0f +/- %.0f)\n",
+        this->sampling_cpi_mean, cpi_ci, 1.0 / this->sampling_cpi_mean,
+        this->sampling_cpi_mean * nb_insns, cpi_ci * nb_insns);
+    }
+  }
+}
+
+void iss_wrapper::get_perf_counters(std::vector<std::pair<std::string, int64_t>> &counters)
+{
+  // Report the HW counters as seen by the software
+  for (int i=0; i<31; i++)
+  {
+    if (this->pcer_info[i].name != "")
+    {
+      iss_reg_t value;
+      iss_csr_read(this, CSR_PCCR(i), &value);
+      counters.push_back({this->pcer_info[i].name, value});
+    }
+  }
+}
+
+void iss_wrapper::checkpoint_state(vp::checkpoint *cp)
+{
+  // Pending memory accesses and their callbacks can not be saved, the core
+  // can only be saved between 2 instructions.
+  if (!cp->is_restore() && this->stalled.get())
+  {
+    cp->error("Can not save core while it is stalled (path: " + this->get_path() + ")");
+    return;
+  }
+
+  iss_addr_t pc = this->cpu.current_insn ? this->cpu.current_insn->addr : 0;
+  bool hwloop_active[2] = { this->cpu.state.hwloop_end_insn[0] != NULL, this->cpu.state.hwloop_end_insn[1] != NULL };
+
+  cp->sync(&pc);
+  cp->sync(&hwloop_active);
+  cp->sync(&this->cpu.regfile);
+  cp->sync(&this->cpu.csr);
+  cp->sync(&this->cpu.pulpv2);
+  cp->sync(&this->cpu.state.bootaddr);
+  cp->sync(&this->cpu.state.fcsr);
+  cp->sync(&this->cpu.state.fprec);
+  cp->sync(&this->cpu.state.debug_mode);
+  cp->sync(&this->cpu.irq.irq_enable);
+  cp->sync(&this->cpu.irq.saved_irq_enable);
+  cp->sync(&this->cpu.irq.debug_saved_irq_enable);
+  cp->sync(&this->cpu.irq.req_irq);
+  cp->sync(&this->cpu.irq.req_debug);
+  cp->sync(&this->cpu.irq.vector_base);
+  cp->sync(&this->irq_req);
+  cp->sync(&this->irq_req_value);
+  cp->sync(&this->wakeup_latency);
+  cp->sync(&this->bootaddr_offset);
+  cp->sync(&this->npc);
+  cp->sync(&this->clock_active);
+
+  if (cp->is_restore())
+  {
+    // Instructions are decoded again so that nothing from the state before
+    // the restore is kept, like hardware loop ends
+    this->cpu.state.hwloop_end_insn[0] = NULL;
+    this->cpu.state.hwloop_end_insn[1] = NULL;
+    iss_cache_flush(this);
+
+    for (int i=0; i<2; i++)
+    {
+      if (hwloop_active[i])
+      {
+        hwloop_set_start(this, NULL, i, this->cpu.pulpv2.hwloop_regs[PULPV2_HWLOOP_LPSTART(i)]);
+        hwloop_set_end(this, NULL, i, this->cpu.pulpv2.hwloop_regs[PULPV2_HWLOOP_LPEND(i)]);
+      }
+    }
+
+    iss_irq_set_vector_table(this, this->cpu.irq.vector_base);
+    iss_pc_set(this, pc);
+  }
+}
+
+
 iss_wrapper::iss_wrapper(js::config *config)
 : vp::component(config)
 {
@@ -1648,6 +2208,7 @@ int iss_wrapper::gdbserver_stop()
 
 int iss_wrapper::gdbserver_cont()
 {
+    this->watchpoint_hit = false;
     this->halted.set(false);
     this->check_state();
 
@@ -1658,6 +2219,7 @@ int iss_wrapper::gdbserver_cont()
 int iss_wrapper::gdbserver_stepi()
 {
     fprintf(stderr, "STEP\n");
+    this->watchpoint_hit = false;
     this->step_mode.set(true);
     this->halted.set(false);
     this->check_state();
@@ -1671,6 +2233,100 @@ int iss_wrapper::gdbserver_state()
 }
 
 
+int iss_wrapper::gdbserver_watchpoint_insert(int type, uint64_t addr, int size)
+{
+    this->gdbserver_trace.msg(vp::trace::LEVEL_DEBUG, "Inserting watchpoint (type: %d, addr: 0x%lx, size: %d)\n", type, addr, size);
+
+    this->watchpoints.push_back({ type, (iss_addr_t)addr, (iss_addr_t)(addr + size - 1) });
+    this->watchpoints_update();
+    return 0;
+}
+
+
+int iss_wrapper::gdbserver_watchpoint_remove(int type, uint64_t addr, int size)
+{
+    this->gdbserver_trace.msg(vp::trace::LEVEL_DEBUG, "Removing watchpoint (type: %d, addr: 0x%lx, size: %d)\n", type, addr, size);
+
+    for (auto it = this->watchpoints.begin(); it != this->watchpoints.end(); it++)
+    {
+        if (it->type == type && it->base == addr && it->end == (iss_addr_t)(addr + size - 1))
+        {
+            this->watchpoints.erase(it);
+            this->watchpoints_update();
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+
+bool iss_wrapper::gdbserver_watchpoint_hit(int *type, uint64_t *addr)
+{
+    if (!this->watchpoint_hit)
+    {
+        return false;
+    }
+
+    *type = this->watchpoint_hit_type;
+    *addr = this->watchpoint_hit_addr;
+    return true;
+}
+
+
+void iss_wrapper::watchpoints_update()
+{
+    bool armed = this->watchpoints.size() != 0;
+
+    if (armed != this->watchpoints_armed)
+    {
+        this->watchpoints_armed = armed;
+
+        // Direct accesses are refused while watchpoints are armed, and the instruction
+        // handlers are decoded again to add or remove the watchpoint wrapper
+        this->dmi_flush(&this->data_dmi);
+        if (this->iss_opened)
+        {
+            iss_cache_flush(this);
+        }
+    }
+}
+
+
+void iss_wrapper::watchpoint_check(iss_addr_t addr, int size, bool is_write)
+{
+    // Only the first hit is kept, it is the one reported when the core stops
+    if (this->watchpoint_hit)
+    {
+        return;
+    }
+
+    iss_addr_t end = addr + size - 1;
+
+    for (iss_watchpoint_t &watchpoint: this->watchpoints)
+    {
+        if (addr > watchpoint.end || end < watchpoint.base)
+        {
+            continue;
+        }
+
+        if ((watchpoint.type == vp::Gdbserver_core::watch_write && !is_write) ||
+            (watchpoint.type == vp::Gdbserver_core::watch_read && is_write))
+        {
+            continue;
+        }
+
+        this->gdbserver_trace.msg(vp::trace::LEVEL_DEBUG, "Hit watchpoint (type: %d, addr: 0x%lx, size: %d, is_write: %d)\n",
+            watchpoint.type, addr, size, is_write);
+
+        this->watchpoint_hit = true;
+        this->watchpoint_hit_type = watchpoint.type;
+        this->watchpoint_hit_addr = addr > watchpoint.base ? addr : watchpoint.base;
+        return;
+    }
+}
+
+
 void iss_wrapper::declare_pcer(int index, std::string name, std::string help)
 {
     this->pcer_info[index].name = name;
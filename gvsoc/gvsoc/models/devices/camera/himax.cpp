@@ -24,6 +24,12 @@
 #include <vp/itf/i2c.hpp>
 #include <unistd.h>
 #include <byteswap.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
 
 #include <stdint.h>
 #ifdef __MAGICK__
@@ -65,8 +71,15 @@ public:
     bool fetch_image();
     unsigned int get_pixel();
     void set_image_size(int width, int height, int pixel_size);
+    void set_socket(string path);
+    void start_prefetch(int nb_frames);
 
   private:
+    bool read_raw_file(uint8_t *buffer, int size, string *error);
+    bool read_socket(uint8_t *buffer, int size, string *error);
+    void prefetch_routine();
+    uint8_t *pop_frame();
+
     Himax *top;
     string stream_path;
     int frame_index;
@@ -85,6 +98,19 @@ public:
     bool is_raw;
     uint8_t *raw_image;
     int little;
+
+    // Raw frames can be received from clients connected to a local socket instead of files
+    int socket_fd;
+    int client_fd;
+
+    // When prefetching is enabled, raw frames are read in advance by a thread into this queue,
+    // which can contain up to nb_prefetch_frames frames
+    std::thread *prefetch_thread;
+    std::mutex prefetch_mutex;
+    std::condition_variable prefetch_cond;
+    std::queue<uint8_t *> prefetch_frames;
+    int nb_prefetch_frames;
+    string prefetch_error;
 };
 
 
@@ -101,12 +127,15 @@ public:
 protected:
 
     static void clock_handler(void *__this, vp::clock_event *event);
+    static void frame_handler(void *__this, vp::clock_event *event);
     static void i2c_sync(void *__this, int scl, int sda);
+    void send_byte();
 
     vp::cpi_master cpi_itf;
     vp::i2c_slave i2c_itf;
 
     vp::clock_event *clock_event;
+    vp::clock_event *frame_event;
 
     vp::trace trace;
 
@@ -140,6 +169,10 @@ protected:
     uint32_t pixel;
     int pixel_bytes;
 
+    // In frame mode, lines are sent to the receiver in a single call instead of byte per byte
+    bool frame_mode;
+    std::vector<uint8_t> line_buffer;
+
     Camera_stream *stream;
 };
 
@@ -153,6 +186,11 @@ Camera_stream::Camera_stream(Himax *top, string path, int color_mode, int little
     image_buffer = NULL;
 #endif
     raw_image = NULL;
+    is_raw = strstr(path.c_str(), ".raw") != NULL;
+    socket_fd = -1;
+    client_fd = -1;
+    prefetch_thread = NULL;
+    nb_prefetch_frames = 0;
 }
 
 
@@ -165,57 +203,228 @@ void Camera_stream::set_image_size(int width, int height, int pixel_size)
 }
 
 
-bool Camera_stream::fetch_image()
+void Camera_stream::set_socket(string path)
+{
+    struct sockaddr_un addr;
+
+    if (path.size() >= sizeof(addr.sun_path))
+    {
+        this->top->trace.fatal("Camera socket path is too long (%s)\n", path.c_str());
+        return;
+    }
+
+    this->socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (this->socket_fd == -1)
+    {
+        this->top->trace.fatal("Unable to create camera socket (error: %s)\n", strerror(errno));
+        return;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+
+    unlink(path.c_str());
+
+    if (bind(this->socket_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(this->socket_fd, 1) == -1)
+    {
+        this->top->trace.fatal("Unable to open camera socket (path: %s, error: %s)\n", path.c_str(), strerror(errno));
+        return;
+    }
+
+    this->is_raw = true;
+}
+
+
+void Camera_stream::start_prefetch(int nb_frames)
+{
+    if (!this->is_raw)
+    {
+        this->top->trace.warning("Frames prefetching is only supported for raw images, ignoring it\n");
+        return;
+    }
+
+    this->nb_prefetch_frames = nb_frames;
+    this->prefetch_thread = new std::thread(&Camera_stream::prefetch_routine, this);
+}
+
+
+void Camera_stream::prefetch_routine()
+{
+    int size = this->width * this->height * this->pixel_size;
+
+    while(1)
+    {
+        uint8_t *frame = new uint8_t[size];
+        bool ok;
+
+        if (this->socket_fd != -1)
+        {
+            ok = this->read_socket(frame, size, &this->prefetch_error);
+        }
+        else
+        {
+            ok = this->read_raw_file(frame, size, &this->prefetch_error);
+        }
+
+        if (!ok)
+        {
+            delete[] frame;
+            frame = NULL;
+        }
+
+        // A NULL frame is pushed in case of error so that the error is reported by the engine
+        // thread when it gets to this frame
+        std::unique_lock<std::mutex> lock(this->prefetch_mutex);
+        while ((int)this->prefetch_frames.size() >= this->nb_prefetch_frames)
+        {
+            this->prefetch_cond.wait(lock);
+        }
+        this->prefetch_frames.push(frame);
+        this->prefetch_cond.notify_all();
+
+        if (frame == NULL)
+        {
+            break;
+        }
+    }
+}
+
+
+uint8_t *Camera_stream::pop_frame()
+{
+    std::unique_lock<std::mutex> lock(this->prefetch_mutex);
+
+    // This blocks the simulation until the frame is available, which is what is needed for
+    // closed-loop tests where the frames are produced by an external client
+    while (this->prefetch_frames.empty())
+    {
+        this->prefetch_cond.wait(lock);
+    }
+
+    uint8_t *frame = this->prefetch_frames.front();
+    this->prefetch_frames.pop();
+    this->prefetch_cond.notify_all();
+
+    if (frame == NULL)
+    {
+        this->top->trace.fatal("%s\n", this->prefetch_error.c_str());
+    }
+
+    return frame;
+}
+
+
+bool Camera_stream::read_raw_file(uint8_t *buffer, int size, string *error)
 {
     char path[strlen(stream_path.c_str()) + 100];
     while(1)
     {
         sprintf(path, stream_path.c_str(), frame_index);
-        this->is_raw = strstr(path, ".raw") != NULL;
 
-        if (this->is_raw)
+        FILE *file = fopen(path, "r");
+        if (file)
         {
-            FILE *file = fopen(path, "r");
-            if (file)
+            int read_size = ::fread(buffer, 1, size, file);
+            fclose(file);
+
+            if (read_size != size)
             {
-                int size = this->width * this->height * this->pixel_size;
-                int read_size;
+                *error = "Image file is too short(" + string(path) + ")";
+                return false;
+            }
 
-                this->raw_image = new uint8_t[size];
-                if ((read_size = ::fread(this->raw_image, 1, size, file)) == size)
-                {
-                    fclose(file);
-                    break;
-                }
+            frame_index++;
+            return true;
+        }
+
+        if (frame_index == 0)
+        {
+            *error = "Unable to open image file (" + string(path) + ")";
+            return false;
+        }
 
-                delete this->raw_image;
-                this->raw_image = NULL;
-                fclose(file);
-                this->top->trace.fatal("Image file is too short(%s)\n", path);
+        frame_index = 0;
+    }
+}
+
+
+bool Camera_stream::read_socket(uint8_t *buffer, int size, string *error)
+{
+    while(1)
+    {
+        if (this->client_fd == -1)
+        {
+            this->client_fd = accept(this->socket_fd, NULL, NULL);
+            if (this->client_fd == -1)
+            {
+                *error = "Failed to accept camera socket connection (error: " + string(strerror(errno)) + ")";
                 return false;
             }
+        }
 
-            if (frame_index == 0)
+        int read_size = 0;
+        while (read_size < size)
+        {
+            int ret = ::read(this->client_fd, buffer + read_size, size - read_size);
+            if (ret <= 0)
             {
-              this->top->trace.fatal("Unable to open image file (%s)\n", path);
-              return false;
+                break;
             }
+            read_size += ret;
         }
-        else
+
+        if (read_size == size)
         {
+            return true;
+        }
+
+        // The client has been disconnected, drop the partial frame and wait for the next client
+        close(this->client_fd);
+        this->client_fd = -1;
+    }
+}
+
+
+bool Camera_stream::fetch_image()
+{
+    if (this->prefetch_thread)
+    {
+        this->raw_image = this->pop_frame();
+        return this->raw_image != NULL;
+    }
+
+    if (this->is_raw)
+    {
+        int size = this->width * this->height * this->pixel_size;
+        string error;
+
+        this->raw_image = new uint8_t[size];
+        if (!this->read_raw_file(this->raw_image, size, &error))
+        {
+            delete[] this->raw_image;
+            this->raw_image = NULL;
+            this->top->trace.fatal("%s\n", error.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
 #ifdef __MAGICK__
-          try {
-              image.read(path);
-              break;
-          }
-          catch( Exception &error_ ) {
-              if (frame_index == 0) {
-                  throw;
-              }
-          }
-#else
-          this->top->trace.fatal("Trying to open image file while ImageMagick has not been installed, use a raw image instead (with.raw extension) (%s)\n", path);
-#endif
+    char path[strlen(stream_path.c_str()) + 100];
+    while(1)
+    {
+        sprintf(path, stream_path.c_str(), frame_index);
+
+        try {
+            image.read(path);
+            break;
+        }
+        catch( Exception &error_ ) {
+            if (frame_index == 0) {
+                throw;
+            }
         }
 
         frame_index = 0;
@@ -224,22 +433,20 @@ bool Camera_stream::fetch_image()
     //dpi_print(top->handle, ("Opened image (path: " + string(path) + ")").c_str());
     frame_index++;
 
-    if (!this->is_raw)
-    {
-#ifdef __MAGICK__
-        image.extent(Geometry(width, height));
+    image.extent(Geometry(width, height));
 
-        if (color_mode == COLOR_MODE_GRAY)
-        {
-            image.quantizeColorSpace( GRAYColorspace );
-            image.quantizeColors( 256 );
-            image.quantize( );
-        }
+    if (color_mode == COLOR_MODE_GRAY)
+    {
+        image.quantizeColorSpace( GRAYColorspace );
+        image.quantizeColors( 256 );
+        image.quantize( );
+    }
 
 
-        image_buffer = (PixelPacket*) image.getPixels(0, 0, width, height);
+    image_buffer = (PixelPacket*) image.getPixels(0, 0, width, height);
+#else
+    this->top->trace.fatal("Trying to open image file while ImageMagick has not been installed, use a raw image instead (with.raw extension) (%s)\n", stream_path.c_str());
 #endif
-    }
 
     return true;
 }
@@ -274,7 +481,7 @@ unsigned int Camera_stream::get_pixel()
         if (current_pixel == nb_pixel)
         {
             current_pixel = 0;
-            delete this->raw_image;
+            delete[] this->raw_image;
             this->raw_image = NULL;
         }
         return result;
@@ -314,6 +521,121 @@ void Himax::i2c_sync(void *__this, int scl, int sda)
 }
 
 
+void Himax::send_byte()
+{
+    int last_byte = 0;
+
+    this->href = this->hsync_polarity;
+
+    if (this->color_mode == COLOR_MODE_CUSTOM)
+    {
+        last_byte = this->pixel_size - 1;
+        if (this->stream)
+        {
+            if (this->pixel_bytes == 0)
+            {
+                this->pixel = this->stream->get_pixel();
+                this->pixel_bytes = this->pixel_size;
+            }
+            this->pixel_bytes--;
+        }
+
+        this->data = this->pixel & 0xFF;
+        this->pixel >>= 8;
+    }
+    else if (this->color_mode == COLOR_MODE_GRAY)
+    {
+        if (this->stream)
+        {
+            if (this->pixel_bytes == 0)
+            {
+                this->data = this->stream->get_pixel();
+                this->pixel_bytes = this->pixel_size;
+            }
+            this->pixel_bytes--;
+        }
+
+        //if (stimImg != NULL) {
+        //  pixel = ((uint32_t *)stimImg[framesel])[(lineptr*width)+2*colptr+offset];
+        //}
+
+        //data = 0.2989 * ((pixel >> 16) & 0xff) +
+        //       0.5870 * ((pixel >>  8) & 0xff) +
+        //       0.1140 * ((pixel >>  0) & 0xff);
+    }
+    else if (this->color_mode == COLOR_MODE_RAW)
+    {
+      if (this->stream)
+        {
+            if (this->pixel_bytes == 0)
+            {
+                this->pixel = this->stream->get_pixel();
+                this->pixel_bytes = this->pixel_size;
+            }
+            this->pixel_bytes--;
+      }
+
+      // Raw bayer mode. Line 0: BGBG, Line 1: GRGR
+      int line = this->width - this->lineptr -1;
+      if (line & 1)
+      {
+          if (this->colptr & 1)
+              this->data = (this->pixel >> 16) & 0xff;
+          else
+              this->data = (this->pixel >> 8) & 0xff;
+      }
+      else
+      {
+        if (this->colptr & 1)
+            this->data = (this->pixel >> 8) & 0xff;
+        else
+            this->data = (this->pixel >> 0) & 0xff;
+      }
+    }
+    else
+    {
+        if (this->stream)
+        {
+            if (this->pixel_bytes == 0)
+            {
+                this->pixel = this->stream->get_pixel();
+                this->pixel_bytes = this->pixel_size;
+            }
+            this->pixel_bytes--;
+        }
+
+        //if (stimImg != NULL) {
+        //  ((uint32_t *)stimImg[framesel])[(lineptr*width)+colptr];
+        //}
+
+        // Coded with RGB565
+        if (this->bytesel) this->data = (((this->pixel >> 10) & 0x7) << 5) | (((this->pixel >> 3) & 0x1f) << 0);
+        else         this->data = (((this->pixel >> 19) & 0x1f) << 3) | (((this->pixel >> 13) & 0x7) << 0);
+    }
+
+    if (this->bytesel == last_byte) {
+        this->bytesel = 0;
+        if(this->colptr == (this->width-1)) {
+            this->colptr = 0;
+            if(this->lineptr == (this->height-1)) {
+                this->state = STATE_WAIT_EOF;
+                this->cnt = 0;
+                this->targetcnt = 10*TLINE(this->width);
+                this->lineptr = 0;
+            } else {
+                this->lineptr = this->lineptr + 1;
+            }
+        } else {
+            this->colptr = this->colptr + 1;
+        }
+
+    } else {
+        this->bytesel++;
+    }
+    this->trace.msg(vp::trace::LEVEL_DEBUG, "State SEND_LINE (data: 0x%x)\n", this->data);
+}
+
+
 void Himax::clock_handler(void *__this, vp::clock_event *event)
 {
     Himax *_this = (Himax *)__this;
@@ -361,119 +683,9 @@ void Himax::clock_handler(void *__this, vp::clock_event *event)
                 }
                 break;
 
-            case STATE_SEND_LINE: {
-                int last_byte = 0;
-
-                _this->href = _this->hsync_polarity;
-
-                if (_this->color_mode == COLOR_MODE_CUSTOM)
-                {
-                    last_byte = _this->pixel_size - 1;
-                    if (_this->stream)
-                    {
-                        if (_this->pixel_bytes == 0)
-                        {
-                            _this->pixel = _this->stream->get_pixel();
-                            _this->pixel_bytes = _this->pixel_size;
-                        }
-                        _this->pixel_bytes--;
-                    }
-
-                    _this->data = _this->pixel & 0xFF;
-                    _this->pixel >>= 8;
-                }
-                else if (_this->color_mode == COLOR_MODE_GRAY)
-                {
-                    if (_this->stream)
-                    {
-                        if (_this->pixel_bytes == 0)
-                        {
-                            _this->data = _this->stream->get_pixel();
-                            _this->pixel_bytes = _this->pixel_size;
-                        }
-                        _this->pixel_bytes--;
-                    }
-
-                    //if (stimImg != NULL) {
-                    //  pixel = ((uint32_t *)stimImg[framesel])[(lineptr*width)+2*colptr+offset];
-                    //}
-
-                    //data = 0.2989 * ((pixel >> 16) & 0xff) +
-                    //       0.5870 * ((pixel >>  8) & 0xff) +
-                    //       0.1140 * ((pixel >>  0) & 0xff);
-                }
-                else if (_this->color_mode == COLOR_MODE_RAW)
-                {
-                  if (_this->stream)
-                    {
-                        if (_this->pixel_bytes == 0)
-                        {
-                            _this->pixel = _this->stream->get_pixel();
-                            _this->pixel_bytes = _this->pixel_size;
-                        }
-                        _this->pixel_bytes--;
-                  }
-
-                  // Raw bayer mode. Line 0: BGBG, Line 1: GRGR
-                  int line = _this->width - _this->lineptr -1;
-                  if (line & 1)
-                  {
-                      if (_this->colptr & 1)
-                          _this->data = (_this->pixel >> 16) & 0xff;
-                      else
-                          _this->data = (_this->pixel >> 8) & 0xff;
-                  }
-                  else
-                  {
-                    if (_this->colptr & 1)
-                        _this->data = (_this->pixel >> 8) & 0xff;
-                    else
-                        _this->data = (_this->pixel >> 0) & 0xff;
-                  }
-                }
-                else
-                {
-                    if (_this->stream)
-                    {
-                        if (_this->pixel_bytes == 0)
-                        {
-                            _this->pixel = _this->stream->get_pixel();
-                            _this->pixel_bytes = _this->pixel_size;
-                        }
-                        _this->pixel_bytes--;
-                    }
-
-                    //if (stimImg != NULL) {
-                    //  ((uint32_t *)stimImg[framesel])[(lineptr*width)+colptr];
-                    //}
-
-                    // Coded with RGB565
-                    if (_this->bytesel) _this->data = (((_this->pixel >> 10) & 0x7) << 5) | (((_this->pixel >> 3) & 0x1f) << 0);
-                    else         _this->data = (((_this->pixel >> 19) & 0x1f) << 3) | (((_this->pixel >> 13) & 0x7) << 0);
-                }
-
-                if (_this->bytesel == last_byte) {
-                    _this->bytesel = 0;
-                    if(_this->colptr == (_this->width-1)) {
-                        _this->colptr = 0;
-                        if(_this->lineptr == (_this->height-1)) {
-                            _this->state = STATE_WAIT_EOF;
-                            _this->cnt = 0;
-                            _this->targetcnt = 10*TLINE(_this->width);
-                            _this->lineptr = 0;
-                        } else {
-                            _this->lineptr = _this->lineptr + 1;
-                        }
-                    } else {
-                        _this->colptr = _this->colptr + 1;
-                    }
-
-                } else {
-                    _this->bytesel++;
-                }
-                _this->trace.msg(vp::trace::LEVEL_DEBUG, "State SEND_LINE (data: 0x%x)\n", _this->data);
+            case STATE_SEND_LINE:
+                _this->send_byte();
                 break;
-            }
 
             case STATE_WAIT_EOF:
                 _this->trace.msg(vp::trace::LEVEL_DEBUG, "State WAIT_EOF (cnt: %d, targetcnt: %d)\n", _this->cnt, _this->targetcnt);
@@ -497,6 +709,82 @@ void Himax::clock_handler(void *__this, vp::clock_event *event)
 
 
 
+void Himax::frame_handler(void *__this, vp::clock_event *event)
+{
+    Himax *_this = (Himax *)__this;
+
+    // Each state is handled in one go, with the same duration as with the byte per byte mode,
+    // in number of pixel clock periods
+    int64_t periods = 1;
+
+    switch (_this->state)
+    {
+        case STATE_INIT:
+            _this->trace.msg(vp::trace::LEVEL_DEBUG, "State INIT\n");
+            _this->cnt = 0;
+            _this->targetcnt = 3*TLINE(_this->width);
+            _this->state = STATE_SOF;
+            _this->bytesel = 0;
+            _this->framesel = 0;
+            break;
+
+        case STATE_SOF:
+            _this->trace.msg(vp::trace::LEVEL_DEBUG, "Starting frame\n");
+            _this->vsync = _this->vsync_polarity;
+            _this->cpi_itf.sync_cycle(_this->href, _this->vsync, _this->data);
+            periods = _this->targetcnt;
+            _this->cnt = 0;
+            _this->targetcnt = 17*TLINE(_this->width);
+            _this->state = STATE_WAIT_SOF;
+            break;
+
+        case STATE_WAIT_SOF:
+            _this->trace.msg(vp::trace::LEVEL_DEBUG, "State WAIT_SOF (targetcnt: %d)\n", _this->targetcnt);
+            _this->vsync = !_this->vsync_polarity;
+            _this->cpi_itf.sync_cycle(_this->href, _this->vsync, _this->data);
+            periods = _this->targetcnt;
+            _this->state = STATE_SEND_LINE;
+            _this->lineptr = 0;
+            _this->colptr = 0;
+            break;
+
+        case STATE_SEND_LINE: {
+            // Gather all the bytes of the current line and send them at once
+            int lineptr = _this->lineptr;
+            int size = 0;
+            while (_this->state == STATE_SEND_LINE && _this->lineptr == lineptr)
+            {
+                _this->send_byte();
+                _this->line_buffer[size++] = _this->data;
+            }
+
+            _this->trace.msg(vp::trace::LEVEL_DEBUG, "State SEND_LINE (line: %d, size: %d)\n", lineptr, size);
+            _this->cpi_itf.sync_line(_this->line_buffer.data(), size);
+            periods = size;
+            break;
+        }
+
+        case STATE_WAIT_EOF:
+            _this->trace.msg(vp::trace::LEVEL_DEBUG, "State WAIT_EOF (targetcnt: %d)\n", _this->targetcnt);
+            _this->href = !_this->hsync_polarity;
+            _this->data = 0;
+            _this->cpi_itf.sync_cycle(_this->href, _this->vsync, _this->data);
+            periods = _this->targetcnt;
+            _this->state = STATE_SOF;
+            _this->cnt = 0;
+            _this->targetcnt = 3*TLINE(_this->width);
+            _this->framesel++;
+            if (_this->framesel == _this->nb_images) _this->framesel = 0;
+            break;
+    }
+
+    // One pixel clock period is 2 cycles
+    _this->event_enqueue(_this->frame_event, periods * 2);
+}
+
+
+
+
 int Himax::build()
 {
     traces.new_trace("trace", &trace, vp::DEBUG);
@@ -507,6 +795,7 @@ int Himax::build()
     this->new_slave_port("i2c", &this->i2c_itf);
 
     this->clock_event = this->event_new(this, Himax::clock_handler);
+    this->frame_event = this->event_new(this, Himax::frame_handler);
 
 #ifdef __MAGICK__
     InitializeMagick(NULL);
@@ -531,10 +820,11 @@ int Himax::build()
     // Default color mode is 16bits RGB565
     //color_mode = COLOR_MODE_RGB565;
     js::config *stream_config = get_js_config()->get("image-stream");
+    js::config *socket_config = get_js_config()->get("image-socket");
 
-    if (stream_config)
+    if (stream_config || socket_config)
     {
-        string stream_path = stream_config->get_str();
+        string stream_path = stream_config ? stream_config->get_str() : "";
 
         if (this->pixel_size != 0)
         {
@@ -559,14 +849,56 @@ int Himax::build()
         }
 
         this->stream->set_image_size(this->width, this->height, this->pixel_size);
+
+        // Frames can be read in advance by a background thread to keep file accesses out of
+        // the simulation. This is always the case for frames received from the socket.
+        int nb_prefetch_frames = 0;
+        js::config *prefetch_config = get_js_config()->get("image-prefetch");
+        if (prefetch_config)
+        {
+            nb_prefetch_frames = prefetch_config->get_int();
+        }
+
+        if (socket_config)
+        {
+            this->stream->set_socket(socket_config->get_str());
+            if (nb_prefetch_frames == 0)
+            {
+                nb_prefetch_frames = 2;
+            }
+        }
+
+        if (nb_prefetch_frames > 0)
+        {
+            this->stream->start_prefetch(nb_prefetch_frames);
+        }
     }
 
+    js::config *frame_mode_config = get_js_config()->get("frame-mode");
+    this->frame_mode = frame_mode_config && frame_mode_config->get_bool();
+
     return 0;
 }
 
 void Himax::start()
 {
-    this->event_enqueue(this->clock_event, 1);
+    // Frame mode can only be used if the receiver can get whole lines, otherwise the pixel
+    // clock is still modeled
+    if (this->frame_mode && !this->cpi_itf.has_sync_line())
+    {
+        this->trace.msg(vp::trace::LEVEL_INFO, "CPI receiver does not support lines, disabling frame mode\n");
+        this->frame_mode = false;
+    }
+
+    if (this->frame_mode)
+    {
+        this->line_buffer.resize(this->width * (this->pixel_size > 0 ? this->pixel_size : 1));
+        this->event_enqueue(this->frame_event, 1);
+    }
+    else
+    {
+        this->event_enqueue(this->clock_event, 1);
+    }
 
     this->pclk_value = 0;
     this->state = STATE_INIT;
@@ -81,6 +81,7 @@ public:
 
   static void sync_cycle(void *_this, int data);
   static void cs_sync(void *__this, bool value);
+  static bool burst(void *__this, vp::hyper_burst *burst);
 
   int get_nb_word() {return nb_word;}
 
@@ -456,6 +457,39 @@ void Hyperflash::sync_cycle(void *__this, int data)
   }
 }
 
+bool Hyperflash::burst(void *__this, vp::hyper_burst *burst)
+{
+  Hyperflash *_this = (Hyperflash *)__this;
+
+  // Status register reads and out-of-bound accesses are handled byte per byte
+  // by the master.
+  if (_this->hyper_state != HYPERBUS_STATE_DATA || burst->is_write == _this->ca.read ||
+    _this->current_address + burst->size > _this->size || _this->state == HYPERFLASH_STATE_GET_STATUS_REG)
+  {
+    return false;
+  }
+
+  _this->trace.msg(vp::trace::LEVEL_TRACE, "Received burst (addr: 0x%x, size: 0x%x, is_write: %d)\n", _this->current_address, burst->size, burst->is_write);
+
+  if (burst->is_write)
+  {
+    // Writes are commands or programming, they go through the same state machine
+    // as cycle-level bytes
+    for (int i=0; i<burst->size; i++)
+    {
+      _this->handle_access(_this->reg_access, _this->current_address, 0, burst->data[i]);
+      _this->current_address++;
+    }
+  }
+  else
+  {
+    memcpy(burst->data, &_this->data[_this->current_address], burst->size);
+    _this->current_address += burst->size;
+  }
+
+  return true;
+}
+
 void Hyperflash::cs_sync(void *__this, bool value)
 {
   Hyperflash *_this = (Hyperflash *)__this;
@@ -491,6 +525,7 @@ int Hyperflash::build()
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   in_itf.set_sync_cycle_meth(&Hyperflash::sync_cycle);
+  in_itf.set_burst_meth(&Hyperflash::burst);
   new_slave_port("input", &in_itf);
 
   cs_itf.set_sync_meth(&Hyperflash::cs_sync);
@@ -55,6 +55,7 @@ public:
 
   static void sync_cycle(void *_this, int data);
   static void cs_sync(void *__this, bool value);
+  static bool burst(void *__this, vp::hyper_burst *burst);
 
 protected:
   vp::trace     trace;
@@ -149,6 +150,30 @@ void Hyperram::sync_cycle(void *__this, int data)
   }
 }
 
+bool Hyperram::burst(void *__this, vp::hyper_burst *burst)
+{
+  Hyperram *_this = (Hyperram *)__this;
+
+  // Anything else than plain data, including out-of-bound accesses, is handled
+  // byte per byte by the master.
+  if (_this->state != HYPERBUS_STATE_DATA || burst->is_write == _this->ca.read ||
+    _this->current_address + burst->size > _this->size)
+  {
+    return false;
+  }
+
+  _this->trace.msg(vp::trace::LEVEL_TRACE, "Received burst (addr: 0x%x, size: 0x%x, is_write: %d)\n", _this->current_address, burst->size, burst->is_write);
+
+  if (burst->is_write)
+    memcpy(&_this->data[_this->current_address], burst->data, burst->size);
+  else
+    memcpy(burst->data, &_this->data[_this->current_address], burst->size);
+
+  _this->current_address += burst->size;
+
+  return true;
+}
+
 void Hyperram::cs_sync(void *__this, bool value)
 {
   Hyperram *_this = (Hyperram *)__this;
@@ -163,6 +188,7 @@ int Hyperram::build()
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   in_itf.set_sync_cycle_meth(&Hyperram::sync_cycle);
+  in_itf.set_burst_meth(&Hyperram::burst);
   new_slave_port("input", &in_itf);
 
   cs_itf.set_sync_meth(&Hyperram::cs_sync);
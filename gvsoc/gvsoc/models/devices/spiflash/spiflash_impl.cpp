@@ -115,6 +115,7 @@ private:
 
   static void sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
   static void cs_sync(void *__this, bool active);
+  static bool xfer(void *__this, vp::qspim_xfer *xfer);
 
   void handle_data(int data_0, int data_1, int data_2, int data_3);
   void start_command();
@@ -147,6 +148,9 @@ private:
 
   vp::clock_event *sector_erase_event;
 
+  // When a transaction-level transfer is being handled, where the data sent back must be stored
+  uint8_t *xfer_rx;
+
 };
 
 
@@ -345,14 +349,20 @@ void spiflash::send_bits()
       unsigned int value = (this->pending_word >> 7) & 0x1;
       this->pending_word <<= 1;
       this->trace.msg(vp::trace::LEVEL_TRACE, "Sending single data (data_0: %d)\n", value);
-      this->in_itf.sync(2, 0, value, 0, 0, 2);
+      if (this->xfer_rx)
+        *this->xfer_rx = value << 1;
+      else
+        this->in_itf.sync(2, 0, value, 0, 0, 2);
     }
     else
     {
       unsigned int value = (this->pending_word >> 4) & 0xf;
       this->pending_word <<= 4;
       this->trace.msg(vp::trace::LEVEL_TRACE, "Sending quad data (data_0: %d, data_1: %d, data_2: %d, data_3: %d)\n", (value >> 0) & 1, (value >> 1) & 1, (value >> 2) & 1, (value >> 3) & 1);
-      this->in_itf.sync(2, (value >> 0) & 1, (value >> 1) & 1, (value >> 2) & 1, (value >> 3) & 1, 0xf);
+      if (this->xfer_rx)
+        *this->xfer_rx = value;
+      else
+        this->in_itf.sync(2, (value >> 0) & 1, (value >> 1) & 1, (value >> 2) & 1, (value >> 3) & 1, 0xf);
     }
   }
 }
@@ -431,6 +441,32 @@ void spiflash::sync(void *__this, int sck, int data_0, int data_1, int data_2, i
 }
 
 
+bool spiflash::xfer(void *__this, vp::qspim_xfer *xfer)
+{
+  spiflash *_this = (spiflash *)__this;
+
+  // DDR is only modelled through edge-level syncs
+  if (xfer->ddr)
+    return false;
+
+  _this->trace.msg(vp::trace::LEVEL_TRACE, "Received transfer (nb_cycles: %d, lanes: %d)\n", xfer->nb_cycles, xfer->lanes);
+
+  // Each cycle goes through the same state machine as an edge, except that the
+  // data sent back is stored into the transfer instead of being synced.
+  for (int i=0; i<xfer->nb_cycles; i++)
+  {
+    unsigned int data = xfer->tx_data[i];
+    xfer->rx_data[i] = QSPIM_XFER_UNDRIVEN;
+    _this->xfer_rx = &xfer->rx_data[i];
+    _this->handle_data((data >> 0) & 1, (data >> 1) & 1, (data >> 2) & 1, (data >> 3) & 1);
+  }
+
+  _this->xfer_rx = NULL;
+
+  return true;
+}
+
+
 void spiflash::cs_sync(void *__this, bool active)
 {
   spiflash *_this = (spiflash *)__this;  
@@ -449,6 +485,7 @@ int spiflash::build()
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   this->in_itf.set_sync_meth(&spiflash::sync);
+  this->in_itf.set_xfer_meth(&spiflash::xfer);
   this->new_slave_port("input", &this->in_itf);
 
   this->cs_itf.set_sync_meth(&spiflash::cs_sync);
@@ -475,6 +512,8 @@ int spiflash::build()
 
   this->sr2v.raw = 0;
 
+  this->xfer_rx = NULL;
+
   return 0;
 }
 
@@ -52,7 +52,7 @@ int Gdb_server::register_core(vp::Gdbserver_core *core)
 
 void Gdb_server::signal(vp::Gdbserver_core *core)
 {
-    this->rsp->signal();
+    this->rsp->signal(core);
 }
 
 
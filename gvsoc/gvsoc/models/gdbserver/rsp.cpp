@@ -148,12 +148,15 @@ bool Rsp::send_str(const char *data)
 }
 
 
-bool Rsp::signal()
+bool Rsp::signal(vp::Gdbserver_core *core)
 {
     char str[128];
     int len;
-    
-    auto core = this->top->get_core();
+
+    if (core == NULL)
+    {
+        core = this->top->get_core();
+    }
 
     int state = core->gdbserver_state();
     int signal;
@@ -169,7 +172,21 @@ bool Rsp::signal()
         signal = 17;
     }
 
-    len = snprintf(str, 128, "S%02x", signal);
+    int watch_type;
+    uint64_t watch_addr;
+
+    if (core->gdbserver_watchpoint_hit(&watch_type, &watch_addr))
+    {
+        // Stopped by a watchpoint, gdb expects a trap with the accessed address
+        const char *reason = watch_type == vp::Gdbserver_core::watch_write ? "watch" :
+            watch_type == vp::Gdbserver_core::watch_read ? "rwatch" : "awatch";
+
+        len = snprintf(str, 128, "T05%s:%lx;", reason, watch_addr);
+    }
+    else
+    {
+        len = snprintf(str, 128, "S%02x", signal);
+    }
 
 
 #if 0
@@ -299,6 +316,58 @@ bool Rsp::mem_write(char *data, size_t len)
 }
 
 
+bool Rsp::watchpoint(char *data, size_t len, bool insert)
+{
+    std::string packet(data, len);
+    int type;
+    unsigned long addr;
+    int size;
+
+    if (sscanf(packet.c_str(), "%d,%lx,%d", &type, &addr, &size) != 3)
+    {
+        this->top->trace.msg(vp::trace::LEVEL_ERROR, "Could not parse packet\n");
+        return send_str("E01");
+    }
+
+    // Only data watchpoints are handled here, an empty reply tells gdb
+    // to use software breakpoints instead.
+    if (type < vp::Gdbserver_core::watch_write || type > vp::Gdbserver_core::watch_access)
+    {
+        return send_str("");
+    }
+
+    this->top->trace.msg(vp::trace::LEVEL_DEBUG, "%s watchpoint (type: %d, addr: 0x%lx, size: %d)\n",
+        insert ? "Inserting" : "Removing", type, addr, size);
+
+    // Watchpoints are global to the program, so they are set on all cores
+    int err = 0;
+    this->top->lock();
+    for (auto core: this->top->get_cores())
+    {
+        if (insert)
+            err |= core->gdbserver_watchpoint_insert(type, addr, size);
+        else
+            err |= core->gdbserver_watchpoint_remove(type, addr, size);
+    }
+    if (err && insert)
+    {
+        // Don't leave the watchpoint on the cores which accepted it
+        for (auto core: this->top->get_cores())
+        {
+            core->gdbserver_watchpoint_remove(type, addr, size);
+        }
+    }
+    this->top->unlock();
+
+    if (err)
+    {
+        return send_str(insert ? "" : "E01");
+    }
+
+    return send_str("OK");
+}
+
+
 bool Rsp::multithread(char *data, size_t len)
 {
     int thread_id;
@@ -575,6 +644,11 @@ bool Rsp::decode(char* data, size_t len)
             return ret;
         }
 
+        case 'Z':
+            return this->watchpoint(&data[1], len-1, true);
+
+        case 'z':
+            return this->watchpoint(&data[1], len-1, false);
 
 
     #if 0
@@ -591,12 +665,6 @@ bool Rsp::decode(char* data, size_t len)
         case 'M':
         return mem_write_ascii(&data[1], len-1);
 
-        case 'z':
-        return bp_remove(&data[0], len);
-
-        case 'Z':
-        return bp_insert(&data[0], len);
-
         case 'T':
         return send_str("OK"); // threads are always alive
 
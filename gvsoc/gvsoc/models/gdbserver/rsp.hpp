@@ -27,12 +27,17 @@
 
 class Gdb_server;
 
+namespace vp
+{
+    class Gdbserver_core;
+};
+
 
 class Rsp {
 public:
     Rsp(Gdb_server *top);
     void start(int port);
-    bool signal();
+    bool signal(vp::Gdbserver_core *core=NULL);
 
     void io_access_done(int status);
 
@@ -50,6 +55,7 @@ private:
     bool mem_write(char *data, size_t len);
     bool reg_read(char *data, size_t);
     bool reg_write(char *data, size_t);
+    bool watchpoint(char *data, size_t len, bool insert);
 
     Gdb_server *top;
     int sock;
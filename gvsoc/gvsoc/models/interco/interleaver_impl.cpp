@@ -34,12 +34,15 @@ public:
   int build();
 
   static vp::io_req_status_e req(void *__this, vp::io_req *req);
+  static bool dmi_req(void *__this, vp::io_dmi *dmi);
 
 
   static void grant(void *_this, vp::io_req *req);
 
   static void response(void *_this, vp::io_req *req);
 
+  static void dmi_invalidate(void *_this);
+
 private:
   vp::trace     trace;
 
@@ -130,6 +133,61 @@ vp::io_req_status_e interleaver::req(void *__this, vp::io_req *req)
   return vp::IO_REQ_OK;
 }
 
+bool interleaver::dmi_req(void *__this, vp::io_dmi *dmi)
+{
+  interleaver *_this = (interleaver *)__this;
+  uint64_t offset = dmi->get_addr();
+  uint64_t init_offset = offset;
+
+  // Consecutive addresses are spread over the slaves, so the biggest contiguous
+  // range we can give is the interleaving chunk containing the address.
+  uint64_t port_size = 1<<_this->interleaving_bits;
+  uint64_t chunk_base = offset & ~(port_size - 1);
+  uint64_t chunk_end = chunk_base + port_size - 1;
+
+  offset -= _this->remove_offset;
+
+  int output_id = (offset >> _this->interleaving_bits) & ((1 << _this->stage_bits) - 1);
+  uint64_t new_offset = ((offset & _this->offset_mask) >> _this->stage_bits) + (offset & ((1<<_this->interleaving_bits)-1));
+  uint64_t new_chunk_base = new_offset & ~(port_size - 1);
+
+  if (!_this->out[output_id])
+  {
+    dmi->deny(chunk_base, chunk_end);
+    return false;
+  }
+
+  dmi->set_addr(new_offset);
+
+  bool granted = _this->out[output_id]->get_dmi(dmi);
+
+  if (granted && dmi->get_base() <= new_chunk_base && dmi->get_end() >= new_chunk_base + port_size - 1)
+  {
+    dmi->clip(new_chunk_base, new_chunk_base + port_size - 1);
+    dmi->shift(chunk_base - new_chunk_base);
+  }
+  else
+  {
+    dmi->deny(chunk_base, chunk_end);
+    granted = false;
+  }
+
+  dmi->set_addr(init_offset);
+
+  return granted;
+}
+
+void interleaver::dmi_invalidate(void *__this)
+{
+  interleaver *_this = (interleaver *)__this;
+
+  _this->in.dmi_invalidate();
+  for (int i=0; i<_this->nb_masters; i++)
+  {
+    _this->masters_in[i]->dmi_invalidate();
+  }
+}
+
 void interleaver::grant(void *_this, vp::io_req *req)
 {
 
@@ -144,6 +202,7 @@ int interleaver::build()
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   in.set_req_meth(&interleaver::req);
+  in.set_dmi_meth(&interleaver::dmi_req);
   new_slave_port("input", &in);
 
   nb_slaves = get_config_int("nb_slaves");
@@ -166,6 +225,7 @@ int interleaver::build()
     out[i] = new vp::io_master();
     out[i]->set_resp_meth(&interleaver::response);
     out[i]->set_grant_meth(&interleaver::grant);
+    out[i]->set_dmi_invalidate_meth(&interleaver::dmi_invalidate);
     new_master_port("out_" + std::to_string(i), out[i]);
   }
 
@@ -174,6 +234,7 @@ int interleaver::build()
   {
     masters_in[i] = new vp::io_slave();
     masters_in[i]->set_req_meth(&interleaver::req);
+    masters_in[i]->set_dmi_meth(&interleaver::dmi_req);
     new_slave_port("in_" + std::to_string(i), masters_in[i]);
   }
   return 0;
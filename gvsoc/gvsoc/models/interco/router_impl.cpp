@@ -25,6 +25,8 @@
 #include <vp/proxy.hpp>
 #include <stdio.h>
 #include <math.h>
+#include <vector>
+#include <algorithm>
 
 class router;
 
@@ -56,22 +58,21 @@ public:
 class MapEntry {
 public:
   MapEntry() {}
-  MapEntry(unsigned long long base, MapEntry *left, MapEntry *right);
 
   void insert(router *router);
 
+  inline bool contains(uint64_t offset) { return offset >= base && offset - base < size; }
+
   string target_name;
   MapEntry *next = NULL;
   int id = -1;
   unsigned long long base = 0;
-  unsigned long long lowestBase = 0;
   unsigned long long size = 0;
   unsigned long long remove_offset = 0;
   unsigned long long add_offset = 0;
   uint32_t latency = 0;
   int64_t next_packet_time = 0;
-  MapEntry *left = NULL;
-  MapEntry *right = NULL;
+  Perf_counter *counter = NULL;
   vp::io_slave *port = NULL;
   vp::io_master *itf = NULL;
 };
@@ -93,15 +94,22 @@ public:
   router(js::config *config);
 
   int build();
+  void start();
   std::string handle_command(Gv_proxy *proxy, FILE *req_file, FILE *reply_file, std::vector<std::string> args, std::string req);
 
   static vp::io_req_status_e req(void *__this, vp::io_req *req);
+  static bool dmi_req(void *__this, vp::io_dmi *dmi);
 
 
   static void grant(void *_this, vp::io_req *req);
 
   static void response(void *_this, vp::io_req *req);
 
+  static void dmi_invalidate(void *_this);
+
+  static void link_req(void *__this, void *_req);
+  static void link_resp(void *__this, void *_req);
+
 private:
   vp::trace     trace;
 
@@ -110,17 +118,35 @@ private:
   bool init = false;
 
   void init_entries();
+  vp::io_req_status_e link_post(vp::io_req *req);
+  void link_respond(vp::io_req *req);
+  inline MapEntry *get_entry(uint64_t offset);
+  void get_gap(uint64_t offset, uint64_t *base, uint64_t *end);
+
   MapEntry *firstMapEntry = NULL;
   MapEntry *defaultMapEntry = NULL;
   MapEntry *errorMapEntry = NULL;
-  MapEntry *topMapEntry = NULL;
   MapEntry *externalBindingMapEntry = NULL;
 
+  // Routing table flattened into arrays sorted by base address, the bases are
+  // kept apart so that the binary search only touches contiguous memory.
+  std::vector<uint64_t> entry_bases;
+  std::vector<MapEntry *> entries;
+  // Last entry which was hit, accesses from the same initiator usually go to
+  // the same target several times in a row.
+  // The cached range stops before the next base, so that an entry nested into
+  // this one is still found by the sorted lookup.
+  MapEntry *last_entry = NULL;
+  uint64_t last_entry_base = 0;
+  uint64_t last_entry_end = 0;
+
   std::map<int, Perf_counter *> counters;
 
   int bandwidth = 0;
   int latency = 0;
   vp::io_req proxy_req;
+  // Requests received from other threads in parallel mode, waiting for the target response
+  int nb_link_reqs = 0;
 };
 
 router::router(js::config *config)
@@ -129,13 +155,8 @@ router::router(js::config *config)
 
 }
 
-MapEntry::MapEntry(unsigned long long base, MapEntry *left, MapEntry *right) : next(NULL), base(base), lowestBase(left->lowestBase), left(left), right(right) {
-}
-
 void MapEntry::insert(router *router)
 {
-  lowestBase = base;
-
   if (size != 0) {
     if (port != NULL || itf != NULL) {    
       MapEntry *current = router->firstMapEntry;
@@ -161,10 +182,47 @@ void MapEntry::insert(router *router)
   }
 }
 
+inline MapEntry *router::get_entry(uint64_t offset)
+{
+  if (this->last_entry && offset >= this->last_entry_base && offset <= this->last_entry_end)
+  {
+    return this->last_entry;
+  }
+
+  // Find the last entry whose base is lower or equal to the offset
+  auto it = std::upper_bound(this->entry_bases.begin(), this->entry_bases.end(), offset);
+  if (it == this->entry_bases.begin())
+  {
+    return NULL;
+  }
+
+  MapEntry *entry = this->entries[it - this->entry_bases.begin() - 1];
+  if (!entry->contains(offset))
+  {
+    return NULL;
+  }
+
+  this->last_entry = entry;
+  this->last_entry_base = entry->base;
+  this->last_entry_end = entry->base + entry->size - 1;
+  if (it != this->entry_bases.end() && *it - 1 < this->last_entry_end)
+  {
+    this->last_entry_end = *it - 1;
+  }
+
+  return entry;
+}
+
 vp::io_req_status_e router::req(void *__this, vp::io_req *req)
 {
   router *_this = (router *)__this;
   vp::io_req_status_e result;
+
+  vp::time_engine *engine = _this->get_time_engine();
+  if (unlikely(engine->is_parallel()) && !engine->is_local(_this->get_clock()))
+  {
+    return _this->link_post(req);
+  }
   
   if (!_this->init)
   {
@@ -179,30 +237,20 @@ vp::io_req_status_e router::req(void *__this, vp::io_req *req)
   uint64_t req_offset = offset;
   uint8_t *req_data = data;
 
-  int count = 0;
+  bool isRead = !req->get_is_write();
+
   while (size)
   {
-    MapEntry *entry = _this->topMapEntry;
-    bool isRead = !req->get_is_write();
-
-    _this->trace.msg(vp::trace::LEVEL_TRACE, "Received IO req (offset: 0x%llx, size: 0x%llx, isRead: %d, bandwidth: %d)\n",
-        offset, size, isRead, _this->bandwidth);
-
-    if (entry)
+    // Traces are checked first so that nothing is formatted on the hot path
+    // when they are inactive, and the whole block is removed in optimized builds.
+    if (_this->trace.get_active())
     {
-      while(1) {
-      // The entry does not have any child, this means we are at a final entry
-        if (entry->left == NULL) break;
-
-        if (offset >= entry->base) entry = entry->right;
-        else entry = entry->left;
-      }
-
-      if (entry && (offset < entry->base || offset > entry->base + entry->size - 1)) {
-        entry = NULL;
-      }
+      _this->trace.msg(vp::trace::LEVEL_TRACE, "Received IO req (offset: 0x%llx, size: 0x%llx, isRead: %d, bandwidth: %d)\n",
+          offset, size, isRead, _this->bandwidth);
     }
 
+    MapEntry *entry = _this->get_entry(offset);
+
     if (!entry) {
       if (_this->errorMapEntry && offset >= _this->errorMapEntry->base && offset + size - 1 <= _this->errorMapEntry->base + _this->errorMapEntry->size - 1) {
       } else {
@@ -215,10 +263,13 @@ vp::io_req_status_e router::req(void *__this, vp::io_req *req)
       return vp::IO_REQ_INVALID;
     }
 
-    if (entry == _this->defaultMapEntry) {
-      _this->trace.msg(vp::trace::LEVEL_TRACE, "Routing to default entry (target: %s)\n", entry->target_name.c_str());
-    } else {
-      _this->trace.msg(vp::trace::LEVEL_TRACE, "Routing to entry (target: %s)\n", entry->target_name.c_str());
+    if (_this->trace.get_active())
+    {
+      if (entry == _this->defaultMapEntry) {
+        _this->trace.msg(vp::trace::LEVEL_TRACE, "Routing to default entry (target: %s)\n", entry->target_name.c_str());
+      } else {
+        _this->trace.msg(vp::trace::LEVEL_TRACE, "Routing to entry (target: %s)\n", entry->target_name.c_str());
+      }
     }
     
     if (!req->is_debug())
@@ -300,7 +351,7 @@ vp::io_req_status_e router::req(void *__this, vp::io_req *req)
       int64_t duration = req->get_duration();
       if (duration > 1) latency += duration - 1;
 
-      Perf_counter *counter = _this->counters[entry->id];
+      Perf_counter *counter = entry->counter;
 
       if (isRead)
         counter->read_stalls += latency;
@@ -329,6 +380,120 @@ vp::io_req_status_e router::req(void *__this, vp::io_req *req)
   return result;
 }
 
+void router::get_gap(uint64_t offset, uint64_t *base, uint64_t *end)
+{
+  auto it = std::upper_bound(this->entry_bases.begin(), this->entry_bases.end(), offset);
+
+  *end = it == this->entry_bases.end() ? (uint64_t)-1 : *it - 1;
+
+  *base = 0;
+  if (it != this->entry_bases.begin())
+  {
+    MapEntry *prev = this->entries[it - this->entry_bases.begin() - 1];
+    *base = prev->base + prev->size;
+  }
+}
+
+bool router::dmi_req(void *__this, vp::io_dmi *dmi)
+{
+  router *_this = (router *)__this;
+
+  // Targets simulated by another thread can only be accessed with requests
+  vp::time_engine *engine = _this->get_time_engine();
+  if (unlikely(engine->is_parallel()) && !engine->is_local(_this->get_clock()))
+  {
+    dmi->deny(0, (uint64_t)-1);
+    return false;
+  }
+
+  if (!_this->init)
+  {
+    _this->init = true;
+    _this->init_entries();
+  }
+
+  uint64_t offset = dmi->get_addr();
+  MapEntry *entry = _this->get_entry(offset);
+  uint64_t entry_base, entry_end;
+
+  if (entry)
+  {
+    // Range of the entry where it is actually selected, excluding nested entries
+    entry_base = _this->last_entry_base;
+    entry_end = _this->last_entry_end;
+  }
+  else
+  {
+    // The address is between mapped entries, the range which can be given is
+    // the gap between them, restricted to either the error entry or what is around.
+    _this->get_gap(offset, &entry_base, &entry_end);
+
+    MapEntry *error = _this->errorMapEntry;
+    if (error && error->contains(offset))
+    {
+      uint64_t error_end = error->base + error->size - 1;
+      dmi->deny(std::max(entry_base, (uint64_t)error->base), std::min(entry_end, error_end));
+      return false;
+    }
+
+    if (error && error->size)
+    {
+      uint64_t error_end = error->base + error->size - 1;
+      if (error->base > offset && error->base <= entry_end)
+        entry_end = error->base - 1;
+      if (error_end < offset && error_end >= entry_base)
+        entry_base = error_end + 1;
+    }
+
+    entry = _this->defaultMapEntry;
+
+    // The address translation of the default entry may not be valid on the whole gap
+    if (!entry || entry->remove_offset || entry->add_offset)
+    {
+      dmi->deny(entry_base, entry_end);
+      return false;
+    }
+  }
+
+  // Bandwidth and performance counters must see every access, as well as
+  // traces, so the access is denied on the whole entry in these cases.
+  // Bandwidth is fine if the master is modeling the timing by itself.
+  if ((_this->bandwidth != 0 && !dmi->get_master_timing()) || entry->id != -1 || _this->trace.get_active() ||
+    (entry->itf && !entry->itf->is_bound()))
+  {
+    dmi->deny(entry_base, entry_end);
+    return false;
+  }
+
+  int64_t addr_offset = entry->add_offset - entry->remove_offset;
+  dmi->set_addr(offset + addr_offset);
+
+  bool granted = false;
+  if (entry->port)
+  {
+    granted = _this->out.get_dmi(dmi, entry->port);
+  }
+  else if (entry->itf)
+  {
+    granted = entry->itf->get_dmi(dmi);
+  }
+
+  // Convert the range returned by the target into our address space and restrict
+  // it to the entry, since other addresses may go somewhere else.
+  dmi->clip(entry_base + addr_offset, entry_end + addr_offset);
+  dmi->shift(-addr_offset);
+  dmi->set_addr(offset);
+  dmi->inc_latency(entry->latency + _this->latency);
+
+  return granted;
+}
+
+void router::dmi_invalidate(void *__this)
+{
+  router *_this = (router *)__this;
+  _this->in.dmi_invalidate();
+}
+
 void router::grant(void *__this, vp::io_req *req)
 {
   router *_this = (router *)__this;
@@ -342,11 +507,95 @@ void router::grant(void *__this, vp::io_req *req)
   req->arg_push(port);
 }
 
-void router::response(void *_this, vp::io_req *req)
+void router::response(void *__this, vp::io_req *req)
 {
+  router *_this = (router *)__this;
+
   vp::io_slave *port = (vp::io_slave *)req->arg_pop();
   if (port != NULL)
     port->resp(req);
+  else if (_this->nb_link_reqs && req->arg_get_last() != req->get_args() && *req->arg_get() == _this)
+  {
+    _this->nb_link_reqs--;
+    _this->link_respond(req);
+  }
+}
+
+
+/*
+ * Parallel mode
+ *
+ * When the router has a latency, it is a link between clock domains, which can be
+ * simulated by different threads. A request received from another thread is posted
+ * to the thread of the router, half of the router latency later. It is routed there
+ * and the response is posted back to the initiator, at the time the router and target
+ * latencies give, so that the initiator sees the same timing as in sequential mode.
+ * The response is never posted before half of the router latency, so the lookahead
+ * of the engine is half of the smallest latency.
+ */
+
+vp::io_req_status_e router::link_post(vp::io_req *req)
+{
+  vp::time_engine *engine = this->get_time_engine();
+  int64_t time = engine->get_time();
+
+  req->arg_push((void *)time);
+  req->arg_push(engine->get_current_client());
+  req->arg_push(req->resp_port);
+
+  engine->parallel_post(this->get_clock(), time + engine->get_parallel_lookahead(), &router::link_req, this, req);
+
+  return vp::IO_REQ_PENDING;
+}
+
+void router::link_req(void *__this, void *_req)
+{
+  router *_this = (router *)__this;
+  vp::io_req *req = (vp::io_req *)_req;
+
+  _this->get_clock()->sync();
+
+  // The target response is recognized from the router on top of the arguments
+  req->resp_port = NULL;
+  req->arg_push(_this);
+
+  vp::io_req_status_e result = router::req(_this, req);
+
+  if (result == vp::IO_REQ_PENDING)
+  {
+    _this->nb_link_reqs++;
+  }
+  else
+  {
+    req->status = result;
+    _this->link_respond(req);
+  }
+}
+
+void router::link_respond(vp::io_req *req)
+{
+  vp::time_engine *engine = this->get_time_engine();
+
+  // A synchronous response can leave arguments of the routing on top of ours
+  while (*req->arg_get() != this)
+    req->arg_pop();
+
+  req->arg_pop();
+  req->resp_port = (vp::io_slave *)req->arg_pop();
+  vp::time_engine_client *initiator = (vp::time_engine_client *)req->arg_pop();
+  int64_t time = (int64_t)req->arg_pop();
+
+  // The latency is now simulated by the time of the response
+  time += req->get_latency() * this->get_clock()->get_period();
+  req->set_latency(0);
+
+  engine->parallel_post(initiator, time, &router::link_resp, this, req);
+}
+
+void router::link_resp(void *__this, void *_req)
+{
+  vp::io_req *req = (vp::io_req *)_req;
+  req->get_resp_port()->resp(req);
 }
 
 
@@ -393,17 +642,32 @@ std::string router::handle_command(Gv_proxy *proxy, FILE *req_file, FILE *reply_
 }
 
 
+void router::start()
+{
+  // The latency lets the router delay requests from other clock domains in parallel mode
+  if (this->latency > 0)
+  {
+    this->get_time_engine()->register_parallel_link(&this->in, this->latency);
+  }
+}
+
+
 int router::build()
 {
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   in.set_req_meth(&router::req);
+  in.set_dmi_meth(&router::dmi_req);
   new_slave_port("input", &in);
 
   out.set_resp_meth(&router::response);
   out.set_grant_meth(&router::grant);
+  out.set_dmi_invalidate_meth(&router::dmi_invalidate);
   new_master_port("out", &out);
 
+  // Direct accesses are denied when traces are active, drop them when it changes
+  this->trace.register_callback(std::bind(&router::dmi_invalidate, (void *)this));
+
   bandwidth = get_config_int("bandwidth");
   latency = get_config_int("latency");
 
@@ -425,6 +689,7 @@ int router::build()
 
       itf->set_resp_meth(&router::response);
       itf->set_grant_meth(&router::grant);
+      itf->set_dmi_invalidate_meth(&router::dmi_invalidate);
       new_master_port(mapping.first, itf);
 
       if (mapping.first == "error")
@@ -472,6 +737,8 @@ int router::build()
         new_slave_port((void *)counter, "stalls[" + std::to_string(entry->id) + "]", &counter->stalls_itf);
       }  
 
+      entry->counter = this->counters[entry->id];
+
       entry->insert(this);
     }
   }
@@ -503,52 +770,12 @@ void router::init_entries() {
     trace.msg(vp::trace::LEVEL_INFO, "       -     :      -     -> %s\n", defaultMapEntry->target_name.c_str());
   }
 
-  MapEntry *firstInLevel = firstMapEntry;
-
-  // Loop until we merged everything into a single entry
-  // Start with the routing table entries
-  current = firstMapEntry;
-
-  // The first loop is here to loop until we have merged everything to a single entry
-  while(1) {
-
-    // Gives the map entry that should be on the left side of the next created entry
-    MapEntry *left = NULL;
-
-    // Gives the last allocated entry where the entry should be inserted
-    MapEntry *currentInLevel=NULL;
-
-    // The second loop is iterating on a single level to merge entries 2 by 2
-    while(current) {
-      if (left == NULL) left = current;
-      else {
-
-        MapEntry *entry = new MapEntry(current->lowestBase, left, current);
-
-        left = NULL;
-        if (currentInLevel) {
-          currentInLevel->next = entry;
-        } else {
-          firstInLevel = entry;
-        }
-        currentInLevel = entry;
-      }
-
-      current = current->next;
-    }
-
-    current = firstInLevel;
-
-    // Stop in case we got a single entry
-    if (currentInLevel == NULL) break;
-
-    // In case an entry is alone, insert it at the end, it will be merged with an upper entry
-    if (left != NULL) {
-      currentInLevel->next = left;
-    }
+  // The entries are already sorted by base address, just flatten them
+  for (current = firstMapEntry; current; current = current->next)
+  {
+    this->entry_bases.push_back(current->base);
+    this->entries.push_back(current);
   }
-
-  topMapEntry = firstInLevel;
 }
 
 inline void io_master_map::bind_to(vp::port *_port, vp::config *config)
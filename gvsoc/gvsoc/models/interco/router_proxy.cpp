@@ -102,6 +102,8 @@ void Router_proxy::response(void *__this, vp::io_req *req)
     gv::Io_request *io_req = (gv::Io_request *)req->arg_pop();
     io_req->retval = req->status == vp::IO_REQ_INVALID ? gv::Io_request_ko : gv::Io_request_ok;
 
+    _this->out.req_del(req);
+
     _this->user->reply(io_req);
 }
 
@@ -125,12 +127,7 @@ void Router_proxy::reply(gv::Io_request *io_req)
 void Router_proxy::access(gv::Io_request *io_req)
 {
     this->get_time_engine()->lock();
-    vp::io_req *req = new vp::io_req();
-    req->init();
-    req->set_addr(io_req->addr);
-    req->set_size(io_req->size);
-    req->set_is_write(io_req->is_write);
-    req->set_data(io_req->data);
+    vp::io_req *req = this->out.req_new(io_req->addr, io_req->data, io_req->size, io_req->is_write);
     req->arg_push(io_req);
 
     int err = this->out.req(req);
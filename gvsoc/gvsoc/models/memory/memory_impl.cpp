@@ -24,6 +24,20 @@
 #include <vp/itf/wire.hpp>
 #include <stdio.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <vector>
+#include <algorithm>
+
+#define MEMORY_CHECKPOINT_PAGE_SIZE 4096
+
+// Value used to initialize the memory to detect uninitialized variables
+#define MEMORY_FILL_PATTERN 0x57
+// Size of the file containing the fill pattern, which is mapped as many
+// times as needed to cover the memory
+#define MEMORY_PATTERN_CHUNK_SIZE (2*1024*1024)
 
 class memory : public vp::component
 {
@@ -34,13 +48,24 @@ public:
 
   int build();
   void start();
+  void stop();
   void reset(bool active);
+  void checkpoint_state(vp::checkpoint *cp);
 
   static vp::io_req_status_e req(void *__this, vp::io_req *req);
+  static bool dmi_req(void *__this, vp::io_dmi *dmi);
 
 private:
 
   static void power_ctrl_sync(void *__this, bool value);
+  void dmi_invalidate();
+  uint8_t *alloc_data();
+  void fill_data();
+  int load_stim_file(std::string path);
+  int get_written_pages(std::vector<bool> *written);
+  int64_t get_footprint();
+  int checkpoint_save_data(std::string path, std::vector<uint8_t> *pages);
+  int checkpoint_restore_data(std::string path, std::vector<uint8_t> *pages);
 
   vp::trace     trace;
   vp::io_slave in;
@@ -51,6 +76,9 @@ private:
 
   uint8_t *mem_data;
   uint8_t *check_mem;
+  size_t mapped_size;
+  // Size of the part of the memory which is mapped from the stim file
+  size_t stim_mapped_size = 0;
 
   int64_t next_packet_start;
 
@@ -181,19 +209,195 @@ vp::io_req_status_e memory::req(void *__this, vp::io_req *req)
   return vp::IO_REQ_OK;
 }
 
+bool memory::dmi_req(void *__this, vp::io_dmi *dmi)
+{
+  memory *_this = (memory *)__this;
+
+  // Direct accesses are only granted when the memory has nothing to model
+  // on each access, otherwise accesses must go through normal requests.
+  // Bandwidth is fine if the master is modeling the timing by itself.
+  if (!_this->powered_up || _this->check_mem || (_this->width_bits != 0 && !dmi->get_master_timing()) ||
+    _this->power_trigger || _this->power.get_power_trace()->get_active() ||
+    _this->trace.get_active())
+  {
+    dmi->deny(0, _this->size - 1);
+    return false;
+  }
+
+  _this->trace.msg(vp::trace::LEVEL_DEBUG, "Granting direct memory access (addr: 0x%lx)\n", dmi->get_addr());
+
+  dmi->set_range(0, _this->size - 1);
+  dmi->set_mem(_this->mem_data);
+
+  return true;
+}
+
+void memory::dmi_invalidate()
+{
+  this->in.dmi_invalidate();
+}
+
 void memory::reset(bool active)
 {
   if (active)
   {
     this->next_packet_start = 0;
     this->powered_up = true;
+    this->dmi_invalidate();
+  }
+}
+
+void memory::checkpoint_state(vp::checkpoint *cp)
+{
+  cp->sync(&this->powered_up);
+  cp->sync(&this->next_packet_start);
+  cp->sync(&this->last_access_timestamp);
+
+  if (this->check_mem)
+  {
+    cp->sync(this->check_mem, (this->size + 7) / 8);
+  }
+
+  // The memory content is stored in a separate raw image so that it can be
+  // mapped by external tools. Only the pages which differ from the fill pattern
+  // are stored, the others are left as holes of a sparse file. The fill byte and
+  // the bitmap of stored pages are kept in the checkpoint itself.
+  std::string path = cp->get_file_path(this, "mem");
+  uint8_t fill = MEMORY_FILL_PATTERN;
+  uint64_t nb_pages = (this->size + MEMORY_CHECKPOINT_PAGE_SIZE - 1) / MEMORY_CHECKPOINT_PAGE_SIZE;
+  std::vector<uint8_t> pages((nb_pages + 7) / 8);
+
+  cp->sync(&fill);
+
+  if (cp->is_restore())
+  {
+    cp->sync(pages.data(), pages.size());
+
+    if (fill != MEMORY_FILL_PATTERN)
+    {
+      cp->error("Memory checkpoint has a different fill pattern (" + std::to_string(fill) + ")");
+    }
+    else if (this->checkpoint_restore_data(path, &pages))
+    {
+      cp->error("Failed to restore memory from " + path + ": " + strerror(errno));
+    }
+    this->dmi_invalidate();
+  }
+  else
+  {
+    if (this->checkpoint_save_data(path, &pages))
+    {
+      cp->error("Failed to save memory to " + path + ": " + strerror(errno));
+    }
+
+    cp->sync(pages.data(), pages.size());
   }
 }
 
+int memory::checkpoint_save_data(std::string path, std::vector<uint8_t> *pages)
+{
+  static const uint8_t zero_page[MEMORY_CHECKPOINT_PAGE_SIZE] = { 0 };
+  static uint8_t fill_page[MEMORY_CHECKPOINT_PAGE_SIZE] = { 0 };
+
+  if (fill_page[0] != MEMORY_FILL_PATTERN)
+  {
+    memset(fill_page, MEMORY_FILL_PATTERN, MEMORY_CHECKPOINT_PAGE_SIZE);
+  }
+
+  // Host pages which have never been written still come from the pattern file,
+  // they can be skipped without reading them. If this information is not
+  // available, all pages are compared to the pattern.
+  size_t host_page_size = sysconf(_SC_PAGESIZE);
+  std::vector<bool> written;
+  bool has_written = this->get_written_pages(&written) == 0;
+
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return -1;
+
+  int err = ftruncate(fd, this->size);
+
+  for (uint64_t offset = 0; err == 0 && offset < this->size; offset += MEMORY_CHECKPOINT_PAGE_SIZE)
+  {
+    if (has_written && offset >= this->stim_mapped_size && !written[offset / host_page_size])
+      continue;
+
+    uint64_t page_size = std::min((uint64_t)MEMORY_CHECKPOINT_PAGE_SIZE, this->size - offset);
+    uint8_t *page = &this->mem_data[offset];
+
+    if (memcmp(page, fill_page, page_size) == 0)
+      continue;
+
+    uint64_t index = offset / MEMORY_CHECKPOINT_PAGE_SIZE;
+    (*pages)[index / 8] |= 1 << (index % 8);
+
+    // Pages full of zeros are holes as well, they read back as zeros
+    if (memcmp(page, zero_page, page_size) != 0)
+    {
+      if (pwrite(fd, page, page_size, offset) != (ssize_t)page_size)
+        err = -1;
+    }
+  }
+
+  close(fd);
+
+  return err;
+}
+
+int memory::checkpoint_restore_data(std::string path, std::vector<uint8_t> *pages)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return -1;
+
+  // Go back to an untouched memory so that only the stored pages get allocated
+  this->fill_data();
+
+  int err = 0;
+  uint64_t nb_pages = (this->size + MEMORY_CHECKPOINT_PAGE_SIZE - 1) / MEMORY_CHECKPOINT_PAGE_SIZE;
+  uint64_t index = 0;
+
+  while (err == 0 && index < nb_pages)
+  {
+    if (!(((*pages)[index / 8] >> (index % 8)) & 1))
+    {
+      index++;
+      continue;
+    }
+
+    // Read consecutive stored pages at once
+    uint64_t last = index + 1;
+    while (last < nb_pages && (((*pages)[last / 8] >> (last % 8)) & 1))
+    {
+      last++;
+    }
+
+    uint64_t offset = index * MEMORY_CHECKPOINT_PAGE_SIZE;
+    uint64_t end = std::min(last * MEMORY_CHECKPOINT_PAGE_SIZE, this->size);
+    while (offset < end)
+    {
+      ssize_t read_size = pread(fd, &this->mem_data[offset], end - offset, offset);
+      if (read_size <= 0)
+      {
+        err = -1;
+        break;
+      }
+      offset += read_size;
+    }
+
+    index = last;
+  }
+
+  close(fd);
+
+  return err;
+}
+
 void memory::power_ctrl_sync(void *__this, bool value)
 {
     memory *_this = (memory *)__this;
     _this->powered_up = value;
+    _this->dmi_invalidate();
 }
 
 
@@ -201,8 +405,13 @@ int memory::build()
 {
   traces.new_trace("trace", &trace, vp::DEBUG);
   in.set_req_meth(&memory::req);
+  in.set_dmi_meth(&memory::dmi_req);
   new_slave_port("input", &in);
 
+  // Direct accesses depend on the trace states, drop them when they change
+  this->trace.register_callback(std::bind(&memory::dmi_invalidate, this));
+  this->power.get_power_trace()->register_callback(std::bind(&memory::dmi_invalidate, this));
+
   this->power_ctrl_itf.set_sync_meth(&memory::power_ctrl_sync);
   new_slave_port("power_ctrl", &this->power_ctrl_itf);
 
@@ -220,6 +429,201 @@ int memory::build()
   return 0;
 }
 
+// Returns a file filled with the memory pattern, shared by all memories
+// of the process, or -1 if it could not be created.
+static int memory_pattern_fd()
+{
+  static int fd = -2;
+
+  if (fd == -2)
+  {
+    fd = memfd_create("gvsoc_memory_pattern", 0);
+    if (fd >= 0)
+    {
+      void *pattern = MAP_FAILED;
+      if (ftruncate(fd, MEMORY_PATTERN_CHUNK_SIZE) == 0)
+      {
+        pattern = mmap(NULL, MEMORY_PATTERN_CHUNK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      }
+
+      if (pattern == MAP_FAILED)
+      {
+        close(fd);
+        fd = -1;
+      }
+      else
+      {
+        memset(pattern, MEMORY_FILL_PATTERN, MEMORY_PATTERN_CHUNK_SIZE);
+        munmap(pattern, MEMORY_PATTERN_CHUNK_SIZE);
+      }
+    }
+  }
+
+  return fd;
+}
+
+uint8_t *memory::alloc_data()
+{
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  this->mapped_size = (this->size + page_size - 1) & ~(page_size - 1);
+
+  // Host pages are only allocated when they are written
+  uint8_t *data = (uint8_t *)mmap(NULL, this->mapped_size, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (data == MAP_FAILED)
+  {
+    return NULL;
+  }
+
+  this->mem_data = data;
+  this->fill_data();
+
+  return data;
+}
+
+void memory::fill_data()
+{
+  // Initialize the memory with a special value to detect uninitialized
+  // variables. The pattern file is mapped copy-on-write so that pages which
+  // are only read share the same host pages. This also drops the pages
+  // previously written.
+  int fd = memory_pattern_fd();
+  if (fd >= 0)
+  {
+    for (size_t offset = 0; offset < this->mapped_size; offset += MEMORY_PATTERN_CHUNK_SIZE)
+    {
+      size_t chunk_size = std::min((size_t)MEMORY_PATTERN_CHUNK_SIZE, this->mapped_size - offset);
+      if (mmap(this->mem_data + offset, chunk_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+      {
+        fd = -1;
+        break;
+      }
+    }
+  }
+
+  if (fd < 0)
+  {
+    memset(this->mem_data, MEMORY_FILL_PATTERN, this->size);
+  }
+
+  this->stim_mapped_size = 0;
+}
+
+int memory::load_stim_file(std::string path)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return -1;
+  }
+
+  struct stat stat;
+  if (fstat(fd, &stat) != 0 || stat.st_size == 0)
+  {
+    close(fd);
+    return -1;
+  }
+
+  uint64_t load_size = std::min((uint64_t)stat.st_size, this->size);
+
+  // The page-aligned part of the file is mapped copy-on-write, so that it is
+  // only read when it is accessed and shared with the page cache until it
+  // is written.
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  uint64_t map_size = load_size & ~(page_size - 1);
+  if (map_size > 0)
+  {
+    if (mmap(this->mem_data, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+      map_size = 0;
+    }
+  }
+  this->stim_mapped_size = map_size;
+
+  uint64_t offset = map_size;
+  while (offset < load_size)
+  {
+    ssize_t read_size = pread(fd, &this->mem_data[offset], load_size - offset, offset);
+    if (read_size <= 0)
+    {
+      close(fd);
+      return -1;
+    }
+    offset += read_size;
+  }
+
+  close(fd);
+
+  return 0;
+}
+
+int memory::get_written_pages(std::vector<bool> *written)
+{
+  // The pages which have been written are the ones present in host memory, or
+  // swapped, and not backed by a file anymore.
+  int fd = open("/proc/self/pagemap", O_RDONLY);
+  if (fd < 0)
+  {
+    return -1;
+  }
+
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  uint64_t first_page = (uint64_t)this->mem_data / page_size;
+  uint64_t nb_pages = this->mapped_size / page_size;
+  uint64_t entries[512];
+  int err = 0;
+
+  written->assign(nb_pages, false);
+
+  for (uint64_t page = 0; page < nb_pages; page += 512)
+  {
+    uint64_t nb_entries = std::min((uint64_t)512, nb_pages - page);
+    ssize_t read_size = pread(fd, entries, nb_entries * sizeof(uint64_t), (first_page + page) * sizeof(uint64_t));
+    if (read_size != (ssize_t)(nb_entries * sizeof(uint64_t)))
+    {
+      err = -1;
+      break;
+    }
+
+    for (uint64_t i = 0; i < nb_entries; i++)
+    {
+      bool present = (entries[i] >> 63) & 1;
+      bool swapped = (entries[i] >> 62) & 1;
+      bool file_page = (entries[i] >> 61) & 1;
+      (*written)[page + i] = (present || swapped) && !file_page;
+    }
+  }
+
+  close(fd);
+
+  return err;
+}
+
+int64_t memory::get_footprint()
+{
+  std::vector<bool> written;
+  if (this->get_written_pages(&written))
+  {
+    return -1;
+  }
+
+  int64_t nb_written = std::count(written.begin(), written.end(), true);
+
+  return nb_written * sysconf(_SC_PAGESIZE);
+}
+
+void memory::stop()
+{
+  if (this->trace.get_active())
+  {
+    int64_t footprint = this->get_footprint();
+    if (footprint >= 0)
+    {
+      this->trace.msg(vp::trace::LEVEL_INFO, "Memory footprint (size: 0x%lx, touched: 0x%lx)\n", this->size, footprint);
+    }
+  }
+}
+
 void memory::start()
 {
   size = get_config_int("size");
@@ -228,13 +632,23 @@ void memory::start()
 
   trace.msg("Building memory (size: 0x%x, check: %d)\n", size, check);
 
-  mem_data = new uint8_t[size];
+  if (this->alloc_data() == NULL)
+  {
+    this->trace.fatal("Failed to allocate memory (size: 0x%lx): %s\n", size, strerror(errno));
+    return;
+  }
 
 
   // Special option to check for uninitialized accesses
   if (check)
   {
-    check_mem = new uint8_t[(size + 7)/8];
+    check_mem = (uint8_t *)mmap(NULL, (size + 7)/8, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (check_mem == MAP_FAILED)
+    {
+      this->trace.fatal("Failed to allocate memory check bitmap (size: 0x%lx): %s\n", size, strerror(errno));
+      return;
+    }
   }
   else
   {
@@ -242,11 +656,6 @@ void memory::start()
   }
 
 
-  // Initialize the memory with a special value to detect uninitialized
-  // variables
-  memset(mem_data, 0x57, size);
-
-
   // Preload the memory
   js::config *stim_file_conf = this->get_js_config()->get("stim_file");
   if (stim_file_conf != NULL)
@@ -256,13 +665,7 @@ void memory::start()
     {
       trace.msg("Preloading memory with stimuli file (path: %s)\n", path.c_str());
 
-      FILE *file = fopen(path.c_str(), "rb");
-      if (file == NULL)
-      {
-        this->trace.fatal("Unable to open stim file: %s, %s\n", path.c_str(), strerror(errno));
-        return;
-      }
-      if (fread(this->mem_data, 1, size, file) == 0)
+      if (this->load_stim_file(path))
       {
         this->trace.fatal("Failed to read stim file: %s, %s\n", path.c_str(), strerror(errno));
         return;
@@ -273,6 +676,10 @@ void memory::start()
   this->background_power.leakage_power_start();
   this->background_power.dynamic_power_start();
   this->last_access_timestamp = -1;
+
+  // The memory has just been allocated, masters may have been denied the
+  // access before
+  this->dmi_invalidate();
 }
 
 extern "C" vp::component *vp_constructor(js::config *config)
@@ -76,16 +76,17 @@ void loader::response(void *__this, vp::io_req *req)
 {
   loader *_this = (loader *)__this;
   _this->pending_reqs.pop_front();
-  delete req->get_data();
   _this->out.req_del(req);
 
   while(1)
   {
     if (_this->pending_reqs.empty()) break;
 
-    if (_this->send_req(_this->pending_reqs.front())) break;
+    vp::io_req *req = _this->pending_reqs.front();
+    if (_this->send_req(req)) break;
 
     _this->pending_reqs.pop_front();
+    _this->out.req_del(req);
   }
 }
 
@@ -106,11 +107,10 @@ void loader::start()
 
 void loader::do_io_req(uint64_t addr, uint64_t size, bool is_write, uint8_t *data)
 {
-
-  void *req_data = new uint8_t[size];
-  memcpy(req_data, data, size);
-
-  vp::io_req *req = out.req_new(addr, (uint8_t *)req_data, size, is_write);
+  // The request is allocated with its own buffer, which is recycled with it,
+  // since it may be kept pending after we return
+  vp::io_req *req = out.req_new(addr, size, is_write);
+  memcpy(req->get_data(), data, size);
 
   if (!this->pending_reqs.empty())
   {
@@ -122,6 +122,10 @@ void loader::do_io_req(uint64_t addr, uint64_t size, bool is_write, uint8_t *dat
     {
       this->pending_reqs.push_back(req);
     }
+    else
+    {
+      this->out.req_del(req);
+    }
   }
 }
 
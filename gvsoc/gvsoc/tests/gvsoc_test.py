@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Runs a test platform with the launcher from the build tree.
+#
+# The models used by the platform are given with their module name and the
+# path of the built module. They are linked into a temporary directory with
+# the same layout as an installed GVSOC_PATH, so that nothing needs to be
+# installed.
+# Properties of the configuration can be overridden with --set, and the
+# output can be checked against regular expressions with --expect.
+#
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+
+def set_property(config, path, value):
+    items = path.split('/')
+    for item in items[:-1]:
+        config = config.setdefault(item, {})
+    config[items[-1]] = json.loads(value)
+
+
+def run(args):
+    with open(args.config) as file:
+        config = json.load(file)
+
+    for prop in args.set:
+        path, value = prop.split('=', 1)
+        set_property(config, path, value)
+
+    with tempfile.TemporaryDirectory(prefix='gvsoc_test_') as work_dir:
+
+        models_dir = os.path.join(work_dir, 'models')
+
+        for model in args.model:
+            name, path = model.split('=', 1)
+            model_path = os.path.join(models_dir, name.replace('.', '/') + '.so')
+            os.makedirs(os.path.dirname(model_path), exist_ok=True)
+            os.symlink(os.path.abspath(path), model_path)
+
+        config_path = os.path.join(work_dir, 'config.json')
+        with open(config_path, 'w') as file:
+            json.dump(config, file, indent=2)
+
+        env = os.environ.copy()
+        env['GVSOC_PATH'] = models_dir
+        env['GVSOC_TEST_DIR'] = work_dir
+
+        proc = subprocess.run([args.launcher, '--config=' + config_path] + args.args,
+            cwd=work_dir, env=env, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+            universal_newlines=True)
+
+        sys.stdout.write(proc.stdout)
+
+        if proc.returncode != 0:
+            print('Test failed with status %d' % proc.returncode)
+            return 1
+
+        for expect in args.expect:
+            if re.search(expect, proc.stdout, re.MULTILINE) is None:
+                print('Test output does not match: %s' % expect)
+                return 1
+
+    return 0
+
+
+parser = argparse.ArgumentParser(description='Run a GVSOC test platform')
+
+parser.add_argument('--launcher', required=True, help='path to the GVSOC launcher')
+parser.add_argument('--config', required=True, help='JSON configuration of the platform')
+parser.add_argument('--model', action='append', default=[],
+    help='model used by the platform, as <module name>=<module path>')
+parser.add_argument('--set', action='append', default=[],
+    help='override a configuration property, as <path>=<JSON value>')
+parser.add_argument('--expect', action='append', default=[],
+    help='regular expression which must match the output')
+parser.add_argument('args', nargs='*', help='extra launcher arguments')
+
+sys.exit(run(parser.parse_args()))
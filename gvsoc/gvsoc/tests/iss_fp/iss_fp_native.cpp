@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks that the native floating-point path of the ISS is bit-exact with
+ * flexfloat, for all the operations it handles, on binary32 and binary16.
+ *
+ * Operands are random, biased toward special values: zeros, infinities, quiet
+ * and signaling NaNs with payloads, subnormals, the smallest and largest
+ * normals and values close to them, so that cancellations, overflows and
+ * underflows are all covered. Both the result and the flags must match.
+ * Operations falling back to flexfloat are counted but not compared.
+ */
+
+#include "iss.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NB_ITERATIONS 1000000
+#define MAX_REPORTED_ERRORS 10
+
+typedef enum
+{
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_SQRT,
+    OP_MADD,
+    OP_MSUB,
+    OP_NMADD,
+    OP_NMSUB,
+    NB_OPS
+} fp_op_e;
+
+static const char *op_names[] = { "add", "sub", "mul", "div", "sqrt", "madd", "msub", "nmadd", "nmsub" };
+
+static uint64_t rand_state = 0x123456789abcdefULL;
+
+
+static uint32_t rand32()
+{
+    // xorshift64*, so that results do not depend on the host libc
+    rand_state ^= rand_state >> 12;
+    rand_state ^= rand_state << 25;
+    rand_state ^= rand_state >> 27;
+    return (rand_state * 0x2545f4914f6cdd1dULL) >> 32;
+}
+
+
+static unsigned int gen_operand(uint8_t e, uint8_t m)
+{
+    uint32_t sign = (rand32() & 1) << (e + m);
+    uint32_t exp_max = (1 << e) - 1;
+    uint32_t frac_mask = (1 << m) - 1;
+    uint32_t frac = rand32() & frac_mask;
+    uint32_t exp;
+
+    switch (rand32() % 16)
+    {
+        case 0: exp = 0; frac = 0; break;                                     // Zero
+        case 1: exp = exp_max; frac = 0; break;                               // Infinity
+        case 2: exp = exp_max; frac |= 1 << (m - 1); break;                   // Quiet NaN
+        case 3: exp = exp_max; frac = (frac >> 1) | 1; break;                 // Signaling NaN
+        case 4: exp = 0; frac |= 1; break;                                    // Subnormal
+        case 5: exp = 0; frac = rand32() & 1 ? 1 : frac_mask; break;          // Subnormal bounds
+        case 6: exp = 1 + rand32() % 2; break;                                // Smallest normals
+        case 7: exp = exp_max - 1 - rand32() % 2; break;                      // Largest normals
+        case 8: exp = (exp_max >> 1) + rand32() % 3 - 1; frac &= 0xf; break; // Close to 1
+        default: exp = rand32() % (exp_max + 1); break;
+    }
+
+    return DoExtend(sign | (exp << m) | frac, e, m);
+}
+
+
+static bool native_op(iss_cpu_state_t *s, fp_op_e op, unsigned int a, unsigned int b, unsigned int c, uint8_t e, uint8_t m, unsigned int *result)
+{
+    switch (op)
+    {
+        case OP_ADD:   return lib_ff_native_add(s, a, b, e, m, result);
+        case OP_SUB:   return lib_ff_native_sub(s, a, b, e, m, result);
+        case OP_MUL:   return lib_ff_native_mul(s, a, b, e, m, result);
+        case OP_DIV:   return lib_ff_native_div(s, a, b, e, m, result);
+        case OP_SQRT:  return lib_ff_native_sqrt(s, a, e, m, result);
+        case OP_MADD:  return lib_ff_native_fma(s, a, b, c, false, false, false, e, m, result);
+        case OP_MSUB:  return lib_ff_native_fma(s, a, b, c, false, false, true, e, m, result);
+        case OP_NMADD: return lib_ff_native_fma(s, a, b, c, true, false, false, e, m, result);
+        case OP_NMSUB: return lib_ff_native_fma(s, a, b, c, false, true, false, e, m, result);
+        default:       return false;
+    }
+}
+
+
+static unsigned int flexfloat_op(iss_cpu_state_t *s, fp_op_e op, unsigned int a, unsigned int b, unsigned int c, uint8_t e, uint8_t m)
+{
+    switch (op)
+    {
+        case OP_ADD:   return lib_flexfloat_add(s, a, b, e, m);
+        case OP_SUB:   return lib_flexfloat_sub(s, a, b, e, m);
+        case OP_MUL:   return lib_flexfloat_mul(s, a, b, e, m);
+        case OP_DIV:   return lib_flexfloat_div(s, a, b, e, m);
+        case OP_SQRT:  return lib_flexfloat_sqrt(s, a, e, m);
+        case OP_MADD:  return lib_flexfloat_madd(s, a, b, c, e, m);
+        case OP_MSUB:  return lib_flexfloat_msub(s, a, b, c, e, m);
+        case OP_NMADD: return lib_flexfloat_nmadd(s, a, b, c, e, m);
+        case OP_NMSUB: return lib_flexfloat_nmsub(s, a, b, c, e, m);
+        default:       return 0;
+    }
+}
+
+
+static int check_format(const char *name, uint8_t e, uint8_t m)
+{
+    int errors = 0;
+
+    for (int op = 0; op < NB_OPS; op++)
+    {
+        int64_t nb_native = 0;
+
+        for (int i = 0; i < NB_ITERATIONS; i++)
+        {
+            unsigned int a = gen_operand(e, m), b = gen_operand(e, m), c = gen_operand(e, m);
+            iss_cpu_state_t native_state = {}, ref_state = {};
+            unsigned int native_result;
+
+            if (!native_op(&native_state, (fp_op_e)op, a, b, c, e, m, &native_result))
+            {
+                continue;
+            }
+
+            nb_native++;
+
+            fesetround(FE_TONEAREST);
+            unsigned int ref_result = flexfloat_op(&ref_state, (fp_op_e)op, a, b, c, e, m);
+
+            if (native_result != ref_result || native_state.fcsr.fflags.raw != ref_state.fcsr.fflags.raw)
+            {
+                if (errors < MAX_REPORTED_ERRORS)
+                {
+                    printf("Mismatch (format: %s, op: %s, operands: 0x%x 0x%x 0x%x, native: 0x%x flags 0x%x, flexfloat: 0x%x flags 0x%x)\n",
+                        name, op_names[op], a, b, c, native_result, native_state.fcsr.fflags.raw,
+                        ref_result, ref_state.fcsr.fflags.raw);
+                }
+                errors++;
+            }
+        }
+
+        printf("Checked %s %s: %ld native results, %ld given to flexfloat\n", name, op_names[op],
+            nb_native, NB_ITERATIONS - nb_native);
+
+        if (nb_native == 0)
+        {
+            printf("No operation went through the native path\n");
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+
+int main()
+{
+    int errors = check_format("binary32", 8, 23);
+
+#if LIB_FF_NATIVE_F16
+    errors += check_format("binary16", 5, 10);
+#else
+    printf("Host has no binary16 support, binary16 goes through flexfloat\n");
+#endif
+
+    printf("Native floating-point check: %s (errors: %d)\n", errors ? "failed" : "passed", errors);
+
+    return errors != 0;
+}
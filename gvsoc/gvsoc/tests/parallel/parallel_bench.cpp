@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Parallel mode test and benchmark.
+ *
+ * Two clock domains each have a driver, a local memory and a router which gives
+ * access to the memory of the other domain through a link, which is a router
+ * with latency in the other domain. At each iteration, the driver emulates an
+ * expensive model with some host computation, accesses its local memory, and
+ * either writes or reads back a word of the remote memory.
+ * The driver checks the data and that it took the same number of cycles as in
+ * sequential mode, as well as whether the engine is in parallel mode or not.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <stdio.h>
+#include <time.h>
+
+// Number of words accessed in the local and remote memories
+#define NB_WORDS 1024
+
+class parallel_bench : public vp::component
+{
+
+public:
+
+    parallel_bench(js::config *config);
+
+    int build();
+    void start();
+
+private:
+
+    static void exec_handler(void *__this, vp::clock_event *event);
+    static void response(void *__this, vp::io_req *req);
+
+    void local_access(uint64_t addr, uint32_t value);
+    void remote_done(int64_t latency);
+    void end();
+
+    vp::io_master mem;
+
+    vp::clock_event *exec_event;
+    vp::io_req local_req;
+    vp::io_req remote_req;
+    uint32_t remote_value;
+    uint32_t remote_expected;
+
+    int nb_iterations;
+    int iteration = 0;
+    uint64_t remote_base;
+    int remote_latency;
+    int work;
+    bool expect_parallel;
+    uint64_t work_state = 0;
+
+    int64_t start_cycles;
+    struct timespec start_time;
+    int errors = 0;
+    bool done = false;
+};
+
+
+parallel_bench::parallel_bench(js::config *config)
+    : vp::component(config)
+{
+}
+
+
+int parallel_bench::build()
+{
+    this->mem.set_resp_meth(&parallel_bench::response);
+    this->new_master_port("mem", &this->mem);
+
+    this->exec_event = this->event_new(this, parallel_bench::exec_handler);
+
+    this->nb_iterations = this->get_js_config()->get_child_int("nb_iterations");
+    this->remote_base = this->get_js_config()->get_child_int("remote_base");
+    this->remote_latency = this->get_js_config()->get_child_int("remote_latency");
+    this->work = this->get_js_config()->get_child_int("work");
+    this->expect_parallel = this->get_js_config()->get_child_bool("expect_parallel");
+
+    return 0;
+}
+
+
+void parallel_bench::start()
+{
+    // The engine is stopped once both drivers are done
+    this->clock->stop_retain(1);
+    this->event_enqueue(this->exec_event, 1);
+}
+
+
+void parallel_bench::local_access(uint64_t addr, uint32_t value)
+{
+    uint32_t data = value;
+
+    // Write the value and read it back
+    for (int is_write = 1; is_write >= 0; is_write--)
+    {
+        this->local_req.init();
+        this->local_req.set_addr(addr);
+        this->local_req.set_size(4);
+        this->local_req.set_data((uint8_t *)&data);
+        this->local_req.set_is_write(is_write);
+
+        if (this->mem.req(&this->local_req) != vp::IO_REQ_OK)
+        {
+            printf("Local request failed (addr: 0x%lx)\n", addr);
+            this->errors++;
+        }
+
+        if (is_write)
+        {
+            data = 0;
+        }
+    }
+
+    if (value != data)
+    {
+        printf("Wrong local value (addr: 0x%lx, value: 0x%x, expected: 0x%x)\n", addr, data, value);
+        this->errors++;
+    }
+}
+
+
+void parallel_bench::exec_handler(void *__this, vp::clock_event *event)
+{
+    parallel_bench *_this = (parallel_bench *)__this;
+
+    if (_this->done)
+    {
+        return;
+    }
+
+    if (_this->iteration == 0)
+    {
+        _this->start_cycles = _this->get_cycles();
+        clock_gettime(CLOCK_MONOTONIC, &_this->start_time);
+    }
+
+    if (_this->iteration == _this->nb_iterations)
+    {
+        _this->end();
+        return;
+    }
+
+    // Emulate a model spending time on the host
+    for (int i = 0; i < _this->work; i++)
+    {
+        _this->work_state = _this->work_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+
+    uint32_t value = _this->iteration * 0x9e3779b1 + _this->work_state;
+    uint64_t word = (_this->iteration / 2) % NB_WORDS;
+
+    _this->local_access(word * 4, value);
+
+    // Even iterations write a word of the remote memory, odd ones read it back
+    bool is_write = (_this->iteration & 1) == 0;
+    if (is_write)
+    {
+        _this->remote_value = value;
+        _this->remote_expected = value;
+    }
+    else
+    {
+        _this->remote_value = 0;
+    }
+
+    vp::io_req *req = &_this->remote_req;
+    req->init();
+    req->set_addr(_this->remote_base + word * 4);
+    req->set_size(4);
+    req->set_data((uint8_t *)&_this->remote_value);
+    req->set_is_write(is_write);
+
+    vp::io_req_status_e status = _this->mem.req(req);
+    if (status == vp::IO_REQ_OK)
+    {
+        _this->remote_done(req->get_latency());
+    }
+    else if (status != vp::IO_REQ_PENDING)
+    {
+        printf("Remote request failed (addr: 0x%lx)\n", req->get_addr());
+        _this->errors++;
+        _this->end();
+    }
+}
+
+
+void parallel_bench::response(void *__this, vp::io_req *req)
+{
+    parallel_bench *_this = (parallel_bench *)__this;
+    _this->remote_done(req->get_latency());
+}
+
+
+void parallel_bench::remote_done(int64_t latency)
+{
+    if (this->remote_value != this->remote_expected)
+    {
+        printf("Wrong remote value (iteration: %d, value: 0x%x, expected: 0x%x)\n",
+            this->iteration, this->remote_value, this->remote_expected);
+        this->errors++;
+    }
+
+    this->iteration++;
+    this->event_enqueue(this->exec_event, 1 + latency);
+}
+
+
+void parallel_bench::end()
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double duration = (end.tv_sec - this->start_time.tv_sec) + (end.tv_nsec - this->start_time.tv_nsec) / 1e9;
+
+    int64_t cycles = this->get_cycles() - this->start_cycles;
+    int64_t expected_cycles = (int64_t)this->nb_iterations * (1 + this->remote_latency);
+    bool parallel = this->get_time_engine()->is_parallel();
+
+    printf("Parallel benchmark: %s mode, %d iterations, %ld cycles, %.3f s\n",
+        parallel ? "parallel" : "sequential", this->nb_iterations, cycles, duration);
+
+    if (cycles != expected_cycles)
+    {
+        printf("Wrong number of cycles (cycles: %ld, expected: %ld)\n", cycles, expected_cycles);
+        this->errors++;
+    }
+
+    if (parallel != this->expect_parallel)
+    {
+        printf("Wrong engine mode (parallel: %d, expected: %d)\n", parallel, this->expect_parallel);
+        this->errors++;
+    }
+
+    printf("Parallel check: %s\n", this->errors ? "failed" : "passed");
+
+    this->clock->stop_retain(-1);
+    this->clock->stop_engine(this->errors != 0);
+
+    // Keep an event pending, otherwise the engine can see that there is nothing
+    // left to simulate before the other driver is done.
+    this->done = true;
+    this->event_enqueue(this->exec_event, 1000000);
+}
+
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new parallel_bench(config);
+}
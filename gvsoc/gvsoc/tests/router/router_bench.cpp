@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Router test and benchmark.
+ *
+ * The router has an outer entry with an entry nested into it, plus a set of
+ * entries mapped one after the other. The test first checks that accesses
+ * are routed to the nested entry even after the outer one has been hit, and
+ * that accesses straddling 2 entries are split between them. It then drives
+ * sequential and random requests through the router and reports the request
+ * throughput.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Outer entry, with the nested entry inside, both mapped from 0
+#define OUTER_SIZE     0x100000
+#define NESTED_BASE    0x10000
+#define NESTED_SIZE    0x1000
+// Entries mapped after the outer one, all of the same size
+#define ENTRIES_BASE   0x100000
+#define ENTRY_SIZE     0x100000
+
+class router_bench : public vp::component
+{
+
+public:
+
+    router_bench(js::config *config);
+
+    int build();
+    void start();
+
+private:
+
+    static void exec_handler(void *__this, vp::clock_event *event);
+
+    int check_routing();
+    int access(vp::io_master *itf, uint64_t addr, uint32_t *value, bool is_write);
+    void bench(const char *name, bool random);
+
+    vp::io_master out;
+    vp::io_master outer_mem;
+    vp::io_master nested_mem;
+
+    vp::clock_event *exec_event;
+    vp::io_req req;
+
+    int nb_requests;
+    int nb_entries;
+    bool done = false;
+};
+
+
+router_bench::router_bench(js::config *config)
+    : vp::component(config)
+{
+}
+
+
+int router_bench::build()
+{
+    this->new_master_port("out", &this->out);
+    this->new_master_port("outer_mem", &this->outer_mem);
+    this->new_master_port("nested_mem", &this->nested_mem);
+
+    this->exec_event = this->event_new(this, router_bench::exec_handler);
+
+    this->nb_requests = this->get_js_config()->get_child_int("nb_requests");
+    this->nb_entries = this->get_js_config()->get_child_int("nb_entries");
+
+    return 0;
+}
+
+
+void router_bench::start()
+{
+    this->event_enqueue(this->exec_event, 1);
+}
+
+
+int router_bench::access(vp::io_master *itf, uint64_t addr, uint32_t *value, bool is_write)
+{
+    this->req.init();
+    this->req.set_addr(addr);
+    this->req.set_size(4);
+    this->req.set_data((uint8_t *)value);
+    this->req.set_is_write(is_write);
+
+    return itf->req(&this->req) != vp::IO_REQ_OK;
+}
+
+
+int router_bench::check_routing()
+{
+    uint32_t value;
+    int errors = 0;
+
+    // Hit the outer entry first so that it gets cached
+    value = 0x11111111;
+    errors += this->access(&this->out, NESTED_BASE - 0x10, &value, true);
+
+    // Then write to the nested entry, which must not be taken by the outer one
+    value = 0x22222222;
+    errors += this->access(&this->out, NESTED_BASE + 0x10, &value, true);
+
+    errors += this->access(&this->nested_mem, 0x10, &value, false);
+    if (value != 0x22222222)
+    {
+        printf("Nested entry was not written (value: 0x%x)\n", value);
+        errors++;
+    }
+
+    errors += this->access(&this->outer_mem, NESTED_BASE + 0x10, &value, false);
+    if (value == 0x22222222)
+    {
+        printf("Outer entry was written instead of the nested one\n");
+        errors++;
+    }
+
+    // An access straddling 2 entries is split between them
+    uint32_t straddle = 0x44444444;
+    this->req.init();
+    this->req.set_addr(ENTRIES_BASE + ENTRY_SIZE - 2);
+    this->req.set_size(4);
+    this->req.set_data((uint8_t *)&straddle);
+    this->req.set_is_write(true);
+    errors += this->out.req(&this->req) != vp::IO_REQ_OK;
+
+    errors += this->access(&this->out, ENTRIES_BASE + ENTRY_SIZE - 4, &value, false);
+    if ((value >> 16) != 0x4444)
+    {
+        printf("First part of straddling access is wrong (value: 0x%x)\n", value);
+        errors++;
+    }
+    errors += this->access(&this->out, ENTRIES_BASE + ENTRY_SIZE, &value, false);
+    if ((value & 0xffff) != 0x4444)
+    {
+        printf("Second part of straddling access is wrong (value: 0x%x)\n", value);
+        errors++;
+    }
+
+    return errors;
+}
+
+
+void router_bench::bench(const char *name, bool random)
+{
+    uint64_t map_size = (uint64_t)this->nb_entries * ENTRY_SIZE;
+    uint32_t value = 0;
+    uint64_t addr = 0;
+    struct timespec start, end;
+
+    srand(0);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < this->nb_requests; i++)
+    {
+        if (random)
+        {
+            addr = ((uint64_t)rand() * 4) % map_size;
+        }
+        else
+        {
+            addr = (addr + 4) % map_size;
+        }
+
+        this->req.init();
+        this->req.set_addr(ENTRIES_BASE + addr);
+        this->req.set_size(4);
+        this->req.set_data((uint8_t *)&value);
+        this->req.set_is_write(false);
+        this->out.req(&this->req);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double duration = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("Router benchmark %s: %d requests, %d entries, %.3f s, %.2f Mreq/s\n",
+        name, this->nb_requests, this->nb_entries, duration, this->nb_requests / duration / 1e6);
+}
+
+
+void router_bench::exec_handler(void *__this, vp::clock_event *event)
+{
+    router_bench *_this = (router_bench *)__this;
+
+    if (_this->done)
+    {
+        return;
+    }
+
+    int errors = _this->check_routing();
+
+    printf("Router routing check: %s\n", errors ? "failed" : "passed");
+
+    if (errors == 0)
+    {
+        _this->bench("sequential", false);
+        _this->bench("random", true);
+    }
+
+    _this->clock->stop_engine(errors != 0);
+
+    // Keep an event pending, otherwise the engine can see that there is nothing
+    // left to simulate before it sees the stop request, and reports a failure.
+    _this->done = true;
+    _this->event_enqueue(_this->exec_event, 1000000);
+}
+
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new router_bench(config);
+}
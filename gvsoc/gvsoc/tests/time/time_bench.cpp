@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Time engine benchmark.
+ *
+ * The platform has several clock domains with slightly different frequencies,
+ * each with an instance of this component. The number of active domains is
+ * given by the nb_domains property of the top component, the instances with a
+ * higher index do nothing.
+ * Each active instance executes an event every cycle until the domains have
+ * executed the requested number of events. Since the frequencies are different,
+ * the time engine has to switch to another clock domain for almost every event,
+ * which measures the cost of its client queue against the number of domains.
+ * The last instance to finish checks the number of events and reports how many
+ * events were executed per host second.
+ */
+
+#include <vp/vp.hpp>
+#include <stdio.h>
+#include <time.h>
+
+// Shared by all instances, they all run in the simulation thread
+static int nb_running = 0;
+static int64_t total_events = 0;
+static int total_errors = 0;
+static struct timespec start_time;
+
+
+class time_bench : public vp::component
+{
+
+public:
+
+    time_bench(js::config *config);
+
+    int build();
+    void start();
+
+private:
+
+    static void exec_handler(void *__this, vp::clock_event *event);
+
+    void end();
+
+    vp::clock_event *exec_event;
+
+    int nb_domains;
+    int64_t nb_events;
+    int64_t count = 0;
+    int64_t start_cycles;
+    bool active;
+    bool done = false;
+};
+
+
+time_bench::time_bench(js::config *config)
+    : vp::component(config)
+{
+}
+
+
+int time_bench::build()
+{
+    this->exec_event = this->event_new(this, time_bench::exec_handler);
+
+    this->nb_domains = this->get_parent()->get_js_config()->get_child_int("nb_domains");
+
+    int index = this->get_js_config()->get_child_int("index");
+    this->active = index < this->nb_domains;
+    this->nb_events = this->get_js_config()->get_child_int("nb_events") / this->nb_domains;
+
+    return 0;
+}
+
+
+void time_bench::start()
+{
+    if (!this->active)
+    {
+        return;
+    }
+
+    if (nb_running++ == 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+    }
+
+    // The engine is stopped once all instances are done
+    this->clock->stop_retain(1);
+
+    this->start_cycles = this->get_cycles();
+    this->event_enqueue(this->exec_event, 1);
+}
+
+
+void time_bench::exec_handler(void *__this, vp::clock_event *event)
+{
+    time_bench *_this = (time_bench *)__this;
+
+    if (_this->done)
+    {
+        return;
+    }
+
+    _this->count++;
+
+    if (_this->count == _this->nb_events)
+    {
+        _this->end();
+        return;
+    }
+
+    _this->event_enqueue(_this->exec_event, 1);
+}
+
+
+void time_bench::end()
+{
+    int64_t cycles = this->get_cycles() - this->start_cycles;
+    if (cycles != this->nb_events)
+    {
+        printf("Wrong number of cycles (cycles: %ld, expected: %ld)\n", cycles, this->nb_events);
+        total_errors++;
+    }
+
+    total_events += this->count;
+
+    if (--nb_running == 0)
+    {
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double duration = (end.tv_sec - start_time.tv_sec) + (end.tv_nsec - start_time.tv_nsec) / 1e9;
+
+        printf("Time engine benchmark: %d clock domains, %ld events, %.3f s, %.2f Mevents/s\n",
+            this->nb_domains, total_events, duration, total_events / duration / 1e6);
+
+        if (total_events != this->nb_events * this->nb_domains)
+        {
+            printf("Wrong number of events (events: %ld, expected: %ld)\n", total_events,
+                this->nb_events * this->nb_domains);
+            total_errors++;
+        }
+
+        printf("Time engine check: %s\n", total_errors ? "failed" : "passed");
+    }
+
+    this->clock->stop_retain(-1);
+    this->clock->stop_engine(total_errors != 0);
+
+    // Keep an event pending, otherwise the engine can see that there is nothing
+    // left to simulate before it sees the stop request, and reports a failure.
+    this->done = true;
+    this->event_enqueue(this->exec_event, 1000000);
+}
+
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new time_bench(config);
+}
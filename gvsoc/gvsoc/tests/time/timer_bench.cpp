@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clock engine delayed events benchmark.
+ *
+ * This component arms nb_timers clock events with pseudo-random delays between
+ * min_delay and max_delay cycles, so that they do not fit into the clock engine
+ * circular buffer, like timer, RTC or UART events. Each time a timer fires, it
+ * is rearmed with a new delay, and every cancel_rate events another timer is
+ * canceled and rearmed.
+ * Each event checks that it is executed at the cycle it was enqueued for, and
+ * the number of executed events per host second is reported at the end.
+ */
+
+#include <vp/vp.hpp>
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+
+
+class timer_bench : public vp::component
+{
+
+public:
+
+    timer_bench(js::config *config);
+
+    int build();
+    void start();
+
+private:
+
+    static void timer_handler(void *__this, vp::clock_event *event);
+
+    uint32_t random();
+    void arm(int timer);
+    void end();
+
+    std::vector<vp::clock_event *> timers;
+    std::vector<int64_t> timers_cycle;
+
+    int nb_timers;
+    int64_t nb_events;
+    int64_t min_delay;
+    int64_t max_delay;
+    int cancel_rate;
+
+    int64_t count = 0;
+    int64_t nb_canceled = 0;
+    int errors = 0;
+    bool done = false;
+    uint32_t seed = 0x12345678;
+    struct timespec start_time;
+};
+
+
+timer_bench::timer_bench(js::config *config)
+    : vp::component(config)
+{
+}
+
+
+int timer_bench::build()
+{
+    this->nb_timers = this->get_js_config()->get_child_int("nb_timers");
+    this->nb_events = this->get_js_config()->get_child_int("nb_events");
+    this->min_delay = this->get_js_config()->get_child_int("min_delay");
+    this->max_delay = this->get_js_config()->get_child_int("max_delay");
+    this->cancel_rate = this->get_js_config()->get_child_int("cancel_rate");
+
+    for (int i=0; i<this->nb_timers; i++)
+    {
+        vp::clock_event *event = this->event_new(this, timer_bench::timer_handler);
+        // Keep the timer index in the event so that the handler can find its expected cycle
+        event->get_args()[0] = (void *)(intptr_t)i;
+        this->timers.push_back(event);
+        this->timers_cycle.push_back(0);
+    }
+
+    return 0;
+}
+
+
+void timer_bench::start()
+{
+    clock_gettime(CLOCK_MONOTONIC, &this->start_time);
+
+    for (int i=0; i<this->nb_timers; i++)
+    {
+        this->arm(i);
+    }
+}
+
+
+uint32_t timer_bench::random()
+{
+    // Xorshift, so that the sequence of delays is the same on all hosts
+    this->seed ^= this->seed << 13;
+    this->seed ^= this->seed >> 17;
+    this->seed ^= this->seed << 5;
+    return this->seed;
+}
+
+
+void timer_bench::arm(int timer)
+{
+    int64_t delay = this->min_delay + this->random() % (this->max_delay - this->min_delay + 1);
+    this->timers_cycle[timer] = this->get_cycles() + delay;
+    this->event_enqueue(this->timers[timer], delay);
+}
+
+
+void timer_bench::timer_handler(void *__this, vp::clock_event *event)
+{
+    timer_bench *_this = (timer_bench *)__this;
+    int timer = (intptr_t)event->get_args()[0];
+
+    if (_this->done)
+    {
+        return;
+    }
+
+    if (_this->get_cycles() != _this->timers_cycle[timer])
+    {
+        printf("Timer executed at wrong cycle (timer: %d, cycle: %ld, expected: %ld)\n",
+            timer, _this->get_cycles(), _this->timers_cycle[timer]);
+        _this->errors++;
+    }
+
+    _this->count++;
+
+    if (_this->count == _this->nb_events)
+    {
+        _this->end();
+        return;
+    }
+
+    _this->arm(timer);
+
+    if (_this->count % _this->cancel_rate == 0)
+    {
+        int other = _this->random() % _this->nb_timers;
+        if (_this->timers[other]->is_enqueued())
+        {
+            _this->event_cancel(_this->timers[other]);
+            _this->nb_canceled++;
+        }
+        _this->arm(other);
+    }
+}
+
+
+void timer_bench::end()
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double duration = (end.tv_sec - this->start_time.tv_sec) + (end.tv_nsec - this->start_time.tv_nsec) / 1e9;
+
+    printf("Timer benchmark: %d timers, delays %ld-%ld cycles, %ld events, %ld canceled, %.3f s, %.2f Mevents/s\n",
+        this->nb_timers, this->min_delay, this->max_delay, this->count, this->nb_canceled, duration,
+        this->count / duration / 1e6);
+
+    printf("Timer check: %s\n", this->errors ? "failed" : "passed");
+
+    // The other timers are still pending, so the engine stops on this request
+    this->done = true;
+    this->clock->stop_engine(this->errors != 0);
+}
+
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new timer_bench(config);
+}
@@ -35,6 +35,8 @@ public:
 
   static vp::io_req_status_e req(void *__this, vp::io_req *req);
   static vp::io_req_status_e req_ts(void *__this, vp::io_req *req);
+  static bool dmi_req(void *__this, vp::io_dmi *dmi);
+  static void dmi_invalidate(void *__this);
 
 
 private:
@@ -109,12 +111,74 @@ vp::io_req_status_e interleaver::req_ts(void *__this, vp::io_req *req)
   return _this->out[bank_id]->req_forward(req);
 }
 
+bool interleaver::dmi_req(void *__this, vp::io_dmi *dmi)
+{
+  interleaver *_this = (interleaver *)__this;
+  uint64_t offset = dmi->get_addr();
+  bool allow_stride = dmi->get_allow_stride();
+
+  // Consecutive words are spread over the banks, so the biggest contiguous
+  // range we can give is the word containing the address, unless the master
+  // accepts strided ranges, in which case we give all the words of the bank.
+  uint64_t chunk_base = offset & ~0x3ULL;
+  uint64_t chunk_end = chunk_base + 3;
+  uint64_t stride = 4ULL << _this->stage_bits;
+
+  int bank_id = (offset >> 2) & _this->bank_mask;
+  uint64_t bank_offset = ((offset >> (_this->stage_bits + 2)) << 2) + (offset & 0x3);
+  uint64_t bank_chunk_base = bank_offset & ~0x3ULL;
+
+  dmi->set_addr(bank_offset);
+
+  bool granted = _this->out[bank_id]->get_dmi(dmi);
+
+  if (granted && dmi->get_base() <= bank_chunk_base && dmi->get_end() >= bank_chunk_base + 3)
+  {
+    if (allow_stride)
+    {
+      // Keep the whole words of the bank range and convert it to our address space,
+      // where the word at bank offset 4*i is at stride*i + 4*bank_id
+      uint64_t first_word = (dmi->get_base() + 3) >> 2;
+      uint64_t last_word = ((dmi->get_end() + 1) >> 2) - 1;
+      dmi->clip(first_word << 2, (last_word << 2) + 3);
+      dmi->set_range(first_word * stride + (bank_id << 2), last_word * stride + (bank_id << 2) + 3);
+      dmi->set_stride(4, stride);
+    }
+    else
+    {
+      dmi->clip(bank_chunk_base, bank_chunk_base + 3);
+      dmi->shift(chunk_base - bank_chunk_base);
+    }
+  }
+  else
+  {
+    dmi->deny(chunk_base, chunk_end);
+    granted = false;
+  }
+
+  dmi->set_addr(offset);
+
+  return granted;
+}
+
+void interleaver::dmi_invalidate(void *__this)
+{
+  interleaver *_this = (interleaver *)__this;
+
+  _this->in.dmi_invalidate();
+  for (int i=0; i<_this->nb_masters; i++)
+  {
+    _this->masters_in[i]->dmi_invalidate();
+  }
+}
+
 int interleaver::build()
 {
 
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   in.set_req_meth(&interleaver::req);
+  in.set_dmi_meth(&interleaver::dmi_req);
   new_slave_port("in", &in);
 
   nb_slaves = get_config_int("nb_slaves");
@@ -132,6 +196,7 @@ int interleaver::build()
   for (int i=0; i<nb_slaves; i++)
   {
     out[i] = new vp::io_master();
+    out[i]->set_dmi_invalidate_meth(&interleaver::dmi_invalidate);
     new_master_port("out_" + std::to_string(i), out[i]);
   }
 
@@ -141,6 +206,7 @@ int interleaver::build()
   {
     masters_in[i] = new vp::io_slave();
     masters_in[i]->set_req_meth(&interleaver::req);
+    masters_in[i]->set_dmi_meth(&interleaver::dmi_req);
     new_slave_port("in_" + std::to_string(i), masters_in[i]);
 
     masters_ts_in[i] = new vp::io_slave();
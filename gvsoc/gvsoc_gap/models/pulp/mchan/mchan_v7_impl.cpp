@@ -35,9 +35,25 @@ using namespace std;
 
 #define MCHAN_NB_COUNTERS 16
 
+// Number of direct memory accesses kept for the local side of a bulk command, this must be
+// at least the number of banks of the local memory so that each bank is resolved once
+#define MCHAN_BULK_NB_LOC_DMIS 64
+
 class mchan;
 class Mchan_channel;
 
+// Part of a bulk command, made of count blocks of size bytes which are contiguous on both
+// sides, the next block being step bytes after on each side
+typedef struct
+{
+  uint8_t *ext_mem;
+  uint8_t *loc_mem;
+  uint64_t size;
+  uint64_t count;
+  uint64_t ext_step;
+  uint64_t loc_step;
+} Mchan_bulk_segment;
+
 // The structure describing a DMA command
 class Mchan_cmd {
 public:
@@ -75,6 +91,8 @@ public:
   int broadcast;
 
   int id;
+
+  int64_t bulk_end_cycle;  // Cycle where the command is over when it is done in bulk mode
   
   Mchan_channel *channel;  // The channel port from which the command arrived
 
@@ -185,6 +203,7 @@ private:
   static void check_ext_read_handler(void *_this, vp::clock_event *event);
   static void check_ext_write_handler(void *_this, vp::clock_event *event);
   static void check_loc_transfer_handler(void *_this, vp::clock_event *event);
+  static void bulk_end_handler(void *_this, vp::clock_event *event);
 
   // This handler is called after an access has been done to the external interface
   // In order to trigger the next steps (push to loc or end of transfer) after the latency 
@@ -204,6 +223,14 @@ private:
   void handle_ext_write_req_end(Mchan_cmd *cmd, vp::io_req *req);
   void cmd_start(int cmd_id);
 
+  // Bulk mode, where a whole command is done at once with direct memory accesses.
+  // Returns false if the command must be done with normal bursts.
+  bool bulk_transfer(Mchan_cmd *cmd);
+  bool bulk_resolve(Mchan_cmd *cmd, int64_t *ext_latency, int64_t *loc_latency);
+  bool bulk_resolve_strided(uint8_t *ext_mem, uint32_t loc_addr, uint64_t size, int64_t *latency);
+  bool bulk_get_dmi(vp::io_master *itf, vp::io_dmi *dmi, uint64_t addr, int64_t *latency);
+  vp::io_dmi *bulk_get_loc_dmi(uint32_t addr, int64_t *latency);
+
   // Can be called after an external request has been done in order to schedule the next step
   // depending on request latency
   void schedule_ext_req(vp::io_req *req);
@@ -220,6 +247,14 @@ private:
   int nb_loc_ports;
   int tcdm_addr_width;
 
+  // Bulk mode parameters, bandwidths are in bytes per cycle and latencies in cycles. The latencies
+  // are added to the ones returned by the direct memory accesses.
+  bool bulk;
+  int bulk_ext_bandwidth;
+  int bulk_ext_latency;
+  int bulk_loc_bandwidth;
+  int bulk_loc_latency;
+
   int nb_pending_ext_read_req;
   int nb_pending_ext_write_req;
   uint32_t free_counter_mask;
@@ -253,6 +288,16 @@ private:
 
   Mchan_cmd *first_command = NULL;
 
+  // Commands done in bulk mode, waiting for the end of their transfer, ordered by end cycle
+  Mchan_cmd *first_bulk_cmd;
+  // Direct memory accesses of the local side of the current bulk command, indexed by word so
+  // that each bank of an interleaved memory gets its own entry, and the last one used
+  vp::io_dmi bulk_loc_dmis[MCHAN_BULK_NB_LOC_DMIS];
+  vp::io_dmi *bulk_loc_dmi;
+  // Segments of the current bulk command, resolved before anything is copied
+  std::vector<Mchan_bulk_segment> bulk_segments;
+  vp::clock_event *bulk_end_event;
+
   vp::io_master ext_itf;
   vp::io_master *loc_itf;
 
@@ -622,11 +667,28 @@ mchan::mchan(js::config *config)
   nb_loc_ports = get_config_int("nb_loc_ports");
   tcdm_addr_width = get_config_int("tcdm_addr_width");
 
+  js::config *config_bulk = get_js_config()->get("bulk");
+  bulk = config_bulk != NULL && config_bulk->get_bool();
+  js::config *config_item = get_js_config()->get("bulk_ext_bandwidth");
+  bulk_ext_bandwidth = config_item ? config_item->get_int() : 8;
+  config_item = get_js_config()->get("bulk_ext_latency");
+  bulk_ext_latency = config_item ? config_item->get_int() : 0;
+  config_item = get_js_config()->get("bulk_loc_bandwidth");
+  bulk_loc_bandwidth = config_item ? config_item->get_int() : 8;
+  config_item = get_js_config()->get("bulk_loc_latency");
+  bulk_loc_latency = config_item ? config_item->get_int() : 0;
+
+  if (bulk_ext_bandwidth <= 0 || bulk_loc_bandwidth <= 0)
+  {
+    this->get_trace()->fatal("Invalid bulk bandwidth (ext: %d, loc: %d)\n", bulk_ext_bandwidth, bulk_loc_bandwidth);
+  }
+
   check_queue_event = event_new(mchan::check_queue_handler);
   check_ext_read_event = event_new(mchan::check_ext_read_handler);
   check_ext_write_event = event_new(mchan::check_ext_write_handler);
   check_loc_transfer_event = event_new(mchan::check_loc_transfer_handler);
   ext_req_event = event_new(mchan::ext_req_handler);
+  bulk_end_event = event_new(mchan::bulk_end_handler);
 
   pending_read_cmds = new Mchan_queue<Mchan_cmd>(global_queue_depth);
   pending_write_cmds = new Mchan_queue<Mchan_cmd>(global_queue_depth);
@@ -1002,8 +1064,15 @@ void mchan::check_ext_read_handler(void *__this, vp::clock_event *event)
   mchan *_this = (mchan *)__this;
 
   if (_this->current_ext_read_cmd == NULL)
+  {
     _this->current_ext_read_cmd = _this->pending_read_cmds->pop();
 
+    if (_this->current_ext_read_cmd != NULL && _this->bulk_transfer(_this->current_ext_read_cmd))
+    {
+      _this->current_ext_read_cmd = NULL;
+    }
+  }
+
 
   if (_this->current_ext_read_cmd != NULL)
   {
@@ -1022,8 +1091,15 @@ void mchan::check_ext_write_handler(void *__this, vp::clock_event *event)
   mchan *_this = (mchan *)__this;
 
   if (_this->current_ext_write_cmd == NULL)
+  {
     _this->current_ext_write_cmd = _this->pending_write_cmds->pop();
 
+    if (_this->current_ext_write_cmd != NULL && _this->bulk_transfer(_this->current_ext_write_cmd))
+    {
+      _this->current_ext_write_cmd = NULL;
+    }
+  }
+
   if (_this->current_ext_write_cmd != NULL)
   {
     if (_this->nb_pending_ext_write_req < _this->max_nb_ext_write_req && 
@@ -1124,6 +1200,275 @@ void mchan::ext_req_handler(void *__this, vp::clock_event *event)
   _this->check_queue();
 }
 
+bool mchan::bulk_get_dmi(vp::io_master *itf, vp::io_dmi *dmi, uint64_t addr, int64_t *latency)
+{
+  // Only query again the memory if the address is not inside the range we already got
+  if (dmi->get_mem() == NULL || !dmi->is_inside(addr))
+  {
+    dmi->init(addr);
+    dmi->set_master_timing(true);
+    dmi->set_allow_stride(true);
+    if (!itf->get_dmi(dmi) || !dmi->is_inside(addr))
+    {
+      return false;
+    }
+
+    if (dmi->get_latency() > *latency)
+    {
+      *latency = dmi->get_latency();
+    }
+  }
+
+  return true;
+}
+
+vp::io_dmi *mchan::bulk_get_loc_dmi(uint32_t addr, int64_t *latency)
+{
+  // A contiguous local memory always hits the last range, while an interleaved one gives one
+  // strided range per bank, which are then found with the word index
+  if (this->bulk_loc_dmi->get_mem() != NULL && this->bulk_loc_dmi->is_inside(addr))
+  {
+    return this->bulk_loc_dmi;
+  }
+
+  vp::io_dmi *dmi = &this->bulk_loc_dmis[(addr >> 2) % MCHAN_BULK_NB_LOC_DMIS];
+  if (!this->bulk_get_dmi(&this->loc_itf[0], dmi, addr, latency))
+  {
+    return NULL;
+  }
+
+  this->bulk_loc_dmi = dmi;
+
+  return dmi;
+}
+
+bool mchan::bulk_resolve_strided(uint8_t *ext_mem, uint32_t loc_addr, uint64_t size, int64_t *latency)
+{
+  // This handles a part of a line which is contiguous on the external side and starts on a chunk
+  // of a strided local range. Each chunk of the first stride is the start of a series of chunks,
+  // one per stride, which are contiguous in host memory, like the words of one bank, and which
+  // can then be described by a single segment.
+  vp::io_dmi *dmi = this->bulk_loc_dmi;
+  uint64_t chunk = dmi->get_chunk_size();
+  uint64_t stride = dmi->get_stride();
+  size_t nb_segments = this->bulk_segments.size();
+
+  if (stride % chunk != 0)
+    return false;
+
+  for (uint64_t offset = 0; offset < stride && offset < size; offset += chunk)
+  {
+    uint32_t addr = loc_addr + offset;
+    uint64_t remaining = size - offset;
+    uint64_t nb_chunks = remaining / stride + (remaining % stride >= chunk);
+    uint64_t tail = remaining % stride < chunk ? remaining % stride : 0;
+    uint64_t last = addr + nb_chunks * stride + (tail ? tail : chunk - stride) - 1;
+
+    dmi = this->bulk_get_loc_dmi(addr, latency);
+    if (dmi == NULL || dmi->get_chunk_size() != chunk || dmi->get_stride() != stride ||
+      dmi->get_contiguous_end(addr) != addr + chunk - 1 || last > dmi->get_end())
+    {
+      // Something else than the same strided range for all chunks, the caller will go
+      // through the chunks one by one
+      this->bulk_segments.resize(nb_segments);
+      return false;
+    }
+
+    uint8_t *loc_mem = dmi->get_mem(addr);
+
+    if (nb_chunks)
+    {
+      this->bulk_segments.push_back({ ext_mem + offset, loc_mem, chunk, nb_chunks, stride, chunk });
+    }
+    if (tail)
+    {
+      this->bulk_segments.push_back({ ext_mem + offset + nb_chunks * stride, loc_mem + nb_chunks * chunk, tail, 1, 0, 0 });
+    }
+  }
+
+  return true;
+}
+
+bool mchan::bulk_resolve(Mchan_cmd *cmd, int64_t *ext_latency, int64_t *loc_latency)
+{
+  vp::io_dmi ext_dmi;
+  ext_dmi.init(0);
+
+  for (int i=0; i<MCHAN_BULK_NB_LOC_DMIS; i++)
+  {
+    this->bulk_loc_dmis[i].init(0);
+  }
+  this->bulk_loc_dmi = &this->bulk_loc_dmis[0];
+  this->bulk_segments.clear();
+
+  uint64_t ext_addr = cmd->loc2ext ? cmd->dest : cmd->source;
+  uint64_t ext_line = ext_addr;
+  uint32_t loc_addr = (cmd->loc2ext ? cmd->source : cmd->dest) & ((1<<tcdm_addr_width) - 1);
+  int size = cmd->size;
+  int line_size = cmd->is_2d ? cmd->length : size;
+
+  while (size > 0)
+  {
+    // The external side is accessed line per line in 2D mode, while the local side is contiguous
+    int iter_size = line_size < size ? line_size : size;
+    int line_remaining = iter_size;
+
+    while (line_remaining > 0)
+    {
+      vp::io_dmi *loc_dmi;
+
+      if (!this->bulk_get_dmi(&this->ext_itf, &ext_dmi, ext_addr, ext_latency) ||
+        (loc_dmi = this->bulk_get_loc_dmi(loc_addr, loc_latency)) == NULL)
+      {
+        return false;
+      }
+
+      // Take as much as we can with the current ranges
+      uint64_t chunk_size = line_remaining;
+      if (ext_dmi.get_contiguous_end(ext_addr) - ext_addr + 1 < chunk_size)
+        chunk_size = ext_dmi.get_contiguous_end(ext_addr) - ext_addr + 1;
+
+      uint8_t *ext_mem = ext_dmi.get_mem(ext_addr);
+
+      // A strided local range, like an interleaved memory, can be handled with one segment per
+      // chunk of the stride instead of one per chunk
+      if (loc_dmi->get_chunk_size() != 0 && chunk_size > loc_dmi->get_stride() &&
+        this->bulk_resolve_strided(ext_mem, loc_addr, chunk_size, loc_latency))
+      {
+        ext_addr += chunk_size;
+        loc_addr += chunk_size;
+        line_remaining -= chunk_size;
+        continue;
+      }
+
+      if (loc_dmi->get_contiguous_end(loc_addr) - loc_addr + 1 < chunk_size)
+        chunk_size = loc_dmi->get_contiguous_end(loc_addr) - loc_addr + 1;
+
+      uint8_t *loc_mem = loc_dmi->get_mem(loc_addr);
+
+      // Merge with the previous segment when both sides follow it in host memory
+      Mchan_bulk_segment *last = this->bulk_segments.empty() ? NULL : &this->bulk_segments.back();
+      if (last && last->count == 1 && last->ext_mem + last->size == ext_mem && last->loc_mem + last->size == loc_mem)
+      {
+        last->size += chunk_size;
+      }
+      else
+      {
+        this->bulk_segments.push_back({ ext_mem, loc_mem, chunk_size, 1, 0, 0 });
+      }
+
+      ext_addr += chunk_size;
+      loc_addr += chunk_size;
+      line_remaining -= chunk_size;
+    }
+
+    size -= iter_size;
+    ext_line += cmd->stride;
+    if (cmd->is_2d)
+      ext_addr = ext_line;
+  }
+
+  return true;
+}
+
+bool mchan::bulk_transfer(Mchan_cmd *cmd)
+{
+  if (!this->bulk)
+    return false;
+
+  int64_t ext_latency = 0, loc_latency = 0;
+
+  // First resolve the whole command, before modifying anything, so that we can still fall
+  // back to normal bursts if a part of it can not be done with direct accesses
+  if (!this->bulk_resolve(cmd, &ext_latency, &loc_latency))
+  {
+    this->trace.msg(vp::trace::LEVEL_DEBUG, "Command can not be done in bulk mode (source: 0x%lx, dest: 0x%lx, size: 0x%x)\n",
+      cmd->source, cmd->dest, cmd->size);
+    return false;
+  }
+
+  for (Mchan_bulk_segment &segment: this->bulk_segments)
+  {
+    uint8_t *ext_mem = segment.ext_mem;
+    uint8_t *loc_mem = segment.loc_mem;
+
+    for (uint64_t i=0; i<segment.count; i++)
+    {
+      if (cmd->loc2ext)
+        memcpy(ext_mem, loc_mem, segment.size);
+      else
+        memcpy(loc_mem, ext_mem, segment.size);
+
+      ext_mem += segment.ext_step;
+      loc_mem += segment.loc_step;
+    }
+  }
+
+  // The command starts when the external interface is available and occupies it for the
+  // duration of the transfer. Both sides are pipelined so the command ends when the slowest
+  // one is done, plus the latencies.
+  int64_t cycles = this->get_cycles();
+  int64_t start = this->ext_itf_next_req_time > cycles ? this->ext_itf_next_req_time : cycles;
+  int64_t ext_duration = (cmd->size + this->bulk_ext_bandwidth - 1) / this->bulk_ext_bandwidth;
+  int64_t loc_duration = (cmd->size + this->bulk_loc_bandwidth - 1) / this->bulk_loc_bandwidth;
+  int64_t duration = ext_duration > loc_duration ? ext_duration : loc_duration;
+
+  this->ext_itf_next_req_time = start + ext_duration;
+  cmd->bulk_end_cycle = start + duration + ext_latency + this->bulk_ext_latency +
+    loc_latency + this->bulk_loc_latency;
+
+  this->trace.msg(vp::trace::LEVEL_TRACE, "Done command in bulk mode (source: 0x%lx, dest: 0x%lx, size: 0x%x, segments: %ld, end_cycle: %ld)\n",
+    cmd->source, cmd->dest, cmd->size, this->bulk_segments.size(), cmd->bulk_end_cycle);
+
+  // Insert the command in the list of pending bulk commands, ordered by end cycle
+  Mchan_cmd *current = this->first_bulk_cmd, *prev = NULL;
+  while (current != NULL && current->bulk_end_cycle <= cmd->bulk_end_cycle)
+  {
+    prev = current;
+    current = current->get_next();
+  }
+
+  if (prev)
+    prev->set_next(cmd);
+  else
+    this->first_bulk_cmd = cmd;
+
+  cmd->set_next(current);
+
+  if (prev == NULL)
+  {
+    int64_t latency = cmd->bulk_end_cycle - cycles;
+    if (latency <= 0)
+    {
+      latency = 1;
+    }
+    this->event_reenqueue(this->bulk_end_event, latency);
+  }
+
+  return true;
+}
+
+void mchan::bulk_end_handler(void *__this, vp::clock_event *event)
+{
+  mchan *_this = (mchan *)__this;
+
+  while (_this->first_bulk_cmd && _this->first_bulk_cmd->bulk_end_cycle <= _this->get_cycles())
+  {
+    Mchan_cmd *cmd = _this->first_bulk_cmd;
+    _this->first_bulk_cmd = cmd->get_next();
+
+    _this->account_transfered_bytes(cmd, cmd->size);
+    _this->handle_cmd_termination(cmd);
+  }
+
+  if (_this->first_bulk_cmd)
+  {
+    _this->event_enqueue(_this->bulk_end_event, _this->first_bulk_cmd->bulk_end_cycle - _this->get_cycles());
+  }
+
+  _this->check_queue();
+}
+
 void mchan::check_loc_transfer_handler(void *__this, vp::clock_event *event)
 {
   mchan *_this = (mchan *)__this;
@@ -1413,6 +1758,7 @@ void mchan::reset(bool active)
     this->busy.set(this->busy_count != 0);
     this->ext_itf_next_req_time = 0;
     this->first_pending_ext_req = NULL;
+    this->first_bulk_cmd = NULL;
   }
   else
   {
@@ -214,6 +214,11 @@ private:
     int OVERHEAD_MV;
     int QUANT_PER_CYCLE;
 
+    // In fast mode, a whole job is executed at once when it starts, and the end of the job is
+    // just delayed by the sum of the FSM state latencies. The matrixvec blocks are also computed
+    // on the packed weights. Outputs and job durations must be the same as in step-by-step mode.
+    bool fast_mode;
+
     static vp::io_req_status_e hwpe_slave(void *__this, vp::io_req *req);
 
     // DEBUG settings
@@ -375,6 +380,7 @@ private:
     // internal functions
 
     void __BinConvArray(uint8_t, uint8_t*, int, int, int32_t*, int32_t*, int32_t*, bool=false, bool=false, bool=false, bool=false, bool=false, int=0, int=0, bool=false, uint32_t=0);
+    void __BinConvArrayPacked(uint8_t*, int, int, bool, uint32_t);
     void __weightoffs(int, int*, int*);
 
     // NORMQUANT
@@ -453,6 +459,7 @@ private:
     int mv_qw_iter; // was simply qw
     int mv_qw_lim; // was simply qw
     int32_t mac_enable[16]; // TP_IN elements
+    uint8_t w_buffer[32*8*32]; // 32 bytes for each of the qw*k_out iterations
 
     // NORMQUANT state
     Ne16VectorLoad<uint8_t> vld_nqs;
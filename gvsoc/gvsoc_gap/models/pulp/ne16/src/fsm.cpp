@@ -107,9 +107,17 @@ void Ne16::fsm_end_handler(void *__this, vp::clock_event *event) {
 
 void Ne16::fsm_loop() {
     auto latency = 0;
-    do {
-        latency = this->fsm();
-    } while(latency == 0 && state.get() != END);
+    if(this->fast_mode) {
+        // Run the whole job now and only account for its duration
+        do {
+            latency += this->fsm();
+        } while(state.get() != END);
+    }
+    else {
+        do {
+            latency = this->fsm();
+        } while(latency == 0 && state.get() != END);
+    }
     if(state.get() == END && !this->fsm_end_event->is_enqueued()) {
         this->event_enqueue(this->fsm_end_event, latency);
     }
@@ -121,7 +129,7 @@ void Ne16::fsm_loop() {
 int Ne16::fsm() {
     auto state_next = this->state.get();
     auto latency = 0;
-    uint8_t *w_buffer = new uint8_t[32*this->mv_qw_lim*this->mv_k_out_lim]; // 8192 elements
+    uint8_t *w_buffer = this->w_buffer;
     uint8_t N;
     auto a = 0;
     auto iter_lim = 0;
@@ -419,7 +427,9 @@ int Ne16::fsm() {
       if(this->streamout_exit_idx()) {
 
         if(this->fs == 1 && !this->mode_linear) {
-          latency += 9 - (this->streamout_i_out_iter+1)*(this->streamout_j_out_iter+1) * (this->output_quant ? this->quantization_bits/8 : 4);
+          // Only pad up to 9 cycles, wider outputs already take longer than that. A negative
+          // latency would be enqueued modulo the engine event queue size.
+          latency += std::max(0, 9 - (this->streamout_i_out_iter+1)*(this->streamout_j_out_iter+1) * (this->output_quant ? this->quantization_bits/8 : 4));
         }
         if(this->accum_traces_streamout) {
           this->trace.msg(vp::trace::LEVEL_DEBUG, "  k_in_major=%d\n", this->k_in_major_iter);
@@ -453,6 +463,5 @@ int Ne16::fsm() {
   }
 
   this->state.set(state_next);
-  delete [] w_buffer;
   return latency;
 }
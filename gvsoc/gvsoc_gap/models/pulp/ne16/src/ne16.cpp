@@ -199,6 +199,8 @@ int Ne16::build()
     this->trace_level = L0_CONFIG;
     this->trace_format = 1;
 
+    this->fast_mode = this->get_js_config()->get_child_bool("fast_mode");
+
     return 0;
 }
 
@@ -20,6 +20,10 @@
 
 #include <ne16.hpp>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 // XTENSOR REMOVAL
 
 uint8_t* __WeightUnpack(uint8_t *w, int size, bool mode16, uint8_t *wu_mode8, uint8_t *wu_mode16) {
@@ -79,6 +83,50 @@ int __BinConvBlock(
     }
 }
 
+// Binary convolution of one block, with the weight bits kept packed. In 8-bit mode, bit j of
+// w_bits enables x[j]. In 16-bit mode, bit i enables the 16-bit activation made of x[2i] and
+// x[2i+1]. This gives the same result as __WeightUnpack followed by __BinConvBlock.
+static inline int __BinConvBlockPacked(
+    uint32_t w_bits,
+    uint8_t* x,
+    bool mode16
+) {
+    if(mode16) {
+        // Duplicate each weight bit so that it enables both bytes of the activation
+        w_bits = (w_bits | (w_bits << 4)) & 0x0f0f;
+        w_bits = (w_bits | (w_bits << 2)) & 0x3333;
+        w_bits = (w_bits | (w_bits << 1)) & 0x5555;
+        w_bits |= w_bits << 1;
+    }
+#if defined(__SSE2__)
+    // Turn the 16 weight bits into a byte mask, and let the sum of absolute differences do the
+    // accumulation of the enabled activations
+    const __m128i bit_sel = _mm_set1_epi64x(0x8040201008040201);
+    __m128i w = _mm_set_epi64x((w_bits >> 8) * 0x0101010101010101ULL, (w_bits & 0xff) * 0x0101010101010101ULL);
+    __m128i mask = _mm_cmpeq_epi8(_mm_and_si128(w, bit_sel), bit_sel);
+    __m128i xw = _mm_and_si128(_mm_loadu_si128((__m128i *)x), mask);
+    if(mode16) {
+        const __m128i even = _mm_set1_epi16(0x00ff);
+        __m128i sum_lo = _mm_sad_epu8(_mm_and_si128(xw, even), _mm_setzero_si128());
+        __m128i sum_hi = _mm_sad_epu8(_mm_andnot_si128(even, xw), _mm_setzero_si128());
+        __m128i sum = _mm_add_epi64(sum_lo, _mm_slli_epi64(sum_hi, 8));
+        return _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum));
+    }
+    else {
+        __m128i sum = _mm_sad_epu8(xw, _mm_setzero_si128());
+        return _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum));
+    }
+#else
+    auto sum = 0;
+    for (auto j=0; j<16; j++) {
+        if((w_bits >> j) & 1) {
+            sum += (mode16 && (j & 1)) ? (x[j] << 8) : x[j];
+        }
+    }
+    return sum;
+#endif
+}
+
 void Ne16::__BinConvArray(
     uint8_t             size,
     uint8_t*            weight_en,
@@ -163,6 +211,74 @@ void Ne16::__BinConvArray(
     }
 }
 
+// Same as __BinConvArray for the matrixvec datapath, except that the weights are read directly
+// from the packed weight buffer instead of being unpacked one bit per byte first. This is only
+// used in fast mode, the step-by-step mode keeps the original datapath as the reference.
+void Ne16::__BinConvArrayPacked(
+    uint8_t*            w,
+    int                 read_size,
+    int                 scale,
+    bool                use_row_as_scale,
+    uint32_t            thread_idx
+) {
+    // MACs are enabled by the same mask for all the blocks
+    uint32_t mac_mask = 0;
+    for (auto j=0; j<(this->mode16 ? 8 : 16); j++) {
+        mac_mask |= (this->mac_enable[j] & 1) << j;
+    }
+
+    // Index of the block among the enabled ones, as in __BinConvArray. The linear
+    // block enable is computed on this compacted index, not on the row and column.
+    auto psum_block_idx = 0;
+
+    for(auto c=0; c<this->NR_COLUMN; c++) { // spatial loop - over columns
+        int64_t psum_column = 0;
+
+        // in linear mode, only the first columns are used
+        if (this->mode_linear && c >= (this->mode16 ? 4 : 2)) {
+            this->accum_buffer[c+thread_idx] = 0;
+            continue;
+        }
+
+        for(auto r=0; r<this->COLUMN_SIZE; r++) { // spatial loop - over blocks in a column
+            if(this->row_enable[r] == 0) {
+                continue;
+            } // row disabling to implement filter masks
+
+            auto block_idx = psum_block_idx++;
+
+            if (this->mode16 && this->mode_linear) {
+                auto rr = block_idx / this->COLUMN_SIZE;
+                auto cc = block_idx % this->COLUMN_SIZE;
+                auto i_kin_16bit = ((cc < 8) && (rr < 4)) ? (rr * 8 + cc) : -1;
+                if ((i_kin_16bit == -1) || (i_kin_16bit >= this->load_fbuf_lim)) {
+                    continue;
+                }
+            }
+
+            // Rows beyond the weight buffer only see null activations
+            uint32_t w_bits = 0;
+            if (this->mode16) {
+                auto idx = r + (this->mode_linear ? (c >> 1) : 0);
+                if (idx < (read_size << 1)) {
+                    w_bits = w[idx];
+                }
+            }
+            else {
+                auto idx = (r << 1) + (this->mode_linear ? (c << 4) : 0);
+                if (idx + 1 < (read_size << 1)) {
+                    w_bits = w[idx] | (w[idx+1] << 8);
+                }
+            }
+
+            auto scale_loc = use_row_as_scale ? (1 << r) : scale;
+            psum_column += __BinConvBlockPacked(w_bits & mac_mask, &x_array[r*this->TP_IN+c*this->COLUMN_SIZE*this->TP_IN], this->mode16) * scale_loc;
+        }
+
+        this->accum_buffer[c+thread_idx] = psum_column;
+    }
+}
+
 void Ne16::__weightoffs(
   int dw_iter,
   int32_t* row_enable,
@@ -341,13 +457,22 @@ void Ne16::acc_reduction (uint32_t i, uint32_t k_out) {
 int Ne16::matrixvec_cycle(uint8_t *w_buf, uint32_t offset, int mv_qw_iter, int mv_k_out_iter, uint32_t thread_idx) {
     auto read_size  = (this->fs == 3) ? (this->FILTER_SIZE*this->FILTER_SIZE) : ((this->mode_linear) ? 16 : this->qw);
     auto k_out      = this->depthwise ? this->dw_iter : mv_k_out_iter;
+    auto scale = 1 << mv_qw_iter;
+
+    if (this->fast_mode) {
+        this->__BinConvArrayPacked(&w_buf[offset], read_size, scale, (this->fs==1) && (!this->mode_linear), thread_idx);
+        return 0;
+    }
 
     // load and unpack weight bits
+    // In linear mode, the last blocks of the second column are beyond the weights, they are
+    // padded with null weights.
     int64_t cycles = 0;
-    uint8_t wu_mode8[read_size<<4];
-    uint8_t wu_mode16[read_size<<5];
+    uint8_t wu_mode8[(read_size<<4) + this->BLOCK_SIZE*this->COLUMN_SIZE];
+    uint8_t wu_mode16[(read_size<<5) + this->BLOCK_SIZE*this->COLUMN_SIZE];
+    memset(wu_mode8, 0, sizeof(wu_mode8));
+    memset(wu_mode16, 0, sizeof(wu_mode16));
     uint8_t* weight = __WeightUnpack(&w_buf[offset], read_size, this->mode16, wu_mode8, wu_mode16);
-    auto scale = 1 << mv_qw_iter;
 
     int32_t block_enable_linear [this->NR_COLUMN*this->COLUMN_SIZE];
     int32_t *src = block_enable_linear;
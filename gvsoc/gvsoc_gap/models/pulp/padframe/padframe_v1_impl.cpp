@@ -173,6 +173,7 @@ private:
   static void qspim_master_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int id);
   static void qspim_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int id);
   static void qspim_cs_sync(void *__this, int cs, int active, int id);
+  static bool qspim_xfer(void *__this, vp::qspim_xfer *xfer, int id);
 
   static void jtag_pad_slave_sync(void *__this, int tck, int tdi, int tms, int trst, int id);
   static void jtag_pad_slave_sync_cycle(void *__this, int tdi, int tms, int trst, int id);
@@ -199,6 +200,7 @@ private:
   static void hyper_master_sync_cycle(void *__this, int data, int id);
   static void hyper_sync_cycle(void *__this, int data, int id);
   static void hyper_cs_sync(void *__this, int cs, int active, int id);
+  static bool hyper_burst(void *__this, vp::hyper_burst *burst, int id);
 
   static void master_wire_sync(void *__this, int value, int id);
   static void wire_sync(void *__this, int value, int id);
@@ -291,6 +293,28 @@ void padframe::qspim_sync(void *__this, int sck, int data_0, int data_1, int dat
 }
 
 
+bool padframe::qspim_xfer(void *__this, vp::qspim_xfer *xfer, int id)
+{
+  padframe *_this = (padframe *)__this;
+  Qspim_group *group = static_cast<Qspim_group *>(_this->groups[id]);
+
+  // Pads can only be traced at edge level, and error cases are reported by the
+  // edge-level path, in both cases let the master fall back to it.
+  if (group->data_0_trace.get_event_active() || group->data_1_trace.get_event_active() ||
+    group->data_2_trace.get_event_active() || group->data_3_trace.get_event_active())
+  {
+    return false;
+  }
+
+  if (group->active_cs == -1 || !group->master[group->active_cs]->is_bound())
+  {
+    return false;
+  }
+
+  return group->master[group->active_cs]->xfer(xfer);
+}
+
+
 void padframe::qspim_cs_sync(void *__this, int cs, int active, int id)
 {
   padframe *_this = (padframe *)__this;
@@ -593,6 +617,22 @@ void padframe::hyper_sync_cycle(void *__this, int data, int id)
 }
 
 
+bool padframe::hyper_burst(void *__this, vp::hyper_burst *burst, int id)
+{
+  padframe *_this = (padframe *)__this;
+  Hyper_group *group = static_cast<Hyper_group *>(_this->groups[id]);
+
+  // Pads can only be traced at cycle level, and error cases are reported by the
+  // cycle-level path, in both cases let the master fall back to it.
+  if (group->data_trace.get_event_active() || !group->master[group->active_cs]->is_bound())
+  {
+    return false;
+  }
+
+  return group->master[group->active_cs]->burst(burst);
+}
+
+
 void padframe::hyper_cs_sync(void *__this, int cs, int active, int id)
 {
   padframe *_this = (padframe *)__this;
@@ -708,6 +748,7 @@ int padframe::build()
         group->active_cs = -1;
         group->slave.set_sync_meth_muxed(&padframe::qspim_sync, nb_itf);
         group->slave.set_cs_sync_meth_muxed(&padframe::qspim_cs_sync, nb_itf);
+        group->slave.set_xfer_meth_muxed(&padframe::qspim_xfer, nb_itf);
         this->groups.push_back(group);
 
         traces.new_trace_event(name + "/data_0", &group->data_0_trace, 1);
@@ -830,6 +871,7 @@ int padframe::build()
         new_slave_port(name, &group->slave);
         group->slave.set_sync_cycle_meth_muxed(&padframe::hyper_sync_cycle, nb_itf);
         group->slave.set_cs_sync_meth_muxed(&padframe::hyper_cs_sync, nb_itf);
+        group->slave.set_burst_meth_muxed(&padframe::hyper_burst, nb_itf);
         this->groups.push_back(group);
         traces.new_trace_event(name + "/data", &group->data_trace, 8);
         js::config *nb_cs_config = config->get("nb_cs");
@@ -33,6 +33,12 @@ For 256 the key size is proportionally larger.
 #include <string.h> // CBC mode, for memset
 #include "udma_aes_model_v1.hpp"
 
+// The host AES instructions are used when available, which is checked at runtime
+#if defined(__x86_64__) || defined(__i386__)
+#define AES_NI_ENABLED 1
+#include <wmmintrin.h>
+#endif
+
 /*****************************************************************************/
 /* Defines:                                                                  */
 /*****************************************************************************/
@@ -204,6 +210,208 @@ static void KeyExpansion(AES_ctx* ctx, const uint8_t* Key)
     }
 }
 
+/*****************************************************************************/
+/* Host AES instructions:                                                    */
+/*****************************************************************************/
+// The expanded key has the same layout as the round keys expected by the
+// AES instructions, so the table key expansion is reused. Only the inverse
+// cipher needs its own keys, with InvMixColumns applied to the middle rounds.
+// Blocks are processed 4 by 4 when possible to hide the instruction latency.
+
+#ifdef AES_NI_ENABLED
+
+#define AES_NI_TARGET __attribute__((target("aes,sse2")))
+#define AES_NI_WAYS 4
+
+AES_NI_TARGET static void NiInitDecKeys(AES_ctx* ctx)
+{
+    const __m128i* enc = (const __m128i*)ctx->RoundKey;
+    __m128i* dec = (__m128i*)ctx->DecRoundKey;
+    int Nr = ctx->Nr;
+
+    _mm_storeu_si128(&dec[0], _mm_loadu_si128(&enc[Nr]));
+    for (int i = 1; i < Nr; i++)
+    {
+        _mm_storeu_si128(&dec[i], _mm_aesimc_si128(_mm_loadu_si128(&enc[Nr - i])));
+    }
+    _mm_storeu_si128(&dec[Nr], _mm_loadu_si128(&enc[0]));
+}
+
+AES_NI_TARGET static inline __m128i NiCipher(__m128i block, const __m128i* keys, int Nr)
+{
+    block = _mm_xor_si128(block, _mm_loadu_si128(&keys[0]));
+    for (int round = 1; round < Nr; round++)
+    {
+        block = _mm_aesenc_si128(block, _mm_loadu_si128(&keys[round]));
+    }
+    return _mm_aesenclast_si128(block, _mm_loadu_si128(&keys[Nr]));
+}
+
+AES_NI_TARGET static inline __m128i NiInvCipher(__m128i block, const __m128i* keys, int Nr)
+{
+    block = _mm_xor_si128(block, _mm_loadu_si128(&keys[0]));
+    for (int round = 1; round < Nr; round++)
+    {
+        block = _mm_aesdec_si128(block, _mm_loadu_si128(&keys[round]));
+    }
+    return _mm_aesdeclast_si128(block, _mm_loadu_si128(&keys[Nr]));
+}
+
+AES_NI_TARGET static void NiEcbEncrypt(const AES_ctx* ctx, uint8_t* buf, size_t length)
+{
+    const __m128i* keys = (const __m128i*)ctx->RoundKey;
+    __m128i* blocks = (__m128i*)buf;
+    size_t nb_blocks = length / AES_BLOCKLEN;
+    int Nr = ctx->Nr;
+    size_t i = 0;
+
+    for (; i + AES_NI_WAYS <= nb_blocks; i += AES_NI_WAYS)
+    {
+        __m128i key = _mm_loadu_si128(&keys[0]);
+        __m128i b[AES_NI_WAYS];
+        for (int j = 0; j < AES_NI_WAYS; j++)
+            b[j] = _mm_xor_si128(_mm_loadu_si128(&blocks[i + j]), key);
+
+        for (int round = 1; round < Nr; round++)
+        {
+            key = _mm_loadu_si128(&keys[round]);
+            for (int j = 0; j < AES_NI_WAYS; j++)
+                b[j] = _mm_aesenc_si128(b[j], key);
+        }
+
+        key = _mm_loadu_si128(&keys[Nr]);
+        for (int j = 0; j < AES_NI_WAYS; j++)
+            _mm_storeu_si128(&blocks[i + j], _mm_aesenclast_si128(b[j], key));
+    }
+
+    for (; i < nb_blocks; i++)
+    {
+        _mm_storeu_si128(&blocks[i], NiCipher(_mm_loadu_si128(&blocks[i]), keys, Nr));
+    }
+}
+
+AES_NI_TARGET static void NiEcbDecrypt(const AES_ctx* ctx, uint8_t* buf, size_t length)
+{
+    const __m128i* keys = (const __m128i*)ctx->DecRoundKey;
+    __m128i* blocks = (__m128i*)buf;
+    size_t nb_blocks = length / AES_BLOCKLEN;
+    int Nr = ctx->Nr;
+    size_t i = 0;
+
+    for (; i + AES_NI_WAYS <= nb_blocks; i += AES_NI_WAYS)
+    {
+        __m128i key = _mm_loadu_si128(&keys[0]);
+        __m128i b[AES_NI_WAYS];
+        for (int j = 0; j < AES_NI_WAYS; j++)
+            b[j] = _mm_xor_si128(_mm_loadu_si128(&blocks[i + j]), key);
+
+        for (int round = 1; round < Nr; round++)
+        {
+            key = _mm_loadu_si128(&keys[round]);
+            for (int j = 0; j < AES_NI_WAYS; j++)
+                b[j] = _mm_aesdec_si128(b[j], key);
+        }
+
+        key = _mm_loadu_si128(&keys[Nr]);
+        for (int j = 0; j < AES_NI_WAYS; j++)
+            _mm_storeu_si128(&blocks[i + j], _mm_aesdeclast_si128(b[j], key));
+    }
+
+    for (; i < nb_blocks; i++)
+    {
+        _mm_storeu_si128(&blocks[i], NiInvCipher(_mm_loadu_si128(&blocks[i]), keys, Nr));
+    }
+}
+
+AES_NI_TARGET static void NiCbcEncrypt(AES_ctx* ctx, uint8_t* buf, size_t length)
+{
+    // Each block depends on the previous one, they can only be processed one by one
+    const __m128i* keys = (const __m128i*)ctx->RoundKey;
+    __m128i* blocks = (__m128i*)buf;
+    size_t nb_blocks = length / AES_BLOCKLEN;
+    __m128i iv = _mm_loadu_si128((__m128i*)ctx->Iv);
+
+    for (size_t i = 0; i < nb_blocks; i++)
+    {
+        iv = NiCipher(_mm_xor_si128(_mm_loadu_si128(&blocks[i]), iv), keys, ctx->Nr);
+        _mm_storeu_si128(&blocks[i], iv);
+    }
+
+    _mm_storeu_si128((__m128i*)ctx->Iv, iv);
+}
+
+AES_NI_TARGET static void NiCbcDecrypt(AES_ctx* ctx, uint8_t* buf, size_t length)
+{
+    const __m128i* keys = (const __m128i*)ctx->DecRoundKey;
+    __m128i* blocks = (__m128i*)buf;
+    size_t nb_blocks = length / AES_BLOCKLEN;
+    int Nr = ctx->Nr;
+    __m128i iv = _mm_loadu_si128((__m128i*)ctx->Iv);
+    size_t i = 0;
+
+    for (; i + AES_NI_WAYS <= nb_blocks; i += AES_NI_WAYS)
+    {
+        __m128i in[AES_NI_WAYS], b[AES_NI_WAYS];
+        __m128i key = _mm_loadu_si128(&keys[0]);
+        for (int j = 0; j < AES_NI_WAYS; j++)
+        {
+            in[j] = _mm_loadu_si128(&blocks[i + j]);
+            b[j] = _mm_xor_si128(in[j], key);
+        }
+
+        for (int round = 1; round < Nr; round++)
+        {
+            key = _mm_loadu_si128(&keys[round]);
+            for (int j = 0; j < AES_NI_WAYS; j++)
+                b[j] = _mm_aesdec_si128(b[j], key);
+        }
+
+        key = _mm_loadu_si128(&keys[Nr]);
+        for (int j = 0; j < AES_NI_WAYS; j++)
+        {
+            _mm_storeu_si128(&blocks[i + j], _mm_xor_si128(_mm_aesdeclast_si128(b[j], key), iv));
+            iv = in[j];
+        }
+    }
+
+    for (; i < nb_blocks; i++)
+    {
+        __m128i in = _mm_loadu_si128(&blocks[i]);
+        _mm_storeu_si128(&blocks[i], _mm_xor_si128(NiInvCipher(in, keys, Nr), iv));
+        iv = in;
+    }
+
+    _mm_storeu_si128((__m128i*)ctx->Iv, iv);
+}
+
+#endif
+
+bool AES_has_ni()
+{
+#ifdef AES_NI_ENABLED
+    static int has_ni = -1;
+    if (has_ni == -1)
+    {
+        __builtin_cpu_init();
+        has_ni = __builtin_cpu_supports("aes") ? 1 : 0;
+    }
+    return has_ni;
+#else
+    return false;
+#endif
+}
+
+static void InitNi(AES_ctx* ctx)
+{
+    ctx->use_ni = AES_has_ni();
+#ifdef AES_NI_ENABLED
+    if (ctx->use_ni)
+    {
+        NiInitDecKeys(ctx);
+    }
+#endif
+}
+
 void AES_init_ctx(struct AES_ctx* ctx,
         aes_keylen_e keylen,
         const uint8_t* key)
@@ -221,6 +429,7 @@ void AES_init_ctx(struct AES_ctx* ctx,
     }
 
     KeyExpansion(ctx, key);
+    InitNi(ctx);
 }
 void AES_init_ctx_iv(struct AES_ctx* ctx,
         aes_keylen_e keylen,
@@ -239,6 +448,7 @@ void AES_init_ctx_iv(struct AES_ctx* ctx,
     }
 
     KeyExpansion(ctx, key);
+    InitNi(ctx);
     memcpy (ctx->Iv, iv, AES_BLOCKLEN);
 }
 void AES_ctx_set_iv(struct AES_ctx* ctx, const uint8_t* iv)
@@ -484,14 +694,46 @@ static void InvCipher(state_t* state, const AES_ctx* ctx)
 
 void AES_ECB_encrypt(const struct AES_ctx* ctx, uint8_t* buf)
 {
-    // The next function call encrypts the PlainText with the Key using AES algorithm.
-    Cipher((state_t*)buf, ctx);
+    AES_ECB_encrypt_buffer(ctx, buf, AES_BLOCKLEN);
 }
 
 void AES_ECB_decrypt(const struct AES_ctx* ctx, uint8_t* buf)
 {
-    // The next function call decrypts the PlainText with the Key using AES algorithm.
-    InvCipher((state_t*)buf, ctx);
+    AES_ECB_decrypt_buffer(ctx, buf, AES_BLOCKLEN);
+}
+
+void AES_ECB_encrypt_buffer(const struct AES_ctx* ctx, uint8_t* buf, size_t length)
+{
+#ifdef AES_NI_ENABLED
+    if (ctx->use_ni)
+    {
+        NiEcbEncrypt(ctx, buf, length);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < length; i += AES_BLOCKLEN)
+    {
+        // The next function call encrypts the PlainText with the Key using AES algorithm.
+        Cipher((state_t*)(buf + i), ctx);
+    }
+}
+
+void AES_ECB_decrypt_buffer(const struct AES_ctx* ctx, uint8_t* buf, size_t length)
+{
+#ifdef AES_NI_ENABLED
+    if (ctx->use_ni)
+    {
+        NiEcbDecrypt(ctx, buf, length);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < length; i += AES_BLOCKLEN)
+    {
+        // The next function call decrypts the PlainText with the Key using AES algorithm.
+        InvCipher((state_t*)(buf + i), ctx);
+    }
 }
 
 
@@ -506,6 +748,14 @@ static void XorWithIv(uint8_t* buf, const uint8_t* Iv)
 
 void AES_CBC_encrypt_buffer(struct AES_ctx *ctx, uint8_t* buf, size_t length)
 {
+#ifdef AES_NI_ENABLED
+    if (ctx->use_ni)
+    {
+        NiCbcEncrypt(ctx, buf, length);
+        return;
+    }
+#endif
+
     size_t i;
     uint8_t *Iv = ctx->Iv;
     for (i = 0; i < length; i += AES_BLOCKLEN)
@@ -521,6 +771,14 @@ void AES_CBC_encrypt_buffer(struct AES_ctx *ctx, uint8_t* buf, size_t length)
 
 void AES_CBC_decrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, size_t length)
 {
+#ifdef AES_NI_ENABLED
+    if (ctx->use_ni)
+    {
+        NiCbcDecrypt(ctx, buf, length);
+        return;
+    }
+#endif
+
     size_t i;
     uint8_t storeNextIv[AES_BLOCKLEN];
     for (i = 0; i < length; i += AES_BLOCKLEN)
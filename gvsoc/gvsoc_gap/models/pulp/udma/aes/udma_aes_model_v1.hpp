@@ -50,6 +50,11 @@ struct AES_ctx
 
     uint8_t RoundKey[AES_maxKeyExpSize];
     uint8_t Iv[AES_BLOCKLEN];
+
+    // Set when the host AES instructions are used instead of the table implementation
+    bool use_ni;
+    // Round keys of the equivalent inverse cipher used with the host AES instructions
+    uint8_t DecRoundKey[AES_maxKeyExpSize];
 };
 
 void AES_init_ctx(struct AES_ctx* ctx,
@@ -66,6 +71,12 @@ void AES_ctx_set_iv(struct AES_ctx* ctx, const uint8_t* iv);
 void AES_ECB_encrypt(const struct AES_ctx* ctx, uint8_t* buf);
 void AES_ECB_decrypt(const struct AES_ctx* ctx, uint8_t* buf);
 
+// buffer size MUST be multiple of AES_BLOCKLEN;
+// each block is processed independently, several blocks at a time when
+// the host AES instructions are available
+void AES_ECB_encrypt_buffer(const struct AES_ctx* ctx, uint8_t* buf, size_t length);
+void AES_ECB_decrypt_buffer(const struct AES_ctx* ctx, uint8_t* buf, size_t length);
+
 // buffer size MUST be multiple of AES_BLOCKLEN;
 // Suggest https://en.wikipedia.org/wiki/Padding_(cryptography)#PKCS7 for padding scheme
 // NOTES: you need to set IV in ctx via AES_init_ctx_iv() or AES_ctx_set_iv()
@@ -73,4 +84,8 @@ void AES_ECB_decrypt(const struct AES_ctx* ctx, uint8_t* buf);
 void AES_CBC_encrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, size_t length);
 void AES_CBC_decrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, size_t length);
 
+// Returns true if the host supports AES instructions (AES-NI), in which case
+// they are used by all the functions above
+bool AES_has_ni();
+
 #endif
@@ -39,6 +39,7 @@ Cpi_periph::Cpi_periph(udma *top, int id, int itf_id) : Udma_periph(top, id)
 
   cpi_itf.set_sync_meth(&Cpi_periph::sync);
   cpi_itf.set_sync_cycle_meth(&Cpi_periph::sync_cycle);
+  cpi_itf.set_sync_line_meth(&Cpi_periph::sync_line);
 }
  
 
@@ -273,19 +274,34 @@ void Cpi_periph::sync_cycle(void *__this, int href, int vsync, int data)
   {
     if (href)
     {
-      // To transmit the data, the channel must be enabled with no frame dropping or with the enabled frame
-      if (_this->enabled && (!_this->frameDrop || !_this->frameDropCount) && _this->cmd_ready) {
-        if (_this->has_pending_byte)
-        {
-          _this->push_pixel((_this->pending_byte << 8) | data);
-          _this->has_pending_byte = false;
-        }
-        else
-        {
-          _this->has_pending_byte = true;
-          _this->pending_byte = data;
-        }
-      }
+      _this->push_byte(data);
+    }
+  }
+}
+
+void Cpi_periph::sync_line(void *__this, uint8_t *data, int size)
+{
+  Cpi_periph *_this = (Cpi_periph *)__this;
+  _this->trace.msg("Sync line (size: %d)\n", size);
+  for (int i=0; i<size; i++)
+  {
+    _this->push_byte(data[i]);
+  }
+}
+
+void Cpi_periph::push_byte(int data)
+{
+  // To transmit the data, the channel must be enabled with no frame dropping or with the enabled frame
+  if (this->enabled && (!this->frameDrop || !this->frameDropCount) && this->cmd_ready) {
+    if (this->has_pending_byte)
+    {
+      this->push_pixel((this->pending_byte << 8) | data);
+      this->has_pending_byte = false;
+    }
+    else
+    {
+      this->has_pending_byte = true;
+      this->pending_byte = data;
     }
   }
 }
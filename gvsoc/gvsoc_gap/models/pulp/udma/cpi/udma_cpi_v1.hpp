@@ -50,12 +50,14 @@ protected:
 private:
   static void sync(void *__this, int pclk, int href, int vsync, int data);
   static void sync_cycle(void *__this, int href, int vsync, int data);
+  static void sync_line(void *__this, uint8_t *data, int size);
   vp::io_req_status_e handle_global_access(bool is_write, uint32_t *data);
   vp::io_req_status_e handle_l1_access(bool is_write, uint32_t *data);
   vp::io_req_status_e handle_ur_access(bool is_write, uint32_t *data);
   vp::io_req_status_e handle_size_access(bool is_write, uint32_t *data);
   vp::io_req_status_e handle_filter_access(bool is_write, uint32_t *data);
   void push_pixel(uint32_t pixel);
+  void push_byte(int data);
 
   vp::trace     trace;
 
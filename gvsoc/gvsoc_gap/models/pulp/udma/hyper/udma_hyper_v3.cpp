@@ -79,7 +79,7 @@ Hyper_periph::Hyper_periph(udma *top, int id, int itf_id) : Udma_periph(top, id)
     this->read_req_free = new Udma_queue<Hyper_read_request>(fifo_size);
     for (int i=0; i<fifo_size; i++)
     {
-         this->read_req_free->push(new Hyper_read_request());
+         this->read_req_free->push(new Hyper_read_request(top->get_burst_size()));
     }
     this->read_req_waiting = new Udma_queue<Hyper_read_request>(-1);
     this->read_req_ready = new Udma_queue<Hyper_read_request>(-1);
@@ -312,6 +312,13 @@ void Hyper_periph::handle_pending_word(void *__this, vp::clock_event *event)
     int cs;
 
         _this->top->get_trace()->msg(vp::trace::LEVEL_INFO, "Handle pending word (state: %d)\n", _this->state.get());
+
+    if (_this->state.get() == HYPER_STATE_DATA && _this->pending_bytes > 0 && _this->handle_burst())
+    {
+        _this->check_state();
+        return;
+    }
+
     if (mba1 >= mba0)
     {
         if (addr >= mba1)
@@ -400,54 +407,7 @@ void Hyper_periph::handle_pending_word(void *__this, vp::clock_event *event)
     else if (_this->state.get() == HYPER_STATE_DATA && _this->pending_bytes > 0)
     {
         send_byte = true;
-        if (_this->pending_is_write)
-        {
-            byte = _this->pending_word & 0xff;
-            _this->pending_word >>= 8;
-        }
-        else
-        {
-            byte = 0;
-        }
-        _this->pending_bytes--;
-        _this->transfer_size--;
-
-        _this->check_read_req_ready();
-
-        if (_this->transfer_size == 0)
-        {
-            _this->pending_bytes = 0;
-            _this->state.set(HYPER_STATE_CS_OFF);
-        }
-        else
-        {
-            if (_this->pending_length != 0)
-            {
-                _this->pending_length--;
-                if (_this->pending_length == 0)
-                {
-                    _this->ext_addr += _this->stride;
-                    _this->pending_ext_addr = _this->ext_addr;
-                    _this->pending_length = _this->length;
-                    _this->state.set(HYPER_STATE_CS_OFF);
-                    _this->iter_2d = true;
-                }
-            }
-
-            if (_this->state.get() != HYPER_STATE_CS_OFF)
-            {
-                if (_this->pending_burst > 0)
-                {
-                    _this->pending_burst--;
-                    if (_this->pending_burst == 0)
-                    {
-                        _this->pending_ext_addr += _this->regmap.timing_cfg.cs_max_get();
-                        _this->pending_burst = _this->regmap.timing_cfg.cs_max_get();
-                        _this->state.set(HYPER_STATE_CS_OFF);
-                    }
-                }
-            }
-        }
+        byte = _this->data_step();
 
         if (_this->pending_bytes == 0)
         {
@@ -524,14 +484,175 @@ void Hyper_periph::handle_pending_word(void *__this, vp::clock_event *event)
 }
 
 
+uint8_t Hyper_periph::data_step()
+{
+    uint8_t byte;
+
+    if (this->pending_is_write)
+    {
+        byte = this->pending_word & 0xff;
+        this->pending_word >>= 8;
+    }
+    else
+    {
+        byte = 0;
+    }
+    this->pending_bytes--;
+    this->transfer_size--;
+
+    this->check_read_req_ready();
+
+    if (this->transfer_size == 0)
+    {
+        this->pending_bytes = 0;
+        this->state.set(HYPER_STATE_CS_OFF);
+    }
+    else
+    {
+        if (this->pending_length != 0)
+        {
+            this->pending_length--;
+            if (this->pending_length == 0)
+            {
+                this->ext_addr += this->stride;
+                this->pending_ext_addr = this->ext_addr;
+                this->pending_length = this->length;
+                this->state.set(HYPER_STATE_CS_OFF);
+                this->iter_2d = true;
+            }
+        }
+
+        if (this->state.get() != HYPER_STATE_CS_OFF)
+        {
+            if (this->pending_burst > 0)
+            {
+                this->pending_burst--;
+                if (this->pending_burst == 0)
+                {
+                    this->pending_ext_addr += this->regmap.timing_cfg.cs_max_get();
+                    this->pending_burst = this->regmap.timing_cfg.cs_max_get();
+                    this->state.set(HYPER_STATE_CS_OFF);
+                }
+            }
+        }
+    }
+
+    return byte;
+}
+
+
+bool Hyper_periph::handle_burst()
+{
+    if (!this->hyper_itf.is_bound())
+    {
+        return false;
+    }
+
+    // The burst stops where the byte-level path would leave the data state, i.e.
+    // at the end of the transfer, of the 2D line or of the chip select burst, so
+    // that state changes only happen on its last byte.
+    int size = this->transfer_size;
+    if (this->pending_length != 0 && (int)this->pending_length < size)
+        size = this->pending_length;
+    if (this->pending_burst > 0 && (int)this->pending_burst < size)
+        size = this->pending_burst;
+    if (size > HYPER_BURST_MAX_SIZE)
+        size = HYPER_BURST_MAX_SIZE;
+
+    uint8_t data[HYPER_BURST_MAX_SIZE];
+
+    if (this->pending_is_write)
+    {
+        // Only the data already received from L2 can be sent
+        int available = 0;
+        uint32_t word = this->pending_word;
+        for (int i=0; i<this->pending_bytes && available < size; i++)
+        {
+            data[available++] = word & 0xff;
+            word >>= 8;
+        }
+
+        for (Hyper_read_request *req = this->read_req_ready->get_first(); req != NULL && available < size; req = req->get_next())
+        {
+            for (int i=req->offset; i<req->size && available < size; i++)
+            {
+                data[available++] = req->data[i];
+            }
+        }
+
+        size = available;
+    }
+    else
+    {
+        // Words are pushed to the channel as they get filled, it must be able to take all of them
+        int available = 4 - this->pending_word_size + (this->rx_channel->get_nb_free() - 1) * 4;
+        if (available < size)
+            size = available;
+    }
+
+    if (size < 2)
+    {
+        return false;
+    }
+
+    int div = this->regmap.clk_div.data_get() * 2;
+    int64_t cycle_duration = div > 0 ? div : 1;
+
+    vp::hyper_burst burst;
+    burst.size = size;
+    burst.is_write = this->pending_is_write;
+    burst.data = data;
+    burst.duration = size * cycle_duration * this->top->get_periph_clock()->get_period();
+
+    if (!this->hyper_itf.burst(&burst))
+    {
+        return false;
+    }
+
+    this->top->get_trace()->msg(vp::trace::LEVEL_INFO, "Transfered burst (size: %d, is_write: %d)\n", size, burst.is_write);
+
+    for (int i=0; i<size; i++)
+    {
+        this->data_step();
+
+        if (!this->pending_is_write)
+        {
+            Hyper_periph::rx_sync(this, data[i]);
+        }
+    }
+
+    // The interface is busy for as many cycles as with byte-level transfers
+    this->next_bit_cycle = this->top->get_periph_clock()->get_cycles() + size * cycle_duration;
+
+    if (this->pending_bytes == 0)
+    {
+        if (!this->ca.read)
+            this->pending_tx = false;
+        else
+            this->pending_rx = false;
+    }
+
+    return true;
+}
+
+
 void Hyper_periph::check_read_req_ready()
 {
     if (this->pending_is_write && this->pending_bytes == 0 && !this->read_req_ready->is_empty())
     {
-        Hyper_read_request *req = this->read_req_ready->pop();
-        this->pending_word = req->data;
-        this->pending_bytes = req->size;
-        this->read_req_free->push(req);
+        // Requests can be bigger than a word in burst mode, in which case they are sent word
+        // per word and released once fully sent
+        Hyper_read_request *req = this->read_req_ready->get_first();
+        int size = req->size - req->offset > 4 ? 4 : req->size - req->offset;
+        this->pending_word = 0;
+        memcpy(&this->pending_word, req->data + req->offset, size);
+        this->pending_bytes = size;
+        req->offset += size;
+        if (req->offset == req->size)
+        {
+            this->read_req_ready->pop();
+            this->read_req_free->push(req);
+        }
     }
 }
 
@@ -552,13 +673,16 @@ void Hyper_periph::handle_check_state(void *__this, vp::clock_event *event)
 
     if (_this->nb_bytes_to_read > 0 && !_this->read_req_free->is_empty() && _this->tx_channel->is_ready())
     {
-        int size = _this->nb_bytes_to_read > 4 ? 4 : _this->nb_bytes_to_read;
+        // In burst mode, the udma reads a whole address generator chunk with a single L2 request,
+        // so the same amount is asked, otherwise this is one word per request
+        int burst_size = _this->top->get_burst_size();
+        int size = _this->nb_bytes_to_read > burst_size ? burst_size : _this->nb_bytes_to_read;
         Hyper_read_request *req = _this->read_req_free->pop();
         _this->nb_bytes_to_read -= size;
         _this->read_req_waiting->push(req);
         req->requested_size = size;
         req->size = 0;
-        req->data = 0;
+        req->offset = 0;
         _this->tx_channel->get_data(size);
     }
 
@@ -612,7 +736,10 @@ void Hyper_periph::push_data(uint8_t *data, int size)
     // Hyper can do 4 outstanding requests so there is a hole of 2 cycles.
     // To model that, just delay a bit the incoming data
     int delay = 4;
-    this->push_data_fifo_data.push(*(uint32_t *)data);
+    for (int i=0; i<size; i++)
+    {
+        this->push_data_fifo_data.push(data[i]);
+    }
     this->push_data_fifo_size.push(size);
     this->push_data_fifo_cycles.push(this->top->get_cycles() + delay);
 
@@ -629,10 +756,8 @@ void Hyper_periph::handle_push_data(void *__this, vp::clock_event *event)
 
     while(!_this->push_data_fifo_cycles.empty() && _this->push_data_fifo_cycles.front() <= _this->top->get_cycles())
     {
-        uint32_t data = _this->push_data_fifo_data.front();
         int size = _this->push_data_fifo_size.front();
 
-        _this->push_data_fifo_data.pop();
         _this->push_data_fifo_size.pop();
         _this->push_data_fifo_cycles.pop();
 
@@ -640,7 +765,11 @@ void Hyper_periph::handle_push_data(void *__this, vp::clock_event *event)
         {
             Hyper_read_request *req = _this->read_req_waiting->get_first();
             int iter_size = size > req->requested_size ? req->requested_size : size;
-            req->data = (req->data & ((1 << (req->size * 8)) - 1)) | (data <<  (req->size * 8));
+            for (int i=0; i<iter_size; i++)
+            {
+                req->data[req->size + i] = _this->push_data_fifo_data.front();
+                _this->push_data_fifo_data.pop();
+            }
 
             req->size += iter_size;
             req->requested_size -= iter_size;
@@ -37,6 +37,9 @@
 #include <udma_hyper/udma_hyper_gvsoc.h>
 #include "../udma_mem_refill.hpp"
 
+// Maximum number of data bytes transfered with a single burst on the hyper interface
+#define HYPER_BURST_MAX_SIZE 256
+
 typedef enum
 {
     HYPER_STATE_IDLE,
@@ -60,13 +63,15 @@ typedef enum
 class Hyper_read_request
 {
 public:
+    Hyper_read_request(int max_size) { this->data = new uint8_t[max_size]; }
     void set_next(Hyper_read_request *next) { this->next = next; }
     Hyper_read_request *get_next() { return next; }
     Hyper_read_request *next;
 
-    uint32_t data;
-    int size;
-    int requested_size;
+    uint8_t *data;       // Data read from L2, one word in beat mode or one udma burst
+    int size;            // Number of bytes already received from L2
+    int requested_size;  // Number of bytes still expected from L2
+    int offset;          // Number of bytes already sent on the interface
 };
 
 class Hyper_periph;
@@ -123,6 +128,8 @@ private:
     void trans_cfg_req(uint64_t reg_offset, int size, uint8_t *value, bool is_write);
     void enqueue_transfer(uint32_t ext_addr, uint32_t l2_addr, uint32_t transfer_size, uint32_t length, uint32_t stride, bool is_write, int address_space);
     void check_read_req_ready();
+    uint8_t data_step();
+    bool handle_burst();
 
     vp_regmap_udma_hyper regmap;
 
@@ -145,7 +152,7 @@ private:
     Udma_queue<Hyper_read_request> *read_req_ready;
     Udma_queue<Hyper_read_request> *read_req_waiting;
 
-    std::queue<uint32_t> push_data_fifo_data;
+    std::queue<uint8_t> push_data_fifo_data;
     std::queue<int> push_data_fifo_size;
     std::queue<int64_t> push_data_fifo_cycles;
 
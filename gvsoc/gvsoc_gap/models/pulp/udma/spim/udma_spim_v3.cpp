@@ -210,52 +210,205 @@ void Spim_v3_cmd_channel::check_state()
   }
 }
 
-void Spim_periph_v3::handle_spi_pending_word(void *__this, vp::clock_event *event)
+bool Spim_periph_v3::rx_sample(unsigned int rx_bits)
 {
-  Spim_periph_v3 *_this = (Spim_periph_v3 *)__this;
-  bool raised_edge = false;
+  int nb_bits = this->qpi ? 4 : 1;
+  unsigned int received_bits =  this->qpi ? rx_bits & ((1<<nb_bits)-1) : (rx_bits >> 1) & 1;
 
-  if (_this->spi_rx_pending_bits > 0 && (_this->spi_tx_pending_bits == 0 || _this->is_full_duplex))
+  this->nb_received_bits += nb_bits;
+  this->spi_rx_pending_bits -= nb_bits;
+  if (!this->is_full_duplex)
+    this->cmd_pending_bits -= nb_bits;
+
+  int bit_index;
+  int shift;
+
+  if (this->spi_lsb_first)
+    bit_index = this->rx_bit_offset + this->rx_counter_bits;
+  else
+    bit_index = this->rx_bit_offset + this->spi_bitsword - this->rx_counter_bits;
+
+
+  if (this->spi_qpi)
   {
-    int nb_bits = _this->qpi ? 4 : 1;
-    unsigned int received_bits =  _this->qpi ? _this->rx_received_bits & ((1<<nb_bits)-1) : (_this->rx_received_bits >> 1) & 1;
-    _this->next_bit_cycle = _this->top->get_clock()->get_cycles() + _this->clkdiv;
+    shift = this->spi_lsb_first ? bit_index : bit_index - 3;
 
-    _this->nb_received_bits += nb_bits;
-    _this->spi_rx_pending_bits -= nb_bits;
-    if (!_this->is_full_duplex)
-      _this->cmd_pending_bits -= nb_bits;
+    this->rx_pending_word &= ~(0xf << shift);
+    this->rx_pending_word |= (received_bits & 0xf) << shift;
 
-    int bit_index;
-    int shift;
+    this->rx_counter_bits += 4;
+  }
+  else
+  {
+    shift = bit_index;
 
-    if (_this->spi_lsb_first)
-      bit_index = _this->rx_bit_offset + _this->rx_counter_bits;
-    else
-      bit_index = _this->rx_bit_offset + _this->spi_bitsword - _this->rx_counter_bits;
+    this->rx_pending_word &= ~(0x1 << bit_index);
+    this->rx_pending_word |= (received_bits & 0x1) << bit_index;
 
+    this->rx_counter_bits += 1;
+  }
 
-    if (_this->spi_qpi)
-    {
-      shift = _this->spi_lsb_first ? bit_index : bit_index - 3;
 
-      _this->rx_pending_word &= ~(0xf << shift);
-      _this->rx_pending_word |= (received_bits & 0xf) << shift;
+  this->top->get_trace()->msg("Sampled bits (nb_bits: %d, shift: %d, value: 0x%x, pending_word: 0x%x, pending_word_bits: %d)\n", nb_bits, shift, received_bits, this->rx_pending_word, this->nb_received_bits);
 
-      _this->rx_counter_bits += 4;
-    }
-    else
+  if (this->rx_counter_bits == this->spi_bitsword + 1)
+  {
+    this->rx_counter_bits = 0;
+    this->rx_bit_offset += this->spi_wordtrans == 0 ? 0 : this->spi_wordtrans == 1 ? 16 : 8;
+    this->rx_counter_transf++;
+    if (this->rx_counter_transf == 1<<this->spi_wordtrans)
     {
-      shift = bit_index;
+      // The word is complete, the caller must push it
+      return true;
+    }
+  }
+
+  return false;
+}
 
-      _this->rx_pending_word &= ~(0x1 << bit_index);
-      _this->rx_pending_word |= (received_bits & 0x1) << bit_index;
+unsigned int Spim_periph_v3::tx_get_bits()
+{
+  int bit_index;
+  int shift;
+  int nb_bits = this->spi_qpi ? 4 : 1;
 
-      _this->rx_counter_bits += 1;
+  if (this->spi_lsb_first)
+    bit_index = this->tx_bit_offset + this->tx_counter_bits;
+  else
+    bit_index = this->tx_bit_offset + this->spi_bitsword - this->tx_counter_bits;
+
+  if (this->spi_qpi)
+  {
+    shift = this->spi_lsb_first ? bit_index : bit_index - 3;
+    this->tx_counter_bits += 4;
+  }
+  else
+  {
+    shift = bit_index;
+    this->tx_counter_bits += 1;
+  }
+
+  unsigned int bits = ARCHI_REG_FIELD_GET(this->spi_tx_pending_word, shift, nb_bits);
+  this->top->get_trace()->msg("Sending bits (nb_bits: %d, shift: %d, value: 0x%x)\n", nb_bits, shift, bits);
+
+  if (this->tx_counter_bits == this->spi_bitsword + 1)
+  {
+    this->tx_counter_bits = 0;
+    this->tx_bit_offset += this->spi_wordtrans == 0 ? 0 : this->spi_wordtrans == 1 ? 16 : 8;
+    this->tx_counter_transf++;
+
+    if (this->tx_counter_transf == 1<<this->spi_wordtrans)
+    {
+      this->tx_counter_transf = 0;
+      this->tx_bit_offset = 0;
     }
+  }
+
+  return bits;
+}
+
+bool Spim_periph_v3::handle_spi_xfer()
+{
+  if (!this->qspim_itf.is_bound() || this->is_full_duplex)
+    return false;
+
+  // The chunk is the pending TX word or the bits until the next RX word is
+  // pushed to the channel. Its last cycle is always left to the edge-level path
+  // so that the end of the chunk (word pushed, transfer done) happens at the same
+  // cycle as with edge-level syncs.
+  bool is_rx = this->spi_tx_pending_bits == 0;
+  int lanes;
+  int nb_bits;
+
+  if (is_rx)
+  {
+    int word_bits = this->spi_bitsword + 1;
+    lanes = this->qpi ? 4 : 1;
+    if (word_bits % lanes)
+      return false;
+
+    nb_bits = word_bits - this->rx_counter_bits + ((1<<this->spi_wordtrans) - this->rx_counter_transf - 1) * word_bits;
+    if (nb_bits > this->spi_rx_pending_bits)
+      nb_bits = this->spi_rx_pending_bits;
+  }
+  else
+  {
+    lanes = this->spi_qpi ? 4 : 1;
+    nb_bits = this->spi_tx_pending_bits;
+  }
+
+  int nb_cycles = (nb_bits + lanes - 1) / lanes - 1;
+  if (nb_cycles > SPIM_XFER_MAX_CYCLES)
+    nb_cycles = SPIM_XFER_MAX_CYCLES;
+  if (nb_cycles < 1)
+    return false;
+
+  uint8_t tx_data[SPIM_XFER_MAX_CYCLES];
+  uint8_t rx_data[SPIM_XFER_MAX_CYCLES];
+  int tx_bit_offset = this->tx_bit_offset;
+  int tx_counter_bits = this->tx_counter_bits;
+  int tx_counter_transf = this->tx_counter_transf;
 
+  for (int i=0; i<nb_cycles; i++)
+  {
+    tx_data[i] = is_rx ? 0 : this->tx_get_bits();
+  }
+
+  // Same as the edge-level path, one SCK cycle every clkdiv cycles, at least one
+  int64_t cycle_duration = this->clkdiv > 0 ? this->clkdiv : 1;
+
+  vp::qspim_xfer xfer;
+  xfer.nb_cycles = nb_cycles;
+  xfer.lanes = lanes;
+  xfer.ddr = false;
+  xfer.tx_data = tx_data;
+  xfer.rx_data = rx_data;
+  xfer.duration = nb_cycles * cycle_duration * this->top->get_period();
+
+  if (!this->qspim_itf.xfer(&xfer))
+  {
+    // The slave only works at edge level, restore what was consumed by the chunk
+    this->tx_bit_offset = tx_bit_offset;
+    this->tx_counter_bits = tx_counter_bits;
+    this->tx_counter_transf = tx_counter_transf;
+    return false;
+  }
+
+  this->top->get_trace()->msg("Transfered chunk (is_rx: %d, nb_cycles: %d, lanes: %d)\n", is_rx, nb_cycles, lanes);
+
+  // Data driven back by the slave after a cycle is what is sampled on the next one
+  for (int i=0; i<nb_cycles; i++)
+  {
+    if (is_rx)
+      this->rx_sample(this->rx_received_bits);
+
+    if (rx_data[i] != QSPIM_XFER_UNDRIVEN)
+      this->rx_received_bits = rx_data[i];
+  }
+
+  if (!is_rx)
+    this->spi_tx_pending_bits -= nb_cycles * lanes;
 
-    _this->top->get_trace()->msg("Sampled bits (nb_bits: %d, shift: %d, value: 0x%x, pending_word: 0x%x, pending_word_bits: %d)\n", nb_bits, shift, received_bits, _this->rx_pending_word, _this->nb_received_bits);
+  this->next_bit_cycle = this->top->get_clock()->get_cycles() + nb_cycles * cycle_duration;
+
+  return true;
+}
+
+void Spim_periph_v3::handle_spi_pending_word(void *__this, vp::clock_event *event)
+{
+  Spim_periph_v3 *_this = (Spim_periph_v3 *)__this;
+
+  if (_this->handle_spi_xfer())
+  {
+    _this->check_state();
+    return;
+  }
+
+  if (_this->spi_rx_pending_bits > 0 && (_this->spi_tx_pending_bits == 0 || _this->is_full_duplex))
+  {
+    _this->next_bit_cycle = _this->top->get_clock()->get_cycles() + _this->clkdiv;
+
+    bool word_done = _this->rx_sample(_this->rx_received_bits);
 
     if (!_this->qspim_itf.is_bound())
     {
@@ -270,22 +423,16 @@ void Spim_periph_v3::handle_spi_pending_word(void *__this, vp::clock_event *even
     }
 
 
-    if (_this->rx_counter_bits == _this->spi_bitsword + 1)
+    if (word_done)
     {
-      _this->rx_counter_bits = 0;
-      _this->rx_bit_offset += _this->spi_wordtrans == 0 ? 0 : _this->spi_wordtrans == 1 ? 16 : 8;
-      _this->rx_counter_transf++;
-      if (_this->rx_counter_transf == 1<<_this->spi_wordtrans)
-      {
-        _this->top->get_trace()->msg("End of word transfer, pushing word (value: 0x%x)\n", _this->rx_pending_word);
-
-        (static_cast<Spim_v3_rx_channel *>(_this->channel0))->push_data((uint8_t *)&_this->rx_pending_word, 4);
-        
-        _this->rx_counter_transf = 0;
-        _this->rx_bit_offset = 0;
-        _this->nb_received_bits = 0;
-        _this->rx_pending_word = 0x57575757;
-      }
+      _this->top->get_trace()->msg("End of word transfer, pushing word (value: 0x%x)\n", _this->rx_pending_word);
+
+      (static_cast<Spim_v3_rx_channel *>(_this->channel0))->push_data((uint8_t *)&_this->rx_pending_word, 4);
+
+      _this->rx_counter_transf = 0;
+      _this->rx_bit_offset = 0;
+      _this->nb_received_bits = 0;
+      _this->rx_pending_word = 0x57575757;
     }
 
     if (_this->spi_rx_pending_bits <= 0)
@@ -301,31 +448,8 @@ void Spim_periph_v3::handle_spi_pending_word(void *__this, vp::clock_event *even
   {
     _this->next_bit_cycle = _this->top->get_clock()->get_cycles() + _this->clkdiv;
 
-
-    int bit_index;
-    int shift;
     int nb_bits = _this->spi_qpi ? 4 : 1;
-
-    if (_this->spi_lsb_first)
-      bit_index = _this->tx_bit_offset + _this->tx_counter_bits;
-    else
-      bit_index = _this->tx_bit_offset + _this->spi_bitsword - _this->tx_counter_bits;
-
-    if (_this->spi_qpi)
-    {
-      shift = _this->spi_lsb_first ? bit_index : bit_index - 3;
-      _this->tx_counter_bits += 4;
-    }
-    else
-    {
-      shift = bit_index;
-      _this->tx_counter_bits += 1;
-    }
-
-    unsigned int bits = ARCHI_REG_FIELD_GET(_this->spi_tx_pending_word, shift, nb_bits);
-    _this->top->get_trace()->msg("Sending bits (nb_bits: %d, shift: %d, value: 0x%x)\n", nb_bits, shift, bits);
-
-    raised_edge = true;
+    unsigned int bits = _this->tx_get_bits();
 
     if (!_this->qspim_itf.is_bound())
     {
@@ -341,20 +465,6 @@ void Spim_periph_v3::handle_spi_pending_word(void *__this, vp::clock_event *even
       );
     }
 
-    if (_this->tx_counter_bits == _this->spi_bitsword + 1)
-    {
-      _this->tx_counter_bits = 0;
-      _this->tx_bit_offset += _this->spi_wordtrans == 0 ? 0 : _this->spi_wordtrans == 1 ? 16 : 8;
-      _this->tx_counter_transf++;
-
-      if (_this->tx_counter_transf == 1<<_this->spi_wordtrans)
-      {
-        _this->tx_counter_transf = 0;
-        _this->tx_bit_offset = 0;
-      }
-    }
-
-
     _this->spi_tx_pending_bits -= nb_bits;
 
     if (_this->waiting_tx_flush && _this->spi_tx_pending_bits <= 0)
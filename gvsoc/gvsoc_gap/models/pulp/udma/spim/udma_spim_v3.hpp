@@ -34,6 +34,9 @@
 #include <vector>
 #include "archi/udma/udma_v3.h"
 
+// Maximum number of SCK cycles transfered with a single transaction-level transfer
+#define SPIM_XFER_MAX_CYCLES 32
+
 /*
  * SPIM
  */
@@ -134,6 +137,10 @@ public:
   bool push_rx_to_spi(int nb_bits, int qpi, int lsb_first, int bitsword, int wordtrans);
 
 protected:
+  bool handle_spi_xfer();
+  bool rx_sample(unsigned int rx_bits);
+  unsigned int tx_get_bits();
+
   vp::clock_event *pending_spi_word_event;
 
   vp::qspim_master qspim_itf;
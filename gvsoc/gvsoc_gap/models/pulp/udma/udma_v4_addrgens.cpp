@@ -146,8 +146,8 @@ bool Udma_addrgen_linear::get_next_transfer(uint32_t *addr, int *size)
 {
     if (this->current_size > 0)
     {
-        int iter_size = 4;
-        
+        int iter_size = this->top->get_burst_size();
+
         if (iter_size > this->current_size)
             iter_size = this->current_size;
 
@@ -272,9 +272,11 @@ bool Udma_addrgen_2d::get_next_transfer(uint32_t *addr, int *size)
 
     if (this->current_size > 0)
     {
-        int align = this->current_addr & 0x3;
-        int iter_size = 4 - align;
-        
+        // Chunks are cut on burst boundaries, which are the 32-bit beats in beat mode
+        int burst_size = this->top->get_burst_size();
+        int align = this->current_addr & (burst_size - 1);
+        int iter_size = burst_size - align;
+
         if (iter_size > this->remaining_length)
             iter_size = this->remaining_length;
 
@@ -480,6 +480,21 @@ int udma::build()
     l2_read_fifo_size = get_config_int("properties/l2_read_fifo_size");
     l2_write_fifo_size = get_config_int("properties/l2_write_fifo_size");
 
+    // Memory-side transfers are done with 32-bit beats unless a bigger burst size is configured,
+    // in which case whole address generator chunks are moved with a single L2 request
+    this->burst_size = 4;
+    js::config *burst_size_config = this->get_js_config()->get("properties/burst_size");
+    if (burst_size_config)
+    {
+        this->burst_size = burst_size_config->get_int();
+    }
+
+    if (this->burst_size < 4 || (this->burst_size & (this->burst_size - 1)) != 0)
+    {
+        this->trace.fatal("Invalid burst size, must be a power of 2 greater or equal to 4 (burst_size: %d)\n", this->burst_size);
+        return -1;
+    }
+
     l2_itf.set_resp_meth(&udma::l2_response);
     l2_itf.set_grant_meth(&udma::l2_grant);
     new_master_port("l2_itf", &l2_itf);
@@ -750,6 +765,14 @@ void udma::reset(bool active)
     this->busy.set(this->busy_count != 0);
 }
 
+void udma::get_perf_counters(std::vector<std::pair<std::string, int64_t>> &counters)
+{
+    // Memory-side traffic, divided by the events of the clock domains it gives the simulation
+    // cost of a transfer, in beat or burst mode
+    counters.push_back({"l2_read_bytes", this->tx_channels->get_nb_bytes()});
+    counters.push_back({"l2_write_bytes", this->rx_channels->get_nb_bytes()});
+}
+
 void udma::busy_set(int count)
 {
     this->busy_count += count;
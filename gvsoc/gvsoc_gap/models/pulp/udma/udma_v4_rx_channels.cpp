@@ -70,6 +70,12 @@ bool Udma_rx_channel::is_ready()
 }
 
 
+int Udma_rx_channel::get_nb_free()
+{
+    return this->top->rx_channels->get_nb_free();
+}
+
+
 void Udma_rx_channel::set_active(bool active)
 {
     bool active_done = !this->is_active() && active;
@@ -98,7 +104,7 @@ Udma_rx_channels::Udma_rx_channels(udma *top, int fifo_size) : top(top)
     for (int i = 0; i < fifo_size; i++)
     {
         vp::io_req *req = new vp::io_req();
-        req->set_data(new uint8_t[4]);
+        req->set_data(new uint8_t[top->get_burst_size()]);
         req->set_is_write(true);
         req->arg_alloc(); // To store request
         this->l2_free_reqs->push(req);
@@ -114,6 +120,8 @@ Udma_rx_channels::Udma_rx_channels(udma *top, int fifo_size) : top(top)
 
     this->send_reqs_event = top->event_new(this, Udma_rx_channels::handle_pending);
     this->waiting_reqs_event = top->event_new(this, Udma_rx_channels::handle_waiting);
+    this->next_req_cycle = 0;
+    this->nb_bytes = 0;
 
     this->stream_in_channels.resize(top->nb_udma_stream_in);
 
@@ -167,20 +175,67 @@ void Udma_rx_channels::handle_pending(void *__this, vp::clock_event *event)
         }
         else
         {
+            // In burst mode, the following fifo entries of the same channel are gathered so that
+            // they are written with a single L2 request
             int size = req->size;
+            for (Udma_request *next = req->get_next(); next != NULL && next->addrgen == req->addrgen &&
+                size + next->size <= _this->top->get_burst_size(); next = next->get_next())
+            {
+                size += next->size;
+            }
+
             uint32_t addr;
             vp::io_req *l2_req = _this->l2_free_reqs->pop();
 
             bool err = req->addrgen->get_next_transfer(&addr, &size);
 
-            if (!err)
+            if (err)
+            {
+                // Nothing can be written, just drop the entry
+                _this->fifo_ready->pop();
+                _this->fifo_free->push(req);
+                _this->l2_free_reqs->push(l2_req);
+            }
+            else
             {
                 l2_req->prepare();
                 l2_req->set_addr(addr);
-                *(uint32_t *)l2_req->get_data() = req->data;
                 l2_req->set_size(size);
 
-                _this->top->trace.msg(vp::trace::LEVEL_TRACE, "Writing to memory (value: 0x%x, addr: 0x%x, size: %d)\n", req->data, l2_req->get_addr(), size);
+                // Copy the data from the fifo entries. The ones which are fully consumed are chained
+                // on the L2 request so that they are released once it is done.
+                uint8_t *data = l2_req->get_data();
+                int remaining_size = size;
+                Udma_request *done_first = NULL, *done_last = NULL;
+                while (remaining_size > 0)
+                {
+                    Udma_request *entry = _this->fifo_ready->get_first();
+                    int iter_size = entry->size < remaining_size ? entry->size : remaining_size;
+
+                    memcpy(data, &entry->data, iter_size);
+                    data += iter_size;
+                    remaining_size -= iter_size;
+                    entry->size -= iter_size;
+
+                    if (entry->size == 0)
+                    {
+                        _this->fifo_ready->pop();
+                        entry->set_next(NULL);
+                        if (done_last)
+                            done_last->set_next(entry);
+                        else
+                            done_first = entry;
+                        done_last = entry;
+                    }
+                    else
+                    {
+                        entry->data >>= iter_size*8;
+                    }
+                }
+
+                *(Udma_request **)l2_req->arg_get(0) = done_first;
+
+                _this->top->trace.msg(vp::trace::LEVEL_TRACE, "Writing to memory (value: 0x%x, addr: 0x%x, size: %d)\n", *(uint32_t *)l2_req->get_data(), l2_req->get_addr(), size);
 
                 int err = _this->top->l2_itf.req(l2_req);
 
@@ -191,7 +246,11 @@ void Udma_rx_channels::handle_pending(void *__this, vp::clock_event *event)
 
                 if (err == vp::IO_REQ_OK)
                 {
-                    l2_req->set_latency(l2_req->get_latency() + _this->top->get_cycles() + 1);
+                    // The L2 interface is busy for as many cycles as needed to transfer all the beats
+                    int burst_cycles = _this->top->get_burst_cycles(size);
+                    _this->next_req_cycle = _this->top->get_cycles() + burst_cycles;
+                    _this->nb_bytes += size;
+                    l2_req->set_latency(l2_req->get_latency() + _this->top->get_cycles() + burst_cycles);
                     _this->l2_waiting_reqs->push(l2_req);
                 }
                 else
@@ -199,19 +258,6 @@ void Udma_rx_channels::handle_pending(void *__this, vp::clock_event *event)
                     _this->top->trace.warning("UNIMPLEMENTED AT %s %d\n", __FILE__, __LINE__);
                 }
             }
-
-            req->size -= size;
-
-            if (req->size == 0)
-            {
-                _this->fifo_ready->pop();
-                *(Udma_request **)l2_req->arg_get(0) = req;
-            }
-            else
-            {
-                req->data >>= size*8;
-                *(Udma_request **)l2_req->arg_get(0) = NULL;
-            }
         }
     }
 
@@ -232,9 +278,11 @@ void Udma_rx_channels::handle_waiting(void *__this, vp::clock_event *event)
         _this->l2_waiting_reqs->pop();
         _this->l2_free_reqs->push(req);
         Udma_request *request = *(Udma_request **)req->arg_get(0);
-        if (request)
+        while (request)
         {
+            Udma_request *next = request->get_next();
             _this->fifo_free->push(request);
+            request = next;
         }
 
         req = _this->l2_waiting_reqs->get_first();
@@ -275,7 +323,8 @@ void Udma_rx_channels::check_state()
     {
         if (!this->fifo_ready->is_empty() && !this->l2_free_reqs->is_empty())
         {
-            this->top->event_enqueue(this->send_reqs_event, 1);
+            int64_t cycles = this->top->get_cycles();
+            this->top->event_enqueue(this->send_reqs_event, this->next_req_cycle > cycles + 1 ? this->next_req_cycle - cycles : 1);
         }
     }
 
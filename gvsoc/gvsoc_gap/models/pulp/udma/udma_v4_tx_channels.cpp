@@ -111,7 +111,7 @@ Udma_tx_channels::Udma_tx_channels(udma *top, int fifo_size) : top(top)
     for (int i = 0; i < nb_outstanding_l2_reqs; i++)
     {
         vp::io_req *req = new vp::io_req();
-        req->set_data(new uint8_t[4]);
+        req->set_data(new uint8_t[top->get_burst_size()]);
         req->set_is_write(false);
         req->arg_alloc();
         this->l2_free_reqs->push(req);
@@ -119,6 +119,8 @@ Udma_tx_channels::Udma_tx_channels(udma *top, int fifo_size) : top(top)
 
     this->send_reqs_event = top->event_new(this, Udma_tx_channels::handle_pending);
     this->waiting_reqs_event = top->event_new(this, Udma_tx_channels::handle_waiting);
+    this->next_req_cycle = 0;
+    this->nb_bytes = 0;
 
     this->stream_out_channels.resize(top->nb_udma_stream_in);
     this->stream_out_data.resize(top->nb_udma_stream_in);
@@ -219,7 +221,9 @@ void Udma_tx_channels::handle_pending(void *__this, vp::clock_event *event)
         // Get the next request from the next channel
         Udma_tx_channel *channel = _this->pending_channels.front();
 
-        int size = 4;
+        // In burst mode, the whole size requested by the peripheral is read at once, up to the
+        // burst size, otherwise it is read beat per beat
+        int size = _this->top->get_burst_size();
         if (size > channel->requested_size_queue.front())
         {
             size = channel->requested_size_queue.front();
@@ -267,7 +271,11 @@ void Udma_tx_channels::handle_pending(void *__this, vp::clock_event *event)
 
         if (err == vp::IO_REQ_OK)
         {
-            l2_req->set_latency(l2_req->get_latency() + _this->top->get_cycles() + 1);
+            // The L2 interface is busy for as many cycles as needed to transfer all the beats
+            int burst_cycles = _this->top->get_burst_cycles(size);
+            _this->next_req_cycle = _this->top->get_cycles() + burst_cycles;
+            _this->nb_bytes += size;
+            l2_req->set_latency(l2_req->get_latency() + _this->top->get_cycles() + burst_cycles);
             _this->l2_waiting_reqs->push(l2_req);
         }
         else
@@ -309,7 +317,8 @@ void Udma_tx_channels::check_state()
     {
         if (!this->pending_channels.empty() && !this->l2_free_reqs->is_empty() && this->pending_channels.front()->is_active())
         {
-            this->top->event_enqueue(this->send_reqs_event, 1);
+            int64_t cycles = this->top->get_cycles();
+            this->top->event_enqueue(this->send_reqs_event, this->next_req_cycle > cycles + 1 ? this->next_req_cycle - cycles : 1);
         }
     }
 
@@ -265,6 +265,9 @@ public:
     // Tell if the channel is ready for sending L2 data (push_data can be called)
     bool is_ready();
 
+    // Tell how many times push_data can be called without waiting for the channel to get ready
+    int get_nb_free();
+
     bool is_active();
 
     void set_active(bool active);
@@ -319,6 +322,7 @@ class Udma_rx_channels
 public:
     Udma_rx_channels(udma *top, int fifo_size);
     bool is_ready();
+    int get_nb_free() { return this->fifo_free->get_nb_free(); }
     void push_data(uint8_t *data, int size, Udma_addrgen *addrgen, int addrgen_id);
     void check_state();
     static void handle_pending(void *__this, vp::clock_event *event);
@@ -326,6 +330,7 @@ public:
     static void stream_in_ready_sync(void *__this, bool ready, int id);
     std::vector<Udma_rx_channel *> stream_in_channels;
     void add_waiting_channel(Udma_rx_channel *channel) { this->waiting_channels.push(channel); }
+    int64_t get_nb_bytes() { return this->nb_bytes; }
 
 private:
     void check_waiting_channels();
@@ -340,6 +345,8 @@ private:
 
     vp::clock_event *send_reqs_event;    // Event used for sending fifo entries to L2
     vp::clock_event *waiting_reqs_event; // Event used for processing l2 requests waiting for completion
+    int64_t next_req_cycle;              // Cycle where the L2 interface is free again for the next request
+    int64_t nb_bytes;                    // Number of bytes written to L2
 
     std::vector<vp::wire_master<uint32_t> *> stream_in_data_itf;
     std::vector<vp::wire_slave<bool> *> stream_in_ready_itf;
@@ -367,6 +374,7 @@ public:
     std::vector<bool> stream_out_data_ready;
     void reset(bool active);
     void stream_out_ready_set(int id, bool ready);
+    int64_t get_nb_bytes() { return this->nb_bytes; }
 
 private:
     udma *top;
@@ -378,6 +386,8 @@ private:
 
     vp::clock_event *send_reqs_event;
     vp::clock_event *waiting_reqs_event;
+    int64_t next_req_cycle;
+    int64_t nb_bytes;
 
     std::vector<vp::wire_slave<uint32_t> *> stream_out_data_itf;
 };
@@ -586,6 +596,7 @@ public:
     int build();
     void start();
     void reset(bool active);
+    void get_perf_counters(std::vector<std::pair<std::string, int64_t>> &counters);
 
     void trigger_event(int event);
 
@@ -600,6 +611,11 @@ public:
 
     void busy_set(int inc);
 
+    // Maximum size of memory-side transfers, 4 means one L2 request per 32-bit beat
+    int get_burst_size() { return this->burst_size; }
+    // Number of cycles taken by a memory-side transfer on the 32-bit L2 interface
+    int get_burst_cycles(int size) { return (size + 3) / 4; }
+
     vp::io_master l2_itf;
 
     Udma_rx_channels *rx_channels;
@@ -648,6 +664,7 @@ private:
     int nb_periphs;
     int l2_read_fifo_size;
     int l2_write_fifo_size;
+    int burst_size;
     int nb_channels;
     std::vector<Udma_periph *> periphs;
     Sfu_periph *sfu_periph;
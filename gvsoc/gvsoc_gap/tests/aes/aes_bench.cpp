@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2021  GreenWaves Technologies, SAS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * AES model test and benchmark.
+ *
+ * Checks the FIPS-197 vectors, checks that the host AES instructions give the
+ * same results as the table implementation on random data, and reports the
+ * throughput of both, one block per call as the uDMA AES peripheral does, and
+ * on whole buffers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "pulp/udma/aes/udma_aes_model_v1.hpp"
+
+#define BENCH_SIZE (4 * 1024 * 1024)
+
+typedef enum
+{
+    ECB_ENCRYPT,
+    ECB_DECRYPT,
+    CBC_ENCRYPT,
+    CBC_DECRYPT,
+    NB_OPS
+} aes_op_e;
+
+static const char *op_names[] = { "ecb_enc", "ecb_dec", "cbc_enc", "cbc_dec" };
+
+
+static void init_ctx(AES_ctx *ctx, aes_keylen_e keylen, const uint8_t *key, const uint8_t *iv, bool use_ni)
+{
+    AES_init_ctx_iv(ctx, keylen, key, iv);
+    // The table implementation is always available, the inverse round keys used
+    // by the host instructions are only needed when they are used
+    if (!use_ni)
+    {
+        ctx->use_ni = false;
+    }
+}
+
+
+static void run_op(AES_ctx *ctx, aes_op_e op, uint8_t *buf, size_t size, bool per_block)
+{
+    size_t step = per_block ? AES_BLOCKLEN : size;
+
+    for (size_t offset = 0; offset < size; offset += step)
+    {
+        switch (op)
+        {
+            case ECB_ENCRYPT: AES_ECB_encrypt_buffer(ctx, buf + offset, step); break;
+            case ECB_DECRYPT: AES_ECB_decrypt_buffer(ctx, buf + offset, step); break;
+            case CBC_ENCRYPT: AES_CBC_encrypt_buffer(ctx, buf + offset, step); break;
+            case CBC_DECRYPT: AES_CBC_decrypt_buffer(ctx, buf + offset, step); break;
+            default: break;
+        }
+    }
+}
+
+
+static int check_vector(aes_keylen_e keylen, const uint8_t *key, const uint8_t *expected, bool use_ni)
+{
+    static const uint8_t plain[AES_BLOCKLEN] = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+    };
+    uint8_t iv[AES_BLOCKLEN] = { 0 };
+    uint8_t buf[AES_BLOCKLEN];
+    AES_ctx ctx;
+    int errors = 0;
+
+    init_ctx(&ctx, keylen, key, iv, use_ni);
+
+    memcpy(buf, plain, AES_BLOCKLEN);
+    AES_ECB_encrypt(&ctx, buf);
+    errors += memcmp(buf, expected, AES_BLOCKLEN) != 0;
+
+    AES_ECB_decrypt(&ctx, buf);
+    errors += memcmp(buf, plain, AES_BLOCKLEN) != 0;
+
+    if (errors)
+    {
+        printf("FIPS-197 vector failed (key: %d bits, host instructions: %d)\n",
+            keylen == AES_KEY_256 ? 256 : 128, use_ni);
+    }
+
+    return errors;
+}
+
+
+static int check_vectors(bool use_ni)
+{
+    uint8_t key[32];
+    static const uint8_t expected_128[AES_BLOCKLEN] = {
+        0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+        0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+    };
+    static const uint8_t expected_256[AES_BLOCKLEN] = {
+        0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf,
+        0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89
+    };
+
+    for (int i = 0; i < 32; i++)
+    {
+        key[i] = i;
+    }
+
+    return check_vector(AES_KEY_128, key, expected_128, use_ni) +
+        check_vector(AES_KEY_256, key, expected_256, use_ni);
+}
+
+
+// Compare the host instructions with the table implementation on random keys,
+// IVs and lengths. CBC operations are split in 2 calls to check the IV chaining.
+static int check_random()
+{
+    int errors = 0;
+
+    srand(0);
+
+    for (int iter = 0; iter < 1000; iter++)
+    {
+        uint8_t key[32], iv[AES_BLOCKLEN];
+        aes_keylen_e keylen = rand() & 1 ? AES_KEY_256 : AES_KEY_128;
+        aes_op_e op = (aes_op_e)(rand() % NB_OPS);
+        int nb_blocks = 1 + rand() % 32;
+        size_t size = nb_blocks * AES_BLOCKLEN;
+        size_t split = (rand() % nb_blocks) * AES_BLOCKLEN;
+        std::vector<uint8_t> ref(size), buf(size);
+
+        for (int i = 0; i < 32; i++) key[i] = rand();
+        for (int i = 0; i < AES_BLOCKLEN; i++) iv[i] = rand();
+        for (size_t i = 0; i < size; i++) ref[i] = buf[i] = rand();
+
+        AES_ctx ref_ctx, ctx;
+        init_ctx(&ref_ctx, keylen, key, iv, false);
+        init_ctx(&ctx, keylen, key, iv, true);
+
+        run_op(&ref_ctx, op, ref.data(), size, false);
+        run_op(&ctx, op, buf.data(), split, false);
+        run_op(&ctx, op, buf.data() + split, size - split, false);
+
+        if (ref != buf)
+        {
+            printf("Mismatch with the table implementation (op: %s, key: %d bits, blocks: %d)\n",
+                op_names[op], keylen == AES_KEY_256 ? 256 : 128, nb_blocks);
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+
+static void bench(const char *name, aes_keylen_e keylen, bool use_ni, bool per_block)
+{
+    uint8_t key[32] = { 0 }, iv[AES_BLOCKLEN] = { 0 };
+    std::vector<uint8_t> buf(BENCH_SIZE, 0x57);
+
+    printf("AES benchmark %s, %d bits, %s:", name, keylen == AES_KEY_256 ? 256 : 128,
+        per_block ? "per block" : "buffer");
+
+    for (int op = 0; op < NB_OPS; op++)
+    {
+        AES_ctx ctx;
+        struct timespec start, end;
+
+        init_ctx(&ctx, keylen, key, iv, use_ni);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        run_op(&ctx, (aes_op_e)op, buf.data(), BENCH_SIZE, per_block);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double duration = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+        printf(" %s %.1f MB/s", op_names[op], BENCH_SIZE / duration / 1e6);
+    }
+
+    printf("\n");
+}
+
+
+int main()
+{
+    int errors = check_vectors(false);
+
+    printf("Host AES instructions: %s\n", AES_has_ni() ? "available" : "not available");
+
+    if (AES_has_ni())
+    {
+        errors += check_vectors(true);
+        errors += check_random();
+    }
+
+    printf("AES check: %s\n", errors ? "failed" : "passed");
+
+    if (errors)
+    {
+        return 1;
+    }
+
+    for (int keylen = AES_KEY_128; keylen <= AES_KEY_256; keylen++)
+    {
+        bench("table", (aes_keylen_e)keylen, false, true);
+        if (AES_has_ni())
+        {
+            bench("host", (aes_keylen_e)keylen, true, true);
+            bench("host", (aes_keylen_e)keylen, true, false);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,431 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ISS execution speed benchmark.
+ *
+ * A core fetches and accesses data from a memory through a router, the way a
+ * core does in a cluster, with direct memory accesses. The driver loads a
+ * small program and starts the core. The program runs one of these kernels:
+ * - loop: a loop mixing loads, stores, ALU operations and a branch.
+ * - matmul: a 16x16 integer matrix multiplication, with the loop nest of the
+ *   MatMul kernels of the CNN libraries.
+ * It then writes its checksum to the driver, which is mapped behind the router,
+ * and goes to sleep.
+ * The driver checks the checksum and reports how many instructions the ISS
+ * executed per host second, and how many L1 data cache misses the host had per
+ * simulated instruction, when the host gives access to this counter. This lets
+ * the timed, block and functional execution modes, and layouts of the decoded
+ * instructions, be compared.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <vp/itf/wire.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// Layout of the memory
+// The program is not at 0 since the core prefetch buffer is flushed with address -1,
+// which is seen as containing the first bytes of the memory
+#define PROGRAM_ADDR   0x100
+#define DATA_ADDR      0x400
+#define NB_ITER_ADDR   0x7fc
+#define MATMUL_A_ADDR  0x1000
+#define MATMUL_B_ADDR  0x2000
+#define MATMUL_C_ADDR  0x3000
+#define MATMUL_SIZE    16
+
+// Number of instructions before, in and after the loop, up to the checksum store
+#define PROLOGUE_INSNS 3
+#define LOOP_INSNS     9
+#define EPILOGUE_INSNS 2
+
+// RV32I, loaded at PROGRAM_ADDR, the loop starts at PROGRAM_ADDR + 0xc
+static const uint32_t loop_program[] = {
+    0x7fc02283, // 0x100: lw    t0, 0x7fc(zero)
+    0x00000513, // 0x104: li    a0, 0
+    0x40000593, // 0x108: li    a1, 0x400
+    0x0005a603, // 0x10c: lw    a2, 0(a1)
+    0x00c50533, // 0x110: add   a0, a0, a2
+    0x00160613, // 0x114: addi  a2, a2, 1
+    0x00c5a023, // 0x118: sw    a2, 0(a1)
+    0x05554693, // 0x11c: xori  a3, a0, 0x55
+    0x00169693, // 0x120: slli  a3, a3, 1
+    0x00d50533, // 0x124: add   a0, a0, a3
+    0xfff28293, // 0x128: addi  t0, t0, -1
+    0xfe0290e3, // 0x12c: bnez  t0, 0x10c
+    0x10000737, // 0x130: lui   a4, 0x10000
+    0x00a72023, // 0x134: sw    a0, 0(a4)
+    0x10500073, // 0x138: wfi
+    0x0000006f, // 0x13c: j     .
+};
+
+// Number of instructions of each level of the matmul loop nest, up to the checksum store
+#define MATMUL_PROLOGUE_INSNS 2
+#define MATMUL_K_INSNS        8
+#define MATMUL_J_INSNS        (4 + MATMUL_SIZE * MATMUL_K_INSNS + 6)
+#define MATMUL_I_INSNS        (2 + MATMUL_SIZE * MATMUL_J_INSNS + 3)
+#define MATMUL_ITER_INSNS     (3 + MATMUL_SIZE * MATMUL_I_INSNS + 2)
+#define MATMUL_EPILOGUE_INSNS 2
+
+// RV32IM, loaded at PROGRAM_ADDR, C = A * B repeated the number of iterations,
+// the checksum is the sum of the elements of C of all iterations
+static const uint32_t matmul_program[] = {
+    0x7fc02283, // 0x100: lw    t0, 0x7fc(zero)
+    0x00000513, // 0x104: li    a0, 0
+    0x00001437, // 0x108: lui   s0, 0x1         iteration: A row
+    0x00003937, // 0x10c: lui   s2, 0x3         C element
+    0x01000313, // 0x110: li    t1, 16
+    0x000024b7, // 0x114: lui   s1, 0x2         i loop: B column
+    0x01000393, // 0x118: li    t2, 16
+    0x00040593, // 0x11c: mv    a1, s0          j loop
+    0x00048613, // 0x120: mv    a2, s1
+    0x00000693, // 0x124: li    a3, 0
+    0x01000e13, // 0x128: li    t3, 16
+    0x0005a703, // 0x12c: lw    a4, 0(a1)       k loop
+    0x00062783, // 0x130: lw    a5, 0(a2)
+    0x02f70733, // 0x134: mul   a4, a4, a5
+    0x00e686b3, // 0x138: add   a3, a3, a4
+    0x00458593, // 0x13c: addi  a1, a1, 4
+    0x04060613, // 0x140: addi  a2, a2, 64
+    0xfffe0e13, // 0x144: addi  t3, t3, -1
+    0xfe0e12e3, // 0x148: bnez  t3, 0x12c
+    0x00d92023, // 0x14c: sw    a3, 0(s2)
+    0x00d50533, // 0x150: add   a0, a0, a3
+    0x00490913, // 0x154: addi  s2, s2, 4
+    0x00448493, // 0x158: addi  s1, s1, 4
+    0xfff38393, // 0x15c: addi  t2, t2, -1
+    0xfa039ee3, // 0x160: bnez  t2, 0x11c
+    0x04040413, // 0x164: addi  s0, s0, 64
+    0xfff30313, // 0x168: addi  t1, t1, -1
+    0xfa0314e3, // 0x16c: bnez  t1, 0x114
+    0xfff28293, // 0x170: addi  t0, t0, -1
+    0xf8029ae3, // 0x174: bnez  t0, 0x108
+    0x10000737, // 0x178: lui   a4, 0x10000
+    0x00a72023, // 0x17c: sw    a0, 0(a4)
+    0x10500073, // 0x180: wfi
+    0x0000006f, // 0x184: j     .
+};
+
+
+static uint32_t matmul_a(int i, int k)
+{
+    return i + 2 * k + 1;
+}
+
+
+static uint32_t matmul_b(int k, int j)
+{
+    return k - j + 3;
+}
+
+
+class iss_bench : public vp::component
+{
+
+public:
+
+    iss_bench(js::config *config);
+
+    int build();
+    void start();
+
+private:
+
+    static void exec_handler(void *__this, vp::clock_event *event);
+    static vp::io_req_status_e exit_req(void *__this, vp::io_req *req);
+    static void irq_ack_sync(void *__this, int irq);
+
+    uint32_t access(uint64_t addr, uint32_t value, bool is_write);
+    void load();
+    int64_t nb_insns();
+    uint32_t expected_checksum();
+    void host_counter_start();
+    int64_t host_counter_stop();
+    void end(int errors);
+
+    vp::io_master mem;
+    vp::io_slave exit;
+    vp::wire_master<bool> fetchen;
+    vp::wire_slave<int> irq_ack;
+
+    vp::clock_event *exec_event;
+    vp::io_req req;
+
+    int nb_iterations;
+    bool matmul;
+
+    int host_counter_fd = -1;
+    int64_t start_cycles;
+    struct timespec start_time;
+    int errors = 0;
+    bool done = false;
+};
+
+
+iss_bench::iss_bench(js::config *config)
+    : vp::component(config)
+{
+}
+
+
+int iss_bench::build()
+{
+    this->new_master_port("mem", &this->mem);
+
+    this->exit.set_req_meth(&iss_bench::exit_req);
+    this->new_slave_port("exit", &this->exit);
+
+    this->new_master_port("fetchen", &this->fetchen);
+
+    this->irq_ack.set_sync_meth(&iss_bench::irq_ack_sync);
+    this->new_slave_port("irq_ack", &this->irq_ack);
+
+    this->exec_event = this->event_new(this, iss_bench::exec_handler);
+
+    this->nb_iterations = this->get_js_config()->get_child_int("nb_iterations");
+    this->matmul = this->get_js_config()->get_child_str("kernel") == "matmul";
+
+    return 0;
+}
+
+
+void iss_bench::start()
+{
+    this->event_enqueue(this->exec_event, 1);
+}
+
+
+void iss_bench::irq_ack_sync(void *__this, int irq)
+{
+    // The program does not use interrupts, the port is only there because the core
+    // requires it to be bound
+}
+
+
+uint32_t iss_bench::access(uint64_t addr, uint32_t value, bool is_write)
+{
+    this->req.init();
+    this->req.set_addr(addr);
+    this->req.set_size(4);
+    this->req.set_data((uint8_t *)&value);
+    this->req.set_is_write(is_write);
+
+    if (this->mem.req(&this->req) != vp::IO_REQ_OK)
+    {
+        printf("Request failed (addr: 0x%lx, is_write: %d)\n", addr, is_write);
+        this->errors++;
+    }
+
+    return value;
+}
+
+
+void iss_bench::load()
+{
+    const uint32_t *program = this->matmul ? matmul_program : loop_program;
+    int program_size = this->matmul ? sizeof(matmul_program) : sizeof(loop_program);
+
+    for (unsigned int i = 0; i < program_size / sizeof(uint32_t); i++)
+    {
+        this->access(PROGRAM_ADDR + i * 4, program[i], true);
+    }
+
+    if (this->matmul)
+    {
+        for (int i = 0; i < MATMUL_SIZE; i++)
+        {
+            for (int j = 0; j < MATMUL_SIZE; j++)
+            {
+                this->access(MATMUL_A_ADDR + (i * MATMUL_SIZE + j) * 4, matmul_a(i, j), true);
+                this->access(MATMUL_B_ADDR + (i * MATMUL_SIZE + j) * 4, matmul_b(i, j), true);
+            }
+        }
+    }
+    else
+    {
+        this->access(DATA_ADDR, 0, true);
+    }
+
+    this->access(NB_ITER_ADDR, this->nb_iterations, true);
+}
+
+
+int64_t iss_bench::nb_insns()
+{
+    if (this->matmul)
+    {
+        return MATMUL_PROLOGUE_INSNS + (int64_t)MATMUL_ITER_INSNS * this->nb_iterations +
+            MATMUL_EPILOGUE_INSNS;
+    }
+
+    return PROLOGUE_INSNS + (int64_t)LOOP_INSNS * this->nb_iterations + EPILOGUE_INSNS;
+}
+
+
+uint32_t iss_bench::expected_checksum()
+{
+    // Same computation as the program
+    if (this->matmul)
+    {
+        uint32_t sum = 0;
+
+        for (int i = 0; i < MATMUL_SIZE; i++)
+        {
+            for (int j = 0; j < MATMUL_SIZE; j++)
+            {
+                for (int k = 0; k < MATMUL_SIZE; k++)
+                {
+                    sum += matmul_a(i, k) * matmul_b(k, j);
+                }
+            }
+        }
+
+        return sum * this->nb_iterations;
+    }
+
+    uint32_t acc = 0;
+    uint32_t data = 0;
+
+    for (int i = 0; i < this->nb_iterations; i++)
+    {
+        acc += data;
+        data += 1;
+        acc += (acc ^ 0x55) << 1;
+    }
+
+    return acc;
+}
+
+
+// Counts the L1 data cache misses of the host, for the calling thread, which is
+// the one simulating the core. The counter is not available on all hosts, for
+// example in some virtual machines, in which case nothing is reported.
+void iss_bench::host_counter_start()
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    this->host_counter_fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+
+int64_t iss_bench::host_counter_stop()
+{
+    int64_t count = -1;
+
+    if (this->host_counter_fd != -1)
+    {
+        if (read(this->host_counter_fd, &count, sizeof(count)) != sizeof(count) || count == 0)
+        {
+            count = -1;
+        }
+        close(this->host_counter_fd);
+        this->host_counter_fd = -1;
+    }
+
+    return count;
+}
+
+
+vp::io_req_status_e iss_bench::exit_req(void *__this, vp::io_req *req)
+{
+    iss_bench *_this = (iss_bench *)__this;
+
+    if (!req->get_is_write() || req->get_size() != 4 || _this->done)
+    {
+        return vp::IO_REQ_INVALID;
+    }
+
+    int64_t host_misses = _this->host_counter_stop();
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double duration = (end.tv_sec - _this->start_time.tv_sec) + (end.tv_nsec - _this->start_time.tv_nsec) / 1e9;
+
+    uint32_t checksum = *(uint32_t *)req->get_data();
+    uint32_t expected = _this->expected_checksum();
+    if (checksum != expected)
+    {
+        printf("Wrong checksum (value: 0x%x, expected: 0x%x)\n", checksum, expected);
+        _this->errors++;
+    }
+
+    int64_t nb_insns = _this->nb_insns();
+    int64_t cycles = _this->get_cycles() - _this->start_cycles;
+
+    printf("ISS benchmark: %ld instructions, %ld cycles, %.3f s, %.1f MIPS\n",
+        nb_insns, cycles, duration, nb_insns / duration / 1e6);
+
+    if (host_misses != -1)
+    {
+        printf("ISS benchmark: %ld host L1d misses, %.4f per instruction\n",
+            host_misses, (double)host_misses / nb_insns);
+    }
+
+    _this->end(_this->errors);
+
+    return vp::IO_REQ_OK;
+}
+
+
+void iss_bench::end(int errors)
+{
+    printf("ISS check: %s\n", errors ? "failed" : "passed");
+
+    this->clock->stop_engine(errors != 0);
+
+    // Keep an event pending, otherwise the engine can see that there is nothing
+    // left to simulate before it sees the stop request, and reports a failure.
+    this->done = true;
+    this->event_enqueue(this->exec_event, 1000000);
+}
+
+
+void iss_bench::exec_handler(void *__this, vp::clock_event *event)
+{
+    iss_bench *_this = (iss_bench *)__this;
+
+    if (_this->done)
+    {
+        return;
+    }
+
+    _this->load();
+
+    _this->start_cycles = _this->get_cycles();
+    clock_gettime(CLOCK_MONOTONIC, &_this->start_time);
+    _this->host_counter_start();
+
+    _this->fetchen.sync(true);
+}
+
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new iss_bench(config);
+}
@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MCHAN end-to-end test and benchmark.
+ *
+ * The DMA is connected to an external memory and to a word-interleaved L1
+ * made of several banks, like in the cluster. Commands are pushed through the
+ * DMA command queue the same way a core does, 1D and 2D in both directions,
+ * and the end of each command is waited for with the DMA event line, like a
+ * core sleeping on it, and the destination is then checked through normal
+ * requests. The number of
+ * cycles taken by each command is reported so that the burst and bulk modes
+ * can be compared. A benchmark then repeats L2 to L1 copies and reports the
+ * simulated throughput per host second.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <vp/itf/wire.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "archi/dma/mchan_v7.h"
+
+// Layout of the external memory, the source is followed by the destinations of the
+// 1D and 2D commands
+#define EXT_SRC        0x00000
+#define EXT_DST_1D     0x40000
+#define EXT_DST_2D     0x80000
+
+// Layout of the L1
+#define L1_DST_1D      0x0000
+#define L1_DST_2D      0x8000
+
+typedef struct
+{
+    const char *name;
+    bool loc2ext;
+    bool is_2d;
+} mchan_bench_cmd_t;
+
+static const mchan_bench_cmd_t commands[] = {
+    { "ext2loc_1d", false, false },
+    { "loc2ext_1d", true,  false },
+    { "ext2loc_2d", false, true  },
+    { "loc2ext_2d", true,  true  },
+};
+
+#define NB_COMMANDS (sizeof(commands) / sizeof(commands[0]))
+
+
+class mchan_bench : public vp::component
+{
+
+public:
+
+    mchan_bench(js::config *config);
+
+    int build();
+    void start();
+
+private:
+
+    static void exec_handler(void *__this, vp::clock_event *event);
+    static void irq_sync(void *__this, bool value);
+
+    uint32_t access(vp::io_master *itf, uint64_t addr, uint32_t value, bool is_write);
+    uint8_t read_byte(vp::io_master *itf, uint64_t addr);
+    void push_command(const mchan_bench_cmd_t *cmd);
+    bool command_done();
+    int check_command(const mchan_bench_cmd_t *cmd);
+    void end(int errors);
+
+    vp::io_master dma;
+    vp::io_master l1;
+    vp::io_master ext;
+    // The DMA event and interrupt lines, the status is checked when any of them is raised
+    vp::wire_slave<bool> irq;
+
+    vp::clock_event *exec_event;
+    vp::io_req req;
+
+    int size;
+    int length;
+    int stride;
+    int nb_iterations;
+
+    int command;
+    int iteration;
+    int counter;
+    int64_t start_cycles;
+    struct timespec start_time;
+    int errors = 0;
+    bool done = false;
+};
+
+
+mchan_bench::mchan_bench(js::config *config)
+    : vp::component(config)
+{
+}
+
+
+int mchan_bench::build()
+{
+    this->new_master_port("dma", &this->dma);
+    this->new_master_port("l1", &this->l1);
+    this->new_master_port("ext", &this->ext);
+
+    this->irq.set_sync_meth(&mchan_bench::irq_sync);
+    this->new_slave_port("irq", &this->irq);
+
+    this->exec_event = this->event_new(this, mchan_bench::exec_handler);
+
+    this->size = this->get_js_config()->get_child_int("size");
+    this->length = this->get_js_config()->get_child_int("length");
+    this->stride = this->get_js_config()->get_child_int("stride");
+    this->nb_iterations = this->get_js_config()->get_child_int("nb_iterations");
+
+    return 0;
+}
+
+
+void mchan_bench::start()
+{
+    this->command = -1;
+    this->event_enqueue(this->exec_event, 1);
+}
+
+
+void mchan_bench::irq_sync(void *__this, bool value)
+{
+    mchan_bench *_this = (mchan_bench *)__this;
+
+    if (value && !_this->done && !_this->exec_event->is_enqueued())
+    {
+        _this->event_enqueue(_this->exec_event, 1);
+    }
+}
+
+
+uint32_t mchan_bench::access(vp::io_master *itf, uint64_t addr, uint32_t value, bool is_write)
+{
+    this->req.init();
+    this->req.set_addr(addr);
+    this->req.set_size(4);
+    this->req.set_data((uint8_t *)&value);
+    this->req.set_is_write(is_write);
+
+    if (itf->req(&this->req) != vp::IO_REQ_OK)
+    {
+        printf("Request failed (addr: 0x%lx, is_write: %d)\n", addr, is_write);
+        this->errors++;
+    }
+
+    return value;
+}
+
+
+uint8_t mchan_bench::read_byte(vp::io_master *itf, uint64_t addr)
+{
+    return this->access(itf, addr & ~3ULL, 0, false) >> ((addr & 3) * 8);
+}
+
+
+void mchan_bench::push_command(const mchan_bench_cmd_t *cmd)
+{
+    uint32_t loc = cmd->is_2d ? L1_DST_2D : L1_DST_1D;
+    uint32_t ext = cmd->loc2ext ? (cmd->is_2d ? EXT_DST_2D : EXT_DST_1D) : EXT_SRC;
+
+    // Same sequence as a core, allocate a counter and push the command words
+    this->counter = this->access(&this->dma, MCHAN_CMD_OFFSET, 0, false);
+
+    uint32_t value = MCHAN_CMD_CMD_LEN_SET(0, this->size);
+    value = MCHAN_CMD_CMD_TYPE_SET(value, !cmd->loc2ext);
+    value = MCHAN_CMD_CMD_INC_SET(value, 1);
+    value = MCHAN_CMD_CMD__2D_EXT_SET(value, cmd->is_2d);
+    value = MCHAN_CMD_CMD_ELE_SET(value, 1);
+
+    this->access(&this->dma, MCHAN_CMD_OFFSET, value, true);
+    this->access(&this->dma, MCHAN_CMD_OFFSET, loc, true);
+    this->access(&this->dma, MCHAN_CMD_OFFSET, ext, true);
+
+    if (cmd->is_2d)
+    {
+        this->access(&this->dma, MCHAN_CMD_OFFSET, this->length, true);
+        this->access(&this->dma, MCHAN_CMD_OFFSET, this->stride, true);
+    }
+
+    this->start_cycles = this->get_cycles();
+}
+
+
+bool mchan_bench::command_done()
+{
+    if (this->access(&this->dma, MCHAN_STATUS_OFFSET, 0, false) & (1 << this->counter))
+    {
+        return false;
+    }
+
+    this->access(&this->dma, MCHAN_STATUS_OFFSET, 1 << this->counter, true);
+
+    return true;
+}
+
+
+int mchan_bench::check_command(const mchan_bench_cmd_t *cmd)
+{
+    uint32_t loc = cmd->is_2d ? L1_DST_2D : L1_DST_1D;
+    uint64_t ext = cmd->loc2ext ? (cmd->is_2d ? EXT_DST_2D : EXT_DST_1D) : EXT_SRC;
+    int errors = 0;
+
+    // The local side is always contiguous, while the external side is made of lines in
+    // 2D mode. The loc2ext commands copy back what the ext2loc ones wrote, so both
+    // are checked against the source. This is checked byte per byte as lines do not
+    // have to be a multiple of words.
+    for (int i = 0; i < this->size; i++)
+    {
+        uint64_t ext_offset = cmd->is_2d ? (i / this->length) * this->stride + i % this->length : i;
+        uint8_t expected = this->read_byte(&this->ext, EXT_SRC + ext_offset);
+        uint8_t value = cmd->loc2ext ? this->read_byte(&this->ext, ext + ext_offset) :
+            this->read_byte(&this->l1, loc + i);
+
+        if (value != expected)
+        {
+            if (errors < 10)
+            {
+                printf("Wrong value (command: %s, offset: 0x%x, value: 0x%x, expected: 0x%x)\n",
+                    cmd->name, i, value, expected);
+            }
+            errors++;
+        }
+    }
+
+    printf("Command %s done (size: %d, cycles: %ld, errors: %d)\n", cmd->name, this->size,
+        this->get_cycles() - this->start_cycles, errors);
+
+    return errors;
+}
+
+
+void mchan_bench::end(int errors)
+{
+    printf("MCHAN check: %s\n", errors ? "failed" : "passed");
+
+    this->clock->stop_engine(errors != 0);
+
+    // Keep an event pending, otherwise the engine can see that there is nothing
+    // left to simulate before it sees the stop request, and reports a failure.
+    this->done = true;
+    this->event_enqueue(this->exec_event, 1000000);
+}
+
+
+void mchan_bench::exec_handler(void *__this, vp::clock_event *event)
+{
+    mchan_bench *_this = (mchan_bench *)__this;
+
+    if (_this->done)
+    {
+        return;
+    }
+
+    if (_this->command == -1)
+    {
+        // Fill the source with a pattern and the destinations with something else
+        int ext_size = _this->size / _this->length * _this->stride;
+        for (int i = 0; i < ext_size; i += 4)
+        {
+            _this->access(&_this->ext, EXT_SRC + i, 0x12345678 * (i + 1), true);
+            _this->access(&_this->ext, EXT_DST_1D + i, 0, true);
+            _this->access(&_this->ext, EXT_DST_2D + i, 0, true);
+        }
+        for (int i = 0; i < _this->size; i += 4)
+        {
+            _this->access(&_this->l1, L1_DST_1D + i, 0, true);
+            _this->access(&_this->l1, L1_DST_2D + i, 0, true);
+        }
+
+        _this->command = 0;
+        _this->push_command(&commands[0]);
+    }
+    else if (_this->command < (int)NB_COMMANDS)
+    {
+        if (_this->command_done())
+        {
+            _this->errors += _this->check_command(&commands[_this->command]);
+
+            _this->command++;
+            if (_this->command < (int)NB_COMMANDS)
+            {
+                _this->push_command(&commands[_this->command]);
+            }
+            else
+            {
+                if (_this->errors)
+                {
+                    _this->end(_this->errors);
+                    return;
+                }
+
+                _this->iteration = 0;
+                _this->push_command(&commands[0]);
+                clock_gettime(CLOCK_MONOTONIC, &_this->start_time);
+            }
+        }
+    }
+    else
+    {
+        // Benchmark, the same command is repeated and the next one is pushed as soon as
+        // the previous one is over
+        if (_this->command_done())
+        {
+            _this->iteration++;
+            if (_this->iteration < _this->nb_iterations)
+            {
+                _this->push_command(&commands[0]);
+            }
+            else
+            {
+                struct timespec end;
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                double duration = (end.tv_sec - _this->start_time.tv_sec) + (end.tv_nsec - _this->start_time.tv_nsec) / 1e9;
+
+                printf("MCHAN benchmark: %d commands of %d bytes, %.3f s, %.1f MB/s\n",
+                    _this->nb_iterations, _this->size, duration,
+                    (double)_this->nb_iterations * _this->size / duration / 1e6);
+
+                _this->end(0);
+                return;
+            }
+        }
+    }
+}
+
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new mchan_bench(config);
+}
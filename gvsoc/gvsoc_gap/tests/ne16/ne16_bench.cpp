@@ -0,0 +1,400 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * NE16 fast mode test and benchmark.
+ *
+ * The platform has 2 NE16, one in step-by-step mode, which is the reference,
+ * and one in fast mode, each with its own memory. Each job is run on both
+ * with the same random memory content and the same configuration, first on
+ * the reference and then on the fast one. The whole memories must then be the
+ * same, and the jobs must take the same number of cycles, from the trigger to
+ * the end-of-job interrupt. The host time taken by each job is also reported.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <vp/itf/wire.hpp>
+#include <stdio.h>
+#include <time.h>
+
+// The NE16 streamers only see the low 128KB of the memory
+#define MEM_SIZE           0x20000
+
+// Memory layout, all the job operands are random
+#define INFEAT_ADDR        0x00000
+#define WEIGHTS_ADDR       0x08000
+#define SCALE_ADDR         0x10000
+#define SCALE_SHIFT_ADDR   0x10400
+#define SCALE_BIAS_ADDR    0x10800
+#define OUTFEAT_ADDR       0x11000
+
+// Registers, as seen from the NE16 input port
+#define NE16_TRIGGER       0x00
+#define NE16_ACQUIRE       0x04
+#define NE16_REG(x)        (0x20 + (x) * 4)
+
+#define NE16_REG_WEIGHTS_PTR       0
+#define NE16_REG_INFEAT_PTR        1
+#define NE16_REG_OUTFEAT_PTR       2
+#define NE16_REG_SCALE_PTR         3
+#define NE16_REG_SCALE_SHIFT_PTR   4
+#define NE16_REG_SCALE_BIAS_PTR    5
+#define NE16_REG_INFEAT_D0_STRIDE  6
+#define NE16_REG_OUTFEAT_D0_STRIDE 9
+#define NE16_REG_WEIGHTS_D0_STRIDE 12
+#define NE16_REG_SUBTILE_REM0      15
+#define NE16_REG_SUBTILE_REM1      16
+#define NE16_REG_SUBTILE_REM2      17
+#define NE16_REG_SUBTILE_NB0       18
+#define NE16_REG_SUBTILE_NB1       19
+#define NE16_REG_PADDING           20
+#define NE16_REG_WEIGHT_OFFSET     21
+#define NE16_REG_FILTER_MASK       22
+#define NE16_REG_CONFIG0           23
+
+// CONFIG0 fields
+#define CFG_QW(x)          ((x) - 1)
+#define CFG_MODE16         (1 << 3)
+#define CFG_OUTQUANT       (1 << 4)
+#define CFG_DEPTHWISE      (1 << 5)
+#define CFG_1X1            (2 << 5)
+#define CFG_LINEAR         (1 << 7)
+#define CFG_NORM_BITS_32   (2 << 12)
+#define CFG_QUANT_SHIFT(x) ((x) << 16)
+#define CFG_QUANT_BITS_32  (2 << 21)
+#define CFG_NORECT         (1 << 23)
+#define CFG_NORM_SHIFT     (1 << 24)
+#define CFG_NORM_BIAS      (1 << 25)
+
+typedef struct
+{
+    const char *name;
+    uint32_t config;
+    int ki;
+    int ko;
+    int ho;
+    int wo;
+    uint32_t padding;
+    uint32_t filter_mask;
+} ne16_bench_job_t;
+
+// Jobs covering the 3x3, 1x1, depthwise and linear modes, in 8 and 16 bits. Some of them have
+// input channel remainders, filter masks and padding, so that the datapath masks are used.
+// Most of them stream out the raw accumulators, as quantized outputs of random data are mostly
+// saturated and would hide differences.
+static const ne16_bench_job_t jobs[] = {
+    { "conv3x3_mode8",      CFG_QW(8) | CFG_QUANT_BITS_32, 24, 40, 5, 5, 0, 0 },
+    { "conv3x3_mode8_mask", CFG_QW(4) | CFG_QUANT_BITS_32, 16, 32, 4, 3, 0x1100002a, 0x00010100 },
+    { "conv3x3_mode8_quant", CFG_QW(4) | CFG_OUTQUANT | CFG_QUANT_SHIFT(10) | CFG_NORM_BIAS | CFG_NORM_SHIFT,
+        16, 32, 4, 3, 0, 0 },
+    { "conv3x3_mode16",     CFG_QW(8) | CFG_MODE16 | CFG_QUANT_BITS_32, 24, 32, 3, 4, 0, 0 },
+    { "conv1x1_mode8",      CFG_QW(4) | CFG_1X1 | CFG_QUANT_BITS_32, 40, 48, 3, 5, 0, 0 },
+    { "conv1x1_mode16",     CFG_QW(2) | CFG_1X1 | CFG_MODE16 | CFG_OUTQUANT | CFG_QUANT_BITS_32 | CFG_NORM_BITS_32 | CFG_NORECT,
+        32, 32, 4, 4, 0, 0 },
+    { "depthwise_mode8",    CFG_QW(8) | CFG_DEPTHWISE | CFG_QUANT_BITS_32, 24, 24, 4, 4, 0, 0 },
+    { "linear_mode8",       CFG_QW(8) | CFG_1X1 | CFG_LINEAR | CFG_QUANT_BITS_32, 72, 40, 1, 1, 0, 0 },
+    { "linear_mode16",      CFG_QW(8) | CFG_1X1 | CFG_LINEAR | CFG_MODE16 | CFG_QUANT_BITS_32, 40, 32, 1, 1, 0, 0 },
+};
+
+#define NB_JOBS (sizeof(jobs) / sizeof(jobs[0]))
+
+
+class ne16_bench : public vp::component
+{
+
+public:
+
+    ne16_bench(js::config *config);
+
+    int build();
+    void start();
+
+private:
+
+    static void exec_handler(void *__this, vp::clock_event *event);
+    static void irq_sync(void *__this, bool value);
+
+    uint32_t access(vp::io_master *itf, uint64_t addr, uint32_t value, bool is_write);
+    void fill_memories(int seed);
+    void push_job(vp::io_master *itf, const ne16_bench_job_t *job);
+    int compare_memories(const ne16_bench_job_t *job);
+    void end(int errors);
+
+    // Register interfaces and memories of the reference and fast NE16
+    vp::io_master ref;
+    vp::io_master ref_mem;
+    vp::io_master fast;
+    vp::io_master fast_mem;
+    // End-of-job interrupt, shared by both as only one of them is running at a time
+    vp::wire_slave<bool> irq;
+
+    vp::clock_event *exec_event;
+    vp::io_req req;
+
+    int job;
+    bool fast_running;
+    int64_t start_cycles;
+    int64_t ref_cycles;
+    struct timespec start_time;
+    double ref_duration;
+    double total_ref_duration = 0;
+    double total_fast_duration = 0;
+    int errors = 0;
+    bool done = false;
+};
+
+
+ne16_bench::ne16_bench(js::config *config)
+    : vp::component(config)
+{
+}
+
+
+int ne16_bench::build()
+{
+    this->new_master_port("ref", &this->ref);
+    this->new_master_port("ref_mem", &this->ref_mem);
+    this->new_master_port("fast", &this->fast);
+    this->new_master_port("fast_mem", &this->fast_mem);
+
+    this->irq.set_sync_meth(&ne16_bench::irq_sync);
+    this->new_slave_port("irq", &this->irq);
+
+    this->exec_event = this->event_new(this, ne16_bench::exec_handler);
+
+    return 0;
+}
+
+
+void ne16_bench::start()
+{
+    this->job = -1;
+    this->event_enqueue(this->exec_event, 1);
+}
+
+
+void ne16_bench::irq_sync(void *__this, bool value)
+{
+    ne16_bench *_this = (ne16_bench *)__this;
+
+    if (value && !_this->done && !_this->exec_event->is_enqueued())
+    {
+        _this->event_enqueue(_this->exec_event, 1);
+    }
+}
+
+
+uint32_t ne16_bench::access(vp::io_master *itf, uint64_t addr, uint32_t value, bool is_write)
+{
+    this->req.init();
+    this->req.set_addr(addr);
+    this->req.set_size(4);
+    this->req.set_data((uint8_t *)&value);
+    this->req.set_is_write(is_write);
+
+    if (itf->req(&this->req) != vp::IO_REQ_OK)
+    {
+        printf("Request failed (addr: 0x%lx, is_write: %d)\n", addr, is_write);
+        this->errors++;
+    }
+
+    return value;
+}
+
+
+void ne16_bench::fill_memories(int seed)
+{
+    // xorshift32, so that the data does not depend on the host libc
+    uint32_t state = 0x2545f491 * (seed + 1);
+
+    for (int i = 0; i < MEM_SIZE; i += 4)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        this->access(&this->ref_mem, i, state, true);
+        this->access(&this->fast_mem, i, state, true);
+    }
+}
+
+
+void ne16_bench::push_job(vp::io_master *itf, const ne16_bench_job_t *job)
+{
+    bool mode16 = job->config & CFG_MODE16;
+    bool depthwise = (job->config & (3 << 5)) == CFG_DEPTHWISE;
+    int fs = (job->config & (3 << 5)) == CFG_1X1 ? 1 : 3;
+    int qw = (job->config & 7) + 1;
+    int out_bytes = job->config & CFG_QUANT_BITS_32 ? 4 : 1;
+
+    int nb_ki = (job->ki + 15) / 16, rem_ki = job->ki % 16 ? job->ki % 16 : 16;
+    int nb_ko = (job->ko + 31) / 32, rem_ko = job->ko % 32 ? job->ko % 32 : 32;
+    if (depthwise)
+    {
+        nb_ko = nb_ki;
+        rem_ko = rem_ki;
+    }
+    int nb_ho = (job->ho + 2) / 3, rem_ho = job->ho % 3;
+    int nb_wo = (job->wo + 2) / 3, rem_wo = job->wo % 3;
+    int rem_hi = rem_ho ? rem_ho + fs - 1 : 0;
+    int rem_wi = rem_wo ? rem_wo + fs - 1 : 0;
+    int in_pixel = job->ki * (mode16 ? 2 : 1);
+    int wi = job->wo + fs - 1, hi = job->ho + fs - 1;
+    int weights_d0 = fs == 3 ? 18 : 2 * qw;
+
+    // Same sequence as the runtime, acquire a job, configure it and trigger it
+    this->access(itf, NE16_ACQUIRE, 0, false);
+
+    uint32_t regs[][2] = {
+        { NE16_REG_WEIGHTS_PTR,         WEIGHTS_ADDR },
+        { NE16_REG_INFEAT_PTR,          INFEAT_ADDR },
+        { NE16_REG_OUTFEAT_PTR,         OUTFEAT_ADDR },
+        { NE16_REG_SCALE_PTR,           SCALE_ADDR },
+        { NE16_REG_SCALE_SHIFT_PTR,     SCALE_SHIFT_ADDR },
+        { NE16_REG_SCALE_BIAS_PTR,      SCALE_BIAS_ADDR },
+        { NE16_REG_INFEAT_D0_STRIDE,    (uint32_t)in_pixel },
+        { NE16_REG_INFEAT_D0_STRIDE+1,  (uint32_t)(in_pixel * wi) },
+        { NE16_REG_INFEAT_D0_STRIDE+2,  (uint32_t)(in_pixel * wi * hi) },
+        { NE16_REG_OUTFEAT_D0_STRIDE,   out_bytes == 4 ? 32U : 0U },
+        { NE16_REG_OUTFEAT_D0_STRIDE+1, (uint32_t)(job->ko * out_bytes) },
+        { NE16_REG_OUTFEAT_D0_STRIDE+2, (uint32_t)(job->ko * out_bytes * job->wo) },
+        { NE16_REG_WEIGHTS_D0_STRIDE,   (uint32_t)weights_d0 },
+        { NE16_REG_WEIGHTS_D0_STRIDE+1, (uint32_t)(weights_d0 * qw) },
+        { NE16_REG_WEIGHTS_D0_STRIDE+2, (uint32_t)(weights_d0 * qw * nb_ki) },
+        { NE16_REG_SUBTILE_REM0,        (uint32_t)((rem_ko << 16) | rem_ki) },
+        { NE16_REG_SUBTILE_REM1,        (uint32_t)((rem_ho << 16) | rem_wo) },
+        { NE16_REG_SUBTILE_REM2,        (uint32_t)((rem_hi << 16) | rem_wi) },
+        { NE16_REG_SUBTILE_NB0,         (uint32_t)((nb_ko << 16) | nb_ki) },
+        { NE16_REG_SUBTILE_NB1,         (uint32_t)((nb_ho << 16) | nb_wo) },
+        { NE16_REG_PADDING,             job->padding },
+        { NE16_REG_WEIGHT_OFFSET,       (uint32_t)-119 },
+        { NE16_REG_FILTER_MASK,         job->filter_mask },
+        { NE16_REG_CONFIG0,             job->config },
+    };
+
+    for (unsigned int i = 0; i < sizeof(regs) / sizeof(regs[0]); i++)
+    {
+        this->access(itf, NE16_REG(regs[i][0]), regs[i][1], true);
+    }
+
+    this->start_cycles = this->get_cycles();
+    clock_gettime(CLOCK_MONOTONIC, &this->start_time);
+
+    this->access(itf, NE16_TRIGGER, 0, true);
+}
+
+
+int ne16_bench::compare_memories(const ne16_bench_job_t *job)
+{
+    int errors = 0;
+
+    for (int i = 0; i < MEM_SIZE; i += 4)
+    {
+        uint32_t expected = this->access(&this->ref_mem, i, 0, false);
+        uint32_t value = this->access(&this->fast_mem, i, 0, false);
+
+        if (value != expected)
+        {
+            if (errors < 10)
+            {
+                printf("Wrong value (job: %s, addr: 0x%x, value: 0x%x, expected: 0x%x)\n",
+                    job->name, i, value, expected);
+            }
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+
+void ne16_bench::end(int errors)
+{
+    printf("NE16 benchmark: step-by-step %.3f ms, fast %.3f ms\n",
+        this->total_ref_duration * 1e3, this->total_fast_duration * 1e3);
+    printf("NE16 check: %s\n", errors ? "failed" : "passed");
+
+    this->clock->stop_engine(errors != 0);
+
+    // Keep an event pending, otherwise the engine can see that there is nothing
+    // left to simulate before it sees the stop request, and reports a failure.
+    this->done = true;
+    this->event_enqueue(this->exec_event, 1000000);
+}
+
+
+void ne16_bench::exec_handler(void *__this, vp::clock_event *event)
+{
+    ne16_bench *_this = (ne16_bench *)__this;
+
+    if (_this->done)
+    {
+        return;
+    }
+
+    if (_this->job >= 0)
+    {
+        const ne16_bench_job_t *job = &jobs[_this->job];
+        int64_t cycles = _this->get_cycles() - _this->start_cycles;
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double duration = (end.tv_sec - _this->start_time.tv_sec) + (end.tv_nsec - _this->start_time.tv_nsec) / 1e9;
+
+        if (!_this->fast_running)
+        {
+            // The reference is done, run the same job in fast mode
+            _this->ref_cycles = cycles;
+            _this->ref_duration = duration;
+            _this->total_ref_duration += duration;
+            _this->fast_running = true;
+            _this->push_job(&_this->fast, job);
+            return;
+        }
+
+        _this->total_fast_duration += duration;
+
+        int errors = _this->compare_memories(job);
+        if (cycles != _this->ref_cycles)
+        {
+            printf("Wrong job duration (job: %s, cycles: %ld, expected: %ld)\n", job->name,
+                cycles, _this->ref_cycles);
+            errors++;
+        }
+
+        printf("Job %s done (cycles: %ld, step-by-step: %.3f ms, fast: %.3f ms, errors: %d)\n",
+            job->name, cycles, _this->ref_duration * 1e3, duration * 1e3, errors);
+
+        _this->errors += errors;
+    }
+
+    _this->job++;
+    if (_this->job == (int)NB_JOBS)
+    {
+        _this->end(_this->errors);
+        return;
+    }
+
+    _this->fill_memories(_this->job);
+    _this->fast_running = false;
+    _this->push_job(&_this->ref, &jobs[_this->job]);
+}
+
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new ne16_bench(config);
+}
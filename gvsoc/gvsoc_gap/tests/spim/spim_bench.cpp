@@ -0,0 +1,431 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * UDMA SPIM and SPI flash end-to-end test and benchmark.
+ *
+ * The UDMA SPIM is connected to a SPI flash and to an L2 memory. The driver
+ * programs the UDMA the same way a core does, with command buffers in L2, and
+ * waits for the end-of-transfer event. It first programs a pattern into the
+ * flash, then reads it back with single and quad reads and checks the data.
+ * The number of cycles taken by each command is reported so that edge-level
+ * syncs and transaction-level transfers can be compared. A benchmark then
+ * repeats quad reads, like a boot loader copying an image from the flash, and
+ * reports the host time.
+ *
+ * The driver sits between the SPIM and the flash, to forward the chip select
+ * to the flash wire, count the syncs and transfers on the bus, and reject
+ * transfers when they are disabled, which forces the edge-level path.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <vp/itf/qspim.hpp>
+#include <vp/itf/wire.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "archi/udma/udma_v3.h"
+#include "archi/udma/spim/udma_spim_v3.h"
+
+// Layout of the L2
+#define L2_CMD         0x00000
+#define L2_TX          0x10000
+#define L2_RX          0x20000
+
+// Where the pattern is programmed in the flash
+#define FLASH_ADDR     0x1000
+
+// UDMA registers of the SPIM, which is the first peripheral
+#define SPIM_RX        (UDMA_PERIPH_OFFSET(0) + UDMA_CHANNEL_RX_OFFSET)
+#define SPIM_TX        (UDMA_PERIPH_OFFSET(0) + UDMA_CHANNEL_TX_OFFSET)
+#define SPIM_CMD       (UDMA_PERIPH_OFFSET(0) + UDMA_CHANNEL_CUSTOM_OFFSET)
+
+// Event generated by the SPIM at the end of a command buffer
+#define SPIM_EOT_EVENT 3
+
+typedef enum
+{
+    SPIM_BENCH_PROGRAM,
+    SPIM_BENCH_SINGLE_READ,
+    SPIM_BENCH_QUAD_READ,
+} spim_bench_cmd_e;
+
+static const char *cmd_names[] = { "page_program", "single_read", "quad_read" };
+
+#define NB_COMMANDS (sizeof(cmd_names) / sizeof(cmd_names[0]))
+
+
+class spim_bench : public vp::component
+{
+
+public:
+
+    spim_bench(js::config *config);
+
+    int build();
+    void start();
+
+private:
+
+    static void exec_handler(void *__this, vp::clock_event *event);
+    static void event_sync(void *__this, int event);
+    static void spi_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
+    static void spi_cs_sync(void *__this, int cs, int active);
+    static bool spi_xfer(void *__this, vp::qspim_xfer *xfer);
+    static void spi_slave_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
+
+    uint32_t access(vp::io_master *itf, uint64_t addr, uint32_t value, bool is_write);
+    void enqueue(uint64_t channel, uint32_t addr, uint32_t size);
+    void push_command(spim_bench_cmd_e cmd);
+    int check_command(spim_bench_cmd_e cmd);
+    void end(int errors);
+
+    vp::io_master udma;
+    vp::io_master l2;
+    vp::wire_slave<int> event;
+
+    // Interposed between the SPIM and the flash
+    vp::qspim_slave spi_in;
+    vp::qspim_master spi_out;
+    vp::wire_master<bool> spi_cs;
+
+    vp::clock_event *exec_event;
+    vp::io_req req;
+
+    int size;
+    int clkdiv;
+    int nb_iterations;
+
+    int command;
+    int iteration;
+    int64_t start_cycles;
+    int64_t cycles;
+    int64_t nb_syncs;
+    int64_t nb_xfers;
+    struct timespec start_time;
+    int errors = 0;
+    bool done = false;
+};
+
+
+spim_bench::spim_bench(js::config *config)
+    : vp::component(config)
+{
+}
+
+
+int spim_bench::build()
+{
+    this->new_master_port("udma", &this->udma);
+    this->new_master_port("l2", &this->l2);
+
+    this->event.set_sync_meth(&spim_bench::event_sync);
+    this->new_slave_port("event", &this->event);
+
+    this->spi_in.set_sync_meth(&spim_bench::spi_sync);
+    this->spi_in.set_cs_sync_meth(&spim_bench::spi_cs_sync);
+    // Without it, the slave rejects transfers and the SPIM falls back to edge-level syncs
+    if (this->get_js_config()->get_child_bool("xfer"))
+    {
+        this->spi_in.set_xfer_meth(&spim_bench::spi_xfer);
+    }
+    this->new_slave_port("spi_in", &this->spi_in);
+
+    this->spi_out.set_sync_meth(&spim_bench::spi_slave_sync);
+    this->new_master_port("spi_out", &this->spi_out);
+
+    this->new_master_port("spi_cs", &this->spi_cs);
+
+    this->exec_event = this->event_new(this, spim_bench::exec_handler);
+
+    this->size = this->get_js_config()->get_child_int("size");
+    this->clkdiv = this->get_js_config()->get_child_int("clkdiv");
+    this->nb_iterations = this->get_js_config()->get_child_int("nb_iterations");
+
+    return 0;
+}
+
+
+void spim_bench::start()
+{
+    this->command = -1;
+    this->nb_syncs = 0;
+    this->nb_xfers = 0;
+    this->event_enqueue(this->exec_event, 1);
+}
+
+
+void spim_bench::event_sync(void *__this, int event)
+{
+    spim_bench *_this = (spim_bench *)__this;
+
+    if (event == SPIM_EOT_EVENT && !_this->done)
+    {
+        // The command duration stops at the end-of-transfer, the check is delayed a bit
+        // to let the last RX word reach L2
+        _this->cycles = _this->get_cycles() - _this->start_cycles;
+        _this->event_enqueue(_this->exec_event, 10);
+    }
+}
+
+
+void spim_bench::spi_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask)
+{
+    spim_bench *_this = (spim_bench *)__this;
+    _this->nb_syncs++;
+    _this->spi_out.sync(sck, data_0, data_1, data_2, data_3, mask);
+}
+
+
+void spim_bench::spi_cs_sync(void *__this, int cs, int active)
+{
+    spim_bench *_this = (spim_bench *)__this;
+    _this->spi_cs.sync(active);
+}
+
+
+bool spim_bench::spi_xfer(void *__this, vp::qspim_xfer *xfer)
+{
+    spim_bench *_this = (spim_bench *)__this;
+    _this->nb_xfers++;
+    return _this->spi_out.xfer(xfer);
+}
+
+
+void spim_bench::spi_slave_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask)
+{
+    spim_bench *_this = (spim_bench *)__this;
+    _this->spi_in.sync(sck, data_0, data_1, data_2, data_3, mask);
+}
+
+
+uint32_t spim_bench::access(vp::io_master *itf, uint64_t addr, uint32_t value, bool is_write)
+{
+    this->req.init();
+    this->req.set_addr(addr);
+    this->req.set_size(4);
+    this->req.set_data((uint8_t *)&value);
+    this->req.set_is_write(is_write);
+
+    if (itf->req(&this->req) != vp::IO_REQ_OK)
+    {
+        printf("Request failed (addr: 0x%lx, is_write: %d)\n", addr, is_write);
+        this->errors++;
+    }
+
+    return value;
+}
+
+
+void spim_bench::enqueue(uint64_t channel, uint32_t addr, uint32_t size)
+{
+    this->access(&this->udma, channel + UDMA_CHANNEL_SADDR_OFFSET, addr, true);
+    this->access(&this->udma, channel + UDMA_CHANNEL_SIZE_OFFSET, size, true);
+    this->access(&this->udma, channel + UDMA_CHANNEL_CFG_OFFSET,
+        UDMA_CHANNEL_CFG_EN | UDMA_CHANNEL_CFG_SIZE_32, true);
+}
+
+
+void spim_bench::push_command(spim_bench_cmd_e cmd)
+{
+    uint32_t cmds[16];
+    int nb_cmds = 0;
+
+    // Same sequences as the flash drivers, the payload is sent or received as bytes,
+    // 4 of them per word
+    cmds[nb_cmds++] = SPI_CMD_CFG(this->clkdiv, 0, 0);
+    cmds[nb_cmds++] = SPI_CMD_SOT(0);
+
+    if (cmd == SPIM_BENCH_PROGRAM)
+    {
+        cmds[nb_cmds++] = SPI_CMD_SEND_CMD(0x02, 8, SPI_CMD_QPI_DIS);
+        cmds[nb_cmds++] = SPI_CMD_SEND_BITS(FLASH_ADDR >> 8, 16, SPI_CMD_QPI_DIS);
+        cmds[nb_cmds++] = SPI_CMD_SEND_BITS(FLASH_ADDR & 0xff, 8, SPI_CMD_QPI_DIS);
+        cmds[nb_cmds++] = SPI_CMD_TX_DATA(this->size, SPI_CMD_4_WORD_PER_TRANSF, 8,
+            SPI_CMD_QPI_DIS, SPI_CMD_MSB_FIRST);
+    }
+    else if (cmd == SPIM_BENCH_SINGLE_READ)
+    {
+        cmds[nb_cmds++] = SPI_CMD_SEND_CMD(0x03, 8, SPI_CMD_QPI_DIS);
+        cmds[nb_cmds++] = SPI_CMD_SEND_BITS(FLASH_ADDR >> 8, 16, SPI_CMD_QPI_DIS);
+        cmds[nb_cmds++] = SPI_CMD_SEND_BITS(FLASH_ADDR & 0xff, 8, SPI_CMD_QPI_DIS);
+        cmds[nb_cmds++] = SPI_CMD_RX_DATA(this->size, SPI_CMD_4_WORD_PER_TRANSF, 8,
+            SPI_CMD_QPI_DIS, SPI_CMD_MSB_FIRST);
+    }
+    else
+    {
+        // Opcode on one lane, then 32 bits address and mode on 4 lanes
+        cmds[nb_cmds++] = SPI_CMD_SEND_CMD(0xEC, 8, SPI_CMD_QPI_DIS);
+        cmds[nb_cmds++] = SPI_CMD_SEND_BITS(FLASH_ADDR >> 16, 16, SPI_CMD_QPI_ENA);
+        cmds[nb_cmds++] = SPI_CMD_SEND_BITS(FLASH_ADDR & 0xffff, 16, SPI_CMD_QPI_ENA);
+        cmds[nb_cmds++] = SPI_CMD_SEND_BITS(0, 8, SPI_CMD_QPI_ENA);
+        cmds[nb_cmds++] = SPI_CMD_RX_DATA(this->size, SPI_CMD_4_WORD_PER_TRANSF, 8,
+            SPI_CMD_QPI_ENA, SPI_CMD_MSB_FIRST);
+    }
+
+    cmds[nb_cmds++] = SPI_CMD_EOT(SPI_CMD_EOT_EVENT_ENA, 0);
+
+    for (int i = 0; i < nb_cmds; i++)
+    {
+        this->access(&this->l2, L2_CMD + i * 4, cmds[i], true);
+    }
+
+    if (cmd == SPIM_BENCH_PROGRAM)
+    {
+        this->enqueue(SPIM_TX, L2_TX, this->size);
+    }
+    else
+    {
+        this->enqueue(SPIM_RX, L2_RX, this->size);
+    }
+
+    this->start_cycles = this->get_cycles();
+
+    this->enqueue(SPIM_CMD, L2_CMD, nb_cmds * 4);
+}
+
+
+int spim_bench::check_command(spim_bench_cmd_e cmd)
+{
+    int errors = 0;
+
+    // What was programmed is checked when it is read back
+    if (cmd != SPIM_BENCH_PROGRAM)
+    {
+        for (int i = 0; i < this->size; i += 4)
+        {
+            uint32_t expected = this->access(&this->l2, L2_TX + i, 0, false);
+            uint32_t value = this->access(&this->l2, L2_RX + i, 0, false);
+
+            if (value != expected)
+            {
+                if (errors < 10)
+                {
+                    printf("Wrong value (command: %s, offset: 0x%x, value: 0x%x, expected: 0x%x)\n",
+                        cmd_names[cmd], i, value, expected);
+                }
+                errors++;
+            }
+        }
+    }
+
+    printf("Command %s done (size: %d, cycles: %ld, errors: %d)\n", cmd_names[cmd], this->size,
+        this->cycles, errors);
+
+    return errors;
+}
+
+
+void spim_bench::end(int errors)
+{
+    printf("SPIM check: %s\n", errors ? "failed" : "passed");
+
+    this->clock->stop_engine(errors != 0);
+
+    // Keep an event pending, otherwise the engine can see that there is nothing
+    // left to simulate before it sees the stop request, and reports a failure.
+    this->done = true;
+    this->event_enqueue(this->exec_event, 1000000);
+}
+
+
+void spim_bench::exec_handler(void *__this, vp::clock_event *event)
+{
+    spim_bench *_this = (spim_bench *)__this;
+
+    if (_this->done)
+    {
+        return;
+    }
+
+    if (_this->command == -1)
+    {
+        // Fill the source with a pattern and the destination with something else
+        for (int i = 0; i < _this->size; i += 4)
+        {
+            _this->access(&_this->l2, L2_TX + i, 0x12345678 * (i + 1), true);
+            _this->access(&_this->l2, L2_RX + i, 0, true);
+        }
+
+        // Enable the SPIM and put the flash in its idle state
+        _this->access(&_this->udma, UDMA_CONF_OFFSET + UDMA_CONF_CG_OFFSET, 1, true);
+        _this->spi_cs.sync(false);
+
+        _this->command = 0;
+        _this->push_command(SPIM_BENCH_PROGRAM);
+    }
+    else if (_this->command < (int)NB_COMMANDS)
+    {
+        _this->errors += _this->check_command((spim_bench_cmd_e)_this->command);
+
+        for (int i = 0; i < _this->size; i += 4)
+        {
+            _this->access(&_this->l2, L2_RX + i, 0, true);
+        }
+
+        _this->command++;
+        if (_this->command < (int)NB_COMMANDS)
+        {
+            _this->push_command((spim_bench_cmd_e)_this->command);
+        }
+        else
+        {
+            if (_this->errors)
+            {
+                _this->end(_this->errors);
+                return;
+            }
+
+            _this->iteration = 0;
+            _this->nb_syncs = 0;
+            _this->nb_xfers = 0;
+            _this->push_command(SPIM_BENCH_QUAD_READ);
+            clock_gettime(CLOCK_MONOTONIC, &_this->start_time);
+        }
+    }
+    else
+    {
+        // Benchmark, the quad read is repeated and the next one is pushed as soon as
+        // the previous one is over
+        _this->iteration++;
+        if (_this->iteration < _this->nb_iterations)
+        {
+            _this->push_command(SPIM_BENCH_QUAD_READ);
+        }
+        else
+        {
+            struct timespec end;
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            double duration = (end.tv_sec - _this->start_time.tv_sec) + (end.tv_nsec - _this->start_time.tv_nsec) / 1e9;
+
+            printf("SPIM benchmark: %d quad reads of %d bytes, %.3f s, %.1f KB/s, %ld syncs, %ld transfers\n",
+                _this->nb_iterations, _this->size, duration,
+                (double)_this->nb_iterations * _this->size / duration / 1e3,
+                _this->nb_syncs, _this->nb_xfers);
+
+            _this->end(0);
+            return;
+        }
+    }
+}
+
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new spim_bench(config);
+}
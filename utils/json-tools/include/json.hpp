@@ -28,8 +28,11 @@
 #include <stdio.h>
 #include <vector>
 #include <map>
+#include <stdint.h>
 #include "string.h"
 
+class js_binary_writer;
+
 namespace js {
 
   class config
@@ -68,17 +71,22 @@ namespace js {
     config *create_config(jsmntok_t *tokens, int *_size);
 
     std::map<std::string, config *> childs;
+
+    // Set once the property has been looked up, so that users can know which
+    // properties have already been read
+    bool accessed = false;
   };
 
   class config_object : public config
   {
 
   public:
+    config_object() {}
     config_object(jsmntok_t *tokens, int *size=NULL);
 
     config *get(std::string name);
     config *get_from_list(std::vector<std::string> name_list);
-    std::map<std::string, config *> get_childs() { return childs; }
+    std::map<std::string, config *> get_childs();
 
     int get_child_int(std::string name);
     bool get_child_bool(std::string name);
@@ -92,17 +100,21 @@ namespace js {
   {
 
   public:
+    config_array(std::vector<config *> elems) : elems(elems) {}
     config_array(jsmntok_t *tokens, int *size=NULL);
     config *get_from_list(std::vector<std::string> name_list);
 
-    std::vector<config *> get_elems() { return elems; }
-    config *get_elem(int index) { return elems[index]; }
+    std::vector<config *> get_elems();
+    config *get_elem(int index) { elems[index]->accessed = true; return elems[index]; }
 
     size_t get_size() { return elems.size(); }
 
     void dump(std::string indent="");
 
   private:
+    // Walks the elements without marking them as accessed
+    friend class ::js_binary_writer;
+
     std::vector<config *> elems;
   };
 
@@ -111,6 +123,7 @@ namespace js {
   {
 
   public:
+    config_string(std::string value) : value(value) {}
     config_string(jsmntok_t *tokens);
     config *get_from_list(std::vector<std::string> name_list);
     std::string get_str() { return value; }
@@ -128,8 +141,10 @@ namespace js {
   {
 
   public:
+    config_number(double value) : value(value) {}
     config_number(jsmntok_t *tokens);
     long long int get_int() { return (int)value; }
+    double get_double() { return value; }
     config *get_from_list(std::vector<std::string> name_list);
 
     void dump(std::string indent="");
@@ -143,6 +158,7 @@ namespace js {
   {
 
   public:
+    config_bool(bool value) : value(value) {}
     config_bool(jsmntok_t *tokens);
     bool get_bool() { return (bool)value; }
     config *get_from_list(std::vector<std::string> name_list);
@@ -157,6 +173,26 @@ namespace js {
 
   config *import_config_from_file(std::string config_path);
 
+  // Binary configurations are a flattened copy of a JSON configuration, with all
+  // keys and strings interned, which can be imported by mapping the file instead
+  // of parsing JSON. They are tagged with a hash of the JSON they come from so
+  // that they can be used as a cache.
+  uint64_t hash_config_string(const std::string &config_string);
+
+  // Hash of a JSON configuration file computed from its path, size and modification
+  // time, without reading it. Returns -1 if the file does not exist.
+  int hash_config_file(std::string config_path, uint64_t *hash);
+
+  int export_config_to_binary(config *config, std::string path, uint64_t source_hash);
+
+  // Returns NULL if the file is missing, invalid or comes from another JSON.
+  config *import_config_from_binary(std::string path, uint64_t source_hash);
+
+  // Same as import_config_from_file but goes through the binary cache at cache_path,
+  // which is created or refreshed if it does not match the JSON configuration file.
+  // The JSON file is only read when the cache is refreshed.
+  config *import_config_from_file_cached(std::string config_path, std::string cache_path, bool *cache_hit=NULL);
+
 }
 
 #endif
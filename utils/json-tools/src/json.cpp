@@ -27,6 +27,10 @@
 #include "string.h"
 #include <streambuf>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 std::vector<std::string> split(const std::string& s, char delimiter)
 {
@@ -181,6 +185,14 @@ js::config *js::config_object::get_from_list(std::vector<std::string> name_list)
     name_pos++;
   }
 
+  // Plain names can only match the child with the same name
+  if (name_pos == 0)
+  {
+    auto it = childs.find(name);
+    if (it == childs.end()) return NULL;
+    return it->second->get_from_list(std::vector<std::string>(name_list.begin () + 1, name_list.begin () + name_list.size()));
+  }
+
   for (auto& x: childs) {
 
     if (name == x.first)
@@ -206,7 +218,27 @@ js::config *js::config_object::get_from_list(std::vector<std::string> name_list)
 
 js::config *js::config_object::get(std::string name)
 {
-  return get_from_list(split(name, '/'));
+  js::config *result = get_from_list(split(name, '/'));
+  if (result) result->accessed = true;
+  return result;
+}
+
+std::map<std::string, js::config *> js::config_object::get_childs()
+{
+  for (auto& x: childs)
+  {
+    x.second->accessed = true;
+  }
+  return childs;
+}
+
+std::vector<js::config *> js::config_array::get_elems()
+{
+  for (auto x: elems)
+  {
+    x->accessed = true;
+  }
+  return elems;
 }
 
 js::config_string::config_string(jsmntok_t *tokens)
@@ -333,3 +365,313 @@ std::string js::config_object::get_child_str(std::string name)
   else
     return "";
 }
+
+
+
+// Layout of binary configurations: the header is followed by the node array, the link array,
+// the string offset array and the string characters. Objects and arrays refer to a contiguous
+// range of links, each link giving a child node and, for objects, its key.
+
+#define JS_BINARY_MAGIC   0x4e4f534a
+#define JS_BINARY_VERSION 2
+
+#define JS_BINARY_OBJECT 0
+#define JS_BINARY_ARRAY  1
+#define JS_BINARY_STRING 2
+#define JS_BINARY_NUMBER 3
+#define JS_BINARY_BOOL   4
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t version;
+  uint64_t source_hash;
+  uint32_t nb_nodes;
+  uint32_t nb_links;
+  uint32_t nb_strings;
+  uint32_t strings_size;
+} js_binary_header_t;
+
+typedef struct
+{
+  uint32_t type;
+  uint32_t first;     // First link for objects and arrays, string index for strings, value for booleans
+  uint32_t count;     // Number of links for objects and arrays
+  uint32_t pad;
+  double number;
+} js_binary_node_t;
+
+typedef struct
+{
+  uint32_t key;
+  uint32_t node;
+} js_binary_link_t;
+
+
+class js_binary_writer
+{
+public:
+  uint32_t add_node(js::config *config);
+  uint32_t add_string(std::string str);
+
+  std::vector<js_binary_node_t> nodes;
+  std::vector<js_binary_link_t> links;
+  std::vector<uint32_t> string_offsets;
+  std::string strings;
+
+private:
+  std::map<std::string, uint32_t> string_ids;
+};
+
+
+uint32_t js_binary_writer::add_string(std::string str)
+{
+  auto it = this->string_ids.find(str);
+  if (it != this->string_ids.end()) return it->second;
+
+  uint32_t id = this->string_offsets.size();
+  this->string_ids[str] = id;
+  this->string_offsets.push_back(this->strings.size());
+  this->strings.append(str.c_str(), str.size() + 1);
+  return id;
+}
+
+
+uint32_t js_binary_writer::add_node(js::config *config)
+{
+  uint32_t id = this->nodes.size();
+  js_binary_node_t node = {};
+  this->nodes.push_back(node);
+
+  std::vector<js_binary_link_t> node_links;
+
+  if (js::config_object *object = dynamic_cast<js::config_object *>(config))
+  {
+    node.type = JS_BINARY_OBJECT;
+    for (auto& x: object->childs)
+    {
+      js_binary_link_t link = { this->add_string(x.first), 0 };
+      link.node = this->add_node(x.second);
+      node_links.push_back(link);
+    }
+  }
+  else if (js::config_array *array = dynamic_cast<js::config_array *>(config))
+  {
+    node.type = JS_BINARY_ARRAY;
+    for (auto x: array->elems)
+    {
+      js_binary_link_t link = { 0, this->add_node(x) };
+      node_links.push_back(link);
+    }
+  }
+  else if (js::config_string *string = dynamic_cast<js::config_string *>(config))
+  {
+    node.type = JS_BINARY_STRING;
+    node.first = this->add_string(string->get_str());
+  }
+  else if (js::config_number *number = dynamic_cast<js::config_number *>(config))
+  {
+    node.type = JS_BINARY_NUMBER;
+    node.number = number->get_double();
+  }
+  else
+  {
+    node.type = JS_BINARY_BOOL;
+    node.first = config->get_bool();
+  }
+
+  // Children links are added once all children are done so that they are contiguous
+  node.first = node_links.size() ? this->links.size() : node.first;
+  node.count = node_links.size();
+  this->links.insert(this->links.end(), node_links.begin(), node_links.end());
+
+  this->nodes[id] = node;
+
+  return id;
+}
+
+
+class js_binary_reader
+{
+public:
+  js::config *get_node(uint32_t id);
+
+  js_binary_node_t *nodes;
+  js_binary_link_t *links;
+  uint32_t *string_offsets;
+  const char *strings;
+};
+
+
+js::config *js_binary_reader::get_node(uint32_t id)
+{
+  js_binary_node_t *node = &this->nodes[id];
+
+  switch (node->type)
+  {
+    case JS_BINARY_OBJECT:
+    {
+      js::config_object *object = new js::config_object();
+      for (uint32_t i=0; i<node->count; i++)
+      {
+        js_binary_link_t *link = &this->links[node->first + i];
+        object->childs[&this->strings[this->string_offsets[link->key]]] = this->get_node(link->node);
+      }
+      return object;
+    }
+
+    case JS_BINARY_ARRAY:
+    {
+      std::vector<js::config *> elems;
+      for (uint32_t i=0; i<node->count; i++)
+      {
+        elems.push_back(this->get_node(this->links[node->first + i].node));
+      }
+      return new js::config_array(elems);
+    }
+
+    case JS_BINARY_STRING:
+      return new js::config_string(&this->strings[this->string_offsets[node->first]]);
+
+    case JS_BINARY_NUMBER:
+      return new js::config_number(node->number);
+
+    default:
+      return new js::config_bool(node->first != 0);
+  }
+}
+
+
+uint64_t js::hash_config_string(const std::string &config_string)
+{
+  // FNV-1a, which is enough to detect that the JSON configuration has changed
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (char c: config_string)
+  {
+    hash = (hash ^ (uint8_t)c) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+
+int js::export_config_to_binary(js::config *config, std::string path, uint64_t source_hash)
+{
+  js_binary_writer writer;
+  writer.add_node(config);
+
+  js_binary_header_t header = {};
+  header.magic = JS_BINARY_MAGIC;
+  header.version = JS_BINARY_VERSION;
+  header.source_hash = source_hash;
+  header.nb_nodes = writer.nodes.size();
+  header.nb_links = writer.links.size();
+  header.nb_strings = writer.string_offsets.size();
+  header.strings_size = writer.strings.size();
+
+  // Write to a temporary file which is then renamed so that concurrent simulations
+  // never see a partial file
+  std::string tmp_path = path + "." + std::to_string(getpid());
+  FILE *file = fopen(tmp_path.c_str(), "wb");
+  if (file == NULL) return -1;
+
+  bool failed =
+    fwrite(&header, sizeof(header), 1, file) != 1 ||
+    fwrite(writer.nodes.data(), sizeof(js_binary_node_t), header.nb_nodes, file) != header.nb_nodes ||
+    fwrite(writer.links.data(), sizeof(js_binary_link_t), header.nb_links, file) != header.nb_links ||
+    fwrite(writer.string_offsets.data(), sizeof(uint32_t), header.nb_strings, file) != header.nb_strings ||
+    fwrite(writer.strings.data(), 1, header.strings_size, file) != header.strings_size;
+
+  if (fclose(file) != 0 || failed || rename(tmp_path.c_str(), path.c_str()) != 0)
+  {
+    unlink(tmp_path.c_str());
+    return -1;
+  }
+
+  return 0;
+}
+
+
+js::config *js::import_config_from_binary(std::string path, uint64_t source_hash)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return NULL;
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || (size_t)file_stat.st_size < sizeof(js_binary_header_t))
+  {
+    close(fd);
+    return NULL;
+  }
+
+  size_t size = file_stat.st_size;
+  void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return NULL;
+
+  js::config *result = NULL;
+  js_binary_header_t *header = (js_binary_header_t *)map;
+
+  uint64_t expected_size = sizeof(js_binary_header_t) +
+    (uint64_t)header->nb_nodes * sizeof(js_binary_node_t) +
+    (uint64_t)header->nb_links * sizeof(js_binary_link_t) +
+    (uint64_t)header->nb_strings * sizeof(uint32_t) + header->strings_size;
+
+  if (header->magic == JS_BINARY_MAGIC && header->version == JS_BINARY_VERSION &&
+    header->source_hash == source_hash && header->nb_nodes > 0 && expected_size == size)
+  {
+    js_binary_reader reader;
+    reader.nodes = (js_binary_node_t *)(header + 1);
+    reader.links = (js_binary_link_t *)(reader.nodes + header->nb_nodes);
+    reader.string_offsets = (uint32_t *)(reader.links + header->nb_links);
+    reader.strings = (const char *)(reader.string_offsets + header->nb_strings);
+    result = reader.get_node(0);
+  }
+
+  munmap(map, size);
+
+  return result;
+}
+
+
+int js::hash_config_file(std::string config_path, uint64_t *hash)
+{
+  struct stat file_stat;
+  if (stat(config_path.c_str(), &file_stat) != 0) return -1;
+
+  // The file is identified by its path and inode, and its content by its size and modification
+  // time, so that the cache can be checked without reading the JSON
+  char *real_path = realpath(config_path.c_str(), NULL);
+  std::string key = real_path ? real_path : config_path;
+  free(real_path);
+
+  key += ":" + std::to_string(file_stat.st_ino) + ":" + std::to_string(file_stat.st_size) +
+    ":" + std::to_string(file_stat.st_mtim.tv_sec) + "." + std::to_string(file_stat.st_mtim.tv_nsec);
+
+  *hash = js::hash_config_string(key);
+
+  return 0;
+}
+
+
+js::config *js::import_config_from_file_cached(std::string config_path, std::string cache_path, bool *cache_hit)
+{
+  uint64_t hash;
+  if (js::hash_config_file(config_path, &hash))
+  {
+      throw std::runtime_error(
+              "configuration file does not exist or could not be open");
+  }
+
+  js::config *config = js::import_config_from_binary(cache_path, hash);
+  if (cache_hit) *cache_hit = config != NULL;
+  if (config) return config;
+
+  config = import_config_from_file(config_path);
+
+  if (js::export_config_to_binary(config, cache_path, hash))
+  {
+    fprintf(stderr, "WARNING: could not write configuration cache (path: %s)\n", cache_path.c_str());
+  }
+
+  return config;
+}